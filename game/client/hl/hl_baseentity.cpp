@@ -56,6 +56,10 @@ void Server_EntityCreated( entvars_t* pev )
 {
 }
 
+void Server_EntityInstanceCreated( CBaseEntity* pEntity )
+{
+}
+
 // UTIL_* Stubs
 void UTIL_PrecacheOther( const char *szClassname ) { }
 void UTIL_BloodDrips( const Vector &origin, const Vector &direction, int color, int amount ) { }
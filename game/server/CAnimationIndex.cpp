@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstring>
+
+#include "extdll.h"
+#include "util.h"
+#include "studio.h"
+
+#include "animation.h"
+
+#include "CAnimationIndex.h"
+
+CAnimationIndexCache g_AnimationIndexCache;
+
+CAnimationIndex::CAnimationIndex( const studiohdr_t* pstudiohdr )
+	: m_iLength( pstudiohdr->length )
+	, m_iNumSeq( pstudiohdr->numseq )
+	, m_iNumTransitions( std::max( 0, pstudiohdr->numtransitions ) )
+{
+	const mstudioseqdesc_t* pseqdesc = ( const mstudioseqdesc_t* ) ( ( const byte* ) pstudiohdr + pstudiohdr->seqindex );
+
+	m_Labels.resize( m_iNumSeq );
+	m_Sequences.reserve( m_iNumSeq );
+
+	m_Transitions.resize( m_iNumTransitions * m_iNumTransitions );
+
+	for( int i = 0; i < m_iNumSeq; ++i )
+	{
+		const mstudioseqdesc_t& seqdesc = pseqdesc[ i ];
+
+		auto& label = m_Labels[ i ];
+
+		strncpy( label.data(), seqdesc.label, label.size() - 1 );
+		label[ label.size() - 1 ] = '\0';
+
+		//The first sequence with a name is the one that's found.
+		m_Sequences.emplace( label.data(), i );
+
+		if( seqdesc.activity >= 0 )
+		{
+			if( static_cast<size_t>( seqdesc.activity ) >= m_Activities.size() )
+				m_Activities.resize( seqdesc.activity + 1 );
+
+			Activity_t& activity = m_Activities[ seqdesc.activity ];
+
+			activity.iLastSequence = i;
+
+			if( seqdesc.actweight > 0 )
+			{
+				activity.sequences.push_back( i );
+				activity.cumulativeWeights.push_back( ( activity.cumulativeWeights.empty() ? 0 : activity.cumulativeWeights.back() ) + seqdesc.actweight );
+
+				if( activity.iHeaviestSequence == -1 || seqdesc.actweight > pseqdesc[ activity.iHeaviestSequence ].actweight )
+					activity.iHeaviestSequence = i;
+			}
+		}
+
+		//The first sequence that goes between two nodes is used, forwards before backwards.
+		if( seqdesc.entrynode > 0 && seqdesc.entrynode <= m_iNumTransitions &&
+			seqdesc.exitnode > 0 && seqdesc.exitnode <= m_iNumTransitions )
+		{
+			Transition_t& forward = m_Transitions[ ( seqdesc.entrynode - 1 ) * m_iNumTransitions + ( seqdesc.exitnode - 1 ) ];
+
+			if( forward.iSequence == -1 )
+			{
+				forward.iSequence = i;
+				forward.iDir = 1;
+			}
+
+			if( seqdesc.nodeflags )
+			{
+				Transition_t& backward = m_Transitions[ ( seqdesc.exitnode - 1 ) * m_iNumTransitions + ( seqdesc.entrynode - 1 ) ];
+
+				if( backward.iSequence == -1 )
+				{
+					backward.iSequence = i;
+					backward.iDir = -1;
+				}
+			}
+		}
+	}
+}
+
+bool CAnimationIndex::Matches( const studiohdr_t* pstudiohdr ) const
+{
+	return pstudiohdr->length == m_iLength && pstudiohdr->numseq == m_iNumSeq;
+}
+
+int CAnimationIndex::LookupActivity( const int activity ) const
+{
+	if( activity < 0 || static_cast<size_t>( activity ) >= m_Activities.size() )
+		return ACTIVITY_NOT_AVAILABLE;
+
+	const Activity_t& entry = m_Activities[ activity ];
+
+	if( entry.sequences.empty() )
+		return entry.iLastSequence;
+
+	if( entry.sequences.size() == 1 )
+		return entry.sequences[ 0 ];
+
+	//Same odds as picking each sequence with a chance of its weight out of the total weight so far.
+	const int iWeight = RANDOM_LONG( 0, entry.cumulativeWeights.back() - 1 );
+
+	const size_t uiIndex = std::upper_bound( entry.cumulativeWeights.begin(), entry.cumulativeWeights.end(), iWeight ) - entry.cumulativeWeights.begin();
+
+	return entry.sequences[ uiIndex ];
+}
+
+int CAnimationIndex::LookupActivityHeaviest( const int activity ) const
+{
+	if( activity < 0 || static_cast<size_t>( activity ) >= m_Activities.size() )
+		return ACTIVITY_NOT_AVAILABLE;
+
+	return m_Activities[ activity ].iHeaviestSequence;
+}
+
+int CAnimationIndex::LookupSequence( const char* const pszLabel ) const
+{
+	auto it = m_Sequences.find( pszLabel );
+
+	return it != m_Sequences.end() ? it->second : -1;
+}
+
+int CAnimationIndex::FindTransition( const int iEndNode, const int iInternNode, int& iDir ) const
+{
+	if( iEndNode <= 0 || iEndNode > m_iNumTransitions || iInternNode <= 0 || iInternNode > m_iNumTransitions )
+		return -1;
+
+	const Transition_t& transition = m_Transitions[ ( iEndNode - 1 ) * m_iNumTransitions + ( iInternNode - 1 ) ];
+
+	if( transition.iSequence != -1 )
+		iDir = transition.iDir;
+
+	return transition.iSequence;
+}
+
+const CAnimationIndex* CAnimationIndexCache::GetIndex( const void* pmodel )
+{
+	const studiohdr_t* pstudiohdr = reinterpret_cast<const studiohdr_t*>( pmodel );
+
+	if( !pstudiohdr )
+		return nullptr;
+
+	auto& index = m_Indices[ pstudiohdr ];
+
+	if( !index || !index->Matches( pstudiohdr ) )
+		index = std::make_unique<CAnimationIndex>( pstudiohdr );
+
+	return index.get();
+}
+
+void CAnimationIndexCache::Clear()
+{
+	m_Indices.clear();
+}
@@ -0,0 +1,123 @@
+#ifndef GAME_SERVER_CANIMATIONINDEX_H
+#define GAME_SERVER_CANIMATIONINDEX_H
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "StringUtils.h"
+
+struct studiohdr_t;
+
+/**
+*	Lookup tables for a studio model's sequences, so activities, sequence names and transitions don't need to scan every sequence.
+*/
+class CAnimationIndex final
+{
+public:
+	/**
+	*	Builds the index for the given model.
+	*/
+	explicit CAnimationIndex( const studiohdr_t* pstudiohdr );
+
+	/**
+	*	@return Whether this index was built for the given model.
+	*/
+	bool Matches( const studiohdr_t* pstudiohdr ) const;
+
+	/**
+	*	@return A random sequence for the activity, chosen by sequence weight, or ACTIVITY_NOT_AVAILABLE if the model has none.
+	*/
+	int LookupActivity( const int activity ) const;
+
+	/**
+	*	@return The sequence with the highest weight for the activity, or ACTIVITY_NOT_AVAILABLE if the model has none.
+	*/
+	int LookupActivityHeaviest( const int activity ) const;
+
+	/**
+	*	@return The sequence with the given name, or -1 if the model has none. Names are case insensitive.
+	*/
+	int LookupSequence( const char* const pszLabel ) const;
+
+	/**
+	*	Finds the sequence that goes from one transition node to another.
+	*	@param iEndNode Node to start from.
+	*	@param iInternNode Node to go to.
+	*	@param[ out ] iDir 1 if the sequence should be played forwards, -1 if it should be played backwards.
+	*	@return The sequence, or -1 if there is none.
+	*/
+	int FindTransition( const int iEndNode, const int iInternNode, int& iDir ) const;
+
+private:
+	struct Activity_t
+	{
+		//Sequences with a positive weight, and the sum of their weights and those before them.
+		std::vector<int> sequences;
+		std::vector<int> cumulativeWeights;
+
+		//Used when no sequence has a positive weight. ACTIVITY_NOT_AVAILABLE if there are no sequences.
+		int iLastSequence = -1;
+
+		int iHeaviestSequence = -1;
+	};
+
+	struct Transition_t
+	{
+		int iSequence = -1;
+		int iDir = 0;
+	};
+
+	//Used to detect models that were reloaded into the same memory.
+	int m_iLength;
+	int m_iNumSeq;
+
+	std::vector<Activity_t> m_Activities;
+
+	//Sequence names are copied so the keys stay valid if the engine moves the model.
+	std::vector<std::array<char, 32>> m_Labels;
+
+	typedef std::unordered_map<const char*, int, RawCharHashI, RawCharEqualToI> SequenceMap_t;
+
+	SequenceMap_t m_Sequences;
+
+	int m_iNumTransitions;
+
+	//Indexed by ( end node - 1 ) * m_iNumTransitions + ( intern node - 1 ).
+	std::vector<Transition_t> m_Transitions;
+
+private:
+	CAnimationIndex( const CAnimationIndex& ) = delete;
+	CAnimationIndex& operator=( const CAnimationIndex& ) = delete;
+};
+
+/**
+*	Caches the animation index of every model that's used.
+*/
+class CAnimationIndexCache final
+{
+public:
+	CAnimationIndexCache() = default;
+
+	/**
+	*	@return The index for the given model, built on first use. Null if pmodel is null.
+	*/
+	const CAnimationIndex* GetIndex( const void* pmodel );
+
+	/**
+	*	Frees all indices. Models are unloaded when the map changes.
+	*/
+	void Clear();
+
+private:
+	std::unordered_map<const studiohdr_t*, std::unique_ptr<CAnimationIndex>> m_Indices;
+
+private:
+	CAnimationIndexCache( const CAnimationIndexCache& ) = delete;
+	CAnimationIndexCache& operator=( const CAnimationIndexCache& ) = delete;
+};
+
+extern CAnimationIndexCache g_AnimationIndexCache;
+
+#endif //GAME_SERVER_CANIMATIONINDEX_H
@@ -14,6 +14,15 @@
 
 #include "nodes/Nodes.h"
 #include "nodes/CTestHull.h"
+#include "nodes/CPathRequestQueue.h"
+#include "nodes/CGraphQueryTrace.h"
+#include "nodes/CNodeVisibility.h"
+#include "ai/CAIProfiler.h"
+#include "ai/CLocalMoveCache.h"
+#include "ai/CSightCache.h"
+#include "ai/CThinkScheduler.h"
+#include "entities/CEntityNameIndex.h"
+#include "entities/CSpatialPartition.h"
 
 #if USE_ANGELSCRIPT
 #include "Angelscript/CHLASServerManager.h"
@@ -81,6 +90,14 @@ void Server_EntityCreated( entvars_t* pev )
 	g_Server.EntityCreated( pev );
 }
 
+void Server_EntityInstanceCreated( CBaseEntity* pEntity )
+{
+	//The engine sets the classname before creating the instance.
+	g_ClassnameIndex.Update( pEntity );
+
+	g_SpatialPartition.EntityMoved( pEntity->edict() );
+}
+
 bool CServerGameInterface::ClientConnect( edict_t* pEntity, const char *pszName, const char *pszAddress, char szRejectReason[ CCONNECT_REJECT_REASON_SIZE ] )
 {
 	//Note: do not create the player instance here. The engine wipes it out before calling ClientPutInServer. - Solokiller
@@ -568,6 +585,29 @@ void CServerGameInterface::Activate( edict_t* pEdictList, const int edictCount,
 			ALERT( at_console, "**Graph Pointers Set!\n" );
 		}
 	}
+
+	if( WorldGraph.m_fGraphPresent && WorldGraph.m_fGraphPointersSet && WorldGraph.m_cNodes > 0 )
+	{
+		bool bSaveGraph = false;
+
+		// Graphs written by the node graph compiler leave the routing tables to the game
+		// when they're too large for the flat tables. They need the link entities.
+		if( !WorldGraph.m_fRoutingComplete )
+		{
+			WorldGraph.ComputeStaticRoutingTables();
+			bSaveGraph = true;
+		}
+
+		// The visibility matrix needs the world to trace against.
+		if( !g_NodeVisibility.IsBuilt() && CNodeVisibility::ShouldBuild( WorldGraph ) )
+		{
+			g_NodeVisibility.Build( WorldGraph );
+			bSaveGraph = true;
+		}
+
+		if( bSaveGraph )
+			WorldGraph.FSaveGraph( STRING( gpGlobals->mapname ) );
+	}
 }
 
 void CServerGameInterface::Deactivate()
@@ -601,6 +641,16 @@ void CServerGameInterface::StartFrame()
 
 	CMap::GetInstance()->Think();
 
+	g_GraphQueryTrace.RunFrame( WorldGraph );
+
+	g_SightCache.RunFrame();
+	g_LocalMoveCache.RunFrame();
+	g_ThinkScheduler.RunFrame();
+	g_AIProfiler.RunFrame();
+	g_SpatialPartition.RunFrame();
+
+	g_PathRequestQueue.RunFrame();
+
 #if USE_ANGELSCRIPT
 	g_ASManager.Think();
 #endif
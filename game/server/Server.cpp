@@ -15,6 +15,7 @@
 #include "extdll.h"
 #include "eiface.h"
 #include "util.h"
+#include "cbase.h"
 
 #include "UserMessages.h"
 
@@ -22,6 +23,13 @@
 
 #include "Server.h"
 
+#include "ai/AICommands.h"
+#include "entities/EntityCommands.h"
+#include "nodes/NodeGraphCommands.h"
+
+#include "entities/CSoundEnt.h"
+#include "entities/NPCs/CScheduleRegistry.h"
+
 cvar_t g_DummyCvar = { "_not_a_real_cvar_", "0" };
 
 cvar_t	displaysoundlist = {"displaysoundlist","0"};
@@ -58,6 +66,80 @@ cvar_t	as_plugin_list_file = { "as_plugin_list_file", "default_plugins.txt", FCV
 //Config file that contains the MySQL settings to use for default connections.
 cvar_t	as_mysql_config = { "as_mysql_config", "server/default_mysql_config.txt", FCVAR_SERVER | FCVAR_UNLOGGED };
 
+//Number of threads used to compute node graph routing tables. 0 uses one thread per core, 1 disables threading.
+cvar_t	sv_nodegraph_threads = { "sv_nodegraph_threads", "0" };
+
+//Search used to find paths when routing tables aren't available. 0 is the original Dijkstra search, 1 is A*.
+cvar_t	sv_nodegraph_search = { "sv_nodegraph_search", "1" };
+
+//Print the number of nodes expanded by each path search.
+cvar_t	sv_nodegraph_search_debug = { "sv_nodegraph_search_debug", "0" };
+
+//Method used to find the nearest node to a point. 0 is the original region tables, 1 is the node grid.
+cvar_t	sv_nodegraph_nearest = { "sv_nodegraph_nearest", "1" };
+
+//Routing tables built for new node graphs. 0 uses hierarchical tables only for graphs with more than 1024 nodes, 1 always uses them.
+cvar_t	sv_nodegraph_hierarchy = { "sv_nodegraph_hierarchy", "0" };
+
+//Whether monsters queue node graph path searches and wait for them instead of searching right away. 0 never does,
+//1 only does when routing tables aren't available, 2 always does.
+cvar_t	sv_nodegraph_async = { "sv_nodegraph_async", "1" };
+
+//Microseconds per frame spent on queued path searches. At least one search is done each frame.
+cvar_t	sv_nodegraph_path_budget = { "sv_nodegraph_path_budget", "1000" };
+
+//Maximum number of node graph paths and path lengths to cache. 0 disables the cache.
+cvar_t	sv_nodegraph_pathcache = { "sv_nodegraph_pathcache", "256" };
+
+//Record node graph queries to maps/graphs/<map>.nqt for the node graph benchmark. Starting a recording overwrites the previous one for the map.
+cvar_t	sv_nodegraph_trace = { "sv_nodegraph_trace", "0" };
+
+//Build a node to node visibility matrix for graphs with up to 4096 nodes, and use it to skip cover candidates before tracing.
+cvar_t	sv_nodegraph_visibility = { "sv_nodegraph_visibility", "1" };
+
+//Maximum number of sounds and scents that monsters can hear at once. The pool starts with 64, and grows by 64 when it's full.
+cvar_t	sv_soundpool_max = { "sv_soundpool_max", "256" };
+
+//Reuse line of sight checks between monsters and clients for the rest of the frame, and keep a per frame list of them for Look.
+cvar_t	sv_ai_sightcache = { "sv_ai_sightcache", "1" };
+
+//Lower the think rate of monsters that no player is near.
+cvar_t	sv_ai_lod = { "sv_ai_lod", "1" };
+
+//Monsters in a player's PVS and within this distance of them think at the full rate.
+cvar_t	sv_ai_lod_near = { "sv_ai_lod_near", "1024" };
+
+//Monsters out of every player's PVS and further than this from all of them are dormant.
+cvar_t	sv_ai_lod_far = { "sv_ai_lod_far", "3072" };
+
+//Seconds between thinks for monsters that aren't near a player, and for dormant monsters.
+cvar_t	sv_ai_lod_reduced_interval = { "sv_ai_lod_reduced_interval", "0.2" };
+cvar_t	sv_ai_lod_dormant_interval = { "sv_ai_lod_dormant_interval", "0.5" };
+
+//Draw each monster's level of detail above its head: green is full, yellow reduced, red dormant.
+cvar_t	sv_ai_lod_debug = { "sv_ai_lod_debug", "0" };
+
+//Spread monster thinks evenly across frames.
+cvar_t	sv_ai_think_stagger = { "sv_ai_think_stagger", "1" };
+
+//Microseconds of monster thinks per frame, after which thinks of monsters out of combat are put off until the next frame. 0 disables the budget.
+cvar_t	sv_ai_think_budget = { "sv_ai_think_budget", "4000" };
+
+//Collect call counts, time and traces of monster AI functions per class, schedule and task. See ai_profile.
+cvar_t	sv_ai_profile = { "sv_ai_profile", "0" };
+
+//Reuse the results of monster local move checks for the rest of the frame, and fail moves that go past a spot that was already found blocked.
+cvar_t	sv_ai_movecache = { "sv_ai_movecache", "1" };
+
+//Find entities by targetname through an index instead of searching all entities. 2 also searches all entities and reports differences.
+cvar_t	sv_targetname_index = { "sv_targetname_index", "1" };
+
+//Find entities by classname through an index instead of searching all entities. 2 also searches all entities and reports differences.
+cvar_t	sv_classname_index = { "sv_classname_index", "1" };
+
+//Find entities in boxes and spheres through a grid instead of testing all entities. 2 also tests all entities and reports differences.
+cvar_t	sv_entity_grid = { "sv_entity_grid", "1" };
+
 // Engine Cvars
 cvar_t 	*g_psv_gravity = NULL;
 cvar_t	*g_psv_aim = NULL;
@@ -623,6 +705,32 @@ void GameDLLInit( void )
 
 	CVAR_REGISTER( &as_mysql_config );
 
+	CVAR_REGISTER( &sv_nodegraph_threads );
+	CVAR_REGISTER( &sv_nodegraph_search );
+	CVAR_REGISTER( &sv_nodegraph_search_debug );
+	CVAR_REGISTER( &sv_nodegraph_nearest );
+	CVAR_REGISTER( &sv_nodegraph_hierarchy );
+	CVAR_REGISTER( &sv_nodegraph_async );
+	CVAR_REGISTER( &sv_nodegraph_path_budget );
+	CVAR_REGISTER( &sv_nodegraph_pathcache );
+	CVAR_REGISTER( &sv_nodegraph_trace );
+	CVAR_REGISTER( &sv_nodegraph_visibility );
+	CVAR_REGISTER( &sv_soundpool_max );
+	CVAR_REGISTER( &sv_ai_sightcache );
+	CVAR_REGISTER( &sv_ai_lod );
+	CVAR_REGISTER( &sv_ai_lod_near );
+	CVAR_REGISTER( &sv_ai_lod_far );
+	CVAR_REGISTER( &sv_ai_lod_reduced_interval );
+	CVAR_REGISTER( &sv_ai_lod_dormant_interval );
+	CVAR_REGISTER( &sv_ai_lod_debug );
+	CVAR_REGISTER( &sv_ai_think_stagger );
+	CVAR_REGISTER( &sv_ai_think_budget );
+	CVAR_REGISTER( &sv_ai_profile );
+	CVAR_REGISTER( &sv_ai_movecache );
+	CVAR_REGISTER( &sv_targetname_index );
+	CVAR_REGISTER( &sv_classname_index );
+	CVAR_REGISTER( &sv_entity_grid );
+
 // REGISTER CVARS FOR SKILL LEVEL STUFF
 	// Agrunt
 	CVAR_REGISTER ( &sk_agrunt_health1 );// {"sk_agrunt_health1","0"};
@@ -1135,6 +1243,14 @@ void GameDLLInit( void )
 	CVAR_REGISTER ( &sk_player_leg3 );
 // END REGISTER CVARS FOR SKILL LEVEL STUFF
 
+	NodeGraph_RegisterCommands();
+	SoundEnt_RegisterCommands();
+	AI_RegisterCommands();
+	Entity_RegisterCommands();
+
+	if( !g_ScheduleRegistry.Initialize() )
+		ALERT( at_error, "One or more monster schedule lists are invalid\n" );
+
 	//Link user messages now.
 	LinkUserMessages();
 
@@ -42,6 +42,31 @@ extern cvar_t	defaultteam;
 extern cvar_t	allowmonsters;
 extern cvar_t	as_plugin_list_file;
 extern cvar_t	as_mysql_config;
+extern cvar_t	sv_nodegraph_threads;
+extern cvar_t	sv_nodegraph_search;
+extern cvar_t	sv_nodegraph_search_debug;
+extern cvar_t	sv_nodegraph_nearest;
+extern cvar_t	sv_nodegraph_hierarchy;
+extern cvar_t	sv_nodegraph_async;
+extern cvar_t	sv_nodegraph_path_budget;
+extern cvar_t	sv_nodegraph_pathcache;
+extern cvar_t	sv_nodegraph_trace;
+extern cvar_t	sv_nodegraph_visibility;
+extern cvar_t	sv_soundpool_max;
+extern cvar_t	sv_ai_sightcache;
+extern cvar_t	sv_ai_lod;
+extern cvar_t	sv_ai_lod_near;
+extern cvar_t	sv_ai_lod_far;
+extern cvar_t	sv_ai_lod_reduced_interval;
+extern cvar_t	sv_ai_lod_dormant_interval;
+extern cvar_t	sv_ai_lod_debug;
+extern cvar_t	sv_ai_think_stagger;
+extern cvar_t	sv_ai_think_budget;
+extern cvar_t	sv_ai_profile;
+extern cvar_t	sv_ai_movecache;
+extern cvar_t	sv_targetname_index;
+extern cvar_t	sv_classname_index;
+extern cvar_t	sv_entity_grid;
 
 // Engine Cvars
 extern cvar_t	*g_psv_gravity;
@@ -28,6 +28,9 @@
 #include "CStudioBlending.h"
 
 #include "CMap.h"
+#include "entities/CEntityNameIndex.h"
+#include "entities/CSpatialPartition.h"
+#include "nodes/Nodes.h"
 
 #include "engine/saverestore/CSaveRestoreBuffer.h"
 #include "engine/saverestore/CSave.h"
@@ -197,6 +200,13 @@ int DispatchSpawn( edict_t *pent )
 
 		if( pEntity )
 		{
+			//Spawn can set the classname and targetname directly.
+			g_ClassnameIndex.Update( pEntity );
+			g_TargetnameIndex.Update( pEntity );
+
+			//The edict may have belonged to an entity that node graph links pass through.
+			WorldGraph.LinkEntStateChanged( pEntity->pev );
+
 			if( g_pGameRules && !g_pGameRules->IsAllowedToSpawn( pEntity ) )
 				return -1;	// return that this entity should be deleted
 			if( pEntity->GetFlags().Any(FL_KILLME ) )
@@ -282,6 +292,17 @@ void DispatchKeyValue( edict_t *pentKeyvalue, KeyValueData *pkvd )
 
 	EntvarsKeyvalue( VARS( pentKeyvalue ), pkvd );
 
+	if( pkvd->fHandled )
+	{
+		if( CBaseEntity* pEntity = GET_PRIVATE( pentKeyvalue ) )
+		{
+			if( FStrEq( pkvd->szKeyName, "classname" ) )
+				g_ClassnameIndex.Update( pEntity );
+			else if( FStrEq( pkvd->szKeyName, "targetname" ) )
+				g_TargetnameIndex.Update( pEntity );
+		}
+	}
+
 	// If the key was an entity variable, or there's no class set yet, don't look for the object, it may
 	// not exist yet.
 	if( pkvd->fHandled || pkvd->szClassName == NULL )
@@ -427,6 +448,13 @@ int DispatchRestore( edict_t *pent, SAVERESTOREDATA *pSaveData, int globalEntity
 		// Again, could be deleted, get the pointer again.
 		pEntity = ( CBaseEntity * ) GET_PRIVATE( pent );
 
+		//Restoring overwrites the classname and targetname.
+		if( pEntity )
+		{
+			g_ClassnameIndex.Update( pEntity );
+			g_TargetnameIndex.Update( pEntity );
+		}
+
 #if 0
 		if( pEntity && pEntity->HasGlobalName() && globalEntity )
 		{
@@ -479,6 +507,9 @@ void DispatchObjectCollisionBox( edict_t *pent )
 	}
 	else
 		SetObjectCollisionBox( &pent->v );
+
+	//The engine calls this whenever it links an entity, so this catches every change to its bounds.
+	g_SpatialPartition.EntityMoved( pent );
 }
 
 void SaveWriteFields( SAVERESTOREDATA *pSaveData, const char *pname, void *pBaseData, engine::TYPEDESCRIPTION *pFields, int fieldCount )
@@ -499,6 +530,11 @@ void OnFreeEntPrivateData( edict_t* pEdict )
 	{
 		CBaseEntity* pEntity = GET_PRIVATE( pEdict );
 
+		g_ClassnameIndex.Remove( pEntity );
+		g_TargetnameIndex.Remove( pEntity );
+
+		WorldGraph.LinkEntRemoved( &pEdict->v );
+
 		UTIL_DestructEntity( pEntity );
 	}
 }
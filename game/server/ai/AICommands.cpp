@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CAILevelOfDetail.h"
+#include "CAIProfiler.h"
+#include "CLocalMoveCache.h"
+#include "CSightCache.h"
+#include "CThinkScheduler.h"
+
+#include "AICommands.h"
+
+void ServerCommand_AISightStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_SightCache.ResetStats();
+		Alert( at_console, "Sight cache statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = g_SightCache.GetStats();
+
+	const double flHitRate = stats.ullQueries > 0 ? 100.0 * stats.ullHits / stats.ullQueries : 0;
+	const double flHitsPerFrame = stats.uiFrames > 0 ? static_cast<double>( stats.ullHits ) / stats.uiFrames : 0;
+
+	Alert( at_console, "Sight cache (sv_ai_sightcache is %d): %u sight candidates last frame\n",
+		   static_cast<int>( sv_ai_sightcache.value ), stats.uiLastFrameCandidates );
+	Alert( at_console, "%llu queries, %llu hits (%.1f%% hit rate), %llu from the other direction\n",
+		   stats.ullQueries, stats.ullHits, flHitRate, stats.ullReverseHits );
+	Alert( at_console, "Traces saved per frame: %u last frame, %.1f average, %u max over %u frames\n",
+		   stats.uiLastFrameHits, flHitsPerFrame, stats.uiMaxFrameHits, stats.uiFrames );
+}
+
+void ServerCommand_AILODStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_AILevelOfDetail.ResetStats();
+		Alert( at_console, "AI level of detail statistics reset\n" );
+		return;
+	}
+
+	//Count the monsters in each band as of their last think.
+	int cMonsters[ static_cast<int>( AILOD::COUNT ) ] = {};
+
+	for( int i = 1; i < gpGlobals->maxEntities; ++i )
+	{
+		edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex( i );
+
+		if( !pEdict || pEdict->free || !( pEdict->v.flags & FL_MONSTER ) )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+
+		CBaseMonster* pMonster = pEntity ? pEntity->MyMonsterPointer() : nullptr;
+
+		if( pMonster && !pMonster->IsPlayer() )
+			++cMonsters[ static_cast<int>( pMonster->m_AILOD ) ];
+	}
+
+	const auto& stats = g_AILevelOfDetail.GetStats();
+
+	Alert( at_console, "AI level of detail (sv_ai_lod is %d):\n", static_cast<int>( sv_ai_lod.value ) );
+
+	for( int i = 0; i < static_cast<int>( AILOD::COUNT ); ++i )
+	{
+		Alert( at_console, "%-8s %d monsters, %llu thinks\n", CAILevelOfDetail::GetName( static_cast<AILOD>( i ) ), cMonsters[ i ], stats.ullThinks[ i ] );
+	}
+}
+
+void ServerCommand_AIThinkStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_ThinkScheduler.ResetStats();
+		Alert( at_console, "AI think statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = g_ThinkScheduler.GetStats();
+
+	const double flAverageTime = stats.uiFrames > 0 ? static_cast<double>( stats.ullMicroseconds ) / stats.uiFrames : 0;
+	const double flAverageThinks = stats.uiFrames > 0 ? static_cast<double>( stats.ullThinks ) / stats.uiFrames : 0;
+
+	Alert( at_console, "AI thinks (sv_ai_think_budget is %d us, sv_ai_think_stagger is %d) over %u frames:\n",
+		   static_cast<int>( sv_ai_think_budget.value ), static_cast<int>( sv_ai_think_stagger.value ), stats.uiFrames );
+	Alert( at_console, "Time per frame:   %u us last frame, %.1f us average, %u us max\n", stats.uiLastFrameMicroseconds, flAverageTime, stats.uiMaxFrameMicroseconds );
+	Alert( at_console, "Thinks per frame: %u last frame, %.1f average, %u max\n", stats.uiLastFrameThinks, flAverageThinks, stats.uiMaxFrameThinks );
+	Alert( at_console, "Deferrals: %u last frame, %llu total\n", stats.uiLastFrameDeferrals, stats.ullDeferrals );
+}
+
+void ServerCommand_AIMoveCacheStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_LocalMoveCache.ResetStats();
+		Alert( at_console, "Local move cache statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = g_LocalMoveCache.GetStats();
+
+	const double flHitRate = stats.ullQueries > 0 ? 100.0 * ( stats.ullHits + stats.ullBlockedHits ) / stats.ullQueries : 0;
+
+	Alert( at_console, "Local move cache (sv_ai_movecache is %d) over %u frames:\n", static_cast<int>( sv_ai_movecache.value ), stats.uiFrames );
+	Alert( at_console, "%llu queries, %llu hits, %llu blocked by earlier moves (%.1f%% hit rate)\n",
+		   stats.ullQueries, stats.ullHits, stats.ullBlockedHits, flHitRate );
+	Alert( at_console, "%llu walk moves saved; hits per frame: %u last frame, %u max\n", stats.ullWalkMovesSaved, stats.uiLastFrameHits, stats.uiMaxFrameHits );
+}
+
+void ServerCommand_AIProfile()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_AIProfiler.Reset();
+		Alert( at_console, "AI profile reset\n" );
+		return;
+	}
+
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "write" ) )
+	{
+		if( CMD_ARGC() < 3 )
+		{
+			Alert( at_console, "Usage: ai_profile write <filename relative to the game directory, .csv or .json>\n" );
+			return;
+		}
+
+		g_AIProfiler.Write( CMD_ARGV( 2 ) );
+		return;
+	}
+
+	const auto& entries = g_AIProfiler.GetEntries();
+
+	//Show the entries that took the most time.
+	std::vector<const AIProfileEntry_t*> sorted;
+
+	sorted.reserve( entries.size() );
+
+	for( const auto& entry : entries )
+		sorted.push_back( &entry );
+
+	std::sort( sorted.begin(), sorted.end(),
+		[]( const AIProfileEntry_t* pLHS, const AIProfileEntry_t* pRHS )
+		{
+			return pLHS->totalTime > pRHS->totalTime;
+		}
+	);
+
+	size_t uiCount = 20;
+
+	if( CMD_ARGC() >= 2 )
+		uiCount = std::max( 1, atoi( CMD_ARGV( 1 ) ) );
+
+	uiCount = std::min( uiCount, sorted.size() );
+
+	Alert( at_console, "AI profile (sv_ai_profile is %d): %u entries, top %u by time\n",
+		   static_cast<int>( sv_ai_profile.value ), static_cast<unsigned int>( sorted.size() ), static_cast<unsigned int>( uiCount ) );
+	Alert( at_console, "%-24s %-18s %-32s %10s %12s %10s %10s\n", "Class", "Function", "Schedule/task", "Calls", "Total us", "Avg us", "Traces" );
+
+	char szId[ 64 ];
+
+	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+	{
+		const auto& entry = *sorted[ uiIndex ];
+
+		if( entry.pszSchedule )
+			snprintf( szId, sizeof( szId ), "%s", entry.pszSchedule );
+		else if( entry.category == AIProfileCategory::START_TASK || entry.category == AIProfileCategory::RUN_TASK )
+			snprintf( szId, sizeof( szId ), "task %d", entry.iTask );
+		else
+			szId[ 0 ] = '\0';
+
+		const double flMicroseconds = CAIProfiler::GetMicroseconds( entry );
+
+		Alert( at_console, "%-24s %-18s %-32s %10llu %12.1f %10.3f %10llu\n",
+			   g_AIProfiler.GetClassName( entry.uiClass ), CAIProfiler::GetCategoryName( entry.category ), szId,
+			   entry.ullCalls, flMicroseconds, flMicroseconds / entry.ullCalls, entry.ullTraces );
+	}
+}
+
+void AI_RegisterCommands()
+{
+	g_engfuncs.pfnAddServerCommand( "ai_sightstats", &::ServerCommand_AISightStats );
+	g_engfuncs.pfnAddServerCommand( "ai_lodstats", &::ServerCommand_AILODStats );
+	g_engfuncs.pfnAddServerCommand( "ai_thinkstats", &::ServerCommand_AIThinkStats );
+	g_engfuncs.pfnAddServerCommand( "ai_movecachestats", &::ServerCommand_AIMoveCacheStats );
+	g_engfuncs.pfnAddServerCommand( "ai_profile", &::ServerCommand_AIProfile );
+}
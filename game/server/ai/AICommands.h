@@ -0,0 +1,9 @@
+#ifndef GAME_SERVER_AI_AICOMMANDS_H
+#define GAME_SERVER_AI_AICOMMANDS_H
+
+/**
+*	Registers the monster AI server commands.
+*/
+void AI_RegisterCommands();
+
+#endif //GAME_SERVER_AI_AICOMMANDS_H
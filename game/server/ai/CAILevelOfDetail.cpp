@@ -0,0 +1,122 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "CBasePlayer.h"
+
+#include "Server.h"
+
+#include "CAILevelOfDetail.h"
+
+CAILevelOfDetail g_AILevelOfDetail;
+
+void CAILevelOfDetail::ResetStats()
+{
+	m_Stats = AILODStats_t();
+}
+
+AILOD CAILevelOfDetail::Classify( const CBaseMonster* pMonster ) const
+{
+	if( sv_ai_lod.value == 0 )
+		return AILOD::FULL;
+
+	//Scripts and death animations are timed to the think rate.
+	if( pMonster->m_MonsterState == MONSTERSTATE_SCRIPT || pMonster->m_MonsterState == MONSTERSTATE_DEAD ||
+		pMonster->m_pCine || pMonster->pev->deadflag != DEAD_NO )
+		return AILOD::FULL;
+
+	float flNearestDistSquared = -1;
+
+	for( int iPlayer = 1; iPlayer <= gpGlobals->maxClients; ++iPlayer )
+	{
+		CBasePlayer* pPlayer = UTIL_PlayerByIndex( iPlayer );
+
+		if( !pPlayer || !pPlayer->IsConnected() )
+			continue;
+
+		const Vector vecDelta = pPlayer->GetAbsOrigin() - pMonster->GetAbsOrigin();
+		const float flDistSquared = DotProduct( vecDelta, vecDelta );
+
+		if( flNearestDistSquared < 0 || flDistSquared < flNearestDistSquared )
+			flNearestDistSquared = flDistSquared;
+	}
+
+	//Nobody to think for.
+	if( flNearestDistSquared < 0 )
+		return pMonster->m_MonsterState == MONSTERSTATE_COMBAT ? AILOD::REDUCED : AILOD::DORMANT;
+
+	const bool fInPVS = UTIL_FindClientInPVS( pMonster ) != nullptr;
+
+	if( fInPVS && flNearestDistSquared <= sv_ai_lod_near.value * sv_ai_lod_near.value )
+		return AILOD::FULL;
+
+	if( fInPVS || flNearestDistSquared <= sv_ai_lod_far.value * sv_ai_lod_far.value || pMonster->m_MonsterState == MONSTERSTATE_COMBAT )
+		return AILOD::REDUCED;
+
+	return AILOD::DORMANT;
+}
+
+float CAILevelOfDetail::GetThinkInterval( const AILOD lod ) const
+{
+	//Never think less often than the default.
+	switch( lod )
+	{
+	default:
+	case AILOD::FULL:		return 0.1;
+	case AILOD::REDUCED:	return max( 0.1f, sv_ai_lod_reduced_interval.value );
+	case AILOD::DORMANT:	return max( 0.1f, sv_ai_lod_dormant_interval.value );
+	}
+}
+
+void CAILevelOfDetail::OnThink( const CBaseMonster* pMonster, const AILOD lod, const float flInterval )
+{
+	++m_Stats.ullThinks[ static_cast<int>( lod ) ];
+
+	if( sv_ai_lod_debug.value == 0 )
+		return;
+
+	//A short line above the monster's head, lasting until its next think. Green is FULL, yellow REDUCED and red DORMANT.
+	const byte colors[][ 3 ] =
+	{
+		{ 0, 255, 0 },
+		{ 255, 255, 0 },
+		{ 255, 0, 0 }
+	};
+
+	const byte* const pColor = colors[ static_cast<int>( lod ) ];
+
+	const Vector vecStart = Vector( pMonster->GetAbsOrigin().x, pMonster->GetAbsOrigin().y, pMonster->pev->absmax.z + 8 );
+
+	extern short g_sModelIndexLaser;
+
+	MESSAGE_BEGIN( MSG_BROADCAST, SVC_TEMPENTITY );
+		WRITE_BYTE( TE_BEAMPOINTS );
+		WRITE_COORD( vecStart.x );
+		WRITE_COORD( vecStart.y );
+		WRITE_COORD( vecStart.z );
+		WRITE_COORD( vecStart.x );
+		WRITE_COORD( vecStart.y );
+		WRITE_COORD( vecStart.z + 16 );
+		WRITE_SHORT( g_sModelIndexLaser );
+		WRITE_BYTE( 0 );	// frame start
+		WRITE_BYTE( 0 );	// framerate
+		WRITE_BYTE( max( 1, static_cast<int>( flInterval * 10 ) ) );	// life
+		WRITE_BYTE( 20 );	// width
+		WRITE_BYTE( 0 );	// noise
+		WRITE_BYTE( pColor[ 0 ] );	// r, g, b
+		WRITE_BYTE( pColor[ 1 ] );
+		WRITE_BYTE( pColor[ 2 ] );
+		WRITE_BYTE( 255 );	// brightness
+		WRITE_BYTE( 0 );	// speed
+	MESSAGE_END();
+}
+
+const char* CAILevelOfDetail::GetName( const AILOD lod )
+{
+	switch( lod )
+	{
+	case AILOD::FULL:		return "Full";
+	case AILOD::REDUCED:	return "Reduced";
+	case AILOD::DORMANT:	return "Dormant";
+	default:				return "Unknown";
+	}
+}
@@ -0,0 +1,80 @@
+#ifndef GAME_SERVER_AI_CAILEVELOFDETAIL_H
+#define GAME_SERVER_AI_CAILEVELOFDETAIL_H
+
+class CBaseMonster;
+
+/**
+*	How much thinking a monster does, based on how close it is to the players.
+*/
+enum class AILOD
+{
+	/**
+	*	Near a player and in their PVS: thinks every 0.1 seconds.
+	*/
+	FULL = 0,
+
+	/**
+	*	In a player's PVS, or within sv_ai_lod_far of one: thinks every sv_ai_lod_reduced_interval seconds.
+	*/
+	REDUCED,
+
+	/**
+	*	Out of every player's PVS and further than sv_ai_lod_far: thinks every sv_ai_lod_dormant_interval seconds.
+	*	Doesn't look or listen, and doesn't handle animation events.
+	*/
+	DORMANT,
+
+	COUNT
+};
+
+/**
+*	AI level of detail statistics.
+*/
+struct AILODStats_t
+{
+	//Monster thinks in each band.
+	unsigned long long ullThinks[ static_cast<int>( AILOD::COUNT ) ] = {};
+};
+
+/**
+*	Lowers the think rate of monsters that no player is near, so maps can have many more monsters.
+*	Monsters in scripts or dying always get FULL, and monsters in combat at least REDUCED, so fights away from players continue as before.
+*	Controlled by sv_ai_lod; sv_ai_lod_debug shows each monster's band.
+*/
+class CAILevelOfDetail final
+{
+public:
+	CAILevelOfDetail() = default;
+
+	const AILODStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	/**
+	*	Finds the band that a monster should think in.
+	*/
+	AILOD Classify( const CBaseMonster* pMonster ) const;
+
+	/**
+	*	@return Number of seconds between thinks in the given band.
+	*/
+	float GetThinkInterval( const AILOD lod ) const;
+
+	/**
+	*	Counts a think in the given band, and draws the band above the monster if sv_ai_lod_debug is set.
+	*/
+	void OnThink( const CBaseMonster* pMonster, const AILOD lod, const float flInterval );
+
+	static const char* GetName( const AILOD lod );
+
+private:
+	AILODStats_t m_Stats;
+
+private:
+	CAILevelOfDetail( const CAILevelOfDetail& ) = delete;
+	CAILevelOfDetail& operator=( const CAILevelOfDetail& ) = delete;
+};
+
+extern CAILevelOfDetail g_AILevelOfDetail;
+
+#endif //GAME_SERVER_AI_CAILEVELOFDETAIL_H
@@ -0,0 +1,173 @@
+#include <cstring>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CAIProfiler.h"
+
+CAIProfiler g_AIProfiler;
+
+const char* CAIProfiler::GetCategoryName( const AIProfileCategory category )
+{
+	switch( category )
+	{
+	case AIProfileCategory::MAINTAIN_SCHEDULE:		return "MaintainSchedule";
+	case AIProfileCategory::START_TASK:				return "StartTask";
+	case AIProfileCategory::RUN_TASK:				return "RunTask";
+	case AIProfileCategory::LOOK:					return "Look";
+	case AIProfileCategory::LISTEN:					return "Listen";
+	case AIProfileCategory::CHECK_ENEMY:			return "CheckEnemy";
+	case AIProfileCategory::BUILD_ROUTE:			return "BuildRoute";
+	case AIProfileCategory::BUILD_NEAREST_ROUTE:	return "BuildNearestRoute";
+	case AIProfileCategory::FIND_COVER:				return "FindCover";
+	case AIProfileCategory::FIND_LATERAL_COVER:		return "FindLateralCover";
+
+	default:										return "Unknown";
+	}
+}
+
+void CAIProfiler::RunFrame()
+{
+	m_bEnabled = sv_ai_profile.value != 0;
+}
+
+void CAIProfiler::Record( const char* const pszClassName, const AIProfileCategory category, const char* const pszSchedule, const int iTask,
+						  const Clock::duration duration, const unsigned long long ullTraces )
+{
+	const unsigned int uiClass = GetClassId( pszClassName );
+
+	const uint32_t uiId = pszSchedule ? GetScheduleId( pszSchedule ) : static_cast<uint32_t>( iTask );
+
+	const uint64_t uiKey = ( static_cast<uint64_t>( uiClass ) << 40 ) | ( static_cast<uint64_t>( category ) << 32 ) | uiId;
+
+	auto it = m_EntryIndices.find( uiKey );
+
+	if( it == m_EntryIndices.end() )
+	{
+		AIProfileEntry_t entry;
+
+		entry.uiClass = uiClass;
+		entry.category = category;
+		entry.pszSchedule = pszSchedule;
+		entry.iTask = iTask;
+
+		it = m_EntryIndices.emplace( uiKey, m_Entries.size() ).first;
+		m_Entries.push_back( entry );
+	}
+
+	AIProfileEntry_t& entry = m_Entries[ it->second ];
+
+	++entry.ullCalls;
+	entry.totalTime += duration;
+	entry.ullTraces += ullTraces;
+}
+
+void CAIProfiler::Reset()
+{
+	m_ClassNames.clear();
+	m_ClassIds.clear();
+	m_ScheduleIds.clear();
+	m_Entries.clear();
+	m_EntryIndices.clear();
+}
+
+bool CAIProfiler::Write( const char* const pszFilename ) const
+{
+	//Keep the file in the game directory.
+	if( !pszFilename || !( *pszFilename ) || strstr( pszFilename, ".." ) || pszFilename[ 0 ] == '/' || pszFilename[ 0 ] == '\\' || strchr( pszFilename, ':' ) )
+	{
+		Alert( at_console, "Invalid AI profile filename \"%s\"\n", pszFilename ? pszFilename : "" );
+		return false;
+	}
+
+	char szFilename[ MAX_PATH ];
+
+	GET_GAME_DIR( szFilename );
+
+	const size_t uiLength = strlen( szFilename );
+	snprintf( szFilename + uiLength, sizeof( szFilename ) - uiLength, "/%s", pszFilename );
+
+	FILE* pFile = fopen( szFilename, "w" );
+
+	if( !pFile )
+	{
+		Alert( at_console, "Couldn't open AI profile \"%s\" for writing\n", szFilename );
+		return false;
+	}
+
+	const size_t uiNameLength = strlen( pszFilename );
+
+	if( uiNameLength >= 5 && stricmp( pszFilename + uiNameLength - 5, ".json" ) == 0 )
+		WriteJSON( pFile );
+	else
+		WriteCSV( pFile );
+
+	fclose( pFile );
+
+	Alert( at_console, "Wrote %u AI profile entries to \"%s\"\n", static_cast<unsigned int>( m_Entries.size() ), szFilename );
+
+	return true;
+}
+
+unsigned int CAIProfiler::GetClassId( const char* const pszClassName )
+{
+	auto it = m_ClassIds.find( pszClassName );
+
+	if( it != m_ClassIds.end() )
+		return it->second;
+
+	m_ClassNames.emplace_back( pszClassName );
+
+	const unsigned int uiClass = static_cast<unsigned int>( m_ClassNames.size() - 1 );
+
+	m_ClassIds.emplace( m_ClassNames.back().c_str(), uiClass );
+
+	return uiClass;
+}
+
+unsigned int CAIProfiler::GetScheduleId( const char* const pszSchedule )
+{
+	return m_ScheduleIds.emplace( pszSchedule, static_cast<unsigned int>( m_ScheduleIds.size() ) ).first->second;
+}
+
+void CAIProfiler::WriteCSV( FILE* pFile ) const
+{
+	fprintf( pFile, "class,function,schedule,task,calls,microseconds,traces\n" );
+
+	for( const auto& entry : m_Entries )
+	{
+		fprintf( pFile, "%s,%s,%s,%d,%llu,%.3f,%llu\n",
+				 GetClassName( entry.uiClass ), GetCategoryName( entry.category ), entry.pszSchedule ? entry.pszSchedule : "", entry.iTask,
+				 entry.ullCalls, GetMicroseconds( entry ), entry.ullTraces );
+	}
+}
+
+void CAIProfiler::WriteJSON( FILE* pFile ) const
+{
+	fprintf( pFile, "[\n" );
+
+	for( size_t uiIndex = 0; uiIndex < m_Entries.size(); ++uiIndex )
+	{
+		const auto& entry = m_Entries[ uiIndex ];
+
+		//Class and schedule names don't contain quotes or backslashes.
+		fprintf( pFile, "\t{ \"class\": \"%s\", \"function\": \"%s\", \"schedule\": \"%s\", \"task\": %d, \"calls\": %llu, \"microseconds\": %.3f, \"traces\": %llu }%s\n",
+				 GetClassName( entry.uiClass ), GetCategoryName( entry.category ), entry.pszSchedule ? entry.pszSchedule : "", entry.iTask,
+				 entry.ullCalls, GetMicroseconds( entry ), entry.ullTraces, uiIndex + 1 < m_Entries.size() ? "," : "" );
+	}
+
+	fprintf( pFile, "]\n" );
+}
+
+void CAIProfileScope::Begin( const CBaseEntity* pEntity, const AIProfileCategory category, const char* const pszSchedule, const int iTask )
+{
+	m_pszClassName = pEntity->GetClassname();
+	m_Category = category;
+	m_pszSchedule = pszSchedule;
+	m_iTask = iTask;
+	m_ullTraces = g_AIProfiler.GetTraceCount();
+	m_Start = CAIProfiler::Clock::now();
+}
@@ -0,0 +1,195 @@
+#ifndef GAME_SERVER_AI_CAIPROFILER_H
+#define GAME_SERVER_AI_CAIPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "StringUtils.h"
+
+class CBaseEntity;
+
+/**
+*	AI functions that the profiler times.
+*/
+enum class AIProfileCategory
+{
+	MAINTAIN_SCHEDULE = 0,
+	START_TASK,
+	RUN_TASK,
+	LOOK,
+	LISTEN,
+	CHECK_ENEMY,
+	BUILD_ROUTE,
+	BUILD_NEAREST_ROUTE,
+	FIND_COVER,
+	FIND_LATERAL_COVER,
+
+	COUNT
+};
+
+/**
+*	Aggregate for one monster class, category and schedule or task.
+*/
+struct AIProfileEntry_t
+{
+	unsigned int uiClass = 0;
+	AIProfileCategory category = AIProfileCategory::MAINTAIN_SCHEDULE;
+
+	//Schedule that was running when MaintainSchedule was entered, for MAINTAIN_SCHEDULE entries.
+	const char* pszSchedule = nullptr;
+
+	//Task number, for START_TASK and RUN_TASK entries.
+	int iTask = 0;
+
+	unsigned long long ullCalls = 0;
+
+	//Kept at the clock's resolution, since many calls take less than a microsecond.
+	std::chrono::steady_clock::duration totalTime = std::chrono::steady_clock::duration::zero();
+
+	//Number of UTIL_Trace* calls made during the calls.
+	unsigned long long ullTraces = 0;
+};
+
+/**
+*	Collects call counts, time and trace counts of AI functions per monster class, and per schedule or task.
+*	Enabled with sv_ai_profile. Times and trace counts are inclusive, so MaintainSchedule includes the tasks it starts and runs,
+*	and tasks include the routes they build.
+*	When disabled, each profiled call costs a single check.
+*/
+class CAIProfiler final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+public:
+	CAIProfiler() = default;
+
+	static const char* GetCategoryName( const AIProfileCategory category );
+
+	/**
+	*	@return Total time of an entry's calls, in microseconds.
+	*/
+	static double GetMicroseconds( const AIProfileEntry_t& entry )
+	{
+		return std::chrono::duration<double, std::micro>( entry.totalTime ).count();
+	}
+
+	bool IsEnabled() const { return m_bEnabled; }
+
+	/**
+	*	Picks up changes to sv_ai_profile. Called at the start of every frame.
+	*/
+	void RunFrame();
+
+	/**
+	*	Called by the UTIL_Trace* functions.
+	*/
+	void CountTrace() { ++m_ullTraces; }
+
+	unsigned long long GetTraceCount() const { return m_ullTraces; }
+
+	/**
+	*	Adds a call to the aggregates.
+	*	@param pszClassName Classname of the monster that made the call.
+	*	@param pszSchedule Schedule name for MAINTAIN_SCHEDULE, null otherwise.
+	*	@param iTask Task number for START_TASK and RUN_TASK, 0 otherwise.
+	*/
+	void Record( const char* const pszClassName, const AIProfileCategory category, const char* const pszSchedule, const int iTask,
+				 const Clock::duration duration, const unsigned long long ullTraces );
+
+	void Reset();
+
+	const std::vector<AIProfileEntry_t>& GetEntries() const { return m_Entries; }
+
+	const char* GetClassName( const unsigned int uiClass ) const { return m_ClassNames[ uiClass ].c_str(); }
+
+	/**
+	*	Writes all entries to a file. Files ending in .json are written as JSON, all others as CSV.
+	*	@return Whether the file could be written.
+	*/
+	bool Write( const char* const pszFilename ) const;
+
+private:
+	unsigned int GetClassId( const char* const pszClassName );
+
+	unsigned int GetScheduleId( const char* const pszSchedule );
+
+	void WriteCSV( FILE* pFile ) const;
+
+	void WriteJSON( FILE* pFile ) const;
+
+private:
+	bool m_bEnabled = false;
+
+	unsigned long long m_ullTraces = 0;
+
+	//Class names are copied, since the string pool is freed on map change. A deque keeps the strings in place so they can be used as keys.
+	std::deque<std::string> m_ClassNames;
+	std::unordered_map<const char*, unsigned int, RawCharHash, RawCharEqualTo> m_ClassIds;
+
+	//Schedule names are static, so they're looked up by address.
+	std::unordered_map<const char*, unsigned int> m_ScheduleIds;
+
+	std::vector<AIProfileEntry_t> m_Entries;
+
+	//Class id, category and schedule id or task, packed.
+	std::unordered_map<uint64_t, size_t> m_EntryIndices;
+
+private:
+	CAIProfiler( const CAIProfiler& ) = delete;
+	CAIProfiler& operator=( const CAIProfiler& ) = delete;
+};
+
+extern CAIProfiler g_AIProfiler;
+
+/**
+*	Times the rest of the enclosing block for a monster, if the profiler is enabled.
+*/
+class CAIProfileScope final
+{
+public:
+	CAIProfileScope( const CBaseEntity* pEntity, const AIProfileCategory category, const int iTask = 0 )
+	{
+		if( g_AIProfiler.IsEnabled() )
+			Begin( pEntity, category, nullptr, iTask );
+	}
+
+	CAIProfileScope( const CBaseEntity* pEntity, const AIProfileCategory category, const char* const pszSchedule )
+	{
+		if( g_AIProfiler.IsEnabled() )
+			Begin( pEntity, category, pszSchedule, 0 );
+	}
+
+	~CAIProfileScope()
+	{
+		if( m_pszClassName )
+		{
+			g_AIProfiler.Record( m_pszClassName, m_Category, m_pszSchedule, m_iTask, CAIProfiler::Clock::now() - m_Start, g_AIProfiler.GetTraceCount() - m_ullTraces );
+		}
+	}
+
+private:
+	void Begin( const CBaseEntity* pEntity, const AIProfileCategory category, const char* const pszSchedule, const int iTask );
+
+private:
+	//Null if the profiler was disabled when the scope was entered.
+	const char* m_pszClassName = nullptr;
+
+	AIProfileCategory m_Category;
+	const char* m_pszSchedule;
+	int m_iTask;
+
+	unsigned long long m_ullTraces;
+	CAIProfiler::Clock::time_point m_Start;
+
+private:
+	CAIProfileScope( const CAIProfileScope& ) = delete;
+	CAIProfileScope& operator=( const CAIProfileScope& ) = delete;
+};
+
+#endif //GAME_SERVER_AI_CAIPROFILER_H
@@ -0,0 +1,167 @@
+#include <cmath>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+#include "entities/NPCs/Monsters.h"
+
+#include "CLocalMoveCache.h"
+
+const int CLocalMoveCache::QUANTIZE;
+const size_t CLocalMoveCache::MAX_ENTRIES;
+const size_t CLocalMoveCache::MAX_BLOCKED_MOVES;
+constexpr float CLocalMoveCache::BLOCKED_YAW_TOLERANCE;
+
+CLocalMoveCache g_LocalMoveCache;
+
+bool CLocalMoveCache::Key_t::operator==( const Key_t& other ) const
+{
+	return iMonster == other.iMonster && iTarget == other.iTarget && iFlags == other.iFlags &&
+		SameStart( *this, other ) &&
+		end[ 0 ] == other.end[ 0 ] && end[ 1 ] == other.end[ 1 ] && end[ 2 ] == other.end[ 2 ];
+}
+
+size_t CLocalMoveCache::KeyHash::operator()( const Key_t& key ) const
+{
+	size_t uiHash = static_cast<size_t>( key.iMonster ) * 31 + static_cast<size_t>( key.iTarget );
+
+	uiHash = uiHash * 31 + static_cast<size_t>( key.iFlags );
+
+	for( int i = 0; i < 3; ++i )
+	{
+		uiHash = uiHash * 31 + static_cast<size_t>( key.start[ i ] );
+		uiHash = uiHash * 31 + static_cast<size_t>( key.end[ i ] );
+	}
+
+	return uiHash;
+}
+
+void CLocalMoveCache::ResetStats()
+{
+	m_Stats = LocalMoveCacheStats_t();
+}
+
+void CLocalMoveCache::RunFrame()
+{
+	m_Stats.uiLastFrameHits = m_uiFrameHits;
+
+	if( m_uiFrameHits > m_Stats.uiMaxFrameHits )
+		m_Stats.uiMaxFrameHits = m_uiFrameHits;
+
+	++m_Stats.uiFrames;
+
+	m_uiFrameHits = 0;
+
+	m_Entries.clear();
+	m_BlockedMoves.clear();
+}
+
+bool CLocalMoveCache::Find( const CBaseMonster* pMonster, const Vector& vecStart, const Vector& vecEnd, const CBaseEntity* pTarget, const float flStepSize, LocalMoveResult_t& result )
+{
+	if( !IsEnabled() )
+		return false;
+
+	++m_Stats.ullQueries;
+
+	const Key_t key = MakeKey( pMonster, vecStart, vecEnd, pTarget );
+
+	auto it = m_Entries.find( key );
+
+	if( it != m_Entries.end() && it->second.vecMins == pMonster->pev->mins && it->second.vecMaxs == pMonster->pev->maxs )
+	{
+		result = it->second.result;
+
+		++m_Stats.ullHits;
+		++m_uiFrameHits;
+		m_Stats.ullWalkMovesSaved += result.cWalkMoves;
+
+		return true;
+	}
+
+	if( m_BlockedMoves.empty() )
+		return false;
+
+	const float flYaw = UTIL_VecToYaw( vecEnd - vecStart );
+	const float flDist = ( vecEnd - vecStart ).Length2D();
+
+	for( const auto& blocked : m_BlockedMoves )
+	{
+		if( blocked.key.iMonster != key.iMonster || blocked.key.iTarget != key.iTarget || blocked.key.iFlags != key.iFlags ||
+			!SameStart( blocked.key, key ) || blocked.vecMins != pMonster->pev->mins || blocked.vecMaxs != pMonster->pev->maxs )
+			continue;
+
+		//The step that was blocked has to be a full step in this move as well; the last step of a move is shorter.
+		if( blocked.result.flDist + flStepSize >= flDist - 1 || fabs( UTIL_AngleDiff( flYaw, blocked.flYaw ) ) >= BLOCKED_YAW_TOLERANCE )
+			continue;
+
+		result = blocked.result;
+
+		++m_Stats.ullBlockedHits;
+		++m_uiFrameHits;
+		m_Stats.ullWalkMovesSaved += result.cWalkMoves;
+
+		return true;
+	}
+
+	return false;
+}
+
+void CLocalMoveCache::Add( const CBaseMonster* pMonster, const Vector& vecStart, const Vector& vecEnd, const CBaseEntity* pTarget, const LocalMoveResult_t& result )
+{
+	if( !IsEnabled() )
+		return;
+
+	const Key_t key = MakeKey( pMonster, vecStart, vecEnd, pTarget );
+
+	if( m_Entries.size() < MAX_ENTRIES )
+	{
+		Entry_t& entry = m_Entries[ key ];
+
+		entry.vecMins = pMonster->pev->mins;
+		entry.vecMaxs = pMonster->pev->maxs;
+		entry.result = result;
+	}
+
+	//Only moves that were blocked by something other than the target can be used for longer moves.
+	if( result.fBlocked && result.fFullStep && result.iReturn == LOCALMOVE_INVALID && m_BlockedMoves.size() < MAX_BLOCKED_MOVES )
+	{
+		BlockedMove_t blocked;
+
+		blocked.key = key;
+		blocked.vecMins = pMonster->pev->mins;
+		blocked.vecMaxs = pMonster->pev->maxs;
+		blocked.flYaw = UTIL_VecToYaw( vecEnd - vecStart );
+		blocked.result = result;
+
+		m_BlockedMoves.push_back( blocked );
+	}
+}
+
+bool CLocalMoveCache::IsEnabled()
+{
+	return sv_ai_movecache.value != 0;
+}
+
+CLocalMoveCache::Key_t CLocalMoveCache::MakeKey( const CBaseMonster* pMonster, const Vector& vecStart, const Vector& vecEnd, const CBaseEntity* pTarget )
+{
+	Key_t key;
+
+	key.iMonster = pMonster->entindex();
+	key.iTarget = pTarget ? pTarget->entindex() : -1;
+	key.iFlags = pMonster->pev->flags & ( FL_FLY | FL_SWIM );
+
+	for( int i = 0; i < 3; ++i )
+	{
+		key.start[ i ] = static_cast<int>( floor( vecStart[ i ] * QUANTIZE + 0.5f ) );
+		key.end[ i ] = static_cast<int>( floor( vecEnd[ i ] * QUANTIZE + 0.5f ) );
+	}
+
+	return key;
+}
+
+bool CLocalMoveCache::SameStart( const Key_t& key, const Key_t& other )
+{
+	return key.start[ 0 ] == other.start[ 0 ] && key.start[ 1 ] == other.start[ 1 ] && key.start[ 2 ] == other.start[ 2 ];
+}
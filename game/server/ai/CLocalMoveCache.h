@@ -0,0 +1,168 @@
+#ifndef GAME_SERVER_AI_CLOCALMOVECACHE_H
+#define GAME_SERVER_AI_CLOCALMOVECACHE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class CBaseEntity;
+class CBaseMonster;
+
+/**
+*	Local move cache statistics.
+*/
+struct LocalMoveCacheStats_t
+{
+	unsigned int uiFrames = 0;
+
+	unsigned long long ullQueries = 0;
+
+	//Queries answered with the result of the same move.
+	unsigned long long ullHits = 0;
+
+	//Queries answered because a shorter move in the same direction was already blocked.
+	unsigned long long ullBlockedHits = 0;
+
+	//Number of walk moves that hits didn't have to make.
+	unsigned long long ullWalkMovesSaved = 0;
+
+	unsigned int uiLastFrameHits = 0;
+	unsigned int uiMaxFrameHits = 0;
+};
+
+/**
+*	Result of a local move check, as made by CBaseMonster::CheckLocalMove.
+*/
+struct LocalMoveResult_t
+{
+	int iReturn = 0;
+
+	//Whether a step failed. If so, flDist is how far the check got, and pBlocker is what it hit.
+	bool fBlocked = false;
+	float flDist = 0;
+	edict_t* pBlocker = nullptr;
+
+	//Whether the step that failed was a full LOCAL_STEP_SIZE step, instead of the shorter last step.
+	bool fFullStep = false;
+
+	//Number of walk moves made.
+	int cWalkMoves = 0;
+};
+
+/**
+*	Caches the results of CBaseMonster::CheckLocalMove for the rest of the frame.
+*	FTriangulate and BuildRoute check the same moves repeatedly when routes fail, and every check walks the whole move in small steps.
+*	Moves are keyed by the monster, the target, the start and end positions rounded to 1/QUANTIZE units, and whether the monster flies or swims.
+*	The monster is part of the key, since it doesn't block itself but does block others. Other entities don't move while a monster thinks,
+*	and the cache is emptied every frame, so results are the same as checking again. Results don't depend on the order of the
+*	entries in the cache, so behavior is deterministic.
+*	Moves that were blocked partway are also remembered, so longer moves from the same start in the same direction fail right away.
+*	Controlled by sv_ai_movecache.
+*/
+class CLocalMoveCache final
+{
+public:
+	/**
+	*	Positions are rounded to this fraction of a unit.
+	*/
+	static const int QUANTIZE = 8;
+
+	/**
+	*	Maximum number of moves and blocked moves cached in a frame.
+	*/
+	static const size_t MAX_ENTRIES = 4096;
+	static const size_t MAX_BLOCKED_MOVES = 256;
+
+	/**
+	*	Moves whose direction differs from a blocked move by less than this many degrees are considered blocked as well.
+	*/
+	static constexpr float BLOCKED_YAW_TOLERANCE = 0.5f;
+
+public:
+	CLocalMoveCache() = default;
+
+	const LocalMoveCacheStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	/**
+	*	Empties the cache. Called at the start of every frame.
+	*/
+	void RunFrame();
+
+	/**
+	*	Looks up the result of a move.
+	*	@param flStepSize Size of the steps that the move is checked with.
+	*	@return Whether the result was cached.
+	*/
+	bool Find( const CBaseMonster* pMonster, const Vector& vecStart, const Vector& vecEnd, const CBaseEntity* pTarget, const float flStepSize, LocalMoveResult_t& result );
+
+	/**
+	*	Adds the result of a move that wasn't cached.
+	*/
+	void Add( const CBaseMonster* pMonster, const Vector& vecStart, const Vector& vecEnd, const CBaseEntity* pTarget, const LocalMoveResult_t& result );
+
+private:
+	struct Key_t
+	{
+		int iMonster;
+		int iTarget;
+		int iFlags;
+		int start[ 3 ];
+		int end[ 3 ];
+
+		bool operator==( const Key_t& other ) const;
+	};
+
+	struct KeyHash
+	{
+		size_t operator()( const Key_t& key ) const;
+	};
+
+	struct Entry_t
+	{
+		//Hull of the monster when the move was checked.
+		Vector vecMins;
+		Vector vecMaxs;
+
+		LocalMoveResult_t result;
+	};
+
+	struct BlockedMove_t
+	{
+		Key_t key;
+
+		Vector vecMins;
+		Vector vecMaxs;
+
+		float flYaw;
+
+		LocalMoveResult_t result;
+	};
+
+	static bool IsEnabled();
+
+	static Key_t MakeKey( const CBaseMonster* pMonster, const Vector& vecStart, const Vector& vecEnd, const CBaseEntity* pTarget );
+
+	/**
+	*	@return Whether the start of both keys is the same.
+	*/
+	static bool SameStart( const Key_t& key, const Key_t& other );
+
+private:
+	std::unordered_map<Key_t, Entry_t, KeyHash> m_Entries;
+
+	std::vector<BlockedMove_t> m_BlockedMoves;
+
+	unsigned int m_uiFrameHits = 0;
+
+	LocalMoveCacheStats_t m_Stats;
+
+private:
+	CLocalMoveCache( const CLocalMoveCache& ) = delete;
+	CLocalMoveCache& operator=( const CLocalMoveCache& ) = delete;
+};
+
+extern CLocalMoveCache g_LocalMoveCache;
+
+#endif //GAME_SERVER_AI_CLOCALMOVECACHE_H
@@ -0,0 +1,156 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CSightCache.h"
+
+CSightCache g_SightCache;
+
+void CSightCache::ResetStats()
+{
+	m_Stats = SightCacheStats_t();
+}
+
+void CSightCache::RunFrame()
+{
+	m_Stats.uiLastFrameHits = m_uiFrameHits;
+
+	if( m_uiFrameHits > m_Stats.uiMaxFrameHits )
+		m_Stats.uiMaxFrameHits = m_uiFrameHits;
+
+	++m_Stats.uiFrames;
+
+	m_uiFrameHits = 0;
+
+	m_Entries.clear();
+
+	m_Candidates.clear();
+	m_fCandidatesBuilt = false;
+}
+
+bool CSightCache::FVisible( const CBaseEntity* pLooker, const Vector& vecLookerOrigin, const CBaseEntity* pTarget, const Vector& vecTargetOrigin )
+{
+	const bool fCache = sv_ai_sightcache.value != 0 && CanCache( pLooker ) && CanCache( pTarget );
+
+	Entry_t* pEntry = nullptr;
+	bool fLookerIsLow = false;
+
+	if( fCache )
+	{
+		++m_Stats.ullQueries;
+
+		const uint32_t uiLooker = static_cast<uint32_t>( pLooker->entindex() );
+		const uint32_t uiTarget = static_cast<uint32_t>( pTarget->entindex() );
+
+		fLookerIsLow = uiLooker < uiTarget;
+
+		const uint32_t uiKey = fLookerIsLow ? ( ( uiLooker << 16 ) | uiTarget ) : ( ( uiTarget << 16 ) | uiLooker );
+
+		auto result = m_Entries.emplace( uiKey, Entry_t() );
+
+		pEntry = &result.first->second;
+
+		if( !result.second )
+		{
+			const Vector& vecLowOrigin = fLookerIsLow ? vecLookerOrigin : vecTargetOrigin;
+			const Vector& vecHighOrigin = fLookerIsLow ? vecTargetOrigin : vecLookerOrigin;
+
+			if( pEntry->vecLowOrigin == vecLowOrigin && pEntry->vecHighOrigin == vecHighOrigin )
+			{
+				++m_Stats.ullHits;
+				++m_uiFrameHits;
+
+				if( pEntry->fLowToHigh != fLookerIsLow )
+					++m_Stats.ullReverseHits;
+
+				return pEntry->fVisible;
+			}
+
+			//One of them moved since the last trace; replace it.
+		}
+	}
+
+	TraceResult tr;
+
+	UTIL_TraceLine( vecLookerOrigin, vecTargetOrigin, ignore_monsters, ignore_glass, ENT( pLooker->pev )/*pentIgnore*/, &tr );
+
+	const bool fVisible = tr.flFraction == 1.0;
+
+	if( pEntry )
+	{
+		pEntry->vecLowOrigin = fLookerIsLow ? vecLookerOrigin : vecTargetOrigin;
+		pEntry->vecHighOrigin = fLookerIsLow ? vecTargetOrigin : vecLookerOrigin;
+		pEntry->fLowToHigh = fLookerIsLow;
+		pEntry->fVisible = fVisible;
+	}
+
+	return fVisible;
+}
+
+int CSightCache::MonstersAndClientsInBox( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs )
+{
+	if( sv_ai_sightcache.value == 0 )
+		return UTIL_EntitiesInBox( pList, listMax, mins, maxs, FL_CLIENT | FL_MONSTER );
+
+	if( !m_fCandidatesBuilt )
+		BuildCandidates();
+
+	int count = 0;
+
+	for( auto pEdict : m_Candidates )
+	{
+		//The entity may have been removed, or may have stopped being a monster, since the list was built.
+		if( pEdict->free || !( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) )
+			continue;
+
+		if( mins.x > pEdict->v.absmax.x ||
+			mins.y > pEdict->v.absmax.y ||
+			mins.z > pEdict->v.absmax.z ||
+			maxs.x < pEdict->v.absmin.x ||
+			maxs.y < pEdict->v.absmin.y ||
+			maxs.z < pEdict->v.absmin.z )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+
+		if( !pEntity )
+			continue;
+
+		pList[ count ] = pEntity;
+		count++;
+
+		if( count >= listMax )
+			break;
+	}
+
+	return count;
+}
+
+bool CSightCache::CanCache( const CBaseEntity* pEntity )
+{
+	//Traces ignore monsters, so a trace between 2 of them is the same in both directions. Brush entities can block a trace that doesn't ignore them.
+	return ( pEntity->pev->flags & ( FL_CLIENT | FL_MONSTER ) ) && pEntity->pev->solid != SOLID_BSP;
+}
+
+void CSightCache::BuildCandidates()
+{
+	m_fCandidatesBuilt = true;
+
+	edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+
+	if( !pEdict )
+		return;
+
+	for( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
+	{
+		if( pEdict->free )
+			continue;
+
+		if( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) )
+			m_Candidates.push_back( pEdict );
+	}
+
+	m_Stats.uiLastFrameCandidates = static_cast<unsigned int>( m_Candidates.size() );
+}
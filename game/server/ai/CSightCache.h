@@ -0,0 +1,100 @@
+#ifndef GAME_SERVER_AI_CSIGHTCACHE_H
+#define GAME_SERVER_AI_CSIGHTCACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class CBaseEntity;
+
+/**
+*	Sight cache statistics.
+*/
+struct SightCacheStats_t
+{
+	unsigned int uiFrames = 0;
+
+	unsigned long long ullQueries = 0;
+
+	//Queries answered from the cache, each of which saved a trace.
+	unsigned long long ullHits = 0;
+
+	//Hits that reused the trace made by the other entity in the pair.
+	unsigned long long ullReverseHits = 0;
+
+	//Traces saved in the last frame, and in the frame that saved the most.
+	unsigned int uiLastFrameHits = 0;
+	unsigned int uiMaxFrameHits = 0;
+
+	//Number of sight candidates in the last frame.
+	unsigned int uiLastFrameCandidates = 0;
+};
+
+/**
+*	Caches line of sight between monsters and clients for the rest of the frame.
+*	When many monsters are near many players, Look checks the same pairs repeatedly, and from both directions.
+*	A result is reused when both entities' eyes are where they were when it was traced, so an entity that moves during the frame is traced again.
+*	Traces between 2 monsters or clients ignore monsters, so they are reused in the other direction as well.
+*	Also keeps the list of monsters and clients for the frame, so Look doesn't have to go through every edict.
+*	Controlled by sv_ai_sightcache.
+*/
+class CSightCache final
+{
+public:
+	CSightCache() = default;
+
+	const SightCacheStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	/**
+	*	Empties the cache. Called at the start of every frame.
+	*/
+	void RunFrame();
+
+	/**
+	*	Gets whether a line can be traced from vecLookerOrigin to vecTargetOrigin, tracing if it's not cached.
+	*	@param pLooker Entity that is looking. Its own body is ignored by the trace.
+	*/
+	bool FVisible( const CBaseEntity* pLooker, const Vector& vecLookerOrigin, const CBaseEntity* pTarget, const Vector& vecTargetOrigin );
+
+	/**
+	*	Finds the monsters and clients whose bounding boxes touch the given box. Same as UTIL_EntitiesInBox with FL_CLIENT | FL_MONSTER,
+	*	but only the frame's candidate list is searched.
+	*	Entities created during the frame aren't found until the next frame.
+	*/
+	int MonstersAndClientsInBox( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs );
+
+private:
+	struct Entry_t
+	{
+		//Eye positions of the entity with the lower and higher index.
+		Vector vecLowOrigin;
+		Vector vecHighOrigin;
+
+		bool fLowToHigh;		//Whether the cached trace went from the entity with the lower index.
+		bool fVisible;
+	};
+
+	static bool CanCache( const CBaseEntity* pEntity );
+
+	void BuildCandidates();
+
+private:
+	std::unordered_map<uint32_t, Entry_t> m_Entries;
+
+	std::vector<edict_t*> m_Candidates;
+	bool m_fCandidatesBuilt = false;
+
+	unsigned int m_uiFrameHits = 0;
+
+	SightCacheStats_t m_Stats;
+
+private:
+	CSightCache( const CSightCache& ) = delete;
+	CSightCache& operator=( const CSightCache& ) = delete;
+};
+
+extern CSightCache g_SightCache;
+
+#endif //GAME_SERVER_AI_CSIGHTCACHE_H
@@ -0,0 +1,114 @@
+#include <cmath>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CThinkScheduler.h"
+
+const int CThinkScheduler::MAX_DEFERRED_THINKS;
+constexpr float CThinkScheduler::PHASE_INTERVAL;
+
+CThinkScheduler g_ThinkScheduler;
+
+void CThinkScheduler::ResetStats()
+{
+	m_Stats = ThinkSchedulerStats_t();
+}
+
+void CThinkScheduler::RunFrame()
+{
+	++m_Stats.uiFrames;
+
+	m_Stats.uiLastFrameThinks = m_uiFrameThinks;
+	m_Stats.uiLastFrameDeferrals = m_uiFrameDeferrals;
+	m_Stats.uiLastFrameMicroseconds = static_cast<unsigned int>( m_iFrameMicroseconds );
+
+	if( m_uiFrameThinks > m_Stats.uiMaxFrameThinks )
+		m_Stats.uiMaxFrameThinks = m_uiFrameThinks;
+
+	if( m_Stats.uiLastFrameMicroseconds > m_Stats.uiMaxFrameMicroseconds )
+		m_Stats.uiMaxFrameMicroseconds = m_Stats.uiLastFrameMicroseconds;
+
+	m_uiFrameThinks = 0;
+	m_uiFrameDeferrals = 0;
+	m_iFrameMicroseconds = 0;
+}
+
+bool CThinkScheduler::BeginThink( CBaseMonster* pMonster )
+{
+	const long long iBudget = static_cast<long long>( sv_ai_think_budget.value );
+
+	if( iBudget > 0 && m_iFrameMicroseconds >= iBudget && pMonster->m_cDeferredThinks < MAX_DEFERRED_THINKS )
+	{
+		bool fDefer;
+
+		//Scripts and death animations are timed to the think rate.
+		if( pMonster->m_MonsterState == MONSTERSTATE_SCRIPT || pMonster->m_MonsterState == MONSTERSTATE_DEAD ||
+			pMonster->m_pCine || pMonster->pev->deadflag != DEAD_NO )
+			fDefer = false;
+		else if( pMonster->m_MonsterState == MONSTERSTATE_COMBAT )
+			fDefer = m_iFrameMicroseconds >= iBudget * 2;
+		else
+			fDefer = true;
+
+		if( fDefer )
+		{
+			++pMonster->m_cDeferredThinks;
+
+			++m_uiFrameDeferrals;
+			++m_Stats.ullDeferrals;
+
+			//Any time before the end of the next frame will do.
+			pMonster->pev->nextthink = gpGlobals->time + 0.001;
+
+			return false;
+		}
+	}
+
+	pMonster->m_cDeferredThinks = 0;
+
+	++m_uiFrameThinks;
+	++m_Stats.ullThinks;
+
+	m_ThinkStart = Clock::now();
+
+	return true;
+}
+
+void CThinkScheduler::EndThink()
+{
+	const long long iMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - m_ThinkStart ).count();
+
+	m_iFrameMicroseconds += iMicroseconds;
+	m_Stats.ullMicroseconds += iMicroseconds;
+}
+
+float CThinkScheduler::GetNextThinkTime( CBaseMonster* pMonster, const float flInterval )
+{
+	const float flNextThink = gpGlobals->time + flInterval;
+
+	if( sv_ai_think_stagger.value == 0 )
+		return flNextThink;
+
+	if( !pMonster->m_fThinkPhaseSet )
+	{
+		//Golden ratio sequence: every new phase lands in the largest gap between the previous ones.
+		const double flFraction = m_uiPhases * 0.6180339887498949;
+
+		pMonster->m_flThinkPhase = static_cast<float>( ( flFraction - floor( flFraction ) ) * PHASE_INTERVAL );
+		pMonster->m_fThinkPhaseSet = true;
+
+		++m_uiPhases;
+	}
+
+	//Move the think to the nearest time in the monster's phase. The first think after the phase is set can be up to half an interval off.
+	float flPhasedThink = floor( ( flNextThink - pMonster->m_flThinkPhase ) / PHASE_INTERVAL + 0.5f ) * PHASE_INTERVAL + pMonster->m_flThinkPhase;
+
+	if( flPhasedThink <= gpGlobals->time )
+		flPhasedThink += PHASE_INTERVAL;
+
+	return flPhasedThink;
+}
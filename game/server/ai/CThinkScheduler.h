@@ -0,0 +1,96 @@
+#ifndef GAME_SERVER_AI_CTHINKSCHEDULER_H
+#define GAME_SERVER_AI_CTHINKSCHEDULER_H
+
+#include <chrono>
+
+class CBaseMonster;
+
+/**
+*	Think scheduler statistics.
+*/
+struct ThinkSchedulerStats_t
+{
+	unsigned int uiFrames = 0;
+
+	unsigned long long ullThinks = 0;
+	unsigned long long ullDeferrals = 0;
+
+	//Time spent in monster thinks.
+	unsigned long long ullMicroseconds = 0;
+
+	unsigned int uiLastFrameThinks = 0;
+	unsigned int uiLastFrameDeferrals = 0;
+	unsigned int uiLastFrameMicroseconds = 0;
+
+	unsigned int uiMaxFrameThinks = 0;
+	unsigned int uiMaxFrameMicroseconds = 0;
+};
+
+/**
+*	Spreads monster thinks across frames, and keeps the time spent in them within a per frame budget.
+*	Monsters spawned together, or at map start, would otherwise think in the same frames. Each monster gets a phase within the 0.1 second
+*	think interval, and its thinks are moved to that phase.
+*	Once the monster thinks in a frame have taken sv_ai_think_budget microseconds, monsters that aren't in combat have their think
+*	put off until the next frame. Monsters in combat are only put off once twice the budget has been spent.
+*	A monster's think is never put off more than MAX_DEFERRED_THINKS frames in a row.
+*/
+class CThinkScheduler final
+{
+public:
+	static const int MAX_DEFERRED_THINKS = 3;
+
+	/**
+	*	Interval that think phases are spread over.
+	*/
+	static constexpr float PHASE_INTERVAL = 0.1f;
+
+public:
+	CThinkScheduler() = default;
+
+	const ThinkSchedulerStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	/**
+	*	Ends the previous frame. Called at the start of every frame.
+	*/
+	void RunFrame();
+
+	/**
+	*	Called at the start of a monster's think.
+	*	@return Whether the monster should think now. If not, its next think has been set to the next frame.
+	*/
+	bool BeginThink( CBaseMonster* pMonster );
+
+	/**
+	*	Called at the end of a think that BeginThink allowed.
+	*/
+	void EndThink();
+
+	/**
+	*	@return The time that a monster that thinks every flInterval seconds should think next, moved to the monster's phase.
+	*/
+	float GetNextThinkTime( CBaseMonster* pMonster, const float flInterval );
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point m_ThinkStart;
+
+	//Number of monsters that have been given a phase.
+	unsigned int m_uiPhases = 0;
+
+	unsigned int m_uiFrameThinks = 0;
+	unsigned int m_uiFrameDeferrals = 0;
+	long long m_iFrameMicroseconds = 0;
+
+	ThinkSchedulerStats_t m_Stats;
+
+private:
+	CThinkScheduler( const CThinkScheduler& ) = delete;
+	CThinkScheduler& operator=( const CThinkScheduler& ) = delete;
+};
+
+extern CThinkScheduler g_ThinkScheduler;
+
+#endif //GAME_SERVER_AI_CTHINKSCHEDULER_H
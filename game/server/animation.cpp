@@ -22,6 +22,8 @@
 
 #include "animation.h"
 
+#include "CAnimationIndex.h"
+
 int ExtractBbox( void *pmodel, int sequence, Vector& vecMins, Vector& vecMaxs )
 {
 	studiohdr_t* pstudiohdr = ( studiohdr_t* ) pmodel;
@@ -45,53 +47,23 @@ int ExtractBbox( void *pmodel, int sequence, Vector& vecMins, Vector& vecMaxs )
 
 int LookupActivity( void *pmodel, int activity )
 {
-	studiohdr_t* pstudiohdr = ( studiohdr_t* ) pmodel;
+	const CAnimationIndex* pIndex = g_AnimationIndexCache.GetIndex( pmodel );
 
-	if( !pstudiohdr )
+	if( !pIndex )
 		return 0;
 
-	mstudioseqdesc_t* pseqdesc = ( mstudioseqdesc_t* ) ( ( byte* ) pstudiohdr + pstudiohdr->seqindex );
-
-	int weighttotal = 0;
-	int seq = ACTIVITY_NOT_AVAILABLE;
-	for (int i = 0; i < pstudiohdr->numseq; i++)
-	{
-		if (pseqdesc[i].activity == activity)
-		{
-			weighttotal += pseqdesc[i].actweight;
-			if (!weighttotal || RANDOM_LONG(0,weighttotal-1) < pseqdesc[i].actweight)
-				seq = i;
-		}
-	}
-
-	return seq;
+	return pIndex->LookupActivity( activity );
 }
 
 
 int LookupActivityHeaviest( void *pmodel, int activity )
 {
-	studiohdr_t* pstudiohdr = ( studiohdr_t* ) pmodel;
+	const CAnimationIndex* pIndex = g_AnimationIndexCache.GetIndex( pmodel );
 
-	if( !pstudiohdr )
+	if( !pIndex )
 		return 0;
 
-	mstudioseqdesc_t* pseqdesc = ( mstudioseqdesc_t* ) ( ( byte* ) pstudiohdr + pstudiohdr->seqindex );
-
-	int weight = 0;
-	int seq = ACTIVITY_NOT_AVAILABLE;
-	for (int i = 0; i < pstudiohdr->numseq; i++)
-	{
-		if (pseqdesc[i].activity == activity)
-		{
-			if ( pseqdesc[i].actweight > weight )
-			{
-				weight = pseqdesc[i].actweight;
-				seq = i;
-			}
-		}
-	}
-
-	return seq;
+	return pIndex->LookupActivityHeaviest( activity );
 }
 
 void GetEyePosition ( void *pmodel, Vector& vecEyePosition )
@@ -109,20 +81,12 @@ void GetEyePosition ( void *pmodel, Vector& vecEyePosition )
 
 int LookupSequence( void *pmodel, const char *label )
 {
-	studiohdr_t* pstudiohdr = ( studiohdr_t* ) pmodel;
+	const CAnimationIndex* pIndex = g_AnimationIndexCache.GetIndex( pmodel );
 
-	if( !pstudiohdr )
+	if( !pIndex )
 		return 0;
 
-	mstudioseqdesc_t* pseqdesc = ( mstudioseqdesc_t* ) ( ( byte* ) pstudiohdr + pstudiohdr->seqindex );
-
-	for (int i = 0; i < pstudiohdr->numseq; i++)
-	{
-		if (stricmp( pseqdesc[i].label, label ) == 0)
-			return i;
-	}
-
-	return -1;
+	return pIndex->LookupSequence( label );
 }
 
 
@@ -391,25 +355,11 @@ int FindTransition( void *pmodel, int iEndingAnim, int iGoalAnim, int *piDir )
 	if (iInternNode == 0)
 		return iGoalAnim;
 
-	int i;
-
 	// look for someone going
-	for (i = 0; i < pstudiohdr->numseq; i++)
-	{
-		if (pseqdesc[i].entrynode == iEndNode && pseqdesc[i].exitnode == iInternNode)
-		{
-			*piDir = 1;
-			return i;
-		}
-		if (pseqdesc[i].nodeflags)
-		{
-			if (pseqdesc[i].exitnode == iEndNode && pseqdesc[i].entrynode == iInternNode)
-			{
-				*piDir = -1;
-				return i;
-			}
-		}
-	}
+	const int iSequence = g_AnimationIndexCache.GetIndex( pmodel )->FindTransition( iEndNode, iInternNode, *piDir );
+
+	if( iSequence != -1 )
+		return iSequence;
 
 	ALERT( at_console, "error in transition graph" );
 	return iGoalAnim;
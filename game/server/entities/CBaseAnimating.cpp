@@ -143,6 +143,24 @@ void CBaseAnimating::DispatchAnimEvents( float flInterval )
 	}
 }
 
+//=========================================================
+// SkipAnimEvents - updates the sequence state the same way
+// DispatchAnimEvents does, without going through the
+// model's events.
+//=========================================================
+void CBaseAnimating::SkipAnimEvents( float flInterval )
+{
+	// same interval as DispatchAnimEvents.
+	flInterval = 0.1;
+
+	float flEnd = pev->frame + flInterval * m_flFrameRate * pev->framerate;
+	m_flLastEventCheck = pev->animtime + flInterval;
+
+	m_fSequenceFinished = false;
+	if( flEnd >= 256 || flEnd <= 0.0 )
+		m_fSequenceFinished = true;
+}
+
 //=========================================================
 //=========================================================
 float CBaseAnimating::SetBoneController( int iController, float flValue )
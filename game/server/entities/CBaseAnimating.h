@@ -29,6 +29,7 @@ public:
 	int  LookupSequence( const char *label );
 	void ResetSequenceInfo();
 	void DispatchAnimEvents( float flFutureInterval = 0.1 ); // Handle events that have happend since last time called up until X seconds into the future
+	void SkipAnimEvents( float flFutureInterval = 0.1 ); // Same as DispatchAnimEvents, but the events are skipped instead of handled
 	virtual void HandleAnimEvent( AnimEvent_t& event ) { return; };
 	float SetBoneController( int iController, float flValue );
 	void InitBoneControllers( void );
@@ -67,7 +67,7 @@ void CBaseDelay::SUB_UseTargets( CBaseEntity *pActivator, USE_TYPE useType, floa
 	{
 		// create a temp object to fire at a later time
 		CBaseDelay *pTemp = GetClassPtr( ( CBaseDelay * ) NULL );
-		pTemp->pev->classname = MAKE_STRING( "DelayedUse" );
+		pTemp->SetClassname( "DelayedUse" );
 
 		pTemp->pev->nextthink = gpGlobals->time + m_flDelay;
 
@@ -17,6 +17,8 @@
 #include "cbase.h"
 #include "entities/DoorConstants.h"
 
+#include "nodes/Nodes.h"
+
 #include "CBaseDoor.h"
 
 BEGIN_DATADESC( CBaseDoor )
@@ -342,6 +344,9 @@ void CBaseDoor::DoorHitTop( void )
 	ASSERT( m_toggle_state == TS_GOING_UP );
 	m_toggle_state = TS_AT_TOP;
 
+	// monsters may path through open doors.
+	WorldGraph.LinkEntStateChanged( pev );
+
 	// toggle-doors don't come down automatically, they wait for refire.
 	if( FBitSet( pev->spawnflags, SF_DOOR_NO_AUTO_RETURN ) )
 	{
@@ -385,6 +390,8 @@ void CBaseDoor::DoorGoDown( void )
 #endif // DOOR_ASSERT
 	m_toggle_state = TS_GOING_DOWN;
 
+	WorldGraph.LinkEntStateChanged( pev );
+
 	SetMoveDone( &CBaseDoor::DoorHitBottom );
 	if( ClassnameIs( "func_door_rotating" ) )//rotating door
 		AngularMove( m_vecAngle1, pev->speed );
@@ -18,6 +18,7 @@
 #include "Decals.h"
 #include "cbase.h"
 #include "Weapons.h"
+#include "ai/CSightCache.h"
 
 /*
 ================
@@ -389,7 +390,6 @@ Vector CBaseEntity::FireBulletsPlayer( const unsigned int cShots,
 //=========================================================
 bool CBaseEntity::FVisible( const CBaseEntity *pEntity ) const
 {
-	TraceResult tr;
 	Vector		vecLookerOrigin;
 	Vector		vecTargetOrigin;
 
@@ -404,16 +404,8 @@ bool CBaseEntity::FVisible( const CBaseEntity *pEntity ) const
 	vecLookerOrigin = GetAbsOrigin() + pev->view_ofs;//look through the caller's 'eyes'
 	vecTargetOrigin = pEntity->EyePosition();
 
-	UTIL_TraceLine( vecLookerOrigin, vecTargetOrigin, ignore_monsters, ignore_glass, ENT( pev )/*pentIgnore*/, &tr );
-
-	if( tr.flFraction != 1.0 )
-	{
-		return false;// Line of sight is not established
-	}
-	else
-	{
-		return true;// line of sight is valid.
-	}
+	// the sight cache traces the line if it wasn't traced already this frame.
+	return g_SightCache.FVisible( this, vecLookerOrigin, pEntity, vecTargetOrigin );
 }
 
 //=========================================================
@@ -42,10 +42,10 @@ void CBaseEntity::UpdateOnRemove( void )
 	// the graph since we are removing it from the world.
 		for ( i = 0 ; i < WorldGraph.m_cLinks ; i++ )
 		{
-			if ( WorldGraph.m_pLinkPool [ i ].m_pLinkEnt == pev )
+			if ( WorldGraph.m_ppLinkEnts [ i ] == pev )
 			{
 				// if this link has a link ent which is the same ent that is removing itself, remove it!
-				WorldGraph.m_pLinkPool [ i ].m_pLinkEnt = NULL;
+				WorldGraph.m_ppLinkEnts [ i ] = NULL;
 			}
 		}
 	}
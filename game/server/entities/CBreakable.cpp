@@ -732,7 +732,7 @@ void CBreakable::Die( void )
 	}
 
 	// Don't fire something that could fire myself
-	pev->targetname = 0;
+	ClearTargetname();
 
 	pev->solid = SOLID_NOT;
 	// Fire targets on break
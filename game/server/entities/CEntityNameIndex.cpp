@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cstring>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+#include "entities/CEntityDictionary.h"
+
+#include "CEntityNameIndex.h"
+
+CEntityNameIndex g_TargetnameIndex( "targetname", &entvars_t::targetname, sv_targetname_index );
+CEntityNameIndex g_ClassnameIndex( "classname", &entvars_t::classname, sv_classname_index );
+
+CEntityNameIterator& CEntityNameIterator::operator++()
+{
+	if( m_pEntity )
+		m_pEntity = m_pIndex->Find( m_pEntity, m_ppszNames, m_uiCount );
+
+	return *this;
+}
+
+CEntityNameIterator CEntityNameRange::begin()
+{
+	//Points to this range's own name, which is valid for as long as the range is being iterated.
+	const char* const* ppszNames = m_pNames ? m_pNames->data() : &m_pszName;
+	const size_t uiCount = m_pNames ? m_pNames->size() : 1;
+
+	return CEntityNameIterator( m_pIndex, ppszNames, uiCount, m_pIndex->Find( nullptr, ppszNames, uiCount ) );
+}
+
+CEntityNameIndex::CEntityNameIndex( const char* const pszKeyword, string_t entvars_t::* pField, cvar_t& cvar )
+	: m_pszKeyword( pszKeyword )
+	, m_pField( pField )
+	, m_Cvar( cvar )
+{
+}
+
+void CEntityNameIndex::ResetStats()
+{
+	m_Stats = EntityNameIndexStats_t();
+}
+
+void CEntityNameIndex::Clear()
+{
+	m_Buckets.clear();
+	m_EntityBuckets.clear();
+	m_uiEntityCount = 0;
+}
+
+void CEntityNameIndex::Update( CBaseEntity* pEntity )
+{
+	SetEntityName( pEntity->entindex(), STRING( pEntity->pev->*m_pField ) );
+}
+
+void CEntityNameIndex::Remove( CBaseEntity* pEntity )
+{
+	SetEntityName( pEntity->entindex(), "" );
+}
+
+CBaseEntity* CEntityNameIndex::Find( CBaseEntity* pStartEntity, const char* const pszName )
+{
+	++m_Stats.ullQueries;
+
+	//The engine never matches empty names, but let it handle them anyway.
+	if( m_Cvar.value == 0 || !pszName || !( *pszName ) )
+	{
+		++m_Stats.ullEngineQueries;
+		return FindInEngine( pStartEntity, pszName );
+	}
+
+	CBaseEntity* pEntity = FindInIndex( pStartEntity, pszName );
+
+	if( m_Cvar.value >= 2 )
+	{
+		CBaseEntity* pEngineEntity = FindInEngine( pStartEntity, pszName );
+
+		if( pEntity != pEngineEntity )
+		{
+			++m_Stats.ullMismatches;
+
+			Alert( at_console, "Entity %s index mismatch for \"%s\" after entity %d: index found %d, engine found %d\n",
+				   m_pszKeyword, pszName, pStartEntity ? pStartEntity->entindex() : 0, pEntity ? pEntity->entindex() : 0, pEngineEntity ? pEngineEntity->entindex() : 0 );
+
+			return pEngineEntity;
+		}
+	}
+
+	return pEntity;
+}
+
+CBaseEntity* CEntityNameIndex::Find( CBaseEntity* pStartEntity, const char* const* ppszNames, const size_t uiCount )
+{
+	CBaseEntity* pResult = nullptr;
+
+	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+	{
+		CBaseEntity* pEntity = Find( pStartEntity, ppszNames[ uiIndex ] );
+
+		if( pEntity && ( !pResult || pEntity->entindex() < pResult->entindex() ) )
+			pResult = pEntity;
+	}
+
+	return pResult;
+}
+
+CEntityNameRange CEntityNameIndex::Entities( const char* const pszName )
+{
+	return CEntityNameRange( this, pszName );
+}
+
+CEntityNameRange CEntityNameIndex::Family( const char* const pszEntityName )
+{
+	if( auto pFamily = GetEntityDict().GetClassFamily( pszEntityName ) )
+		return CEntityNameRange( this, *pFamily );
+
+	return CEntityNameRange( this, pszEntityName );
+}
+
+CBaseEntity* CEntityNameIndex::FindInIndex( CBaseEntity* pStartEntity, const char* const pszName )
+{
+	auto it = m_Buckets.find( pszName );
+
+	if( it == m_Buckets.end() )
+		return nullptr;
+
+	const auto& entities = it->second->entities;
+
+	//The engine never returns the world.
+	const int iStart = pStartEntity ? pStartEntity->entindex() : 0;
+
+	for( auto entityIt = std::upper_bound( entities.begin(), entities.end(), iStart ); entityIt != entities.end(); ++entityIt )
+	{
+		edict_t* pEdict = INDEXENT( *entityIt );
+
+		if( pEdict && !pEdict->free && strcmp( STRING( pEdict->v.*m_pField ), pszName ) == 0 )
+			return CBaseEntity::Instance( pEdict );
+
+		++m_Stats.ullStaleEntries;
+	}
+
+	return nullptr;
+}
+
+CBaseEntity* CEntityNameIndex::FindInEngine( CBaseEntity* pStartEntity, const char* const pszName ) const
+{
+	edict_t* pEdict = FIND_ENTITY_BY_STRING( pStartEntity ? pStartEntity->edict() : nullptr, m_pszKeyword, pszName );
+
+	if( !FNullEnt( pEdict ) )
+		return CBaseEntity::Instance( pEdict );
+
+	return nullptr;
+}
+
+void CEntityNameIndex::SetEntityName( const int iIndex, const char* const pszName )
+{
+	if( iIndex < 0 )
+		return;
+
+	Bucket_t* pOldBucket = static_cast<size_t>( iIndex ) < m_EntityBuckets.size() ? m_EntityBuckets[ iIndex ] : nullptr;
+
+	if( pOldBucket )
+	{
+		if( pOldBucket->szName == pszName )
+			return;
+
+		auto& entities = pOldBucket->entities;
+
+		auto it = std::lower_bound( entities.begin(), entities.end(), iIndex );
+
+		if( it != entities.end() && *it == iIndex )
+			entities.erase( it );
+
+		m_EntityBuckets[ iIndex ] = nullptr;
+		--m_uiEntityCount;
+
+		if( entities.empty() )
+			m_Buckets.erase( pOldBucket->szName.c_str() );
+	}
+
+	if( !( *pszName ) )
+		return;
+
+	auto bucketIt = m_Buckets.find( pszName );
+
+	if( bucketIt == m_Buckets.end() )
+	{
+		std::unique_ptr<Bucket_t> bucket( new Bucket_t );
+
+		bucket->szName = pszName;
+
+		const char* const pszKey = bucket->szName.c_str();
+
+		bucketIt = m_Buckets.emplace( pszKey, std::move( bucket ) ).first;
+	}
+
+	Bucket_t* pBucket = bucketIt->second.get();
+
+	auto& entities = pBucket->entities;
+
+	entities.insert( std::upper_bound( entities.begin(), entities.end(), iIndex ), iIndex );
+
+	if( static_cast<size_t>( iIndex ) >= m_EntityBuckets.size() )
+		m_EntityBuckets.resize( iIndex + 1, nullptr );
+
+	m_EntityBuckets[ iIndex ] = pBucket;
+	++m_uiEntityCount;
+}
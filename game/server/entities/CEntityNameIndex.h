@@ -0,0 +1,201 @@
+#ifndef GAME_SERVER_ENTITIES_CENTITYNAMEINDEX_H
+#define GAME_SERVER_ENTITIES_CENTITYNAMEINDEX_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "StringUtils.h"
+
+class CBaseEntity;
+class CEntityNameIndex;
+
+/**
+*	Entity name index statistics.
+*/
+struct EntityNameIndexStats_t
+{
+	unsigned long long ullQueries = 0;
+
+	//Queries that searched all entities, because the index is disabled or the name is empty.
+	unsigned long long ullEngineQueries = 0;
+
+	//Entities in a bucket whose name no longer matched, because it was changed without updating the index.
+	unsigned long long ullStaleEntries = 0;
+
+	//Queries whose result differed from the engine's, when the index's cvar is 2.
+	unsigned long long ullMismatches = 0;
+};
+
+/**
+*	Iterates over the entities in an index that have one of a list of names, in entity index order.
+*	Every step searches the index again, so entities can be created, renamed and removed while iterating.
+*/
+class CEntityNameIterator final
+{
+public:
+	CEntityNameIterator( CEntityNameIndex* pIndex, const char* const* ppszNames, const size_t uiCount, CBaseEntity* pEntity )
+		: m_pIndex( pIndex )
+		, m_ppszNames( ppszNames )
+		, m_uiCount( uiCount )
+		, m_pEntity( pEntity )
+	{
+	}
+
+	CBaseEntity* operator*() const { return m_pEntity; }
+
+	CEntityNameIterator& operator++();
+
+	bool operator==( const CEntityNameIterator& other ) const { return m_pEntity == other.m_pEntity; }
+	bool operator!=( const CEntityNameIterator& other ) const { return m_pEntity != other.m_pEntity; }
+
+private:
+	CEntityNameIndex* m_pIndex;
+	const char* const* m_ppszNames;
+	size_t m_uiCount;
+	CBaseEntity* m_pEntity;
+};
+
+/**
+*	Range of entities with a given name, or with one of a list of names. Only valid while the names are.
+*/
+class CEntityNameRange final
+{
+public:
+	CEntityNameRange( CEntityNameIndex* pIndex, const char* const pszName )
+		: m_pIndex( pIndex )
+		, m_pszName( pszName )
+	{
+	}
+
+	CEntityNameRange( CEntityNameIndex* pIndex, const std::vector<const char*>& names )
+		: m_pIndex( pIndex )
+		, m_pNames( &names )
+	{
+	}
+
+	CEntityNameIterator begin();
+	CEntityNameIterator end() { return CEntityNameIterator( m_pIndex, nullptr, 0, nullptr ); }
+
+private:
+	CEntityNameIndex* m_pIndex;
+	const char* m_pszName = nullptr;
+	const std::vector<const char*>* m_pNames = nullptr;
+};
+
+/**
+*	Keeps track of which entities have which name in a string field of entvars_t, so searches by that field don't have to go through all entities.
+*	Entities are grouped by name, sorted by entity index, so searches return entities in the same order as the engine.
+*	Entities are updated when they're created, when keyvalues are set, when they're spawned or restored, when the field is set through
+*	CBaseEntity, and removed when they're freed. Every result is checked against the entity's current name, so names that were
+*	changed directly are never returned under the old name.
+*	Controlled by a cvar: 0 searches all entities, 1 uses the index, 2 uses the index and compares the results with a search of all entities.
+*/
+class CEntityNameIndex final
+{
+public:
+	/**
+	*	@param pszKeyword Name of the field, as used by the engine.
+	*	@param pField The field.
+	*	@param cvar Cvar that controls the index.
+	*/
+	CEntityNameIndex( const char* const pszKeyword, string_t entvars_t::* pField, cvar_t& cvar );
+
+	const char* GetKeyword() const { return m_pszKeyword; }
+
+	const cvar_t& GetCvar() const { return m_Cvar; }
+
+	const EntityNameIndexStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	size_t GetNameCount() const { return m_Buckets.size(); }
+
+	size_t GetEntityCount() const { return m_uiEntityCount; }
+
+	/**
+	*	Removes all entities. Called when the world is created.
+	*/
+	void Clear();
+
+	/**
+	*	Moves the entity to the bucket for its current name.
+	*/
+	void Update( CBaseEntity* pEntity );
+
+	void Remove( CBaseEntity* pEntity );
+
+	/**
+	*	@return The first entity with the given name whose entity index is higher than that of pStartEntity,
+	*	or the first one if pStartEntity is null. Matches the order that the engine's search uses.
+	*/
+	CBaseEntity* Find( CBaseEntity* pStartEntity, const char* const pszName );
+
+	/**
+	*	@return The first entity with any of the given names whose entity index is higher than that of pStartEntity,
+	*	or the first one if pStartEntity is null.
+	*/
+	CBaseEntity* Find( CBaseEntity* pStartEntity, const char* const* ppszNames, const size_t uiCount );
+
+	/**
+	*	@return All entities with the given name.
+	*/
+	CEntityNameRange Entities( const char* const pszName );
+
+	/**
+	*	@return All entities whose name is the given entity class or an entity class whose C++ class derives from its C++ class.
+	*	Only makes sense for the classname index. Unknown entity classes only match themselves.
+	*	@see CEntityDictionary::GetClassFamily
+	*/
+	CEntityNameRange Family( const char* const pszEntityName );
+
+private:
+	struct Bucket_t
+	{
+		std::string szName;
+
+		//Entity indices, sorted.
+		std::vector<int> entities;
+	};
+
+	CBaseEntity* FindInIndex( CBaseEntity* pStartEntity, const char* const pszName );
+
+	CBaseEntity* FindInEngine( CBaseEntity* pStartEntity, const char* const pszName ) const;
+
+	/**
+	*	Moves the entity with the given index to the bucket for the given name. An empty name removes it.
+	*/
+	void SetEntityName( const int iIndex, const char* const pszName );
+
+private:
+	const char* const m_pszKeyword;
+	string_t entvars_t::* const m_pField;
+	cvar_t& m_Cvar;
+
+	//Keys point to the bucket's own copy of the name, since names in the string pool are freed on map change.
+	std::unordered_map<const char*, std::unique_ptr<Bucket_t>, RawCharHash, RawCharEqualTo> m_Buckets;
+
+	//Bucket of each entity, by entity index.
+	std::vector<Bucket_t*> m_EntityBuckets;
+
+	size_t m_uiEntityCount = 0;
+
+	EntityNameIndexStats_t m_Stats;
+
+private:
+	CEntityNameIndex( const CEntityNameIndex& ) = delete;
+	CEntityNameIndex& operator=( const CEntityNameIndex& ) = delete;
+};
+
+/**
+*	Index of entities by targetname. Used by FireTargets and UTIL_FindEntityByTargetname. Controlled by sv_targetname_index.
+*/
+extern CEntityNameIndex g_TargetnameIndex;
+
+/**
+*	Index of entities by classname. Used by UTIL_FindEntityByClassname. Controlled by sv_classname_index.
+*/
+extern CEntityNameIndex g_ClassnameIndex;
+
+#endif //GAME_SERVER_ENTITIES_CENTITYNAMEINDEX_H
@@ -351,7 +351,7 @@ void CGrenade :: TumbleThink( void )
 void CGrenade:: Spawn( void )
 {
 	pev->movetype = MOVETYPE_BOUNCE;
-	pev->classname = MAKE_STRING( "grenade" );
+	SetClassname( "grenade" );
 	
 	pev->solid = SOLID_BBOX;
 
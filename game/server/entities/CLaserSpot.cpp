@@ -17,7 +17,7 @@ CLaserSpot *CLaserSpot::CreateSpot()
 	CLaserSpot *pSpot = GetClassPtr( ( CLaserSpot * ) NULL );
 	pSpot->Spawn();
 
-	pSpot->pev->classname = MAKE_STRING( "laser_spot" );
+	pSpot->SetClassname( "laser_spot" );
 
 	return pSpot;
 }
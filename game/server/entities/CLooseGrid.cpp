@@ -0,0 +1,205 @@
+#include <cmath>
+
+#include "CLooseGrid.h"
+
+constexpr float CLooseGrid::DEFAULT_CELL_SIZE;
+
+namespace
+{
+//Cells are clamped to this range, so boxes far outside the world don't overflow.
+const int MAX_CELL = 1 << 20;
+}
+
+void CLooseGrid::ResetStats()
+{
+	m_Stats = LooseGridStats_t();
+}
+
+void CLooseGrid::SetCellSize( const float flCellSize )
+{
+	m_flCellSize = flCellSize;
+
+	Clear();
+}
+
+void CLooseGrid::Clear()
+{
+	m_Indices.clear();
+	m_MinX.clear();
+	m_MinY.clear();
+	m_MinZ.clear();
+	m_MaxX.clear();
+	m_MaxY.clear();
+	m_MaxZ.clear();
+	m_LargeBoxes.clear();
+	m_BucketStart.clear();
+	m_SortedBoxes.clear();
+}
+
+void CLooseGrid::Add( const int iIndex, const float* vecMins, const float* vecMaxs )
+{
+	m_Indices.push_back( iIndex );
+	m_MinX.push_back( vecMins[ 0 ] );
+	m_MinY.push_back( vecMins[ 1 ] );
+	m_MinZ.push_back( vecMins[ 2 ] );
+	m_MaxX.push_back( vecMaxs[ 0 ] );
+	m_MaxY.push_back( vecMaxs[ 1 ] );
+	m_MaxZ.push_back( vecMaxs[ 2 ] );
+}
+
+void CLooseGrid::Build()
+{
+	++m_Stats.ullBuilds;
+
+	const size_t uiCount = GetCount();
+
+	m_CellX.resize( uiCount );
+	m_CellY.resize( uiCount );
+	m_CellZ.resize( uiCount );
+
+	m_LargeBoxes.clear();
+
+	//Boxes that don't fit in a cell can't be found through their center; this also catches boxes with invalid bounds.
+	m_IsLarge.assign( uiCount, false );
+
+	size_t uiGridCount = 0;
+
+	for( size_t uiBox = 0; uiBox < uiCount; ++uiBox )
+	{
+		if( !( m_MaxX[ uiBox ] - m_MinX[ uiBox ] <= m_flCellSize ) ||
+			!( m_MaxY[ uiBox ] - m_MinY[ uiBox ] <= m_flCellSize ) ||
+			!( m_MaxZ[ uiBox ] - m_MinZ[ uiBox ] <= m_flCellSize ) )
+		{
+			m_IsLarge[ uiBox ] = true;
+			m_LargeBoxes.push_back( uiBox );
+			continue;
+		}
+
+		m_CellX[ uiBox ] = GetCell( ( m_MinX[ uiBox ] + m_MaxX[ uiBox ] ) * 0.5f );
+		m_CellY[ uiBox ] = GetCell( ( m_MinY[ uiBox ] + m_MaxY[ uiBox ] ) * 0.5f );
+		m_CellZ[ uiBox ] = GetCell( ( m_MinZ[ uiBox ] + m_MaxZ[ uiBox ] ) * 0.5f );
+
+		++uiGridCount;
+	}
+
+	//At least twice as many buckets as boxes keeps most cells in their own bucket.
+	size_t uiBuckets = 16;
+
+	while( uiBuckets < uiGridCount * 2 )
+		uiBuckets *= 2;
+
+	m_BucketStart.assign( uiBuckets + 1, 0 );
+	m_SortedBoxes.resize( uiGridCount );
+
+	for( size_t uiBox = 0; uiBox < uiCount; ++uiBox )
+	{
+		if( !m_IsLarge[ uiBox ] )
+			++m_BucketStart[ GetBucket( m_CellX[ uiBox ], m_CellY[ uiBox ], m_CellZ[ uiBox ] ) + 1 ];
+	}
+
+	for( size_t uiBucket = 0; uiBucket < uiBuckets; ++uiBucket )
+		m_BucketStart[ uiBucket + 1 ] += m_BucketStart[ uiBucket ];
+
+	//Counting sort; boxes stay in the order they were added within a bucket.
+	for( size_t uiBox = 0; uiBox < uiCount; ++uiBox )
+	{
+		if( !m_IsLarge[ uiBox ] )
+			m_SortedBoxes[ m_BucketStart[ GetBucket( m_CellX[ uiBox ], m_CellY[ uiBox ], m_CellZ[ uiBox ] ) ]++ ] = uiBox;
+	}
+
+	//Filling the buckets moved each start to the next bucket's start.
+	for( size_t uiBucket = uiBuckets; uiBucket > 0; --uiBucket )
+		m_BucketStart[ uiBucket ] = m_BucketStart[ uiBucket - 1 ];
+
+	m_BucketStart[ 0 ] = 0;
+}
+
+void CLooseGrid::Query( const float* vecMins, const float* vecMaxs, std::vector<int>& list )
+{
+	++m_Stats.ullQueries;
+
+	if( !m_SortedBoxes.empty() )
+	{
+		//One more unit so rounding can't lose boxes whose center is right on the edge.
+		const float flHalfCell = m_flCellSize * 0.5f + 1;
+
+		const int iMinX = GetCell( vecMins[ 0 ] - flHalfCell ), iMaxX = GetCell( vecMaxs[ 0 ] + flHalfCell );
+		const int iMinY = GetCell( vecMins[ 1 ] - flHalfCell ), iMaxY = GetCell( vecMaxs[ 1 ] + flHalfCell );
+		const int iMinZ = GetCell( vecMins[ 2 ] - flHalfCell ), iMaxZ = GetCell( vecMaxs[ 2 ] + flHalfCell );
+
+		const double flCells = ( static_cast<double>( iMaxX ) - iMinX + 1 ) * ( static_cast<double>( iMaxY ) - iMinY + 1 ) * ( static_cast<double>( iMaxZ ) - iMinZ + 1 );
+
+		//Large queries cover more cells than there are boxes. Queries with invalid bounds can match boxes in any cell.
+		if( flCells > m_SortedBoxes.size() ||
+			std::isnan( vecMins[ 0 ] ) || std::isnan( vecMins[ 1 ] ) || std::isnan( vecMins[ 2 ] ) ||
+			std::isnan( vecMaxs[ 0 ] ) || std::isnan( vecMaxs[ 1 ] ) || std::isnan( vecMaxs[ 2 ] ) )
+		{
+			++m_Stats.ullLinearQueries;
+
+			for( const auto uiBox : m_SortedBoxes )
+				TestBox( uiBox, vecMins, vecMaxs, list );
+		}
+		else
+		{
+			//Cells can share a bucket, so only boxes in the cell being searched are used.
+			for( int iX = iMinX; iX <= iMaxX; ++iX )
+			{
+				for( int iY = iMinY; iY <= iMaxY; ++iY )
+				{
+					for( int iZ = iMinZ; iZ <= iMaxZ; ++iZ )
+					{
+						const size_t uiBucket = GetBucket( iX, iY, iZ );
+
+						for( size_t uiSorted = m_BucketStart[ uiBucket ]; uiSorted < m_BucketStart[ uiBucket + 1 ]; ++uiSorted )
+						{
+							const size_t uiBox = m_SortedBoxes[ uiSorted ];
+
+							if( m_CellX[ uiBox ] == iX && m_CellY[ uiBox ] == iY && m_CellZ[ uiBox ] == iZ )
+								TestBox( uiBox, vecMins, vecMaxs, list );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	for( const auto uiBox : m_LargeBoxes )
+		TestBox( uiBox, vecMins, vecMaxs, list );
+}
+
+size_t CLooseGrid::GetBucket( const int iX, const int iY, const int iZ ) const
+{
+	const size_t uiHash =
+		( static_cast<unsigned int>( iX ) * 73856093u ) ^ ( static_cast<unsigned int>( iY ) * 19349663u ) ^ ( static_cast<unsigned int>( iZ ) * 83492791u );
+
+	return uiHash & ( m_BucketStart.size() - 2 );
+}
+
+int CLooseGrid::GetCell( const float flValue ) const
+{
+	const float flCell = std::floor( flValue / m_flCellSize );
+
+	//Also catches NaN.
+	if( !( flCell > -MAX_CELL ) )
+		return -MAX_CELL;
+
+	if( flCell > MAX_CELL )
+		return MAX_CELL;
+
+	return static_cast<int>( flCell );
+}
+
+void CLooseGrid::TestBox( const size_t uiBox, const float* vecMins, const float* vecMaxs, std::vector<int>& list )
+{
+	++m_Stats.ullBoxTests;
+
+	if( vecMins[ 0 ] > m_MaxX[ uiBox ] ||
+		vecMins[ 1 ] > m_MaxY[ uiBox ] ||
+		vecMins[ 2 ] > m_MaxZ[ uiBox ] ||
+		vecMaxs[ 0 ] < m_MinX[ uiBox ] ||
+		vecMaxs[ 1 ] < m_MinY[ uiBox ] ||
+		vecMaxs[ 2 ] < m_MinZ[ uiBox ] )
+		return;
+
+	list.push_back( m_Indices[ uiBox ] );
+}
@@ -0,0 +1,109 @@
+#ifndef GAME_SERVER_ENTITIES_CLOOSEGRID_H
+#define GAME_SERVER_ENTITIES_CLOOSEGRID_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*	Loose grid statistics.
+*/
+struct LooseGridStats_t
+{
+	unsigned long long ullBuilds = 0;
+	unsigned long long ullQueries = 0;
+
+	//Number of boxes whose bounds were tested against a query.
+	unsigned long long ullBoxTests = 0;
+
+	//Queries that covered so many cells that every box was tested instead.
+	unsigned long long ullLinearQueries = 0;
+};
+
+/**
+*	Uniform grid of boxes, used to find the boxes that touch a given box without testing all of them.
+*	Each box is put in the cell that holds its center. Boxes are at most a cell wide, so a box can only touch boxes
+*	whose center is within half a cell of it; queries look at the cells that cover the box grown by half a cell.
+*	Boxes that are larger than a cell are kept in a separate list that every query tests.
+*	Cells are hashed into buckets, so the size of the world doesn't matter.
+*	The grid is built all at once; boxes can't be moved or removed afterwards, only cleared.
+*	Doesn't use the engine, so it can be benchmarked on its own.
+*/
+class CLooseGrid final
+{
+public:
+	static constexpr float DEFAULT_CELL_SIZE = 512;
+
+public:
+	CLooseGrid() = default;
+
+	const LooseGridStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	float GetCellSize() const { return m_flCellSize; }
+
+	/**
+	*	Sets the cell size. Clears the grid.
+	*/
+	void SetCellSize( const float flCellSize );
+
+	size_t GetCount() const { return m_Indices.size(); }
+
+	/**
+	*	Removes all boxes.
+	*/
+	void Clear();
+
+	/**
+	*	Adds a box. Call Build after adding all boxes.
+	*	@param iIndex Index that queries return for this box.
+	*/
+	void Add( const int iIndex, const float* vecMins, const float* vecMaxs );
+
+	/**
+	*	Sorts the boxes into cells.
+	*/
+	void Build();
+
+	/**
+	*	Adds the indices of all boxes that touch the given box to list. Boxes that only share a face touch, like in UTIL_EntitiesInBox.
+	*	Indices are added in no particular order.
+	*/
+	void Query( const float* vecMins, const float* vecMaxs, std::vector<int>& list );
+
+private:
+	size_t GetBucket( const int iX, const int iY, const int iZ ) const;
+
+	int GetCell( const float flValue ) const;
+
+	/**
+	*	Adds the index of the given box to list if it touches the given box.
+	*/
+	void TestBox( const size_t uiBox, const float* vecMins, const float* vecMaxs, std::vector<int>& list );
+
+private:
+	float m_flCellSize = DEFAULT_CELL_SIZE;
+
+	std::vector<int> m_Indices;
+	std::vector<float> m_MinX, m_MinY, m_MinZ;
+	std::vector<float> m_MaxX, m_MaxY, m_MaxZ;
+
+	//Grid cell of each box in the grid.
+	std::vector<int> m_CellX, m_CellY, m_CellZ;
+
+	//Boxes that are larger than a cell.
+	std::vector<bool> m_IsLarge;
+	std::vector<size_t> m_LargeBoxes;
+
+	//Boxes in the grid, sorted by bucket, and where each bucket starts.
+	std::vector<size_t> m_BucketStart;
+	std::vector<size_t> m_SortedBoxes;
+
+	LooseGridStats_t m_Stats;
+
+private:
+	CLooseGrid( const CLooseGrid& ) = delete;
+	CLooseGrid& operator=( const CLooseGrid& ) = delete;
+};
+
+#endif //GAME_SERVER_ENTITIES_CLOOSEGRID_H
@@ -47,7 +47,7 @@ void CRpgRocket::Spawn( void )
 	SetSize( Vector( 0, 0, 0 ), Vector( 0, 0, 0 ) );
 	SetAbsOrigin( GetAbsOrigin() );
 
-	pev->classname = MAKE_STRING( "rpg_rocket" );
+	SetClassname( "rpg_rocket" );
 
 	SetThink( &CRpgRocket::IgniteThink );
 	SetTouch( &CRpgRocket::ExplodeTouch );
@@ -12,9 +12,12 @@
 *   without written permission from Valve LLC.
 *
 ****/
+#include	<algorithm>
+
 #include	"extdll.h"
 #include	"util.h"
 #include	"cbase.h"
+#include	"Server.h"
 #include	"entities/NPCs/Monsters.h"
 #include	"CSoundEnt.h"
 
@@ -23,6 +26,8 @@ LINK_ENTITY_TO_CLASS( soundent, CSoundEnt );
 
 CSoundEnt *pSoundEnt;
 
+CSoundEnt::Stats_t CSoundEnt::m_Stats = {};
+
 //=========================================================
 // CSound - Clear - zeros all fields for a sound
 //=========================================================
@@ -33,7 +38,15 @@ void CSound::Clear()
 	m_iVolume		= 0;
 	m_flExpireTime	= 0;
 	m_iNext			= SOUNDLIST_EMPTY;
+	m_iPrevious		= SOUNDLIST_EMPTY;
+	m_iNextOfType	= SOUNDLIST_EMPTY;
+	m_iPreviousOfType = SOUNDLIST_EMPTY;
+	m_iCategory		= 0;
+	m_fActive		= false;
 	m_iNextAudible	= 0;
+	m_iNextInCell	= SOUNDLIST_EMPTY;
+	m_iCellX		= 0;
+	m_iCellY		= 0;
 }
 
 //=========================================================
@@ -45,7 +58,6 @@ void CSound::Reset()
 	m_vecOrigin		= g_vecZero;
 	m_iType			= 0;
 	m_iVolume		= 0;
-	m_iNext			= SOUNDLIST_EMPTY;
 }
 
 //=========================================================
@@ -86,42 +98,43 @@ void CSoundEnt :: Spawn( void )
 }
 
 //=========================================================
-// Think - at interval, the entire active sound list is checked
-// for sounds that have ExpireTimes less than or equal
-// to the current world time, and these sounds are deallocated.
+// Think - at interval, sounds with ExpireTimes less than or
+// equal to the current world time are deallocated. Sounds 
+// are taken from the expiry heap in the order they expire,
+// so only the expired sounds are visited.
 //=========================================================
 void CSoundEnt :: Think ( void )
 {
-	int iSound;
-	int iPreviousSound;
-
 	pev->nextthink = gpGlobals->time + 0.3;// how often to check the sound list.
 
-	iPreviousSound = SOUNDLIST_EMPTY;
-	iSound = m_iActiveSound; 
-
-	while ( iSound != SOUNDLIST_EMPTY )
+	while ( !m_Expiries.empty() && m_Expiries.front().flExpireTime <= gpGlobals->time )
 	{
-		if ( m_SoundPool[ iSound ].m_flExpireTime <= gpGlobals->time && m_SoundPool[ iSound ].m_flExpireTime != SOUND_NEVER_EXPIRE )
-		{
-			int iNext = m_SoundPool[ iSound ].m_iNext;
+		const SoundExpiry_t expiry = m_Expiries.front();
 
-			// move this sound back into the free list
-			FreeSound( iSound, iPreviousSound );
+		std::pop_heap( m_Expiries.begin(), m_Expiries.end() );
+		m_Expiries.pop_back();
 
-			iSound = iNext;
-		}
-		else
+		CSound& sound = Sound( expiry.iSound );
+
+		// the sound may have been freed already, and possibly reused.
+		if ( sound.m_fActive && sound.m_flExpireTime == expiry.flExpireTime )
 		{
-			iPreviousSound = iSound;
-			iSound = m_SoundPool[ iSound ].m_iNext;
+			// move this sound back into the free list
+			FreeSound( expiry.iSound );
+
+			++m_Stats.uiExpired;
 		}
 	}
 
+	if ( m_afStaleMaxVolume )
+	{
+		UpdateMaxCellVolume();
+	}
+
 	if ( m_fShowReport )
 	{
-		ALERT ( at_aiconsole, "Soundlist: %d / %d  (%d)\n", ISoundsInList( SOUNDLISTTYPE_ACTIVE ),ISoundsInList( SOUNDLISTTYPE_FREE ), ISoundsInList( SOUNDLISTTYPE_ACTIVE ) - m_cLastActiveSounds );
-		m_cLastActiveSounds = ISoundsInList ( SOUNDLISTTYPE_ACTIVE );
+		ALERT ( at_aiconsole, "Soundlist: %d / %d  (%d)\n", m_cActiveSounds, m_cSounds - m_cActiveSounds, m_cActiveSounds - m_cLastActiveSounds );
+		m_cLastActiveSounds = m_cActiveSounds;
 	}
 
 }
@@ -138,7 +151,7 @@ void CSoundEnt :: Precache ( void )
 // to the top of the free list. TAKE CARE to only call this
 // function for sounds in the Active list!!
 //=========================================================
-void CSoundEnt :: FreeSound ( int iSound, int iPrevious )
+void CSoundEnt :: FreeSound ( int iSound )
 {
 	if ( !pSoundEnt )
 	{
@@ -146,22 +159,78 @@ void CSoundEnt :: FreeSound ( int iSound, int iPrevious )
 		return;
 	}
 
-	if ( iPrevious != SOUNDLIST_EMPTY )
+	CSound& sound = pSoundEnt->Sound( iSound );
+
+	if ( sound.m_iPrevious != SOUNDLIST_EMPTY )
 	{
 		// iSound is not the head of the active list, so
 		// must fix the index for the Previous sound
-//		pSoundEnt->m_SoundPool[ iPrevious ].m_iNext = m_SoundPool[ iSound ].m_iNext;
-		pSoundEnt->m_SoundPool[ iPrevious ].m_iNext = pSoundEnt->m_SoundPool[ iSound ].m_iNext;
+		pSoundEnt->Sound( sound.m_iPrevious ).m_iNext = sound.m_iNext;
 	}
 	else 
 	{
 		// the sound we're freeing IS the head of the active list.
-		pSoundEnt->m_iActiveSound = pSoundEnt->m_SoundPool [ iSound ].m_iNext;
+		pSoundEnt->m_iActiveSound = sound.m_iNext;
+	}
+
+	if ( sound.m_iNext != SOUNDLIST_EMPTY )
+	{
+		pSoundEnt->Sound( sound.m_iNext ).m_iPrevious = sound.m_iPrevious;
+	}
+
+	if ( iSound >= pSoundEnt->m_cClientSounds )
+	{
+		pSoundEnt->UnlinkFromCell( iSound );
+		pSoundEnt->UnlinkFromCategory( iSound );
 	}
 
 	// make iSound the head of the Free list.
-	pSoundEnt->m_SoundPool[ iSound ].m_iNext = pSoundEnt->m_iFreeSound;
+	sound.m_iNext = pSoundEnt->m_iFreeSound;
+	sound.m_iPrevious = SOUNDLIST_EMPTY;
+	sound.m_fActive = false;
 	pSoundEnt->m_iFreeSound = iSound;
+
+	--pSoundEnt->m_cActiveSounds;
+}
+
+//=========================================================
+// GrowPool - adds a block of sounds to the free list. The
+// pool never shrinks during a map.
+//=========================================================
+bool CSoundEnt :: GrowPool( void )
+{
+	const int iMaxSounds = max( MAX_WORLD_SOUNDS, static_cast<int>( sv_soundpool_max.value ) );
+
+	if ( m_cSounds + MAX_WORLD_SOUNDS > iMaxSounds )
+	{
+		return false;
+	}
+
+	m_SoundChunks.emplace_back( new CSound[ MAX_WORLD_SOUNDS ] );
+
+	const int iFirstSound = m_cSounds;
+
+	m_cSounds += MAX_WORLD_SOUNDS;
+
+	// link the new sounds into the free list, in order.
+	for ( int i = m_cSounds - 1 ; i >= iFirstSound ; i-- )
+	{
+		Sound( i ).Clear();
+		Sound( i ).m_iNext = m_iFreeSound;
+		m_iFreeSound = i;
+	}
+
+	if ( iFirstSound > 0 )
+	{
+		++m_Stats.uiGrowths;
+	}
+
+	if ( m_cSounds > m_Stats.iPoolHighWater )
+	{
+		m_Stats.iPoolHighWater = m_cSounds;
+	}
+
+	return true;
 }
 
 //=========================================================
@@ -172,10 +241,10 @@ int CSoundEnt :: IAllocSound( void )
 {
 	int iNewSound;
 
-	if ( m_iFreeSound == SOUNDLIST_EMPTY )
+	if ( m_iFreeSound == SOUNDLIST_EMPTY && !GrowPool() )
 	{
 		// no free sound!
-		ALERT ( at_console, "Free Sound List is full!\n" );
+		ALERT ( at_aiconsole, "Free Sound List is full!\n" );
 		return SOUNDLIST_EMPTY;
 	}
 
@@ -184,12 +253,28 @@ int CSoundEnt :: IAllocSound( void )
 	
 	iNewSound = m_iFreeSound;// copy the index of the next free sound
 
-	m_iFreeSound = m_SoundPool[ m_iFreeSound ].m_iNext;// move the index down into the free list. 
+	CSound& sound = Sound( iNewSound );
+
+	m_iFreeSound = sound.m_iNext;// move the index down into the free list. 
+
+	sound.m_iNext = m_iActiveSound;// point the new sound at the top of the active list.
+	sound.m_iPrevious = SOUNDLIST_EMPTY;
+	sound.m_fActive = true;
 
-	m_SoundPool[ iNewSound ].m_iNext = m_iActiveSound;// point the new sound at the top of the active list.
+	if ( m_iActiveSound != SOUNDLIST_EMPTY )
+	{
+		Sound( m_iActiveSound ).m_iPrevious = iNewSound;
+	}
 
 	m_iActiveSound = iNewSound;// now make the new sound the top of the active list. You're done.
 
+	++m_cActiveSounds;
+
+	if ( m_cActiveSounds > m_Stats.iActiveHighWater )
+	{
+		m_Stats.iActiveHighWater = m_cActiveSounds;
+	}
+
 	return iNewSound;
 }
 
@@ -211,14 +296,25 @@ void CSoundEnt :: InsertSound ( int iType, const Vector &vecOrigin, int iVolume,
 
 	if ( iThisSound == SOUNDLIST_EMPTY )
 	{
-		ALERT ( at_console, "Could not AllocSound() for InsertSound() (DLL)\n" );
+		++m_Stats.uiDropped;
+		ALERT ( at_aiconsole, "Could not AllocSound() for InsertSound() (DLL)\n" );
 		return;
 	}
 
-	pSoundEnt->m_SoundPool[ iThisSound ].m_vecOrigin = vecOrigin;
-	pSoundEnt->m_SoundPool[ iThisSound ].m_iType = iType;
-	pSoundEnt->m_SoundPool[ iThisSound ].m_iVolume = iVolume;
-	pSoundEnt->m_SoundPool[ iThisSound ].m_flExpireTime = gpGlobals->time + flDuration;
+	++m_Stats.uiInserted;
+
+	CSound& sound = pSoundEnt->Sound( iThisSound );
+
+	sound.m_vecOrigin = vecOrigin;
+	sound.m_iType = iType;
+	sound.m_iVolume = iVolume;
+	sound.m_flExpireTime = gpGlobals->time + flDuration;
+
+	pSoundEnt->LinkToCell( iThisSound );
+	pSoundEnt->LinkToCategory( iThisSound );
+
+	pSoundEnt->m_Expiries.push_back( { sound.m_flExpireTime, iThisSound } );
+	std::push_heap( pSoundEnt->m_Expiries.begin(), pSoundEnt->m_Expiries.end() );
 }
 
 //=========================================================
@@ -230,22 +326,61 @@ void CSoundEnt :: Initialize ( void )
   	int i;
 	int iSound;
 
-	m_iFreeSound = 0;
+	m_iFreeSound = SOUNDLIST_EMPTY;
 	m_iActiveSound = SOUNDLIST_EMPTY;
+	m_cActiveSounds = 0;
+	m_cClientSounds = 0;
+
+	m_SoundChunks.clear();
+	m_cSounds = 0;
+	m_Expiries.clear();
+
+	for ( i = 0 ; i < SOUND_CATEGORIES ; i++ )
+	{
+		m_iCategorySounds[ i ] = SOUNDLIST_EMPTY;
+		m_afCategoryTypes[ i ] = 0;
+	}
+
+	for ( i = 0 ; i < SOUND_CELL_BUCKETS ; i++ )
+	{
+		m_iCellSounds[ i ] = SOUNDLIST_EMPTY;
+		m_afCellTypes[ i ] = 0;
+	}
+
+	m_cCellSounds = 0;
+
+	for ( i = 0 ; i < SOUND_TYPE_BITS ; i++ )
+	{
+		m_iMaxCellVolume[ i ] = 0;
+		m_cMaxCellVolume[ i ] = 0;
+	}
+
+	m_afStaleMaxVolume = 0;
+
+	// clear all sounds, and link them into the free sound list.
+	// the first block is always allocated, no matter what sv_soundpool_max is set to.
+	m_SoundChunks.emplace_back( new CSound[ MAX_WORLD_SOUNDS ] );
+	m_cSounds = MAX_WORLD_SOUNDS;
+	m_iFreeSound = 0;
 
 	for ( i = 0 ; i < MAX_WORLD_SOUNDS ; i++ )
-	{// clear all sounds, and link them into the free sound list.
-		m_SoundPool[ i ].Clear();
-		m_SoundPool[ i ].m_iNext = i + 1;
+	{
+		Sound( i ).Clear();
+		Sound( i ).m_iNext = i + 1;
 	}
 
-	m_SoundPool[ i - 1 ].m_iNext = SOUNDLIST_EMPTY;// terminate the list here.
+	Sound( i - 1 ).m_iNext = SOUNDLIST_EMPTY;// terminate the list here.
+
+	if ( m_cSounds > m_Stats.iPoolHighWater )
+	{
+		m_Stats.iPoolHighWater = m_cSounds;
+	}
 
 	
 	// now reserve enough sounds for each client
 	for ( i = 0 ; i < gpGlobals->maxClients ; i++ )
 	{
-		iSound = pSoundEnt->IAllocSound();
+		iSound = IAllocSound();
 
 		if ( iSound == SOUNDLIST_EMPTY )
 		{
@@ -253,7 +388,9 @@ void CSoundEnt :: Initialize ( void )
 			return;
 		}
 
-		pSoundEnt->m_SoundPool[ iSound ].m_flExpireTime = SOUND_NEVER_EXPIRE;
+		Sound( iSound ).m_flExpireTime = SOUND_NEVER_EXPIRE;
+
+		++m_cClientSounds;
 	}
 
 	if ( CVAR_GET_FLOAT("displaysoundlist") == 1 )
@@ -300,7 +437,7 @@ int CSoundEnt :: ISoundsInList ( int iListType )
 	{
 		i++;
 
-		iThisSound = m_SoundPool[ iThisSound ].m_iNext;
+		iThisSound = Sound( iThisSound ).m_iNext;
 	}
 
 	return i;
@@ -343,7 +480,7 @@ CSound*	CSoundEnt :: SoundPointerForIndex( int iIndex )
 		return NULL;
 	}
 
-	if ( iIndex > ( MAX_WORLD_SOUNDS - 1 ) )
+	if ( iIndex > ( pSoundEnt->m_cSounds - 1 ) )
 	{
 		ALERT ( at_console, "SoundPointerForIndex() - Index too large!\n" );
 		return NULL;
@@ -355,7 +492,7 @@ CSound*	CSoundEnt :: SoundPointerForIndex( int iIndex )
 		return NULL;
 	}
 
-	return &pSoundEnt->m_SoundPool[ iIndex ];
+	return &pSoundEnt->Sound( iIndex );
 }
 
 //=========================================================
@@ -376,4 +513,420 @@ int CSoundEnt::ClientSoundIndex( const CBaseEntity* const pClient )
 #endif // _DEBUG
 
 	return iReturn;
-}
\ No newline at end of file
+}
+
+//=========================================================
+// SoundCell - returns the cell that a position is in.
+//=========================================================
+static inline int SoundCell( const float flCoord )
+{
+	return static_cast<int>( floor( flCoord / SOUND_CELL_SIZE ) );
+}
+
+//=========================================================
+// SoundCellBucket - returns the bucket that a cell is 
+// hashed into. Several cells can share a bucket, so sounds
+// in a bucket must be checked against the cell.
+//=========================================================
+static inline int SoundCellBucket( const int iCellX, const int iCellY )
+{
+	return static_cast<int>( ( ( static_cast<unsigned int>( iCellX ) * 73856093U ) ^ ( static_cast<unsigned int>( iCellY ) * 19349663U ) ) & ( SOUND_CELL_BUCKETS - 1 ) );
+}
+
+//=========================================================
+// LinkToCell - puts an inserted sound into the bucket for
+// the cell that it's in.
+//=========================================================
+void CSoundEnt::LinkToCell( const int iSound )
+{
+	CSound& sound = Sound( iSound );
+
+	sound.m_iCellX = SoundCell( sound.m_vecOrigin.x );
+	sound.m_iCellY = SoundCell( sound.m_vecOrigin.y );
+
+	const int iBucket = SoundCellBucket( sound.m_iCellX, sound.m_iCellY );
+
+	sound.m_iNextInCell = m_iCellSounds[ iBucket ];
+	m_iCellSounds[ iBucket ] = iSound;
+	m_afCellTypes[ iBucket ] |= sound.m_iType;
+
+	++m_cCellSounds;
+
+	for ( int iBit = 0 ; iBit < SOUND_TYPE_BITS ; iBit++ )
+	{
+		if ( !( sound.m_iType & ( 1 << iBit ) ) )
+		{
+			continue;
+		}
+
+		if ( sound.m_iVolume > m_iMaxCellVolume[ iBit ] )
+		{
+			m_iMaxCellVolume[ iBit ] = sound.m_iVolume;
+			m_cMaxCellVolume[ iBit ] = 1;
+		}
+		else if ( sound.m_iVolume == m_iMaxCellVolume[ iBit ] )
+		{
+			++m_cMaxCellVolume[ iBit ];
+		}
+	}
+}
+
+//=========================================================
+// UnlinkFromCell - removes a sound from its cell bucket.
+//=========================================================
+void CSoundEnt::UnlinkFromCell( const int iSound )
+{
+	CSound& sound = Sound( iSound );
+
+	const int iBucket = SoundCellBucket( sound.m_iCellX, sound.m_iCellY );
+
+	int iPrevious = SOUNDLIST_EMPTY;
+
+	for ( int iThisSound = m_iCellSounds[ iBucket ] ; iThisSound != SOUNDLIST_EMPTY ; iThisSound = Sound( iThisSound ).m_iNextInCell )
+	{
+		if ( iThisSound == iSound )
+		{
+			if ( iPrevious != SOUNDLIST_EMPTY )
+			{
+				Sound( iPrevious ).m_iNextInCell = sound.m_iNextInCell;
+			}
+			else
+			{
+				m_iCellSounds[ iBucket ] = sound.m_iNextInCell;
+			}
+
+			sound.m_iNextInCell = SOUNDLIST_EMPTY;
+
+			--m_cCellSounds;
+			break;
+		}
+
+		iPrevious = iThisSound;
+	}
+
+	// the types of the remaining sounds.
+	m_afCellTypes[ iBucket ] = 0;
+
+	for ( int iThisSound = m_iCellSounds[ iBucket ] ; iThisSound != SOUNDLIST_EMPTY ; iThisSound = Sound( iThisSound ).m_iNextInCell )
+	{
+		m_afCellTypes[ iBucket ] |= Sound( iThisSound ).m_iType;
+	}
+
+	// once the last of the loudest sounds of a type is gone, the next Think finds the new loudest one.
+	for ( int iBit = 0 ; iBit < SOUND_TYPE_BITS ; iBit++ )
+	{
+		if ( ( sound.m_iType & ( 1 << iBit ) ) && sound.m_iVolume == m_iMaxCellVolume[ iBit ] && --m_cMaxCellVolume[ iBit ] <= 0 )
+		{
+			m_afStaleMaxVolume |= 1 << iBit;
+		}
+	}
+}
+
+//=========================================================
+// SoundCategory - returns the category list for a sound
+// type.
+//=========================================================
+static inline int SoundCategory( const int iType )
+{
+	for ( int iBit = 0 ; iBit < SOUND_TYPE_BITS ; iBit++ )
+	{
+		if ( iType & ( 1 << iBit ) )
+		{
+			return iBit;
+		}
+	}
+
+	return SOUND_TYPE_BITS;
+}
+
+//=========================================================
+// LinkToCategory - puts an inserted sound at the top of
+// its category list.
+//=========================================================
+void CSoundEnt::LinkToCategory( const int iSound )
+{
+	CSound& sound = Sound( iSound );
+
+	sound.m_iCategory = SoundCategory( sound.m_iType );
+
+	sound.m_iPreviousOfType = SOUNDLIST_EMPTY;
+	sound.m_iNextOfType = m_iCategorySounds[ sound.m_iCategory ];
+
+	if ( sound.m_iNextOfType != SOUNDLIST_EMPTY )
+	{
+		Sound( sound.m_iNextOfType ).m_iPreviousOfType = iSound;
+	}
+
+	m_iCategorySounds[ sound.m_iCategory ] = iSound;
+	m_afCategoryTypes[ sound.m_iCategory ] |= sound.m_iType;
+}
+
+//=========================================================
+// UnlinkFromCategory - removes a sound from its category
+// list.
+//=========================================================
+void CSoundEnt::UnlinkFromCategory( const int iSound )
+{
+	CSound& sound = Sound( iSound );
+
+	if ( sound.m_iPreviousOfType != SOUNDLIST_EMPTY )
+	{
+		Sound( sound.m_iPreviousOfType ).m_iNextOfType = sound.m_iNextOfType;
+	}
+	else
+	{
+		m_iCategorySounds[ sound.m_iCategory ] = sound.m_iNextOfType;
+	}
+
+	if ( sound.m_iNextOfType != SOUNDLIST_EMPTY )
+	{
+		Sound( sound.m_iNextOfType ).m_iPreviousOfType = sound.m_iPreviousOfType;
+	}
+
+	sound.m_iNextOfType = sound.m_iPreviousOfType = SOUNDLIST_EMPTY;
+
+	// the types are only kept up to date when the list empties; until then, listeners may walk a list that has none of their types.
+	if ( m_iCategorySounds[ sound.m_iCategory ] == SOUNDLIST_EMPTY )
+	{
+		m_afCategoryTypes[ sound.m_iCategory ] = 0;
+	}
+}
+
+//=========================================================
+// UpdateMaxCellVolume - finds the loudest sounds of the 
+// types whose loudest sound was freed. A sound of type bit
+// N is in one of the first N + 1 category lists, so only 
+// those are walked.
+//=========================================================
+void CSoundEnt::UpdateMaxCellVolume()
+{
+	for ( int iBit = 0 ; iBit < SOUND_TYPE_BITS ; iBit++ )
+	{
+		if ( !( m_afStaleMaxVolume & ( 1 << iBit ) ) )
+		{
+			continue;
+		}
+
+		m_iMaxCellVolume[ iBit ] = 0;
+		m_cMaxCellVolume[ iBit ] = 0;
+
+		for ( int iCategory = 0 ; iCategory <= iBit ; iCategory++ )
+		{
+			if ( !( m_afCategoryTypes[ iCategory ] & ( 1 << iBit ) ) )
+			{
+				continue;
+			}
+
+			for ( int iSound = m_iCategorySounds[ iCategory ] ; iSound != SOUNDLIST_EMPTY ; iSound = Sound( iSound ).m_iNextOfType )
+			{
+				const CSound& sound = Sound( iSound );
+
+				if ( !( sound.m_iType & ( 1 << iBit ) ) )
+				{
+					continue;
+				}
+
+				if ( sound.m_iVolume > m_iMaxCellVolume[ iBit ] )
+				{
+					m_iMaxCellVolume[ iBit ] = sound.m_iVolume;
+					m_cMaxCellVolume[ iBit ] = 1;
+				}
+				else if ( sound.m_iVolume == m_iMaxCellVolume[ iBit ] )
+				{
+					++m_cMaxCellVolume[ iBit ];
+				}
+			}
+		}
+	}
+
+	m_afStaleMaxVolume = 0;
+}
+
+//=========================================================
+// FIsAudible - returns true if the sound is of a type in
+// iSoundMask, and is close enough to hear.
+//=========================================================
+static inline bool FIsAudible( const CSound& sound, const Vector& vecEarPosition, const int iSoundMask, const float flHearingSensitivity )
+{
+	if ( !( sound.m_iType & iSoundMask ) )
+	{
+		return false;
+	}
+
+	const float flRange = sound.m_iVolume * flHearingSensitivity;
+
+	if ( flRange < 0 )
+	{
+		return false;
+	}
+
+	const Vector vecDelta = sound.m_vecOrigin - vecEarPosition;
+
+	return DotProduct( vecDelta, vecDelta ) <= flRange * flRange;
+}
+
+//=========================================================
+// BuildAudibleList - links all sounds that can be heard
+// from vecEarPosition, and returns the first one.
+//=========================================================
+int CSoundEnt::BuildAudibleList( const Vector& vecEarPosition, const int iSoundMask, const float flHearingSensitivity, int& iFirstScent )
+{
+	iFirstScent = SOUNDLIST_EMPTY;
+
+	if ( !pSoundEnt )
+	{
+		return SOUNDLIST_EMPTY;
+	}
+
+	int iSounds = SOUNDLIST_EMPTY;
+	int iLastSound = SOUNDLIST_EMPTY;
+	int iScents = SOUNDLIST_EMPTY;
+
+	auto linkAudible = [ & ]( const int iSound, CSound& sound )
+	{
+		if ( !FIsAudible( sound, vecEarPosition, iSoundMask, flHearingSensitivity ) )
+		{
+			return;
+		}
+
+		if ( sound.FIsScent() )
+		{
+			sound.m_iNextAudible = iScents;
+			iScents = iSound;
+		}
+		else
+		{
+			if ( iSounds == SOUNDLIST_EMPTY )
+			{
+				iLastSound = iSound;
+			}
+
+			sound.m_iNextAudible = iSounds;
+			iSounds = iSound;
+		}
+	};
+
+	for ( int iSound = 0 ; iSound < pSoundEnt->m_cClientSounds ; iSound++ )
+	{
+		linkAudible( iSound, pSoundEnt->Sound( iSound ) );
+	}
+
+	// no sound in a cell can be heard from further away than the loudest one.
+	int iMaxVolume = 0;
+
+	for ( int iBit = 0 ; iBit < SOUND_TYPE_BITS ; iBit++ )
+	{
+		if ( ( iSoundMask & ( 1 << iBit ) ) && pSoundEnt->m_iMaxCellVolume[ iBit ] > iMaxVolume )
+		{
+			iMaxVolume = pSoundEnt->m_iMaxCellVolume[ iBit ];
+		}
+	}
+
+	const float flRange = iMaxVolume * flHearingSensitivity;
+
+	const int iMinCellX = SoundCell( vecEarPosition.x - flRange );
+	const int iMaxCellX = SoundCell( vecEarPosition.x + flRange );
+	const int iMinCellY = SoundCell( vecEarPosition.y - flRange );
+	const int iMaxCellY = SoundCell( vecEarPosition.y + flRange );
+
+	if ( ( iMaxCellX - iMinCellX + 1 ) * ( iMaxCellY - iMinCellY + 1 ) > pSoundEnt->m_cCellSounds )
+	{
+		// with a large range, it's cheaper to check the sounds of the listener's types.
+		for ( int iCategory = 0 ; iCategory < SOUND_CATEGORIES ; iCategory++ )
+		{
+			if ( !( pSoundEnt->m_afCategoryTypes[ iCategory ] & iSoundMask ) )
+			{
+				continue;
+			}
+
+			for ( int iSound = pSoundEnt->m_iCategorySounds[ iCategory ] ; iSound != SOUNDLIST_EMPTY ; iSound = pSoundEnt->Sound( iSound ).m_iNextOfType )
+			{
+				linkAudible( iSound, pSoundEnt->Sound( iSound ) );
+			}
+		}
+	}
+	else
+	{
+		for ( int iCellX = iMinCellX ; iCellX <= iMaxCellX ; iCellX++ )
+		{
+			for ( int iCellY = iMinCellY ; iCellY <= iMaxCellY ; iCellY++ )
+			{
+				const int iBucket = SoundCellBucket( iCellX, iCellY );
+
+				if ( !( pSoundEnt->m_afCellTypes[ iBucket ] & iSoundMask ) )
+				{
+					continue;
+				}
+
+				for ( int iSound = pSoundEnt->m_iCellSounds[ iBucket ] ; iSound != SOUNDLIST_EMPTY ; iSound = pSoundEnt->Sound( iSound ).m_iNextInCell )
+				{
+					CSound& sound = pSoundEnt->Sound( iSound );
+
+					// sounds from other cells hashed into this bucket are found when their own cell is checked.
+					if ( sound.m_iCellX == iCellX && sound.m_iCellY == iCellY )
+					{
+						linkAudible( iSound, sound );
+					}
+				}
+			}
+		}
+	}
+
+	iFirstScent = iScents;
+
+	// the scents go after the sounds.
+	if ( iSounds == SOUNDLIST_EMPTY )
+	{
+		return iScents;
+	}
+
+	pSoundEnt->Sound( iLastSound ).m_iNextAudible = iScents;
+
+	return iSounds;
+}
+
+//=========================================================
+// GetStats - returns the pool statistics, which are kept
+// across maps until they're reset.
+//=========================================================
+const CSoundEnt::Stats_t& CSoundEnt::GetStats()
+{
+	return m_Stats;
+}
+
+void CSoundEnt::ResetStats()
+{
+	m_Stats = {};
+
+	if ( pSoundEnt )
+	{
+		m_Stats.iActiveHighWater = pSoundEnt->m_cActiveSounds;
+		m_Stats.iPoolHighWater = pSoundEnt->m_cSounds;
+	}
+}
+
+static void ServerCommand_SoundEntStats()
+{
+	if ( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		CSoundEnt::ResetStats();
+		Alert( at_console, "Sound pool statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = CSoundEnt::GetStats();
+
+	if ( pSoundEnt )
+	{
+		Alert( at_console, "Sound pool (sv_soundpool_max is %d): %d sounds, %d active\n",
+			   static_cast<int>( sv_soundpool_max.value ), pSoundEnt->GetPoolSize(), pSoundEnt->GetActiveCount() );
+	}
+
+	Alert( at_console, "%u inserted, %u dropped, %u expired, %u growths\n", stats.uiInserted, stats.uiDropped, stats.uiExpired, stats.uiGrowths );
+	Alert( at_console, "High water: %d active, %d in pool\n", stats.iActiveHighWater, stats.iPoolHighWater );
+}
+
+void SoundEnt_RegisterCommands()
+{
+	g_engfuncs.pfnAddServerCommand( "soundent_stats", &::ServerCommand_SoundEntStats );
+}
@@ -18,7 +18,10 @@
 // lists.
 //=========================================================
 
-#define	MAX_WORLD_SOUNDS	64 // maximum number of sounds handled by the world at one time.
+#include <memory>
+#include <vector>
+
+#define	MAX_WORLD_SOUNDS	64 // number of sounds the world starts with. The pool grows by this many sounds at a time, up to sv_soundpool_max.
 
 #define bits_SOUND_NONE		0
 #define	bits_SOUND_COMBAT	( 1 << 0 )// gunshots, explosions
@@ -38,6 +41,12 @@
 
 #define	SOUND_NEVER_EXPIRE	-1 // with this set as a sound's ExpireTime, the sound will never expire.
 
+#define SOUND_TYPE_BITS		7 // number of bits_SOUND_* types.
+#define SOUND_CATEGORIES	( SOUND_TYPE_BITS + 1 ) // inserted sounds are kept in a list for their lowest type bit, or in the last list if they have no type.
+
+#define SOUND_CELL_SIZE		512 // size of the cells that inserted sounds are bucketed into, on the X and Y axes.
+#define SOUND_CELL_BUCKETS	128 // number of buckets that cells are hashed into. Must be a power of 2.
+
 //=========================================================
 // CSound - an instance of a sound in the world.
 //=========================================================
@@ -53,7 +62,15 @@ public:
 	int		m_iVolume;		// how loud the sound is
 	float	m_flExpireTime;	// when the sound should be purged from the list
 	int		m_iNext;		// index of next sound in this list ( Active or Free )
+	int		m_iPrevious;	// index of previous sound in the active list
+	int		m_iNextOfType;	// index of next sound in this sound's category list
+	int		m_iPreviousOfType; // index of previous sound in this sound's category list
+	int		m_iCategory;	// category list that this sound is in
+	bool	m_fActive;		// whether this sound is in the active list
 	int		m_iNextAudible;	// temporary link that monsters use to build a list of audible sounds
+	int		m_iNextInCell;	// index of next sound in this sound's cell bucket
+	int		m_iCellX;		// cell that this sound was bucketed in
+	int		m_iCellY;
 
 	bool	FIsSound() const;
 	bool	FIsScent() const;
@@ -75,15 +92,42 @@ public:
 	void Initialize ( void );
 	
 	static void		InsertSound ( int iType, const Vector &vecOrigin, int iVolume, float flDuration );
-	static void		FreeSound ( int iSound, int iPrevious );
+	static void		FreeSound ( int iSound );
 	static int		ActiveList( void );// return the head of the active list
 	static int		FreeList( void );// return the head of the free list
 	static CSound*	SoundPointerForIndex( int iIndex );// return a pointer for this index in the sound list
 	static int		ClientSoundIndex( const CBaseEntity* const pClient );
 
+	/**
+	*	Links the sounds that can be heard from the given position into a list through CSound::m_iNextAudible.
+	*	Sounds that were inserted are found through the cells within hearing range; client sounds move every frame, and are always checked.
+	*	@param vecEarPosition Position to listen from.
+	*	@param iSoundMask Sound types to look for.
+	*	Scents are linked after the other sounds, so they can be searched without going through the sounds.
+	*	@param flHearingSensitivity Multiplier for the distance that sounds can be heard from.
+	*	@param[ out ] iFirstScent Index of the first scent in the list, or SOUNDLIST_EMPTY if none can be smelled.
+	*	@return Index of the first audible sound, or SOUNDLIST_EMPTY if none can be heard.
+	*/
+	static int		BuildAudibleList( const Vector& vecEarPosition, const int iSoundMask, const float flHearingSensitivity, int& iFirstScent );
+
+	struct Stats_t
+	{
+		unsigned int uiInserted;	// sounds inserted.
+		unsigned int uiDropped;		// sounds that couldn't be inserted because the pool was full.
+		unsigned int uiExpired;		// sounds freed by Think.
+		unsigned int uiGrowths;		// times that the pool grew.
+		int iActiveHighWater;		// most sounds active at once.
+		int iPoolHighWater;			// largest size of the pool.
+	};
+
+	static const Stats_t& GetStats();
+	static void ResetStats();
+
 	bool	IsEmpty() const { return m_iActiveSound == SOUNDLIST_EMPTY; }
 	int		ISoundsInList ( int iListType );
 	int		IAllocSound ( void );
+	int		GetPoolSize() const { return m_cSounds; }
+	int		GetActiveCount() const { return m_cActiveSounds; }
 	virtual int		ObjectCaps() const override { return FCAP_DONT_SAVE; }
 	
 	int		m_iFreeSound;	// index of the first sound in the free sound list
@@ -92,5 +136,51 @@ public:
 	bool	m_fShowReport; // if true, dump information about free/active sounds.
 
 private:
-	CSound		m_SoundPool[ MAX_WORLD_SOUNDS ];
+	CSound&	Sound( const int iSound ) { return m_SoundChunks[ iSound / MAX_WORLD_SOUNDS ][ iSound % MAX_WORLD_SOUNDS ]; }
+
+	// adds MAX_WORLD_SOUNDS sounds to the free list, if sv_soundpool_max allows it.
+	bool	GrowPool();
+
+	void	LinkToCell( const int iSound );
+	void	UnlinkFromCell( const int iSound );
+
+	void	LinkToCategory( const int iSound );
+	void	UnlinkFromCategory( const int iSound );
+
+	// recalculates the loudest volume of the types whose loudest sound was freed.
+	void	UpdateMaxCellVolume();
+
+private:
+	struct SoundExpiry_t
+	{
+		float flExpireTime;
+		int iSound;
+
+		// orders the expiry heap so that the first sound to expire is on top.
+		bool operator<( const SoundExpiry_t& other ) const { return flExpireTime > other.flExpireTime; }
+	};
+
+	// the pool is allocated in blocks of MAX_WORLD_SOUNDS, so growing it doesn't move the sounds.
+	std::vector<std::unique_ptr<CSound[]>> m_SoundChunks;
+	int		m_cSounds; // number of sounds in the pool.
+	int		m_cActiveSounds; // number of sounds in the active list.
+
+	// heap of the inserted sounds, by the time they expire. Entries for sounds that were freed some other way are skipped.
+	std::vector<SoundExpiry_t> m_Expiries;
+
+	int		m_cClientSounds; // number of sounds reserved for clients. These are the first sounds in the pool.
+
+	int		m_iCategorySounds[ SOUND_CATEGORIES ]; // index of the first sound in each category list.
+	int		m_afCategoryTypes[ SOUND_CATEGORIES ]; // sound types of all sounds in each category list.
+
+	int		m_iCellSounds[ SOUND_CELL_BUCKETS ]; // index of the first sound in each cell bucket.
+	int		m_afCellTypes[ SOUND_CELL_BUCKETS ]; // sound types of all sounds in each cell bucket.
+	int		m_cCellSounds; // number of sounds in cells.
+	int		m_iMaxCellVolume[ SOUND_TYPE_BITS ]; // loudest sound of each type in cells. May be louder than the loudest sound until the next Think.
+	int		m_cMaxCellVolume[ SOUND_TYPE_BITS ]; // number of sounds of each type that are as loud as m_iMaxCellVolume.
+	int		m_afStaleMaxVolume; // sound types whose loudest sound was freed.
+
+	static Stats_t m_Stats;
 };
+
+void SoundEnt_RegisterCommands();
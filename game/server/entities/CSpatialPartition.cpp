@@ -0,0 +1,546 @@
+#include <algorithm>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CSpatialPartition.h"
+
+CSpatialPartition g_SpatialPartition;
+
+void CSpatialPartition::ResetStats()
+{
+	m_Stats = SpatialPartitionStats_t();
+	m_Grid.ResetStats();
+}
+
+void CSpatialPartition::Clear()
+{
+	m_Grid.Clear();
+	m_States.clear();
+	m_MobileEntities.clear();
+	m_bMobileSorted = true;
+	m_bDirty = true;
+	m_bFindValid = false;
+}
+
+void CSpatialPartition::RunFrame()
+{
+	m_bDirty = true;
+	m_bFindValid = false;
+}
+
+void CSpatialPartition::EntityMoved( edict_t* pEdict )
+{
+	if( !pEdict )
+		return;
+
+	++m_uiGeneration;
+
+	//The next rebuild will see it.
+	if( m_bDirty )
+		return;
+
+	const int iIndex = ENTINDEX( pEdict );
+
+	if( iIndex <= 0 || static_cast<size_t>( iIndex ) >= m_States.size() )
+		return;
+
+	if( m_States[ iIndex ] != EntityState::MOBILE )
+	{
+		m_States[ iIndex ] = EntityState::MOBILE;
+		m_MobileEntities.push_back( iIndex );
+		m_bMobileSorted = false;
+	}
+}
+
+int CSpatialPartition::EntitiesInBox( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs, const int flagMask )
+{
+	++m_Stats.ullBoxQueries;
+
+	if( !IsEnabled() )
+	{
+		++m_Stats.ullEngineQueries;
+		return EntitiesInBoxInAllEntities( pList, listMax, mins, maxs, flagMask );
+	}
+
+	const int count = EntitiesInBoxFromCandidates( pList, listMax, mins, maxs, flagMask );
+
+	if( IsValidating() )
+	{
+		m_ValidationList.resize( std::max( listMax, 1 ) );
+
+		const int allCount = EntitiesInBoxInAllEntities( m_ValidationList.data(), listMax, mins, maxs, flagMask );
+
+		if( !CompareResults( "UTIL_EntitiesInBox", pList, count, m_ValidationList.data(), allCount ) )
+		{
+			std::copy( m_ValidationList.begin(), m_ValidationList.begin() + allCount, pList );
+			return allCount;
+		}
+	}
+
+	return count;
+}
+
+int CSpatialPartition::MonstersInSphere( CBaseEntity** pList, const int listMax, const Vector& center, const float radius )
+{
+	++m_Stats.ullSphereQueries;
+
+	if( !IsEnabled() )
+	{
+		++m_Stats.ullEngineQueries;
+		return MonstersInSphereInAllEntities( pList, listMax, center, radius );
+	}
+
+	const int count = MonstersInSphereFromCandidates( pList, listMax, center, radius );
+
+	if( IsValidating() )
+	{
+		m_ValidationList.resize( std::max( listMax, 1 ) );
+
+		const int allCount = MonstersInSphereInAllEntities( m_ValidationList.data(), listMax, center, radius );
+
+		if( !CompareResults( "UTIL_MonstersInSphere", pList, count, m_ValidationList.data(), allCount ) )
+		{
+			std::copy( m_ValidationList.begin(), m_ValidationList.begin() + allCount, pList );
+			return allCount;
+		}
+	}
+
+	return count;
+}
+
+CBaseEntity* CSpatialPartition::FindEntityInSphere( CBaseEntity* pStartEntity, const Vector& vecCenter, const float flRadius )
+{
+	++m_Stats.ullFindQueries;
+
+	edict_t* pStartEdict = pStartEntity ? pStartEntity->edict() : nullptr;
+
+	edict_t* pEdict;
+
+	if( !IsEnabled() )
+	{
+		++m_Stats.ullEngineQueries;
+		pEdict = FIND_ENTITY_IN_SPHERE( pStartEdict, vecCenter, flRadius );
+	}
+	else
+	{
+		pEdict = FindEntityInSphereFromCandidates( pStartEdict, vecCenter, flRadius );
+
+		if( IsValidating() )
+		{
+			edict_t* pEngineEdict = FIND_ENTITY_IN_SPHERE( pStartEdict, vecCenter, flRadius );
+
+			if( FNullEnt( pEdict ) != FNullEnt( pEngineEdict ) || ( !FNullEnt( pEdict ) && pEdict != pEngineEdict ) )
+			{
+				++m_Stats.ullMismatches;
+
+				Alert( at_console, "Entity grid mismatch in UTIL_FindEntityInSphere after entity %d: grid found %d, engine found %d\n",
+					   pStartEdict ? ENTINDEX( pStartEdict ) : 0, !FNullEnt( pEdict ) ? ENTINDEX( pEdict ) : 0, !FNullEnt( pEngineEdict ) ? ENTINDEX( pEngineEdict ) : 0 );
+
+				pEdict = pEngineEdict;
+			}
+		}
+	}
+
+	if( !FNullEnt( pEdict ) )
+		return CBaseEntity::Instance( pEdict );
+
+	return nullptr;
+}
+
+bool CSpatialPartition::IsEnabled()
+{
+	return sv_entity_grid.value != 0;
+}
+
+bool CSpatialPartition::IsValidating()
+{
+	return sv_entity_grid.value >= 2;
+}
+
+void CSpatialPartition::Rebuild()
+{
+	++m_Stats.ullRebuilds;
+
+	m_bDirty = false;
+	m_bFindValid = false;
+	++m_uiGeneration;
+
+	m_Grid.Clear();
+	m_MobileEntities.clear();
+	m_bMobileSorted = true;
+
+	const int iMaxEntities = gpGlobals->maxEntities;
+
+	m_States.assign( std::max( iMaxEntities, 1 ), EntityState::NONE );
+
+	edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+
+	if( pEdict )
+	{
+		for( int iIndex = 1; iIndex < iMaxEntities; ++iIndex, ++pEdict )
+		{
+			if( pEdict->free )
+				continue;
+
+			if( pEdict->v.movetype == MOVETYPE_NONE && !( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) )
+			{
+				m_States[ iIndex ] = EntityState::STATIC;
+				m_Grid.Add( iIndex, pEdict->v.absmin, pEdict->v.absmax );
+			}
+			else
+			{
+				m_States[ iIndex ] = EntityState::MOBILE;
+				m_MobileEntities.push_back( iIndex );
+			}
+		}
+	}
+
+	m_Grid.Build();
+
+	m_Stats.uiStaticEntities = static_cast<unsigned int>( m_Grid.GetCount() );
+	m_Stats.uiMobileEntities = static_cast<unsigned int>( m_MobileEntities.size() );
+}
+
+void CSpatialPartition::GetCandidates( const Vector& mins, const Vector& maxs, std::vector<int>& list )
+{
+	if( m_bDirty )
+		Rebuild();
+
+	list.clear();
+
+	m_Grid.Query( mins, maxs, list );
+
+	//Entities that moved since the grid was built are in the mobile list instead.
+	list.erase( std::remove_if( list.begin(), list.end(), [ this ]( const int iIndex ) { return m_States[ iIndex ] != EntityState::STATIC; } ), list.end() );
+
+	edict_t* pBase = g_engfuncs.pfnPEntityOfEntIndex( 0 );
+
+	for( const auto iIndex : m_MobileEntities )
+	{
+		const edict_t* pEdict = pBase + iIndex;
+
+		if( !pEdict->free && BoxTouches( pEdict, mins, maxs ) )
+			list.push_back( iIndex );
+	}
+
+	std::sort( list.begin(), list.end() );
+
+	m_Stats.ullCandidates += list.size();
+}
+
+void CSpatialPartition::SortMobileEntities()
+{
+	if( m_bDirty )
+		Rebuild();
+
+	if( !m_bMobileSorted )
+	{
+		std::sort( m_MobileEntities.begin(), m_MobileEntities.end() );
+		m_bMobileSorted = true;
+	}
+}
+
+bool CSpatialPartition::BoxTouches( const edict_t* pEdict, const Vector& mins, const Vector& maxs )
+{
+	return !( mins.x > pEdict->v.absmax.x ||
+			  mins.y > pEdict->v.absmax.y ||
+			  mins.z > pEdict->v.absmax.z ||
+			  maxs.x < pEdict->v.absmin.x ||
+			  maxs.y < pEdict->v.absmin.y ||
+			  maxs.z < pEdict->v.absmin.z );
+}
+
+float CSpatialPartition::DistanceToBoxSquared( const edict_t* pEdict, const Vector& vecPoint )
+{
+	float flDistance = 0;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		float flDelta = 0;
+
+		if( vecPoint[ i ] < pEdict->v.absmin[ i ] )
+			flDelta = vecPoint[ i ] - pEdict->v.absmin[ i ];
+		else if( vecPoint[ i ] > pEdict->v.absmax[ i ] )
+			flDelta = vecPoint[ i ] - pEdict->v.absmax[ i ];
+
+		flDistance += flDelta * flDelta;
+	}
+
+	return flDistance;
+}
+
+int CSpatialPartition::EntitiesInBoxFromCandidates( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs, const int flagMask )
+{
+	GetCandidates( mins, maxs, m_Candidates );
+
+	edict_t* pBase = g_engfuncs.pfnPEntityOfEntIndex( 0 );
+
+	int count = 0;
+
+	if( !pBase )
+		return count;
+
+	//Same tests as testing every edict, in the same order.
+	for( const auto iIndex : m_Candidates )
+	{
+		edict_t* pEdict = pBase + iIndex;
+
+		if( pEdict->free )
+			continue;
+
+		if( flagMask && !( pEdict->v.flags & flagMask ) )
+			continue;
+
+		if( !BoxTouches( pEdict, mins, maxs ) )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+
+		if( !pEntity )
+			continue;
+
+		pList[ count ] = pEntity;
+		++count;
+
+		if( count >= listMax )
+			return count;
+	}
+
+	return count;
+}
+
+int CSpatialPartition::MonstersInSphereFromCandidates( CBaseEntity** pList, const int listMax, const Vector& center, const float radius )
+{
+	//Monsters and clients are never in the grid.
+	SortMobileEntities();
+
+	edict_t* pBase = g_engfuncs.pfnPEntityOfEntIndex( 0 );
+
+	int count = 0;
+
+	if( !pBase )
+		return count;
+
+	m_Stats.ullCandidates += m_MobileEntities.size();
+
+	const float radiusSquared = radius * radius;
+
+	for( const auto iIndex : m_MobileEntities )
+	{
+		edict_t* pEdict = pBase + iIndex;
+
+		if( pEdict->free )
+			continue;
+
+		if( !( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) )
+			continue;
+
+		//Same distance as UTIL_MonstersInSphere: origin for X & Y, center of the bounds for Z.
+		float delta = center.x - pEdict->v.origin.x;
+		delta *= delta;
+
+		if( delta > radiusSquared )
+			continue;
+
+		float distance = delta;
+
+		delta = center.y - pEdict->v.origin.y;
+		delta *= delta;
+
+		distance += delta;
+
+		if( distance > radiusSquared )
+			continue;
+
+		delta = center.z - ( pEdict->v.absmin.z + pEdict->v.absmax.z ) * 0.5;
+		delta *= delta;
+
+		distance += delta;
+
+		if( distance > radiusSquared )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+
+		if( !pEntity )
+			continue;
+
+		pList[ count ] = pEntity;
+		++count;
+
+		if( count >= listMax )
+			return count;
+	}
+
+	return count;
+}
+
+edict_t* CSpatialPartition::FindEntityInSphereFromCandidates( edict_t* pStartEdict, const Vector& vecCenter, const float flRadius )
+{
+	if( m_bDirty )
+		Rebuild();
+
+	//Callers usually search the same sphere until nothing is left.
+	if( m_bFindValid && m_uiFindGeneration == m_uiGeneration && m_vecFindCenter == vecCenter && m_flFindRadius == flRadius )
+	{
+		++m_Stats.ullFindCacheHits;
+	}
+	else
+	{
+		//The engine tests the distance from the center to the entity's absmin and absmax box, so any box that passes touches this one.
+		const Vector vecExtents( flRadius + 1, flRadius + 1, flRadius + 1 );
+
+		GetCandidates( vecCenter - vecExtents, vecCenter + vecExtents, m_FindCandidates );
+
+		m_bFindValid = true;
+		m_uiFindGeneration = m_uiGeneration;
+		m_vecFindCenter = vecCenter;
+		m_flFindRadius = flRadius;
+	}
+
+	edict_t* pBase = g_engfuncs.pfnPEntityOfEntIndex( 0 );
+
+	if( !pBase )
+		return nullptr;
+
+	const int iStart = pStartEdict ? ENTINDEX( pStartEdict ) : 0;
+
+	//Slightly larger than the engine's test, so rounding can't lose entities.
+	const float flTestRadiusSquared = ( flRadius + 1 ) * ( flRadius + 1 );
+
+	for( auto it = std::upper_bound( m_FindCandidates.begin(), m_FindCandidates.end(), iStart ); it != m_FindCandidates.end(); ++it )
+	{
+		const edict_t* pEdict = pBase + *it;
+
+		if( pEdict->free )
+			continue;
+
+		if( DistanceToBoxSquared( pEdict, vecCenter ) > flTestRadiusSquared )
+			continue;
+
+		//Let the engine make the final test, starting at this entity.
+		return FIND_ENTITY_IN_SPHERE( pBase + ( *it - 1 ), vecCenter, flRadius );
+	}
+
+	return nullptr;
+}
+
+int CSpatialPartition::EntitiesInBoxInAllEntities( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs, const int flagMask )
+{
+	edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+
+	int count = 0;
+
+	if( !pEdict )
+		return count;
+
+	for( int i = 1; i < gpGlobals->maxEntities; ++i, ++pEdict )
+	{
+		if( pEdict->free )	// Not in use
+			continue;
+
+		if( flagMask && !( pEdict->v.flags & flagMask ) )	// Does it meet the criteria?
+			continue;
+
+		if( !BoxTouches( pEdict, mins, maxs ) )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+
+		if( !pEntity )
+			continue;
+
+		pList[ count ] = pEntity;
+		++count;
+
+		if( count >= listMax )
+			return count;
+	}
+
+	return count;
+}
+
+int CSpatialPartition::MonstersInSphereInAllEntities( CBaseEntity** pList, const int listMax, const Vector& center, const float radius )
+{
+	edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+
+	int count = 0;
+
+	if( !pEdict )
+		return count;
+
+	const float radiusSquared = radius * radius;
+
+	for( int i = 1; i < gpGlobals->maxEntities; ++i, ++pEdict )
+	{
+		if( pEdict->free )	// Not in use
+			continue;
+
+		if( !( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) )	// Not a client/monster ?
+			continue;
+
+		// Use origin for X & Y since they are centered for all monsters
+		// Now X
+		float delta = center.x - pEdict->v.origin.x;
+		delta *= delta;
+
+		if( delta > radiusSquared )
+			continue;
+
+		float distance = delta;
+
+		// Now Y
+		delta = center.y - pEdict->v.origin.y;
+		delta *= delta;
+
+		distance += delta;
+
+		if( distance > radiusSquared )
+			continue;
+
+		// Now Z
+		delta = center.z - ( pEdict->v.absmin.z + pEdict->v.absmax.z ) * 0.5;
+		delta *= delta;
+
+		distance += delta;
+
+		if( distance > radiusSquared )
+			continue;
+
+		CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+
+		if( !pEntity )
+			continue;
+
+		pList[ count ] = pEntity;
+		++count;
+
+		if( count >= listMax )
+			return count;
+	}
+
+	return count;
+}
+
+bool CSpatialPartition::CompareResults( const char* const pszQuery, CBaseEntity* const* pList, const int count, CBaseEntity* const* pOtherList, const int otherCount )
+{
+	if( count == otherCount && std::equal( pList, pList + count, pOtherList ) )
+		return true;
+
+	++m_Stats.ullMismatches;
+
+	int iFirst = 0;
+
+	while( iFirst < count && iFirst < otherCount && pList[ iFirst ] == pOtherList[ iFirst ] )
+		++iFirst;
+
+	Alert( at_console, "Entity grid mismatch in %s: grid found %d entities, engine found %d; first difference at %d: grid %d, engine %d\n",
+		   pszQuery, count, otherCount, iFirst,
+		   iFirst < count ? pList[ iFirst ]->entindex() : 0, iFirst < otherCount ? pOtherList[ iFirst ]->entindex() : 0 );
+
+	return false;
+}
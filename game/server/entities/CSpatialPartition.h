@@ -0,0 +1,173 @@
+#ifndef GAME_SERVER_ENTITIES_CSPATIALPARTITION_H
+#define GAME_SERVER_ENTITIES_CSPATIALPARTITION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "CLooseGrid.h"
+
+class CBaseEntity;
+
+/**
+*	Spatial partition statistics.
+*/
+struct SpatialPartitionStats_t
+{
+	unsigned long long ullRebuilds = 0;
+
+	unsigned long long ullBoxQueries = 0;
+	unsigned long long ullSphereQueries = 0;
+	unsigned long long ullFindQueries = 0;
+
+	//Queries that searched all entities, because the partition is disabled.
+	unsigned long long ullEngineQueries = 0;
+
+	//Entities whose bounds were tested by queries that used the partition.
+	unsigned long long ullCandidates = 0;
+
+	//UTIL_FindEntityInSphere calls that reused the candidates of the previous call.
+	unsigned long long ullFindCacheHits = 0;
+
+	//Queries whose result differed from a search of all entities, when sv_entity_grid is 2.
+	unsigned long long ullMismatches = 0;
+
+	//Entities that were put in the grid and the mobile list by the last rebuild.
+	unsigned int uiStaticEntities = 0;
+	unsigned int uiMobileEntities = 0;
+};
+
+/**
+*	Finds entities by position for UTIL_EntitiesInBox, UTIL_MonstersInSphere and UTIL_FindEntityInSphere without testing every edict.
+*	Entities that can't move on their own (MOVETYPE_NONE, and not a monster or client) are put in a loose grid by their absmin and absmax.
+*	All other entities are kept in a list that queries test one by one.
+*	Both are rebuilt on the first query of every frame. The engine asks the game for an entity's absmin and absmax whenever it links it,
+*	so entities that are created or moved later in the frame are moved to the list, and the grid never holds bounds that are out of date.
+*	Results are the same as testing every edict, in the same order.
+*	Controlled by sv_entity_grid: 0 tests every edict, 1 uses the partition, 2 uses the partition and compares the results with testing every edict.
+*/
+class CSpatialPartition final
+{
+public:
+	CSpatialPartition() = default;
+
+	const SpatialPartitionStats_t& GetStats() const { return m_Stats; }
+
+	const CLooseGrid& GetGrid() const { return m_Grid; }
+
+	void ResetStats();
+
+	/**
+	*	Forgets all entities. Called when the world is created.
+	*/
+	void Clear();
+
+	/**
+	*	Marks the partition as out of date. Called at the start of every frame.
+	*/
+	void RunFrame();
+
+	/**
+	*	Called when an entity's instance has been created, and when the engine links it. Its bounds may have changed.
+	*/
+	void EntityMoved( edict_t* pEdict );
+
+	/**
+	*	@copydoc UTIL_EntitiesInBox
+	*/
+	int EntitiesInBox( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs, const int flagMask );
+
+	/**
+	*	@copydoc UTIL_MonstersInSphere
+	*/
+	int MonstersInSphere( CBaseEntity** pList, const int listMax, const Vector& center, const float radius );
+
+	/**
+	*	@copydoc UTIL_FindEntityInSphere
+	*/
+	CBaseEntity* FindEntityInSphere( CBaseEntity* pStartEntity, const Vector& vecCenter, const float flRadius );
+
+private:
+	enum class EntityState : unsigned char
+	{
+		NONE = 0,
+		STATIC,
+		MOBILE
+	};
+
+	static bool IsEnabled();
+
+	static bool IsValidating();
+
+	void Rebuild();
+
+	/**
+	*	Gets the indices of all entities whose bounds may touch the given box, sorted.
+	*/
+	void GetCandidates( const Vector& mins, const Vector& maxs, std::vector<int>& list );
+
+	/**
+	*	Sorts the mobile list if entities were added to it after the last rebuild.
+	*/
+	void SortMobileEntities();
+
+	/**
+	*	@return Whether the given entity's bounds touch the given box.
+	*/
+	static bool BoxTouches( const edict_t* pEdict, const Vector& mins, const Vector& maxs );
+
+	/**
+	*	@return Squared distance from the given point to the entity's bounds, 0 if the point is inside. Same test as the engine's FindEntityInSphere.
+	*/
+	static float DistanceToBoxSquared( const edict_t* pEdict, const Vector& vecPoint );
+
+	int EntitiesInBoxFromCandidates( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs, const int flagMask );
+
+	int MonstersInSphereFromCandidates( CBaseEntity** pList, const int listMax, const Vector& center, const float radius );
+
+	edict_t* FindEntityInSphereFromCandidates( edict_t* pStartEdict, const Vector& vecCenter, const float flRadius );
+
+	static int EntitiesInBoxInAllEntities( CBaseEntity** pList, const int listMax, const Vector& mins, const Vector& maxs, const int flagMask );
+
+	static int MonstersInSphereInAllEntities( CBaseEntity** pList, const int listMax, const Vector& center, const float radius );
+
+	/**
+	*	@return Whether both lists have the same entities in the same order. Logs the difference if not.
+	*/
+	bool CompareResults( const char* const pszQuery, CBaseEntity* const* pList, const int count, CBaseEntity* const* pOtherList, const int otherCount );
+
+private:
+	CLooseGrid m_Grid;
+
+	//State of each entity, by entity index.
+	std::vector<EntityState> m_States;
+
+	//Entities that can move on their own, and entities that were moved since the last rebuild. May hold freed entities.
+	std::vector<int> m_MobileEntities;
+	bool m_bMobileSorted = true;
+
+	bool m_bDirty = true;
+
+	//Incremented when entities may have moved. Candidates of a previous query are only valid for the same generation.
+	unsigned int m_uiGeneration = 0;
+
+	std::vector<int> m_Candidates;
+
+	//Candidates of the last UTIL_FindEntityInSphere query, which is usually called in a loop with the same sphere.
+	std::vector<int> m_FindCandidates;
+	Vector m_vecFindCenter;
+	float m_flFindRadius = 0;
+	unsigned int m_uiFindGeneration = 0;
+	bool m_bFindValid = false;
+
+	std::vector<CBaseEntity*> m_ValidationList;
+
+	SpatialPartitionStats_t m_Stats;
+
+private:
+	CSpatialPartition( const CSpatialPartition& ) = delete;
+	CSpatialPartition& operator=( const CSpatialPartition& ) = delete;
+};
+
+extern CSpatialPartition g_SpatialPartition;
+
+#endif //GAME_SERVER_ENTITIES_CSPATIALPARTITION_H
@@ -33,6 +33,10 @@ precaches and defs for entities and other data that must always be available.
 #include "Decals.h"
 
 #include "CMap.h"
+#include "CAnimationIndex.h"
+
+#include "CEntityNameIndex.h"
+#include "CSpatialPartition.h"
 
 #if USE_ANGELSCRIPT
 #include "Angelscript/CHLASServerManager.h"
@@ -71,6 +75,11 @@ void CWorld::OnCreate()
 
 	m_pInstance = this;
 
+	//Entities from the last map are all gone by now.
+	g_ClassnameIndex.Clear();
+	g_TargetnameIndex.Clear();
+	g_SpatialPartition.Clear();
+
 	//Due to how save/restore works, we can't just move all of this stuff over to CMap.
 	//Only data that must be available before any entities are created should be moved over to CMap. - Solokiller
 }
@@ -100,6 +109,9 @@ void CWorld::OnDestroy()
 
 	//TODO: this might not be the best place to put the pool clear call - Solokiller
 	g_StringPool.Clear();
+
+	//Models are freed when the map changes.
+	g_AnimationIndexCache.Clear();
 }
 
 void CWorld::Spawn()
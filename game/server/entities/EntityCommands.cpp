@@ -0,0 +1,68 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CEntityNameIndex.h"
+#include "CSpatialPartition.h"
+
+#include "EntityCommands.h"
+
+namespace
+{
+void PrintNameIndexStats( CEntityNameIndex& index )
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		index.ResetStats();
+		Alert( at_console, "Entity %s index statistics reset\n", index.GetKeyword() );
+		return;
+	}
+
+	const auto& stats = index.GetStats();
+
+	Alert( at_console, "Entity %s index (%s is %d): %u entities with %u names\n",
+		   index.GetKeyword(), index.GetCvar().pszName, static_cast<int>( index.GetCvar().value ),
+		   static_cast<unsigned int>( index.GetEntityCount() ), static_cast<unsigned int>( index.GetNameCount() ) );
+	Alert( at_console, "%llu queries, %llu searched all entities, %llu stale entries skipped, %llu mismatches\n",
+		   stats.ullQueries, stats.ullEngineQueries, stats.ullStaleEntries, stats.ullMismatches );
+}
+}
+
+void ServerCommand_EntTargetnameStats()
+{
+	PrintNameIndexStats( g_TargetnameIndex );
+}
+
+void ServerCommand_EntClassnameStats()
+{
+	PrintNameIndexStats( g_ClassnameIndex );
+}
+
+void ServerCommand_EntGridStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_SpatialPartition.ResetStats();
+		Alert( at_console, "Entity grid statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = g_SpatialPartition.GetStats();
+	const auto& gridStats = g_SpatialPartition.GetGrid().GetStats();
+
+	Alert( at_console, "Entity grid (sv_entity_grid is %d): %u static entities, %u mobile entities, %llu rebuilds\n",
+		   static_cast<int>( sv_entity_grid.value ), stats.uiStaticEntities, stats.uiMobileEntities, stats.ullRebuilds );
+	Alert( at_console, "%llu box queries, %llu monster sphere queries, %llu find in sphere queries (%llu reused candidates)\n",
+		   stats.ullBoxQueries, stats.ullSphereQueries, stats.ullFindQueries, stats.ullFindCacheHits );
+	Alert( at_console, "%llu searched all entities, %llu candidates tested, %llu grid box tests, %llu grid queries tested every box, %llu mismatches\n",
+		   stats.ullEngineQueries, stats.ullCandidates, gridStats.ullBoxTests, gridStats.ullLinearQueries, stats.ullMismatches );
+}
+
+void Entity_RegisterCommands()
+{
+	g_engfuncs.pfnAddServerCommand( "ent_targetnamestats", &::ServerCommand_EntTargetnameStats );
+	g_engfuncs.pfnAddServerCommand( "ent_classnamestats", &::ServerCommand_EntClassnameStats );
+	g_engfuncs.pfnAddServerCommand( "ent_gridstats", &::ServerCommand_EntGridStats );
+}
@@ -0,0 +1,9 @@
+#ifndef GAME_SERVER_ENTITIES_ENTITYCOMMANDS_H
+#define GAME_SERVER_ENTITIES_ENTITYCOMMANDS_H
+
+/**
+*	Registers the entity lookup server commands.
+*/
+void Entity_RegisterCommands();
+
+#endif //GAME_SERVER_ENTITIES_ENTITYCOMMANDS_H
@@ -36,7 +36,7 @@ LINK_ENTITY_TO_CLASS( bmortar, CBMortar );
 void CBMortar::Spawn( void )
 {
 	pev->movetype = MOVETYPE_TOSS;
-	pev->classname = MAKE_STRING( "bmortar" );
+	SetClassname( "bmortar" );
 
 	pev->solid = SOLID_BBOX;
 	pev->rendermode = kRenderTransAlpha;
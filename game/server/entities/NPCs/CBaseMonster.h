@@ -16,6 +16,8 @@
 #define GAME_SERVER_ENTITIES_NPCS_BASEMONSTER_H
 
 #include "Monsters.h"
+#include "nodes/CPathRequestQueue.h"
+#include "ai/CAILevelOfDetail.h"
 
 #define	ROUTE_SIZE			8 // how many waypoints a monster can store at one time
 #define MAX_OLD_ENEMIES		4 // how many old enemies to remember
@@ -189,6 +191,15 @@ public:
 		Schedule_t			*m_pSchedule;
 		size_t				m_iScheduleIndex;
 
+		PathRequestId		m_PathRequest;			// path search queued by the current task, if any
+		bool				m_fCanQueuePath;		// FGetNodeRoute may queue its search. Only set while a task is starting for the first time.
+
+		AILOD				m_AILOD;				// how much thinking the monster did on its last think
+
+		float				m_flThinkPhase;			// offset of this monster's thinks within the think interval, so monsters don't all think in the same frame
+		bool				m_fThinkPhaseSet;
+		int					m_cDeferredThinks;		// number of frames in a row that this monster's think was put off because the AI budget was spent
+
 		WayPoint_t			m_Route[ ROUTE_SIZE ];	// Positions of movement
 		int					m_movementGoal;			// Goal that defines route
 		int					m_iRouteIndex;			// index into m_Route[]
@@ -198,6 +209,7 @@ public:
 		Activity			m_movementActivity;	// When moving, set this activity
 
 		int					m_iAudibleList; // first index of a linked list of sounds that the monster can hear.
+		int					m_iAudibleScents; // first scent in m_iAudibleList. Scents are linked after the sounds.
 		int					m_afSoundTypes;
 
 		Vector				m_vecLastPosition;// monster sometimes wants to return to where it started after an operation.
@@ -340,6 +352,8 @@ public:
 		bool PopEnemy();
 
 		bool FGetNodeRoute( const Vector& vecDest );
+		bool IsWaitingForPath() const;
+		void ReleasePathRequest();
 		
 		inline void TaskComplete( void ) { if ( !HasConditions(bits_COND_TASK_FAILED) ) m_iTaskStatus = TASKSTATUS_COMPLETE; }
 		void MovementComplete( void );
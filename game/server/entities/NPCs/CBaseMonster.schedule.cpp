@@ -24,7 +24,10 @@
 #include "entities/NPCs/scripted/Scripted.h"
 #include "nodes/Nodes.h"
 #include "entities/NPCs/DefaultAI.h"
+#include "entities/NPCs/CScheduleRegistry.h"
 #include "entities/CSoundEnt.h"
+#include "Server.h"
+#include "ai/CAIProfiler.h"
 
 extern CGraph WorldGraph;
 
@@ -48,6 +51,7 @@ bool CBaseMonster::FHaveSchedule() const
 //=========================================================
 void CBaseMonster :: ClearSchedule( void )
 {
+	ReleasePathRequest();
 	m_iTaskStatus = TASKSTATUS_NEW;
 	m_pSchedule = NULL;
 	m_iScheduleIndex = 0;
@@ -78,6 +82,8 @@ void CBaseMonster :: ChangeSchedule ( Schedule_t *pNewSchedule )
 {
 	ASSERT( pNewSchedule != NULL );
 
+	ReleasePathRequest();
+
 	m_pSchedule			= pNewSchedule;
 	m_iScheduleIndex	= 0;
 	m_iTaskStatus		= TASKSTATUS_NEW;
@@ -93,12 +99,14 @@ void CBaseMonster :: ChangeSchedule ( Schedule_t *pNewSchedule )
 		ALERT ( at_aiconsole, "Sound mask without COND_HEAR_SOUND!\n" );
 	}
 
-#if _DEBUG
-	if ( !ScheduleFromName( pNewSchedule->pName ) )
+	//Tables are checked when they're built, so only schedules returned from outside the class's list are caught here.
+	if( const CScheduleTable* pTable = GetSchedulesList()->pTable )
 	{
-		ALERT( at_console, "Schedule %s not in table!!!\n", pNewSchedule->pName );
+		if ( !pTable->Contains( pNewSchedule ) )
+		{
+			ALERT( at_console, "Schedule %s not in table!!!\n", pNewSchedule->pName );
+		}
 	}
-#endif
 	
 // this is very useful code if you can isolate a test case in a level with a single monster. It will notify
 // you of every schedule selection the monster makes.
@@ -210,6 +218,8 @@ void CBaseMonster :: MaintainSchedule ( void )
 	Schedule_t	*pNewSchedule;
 	int			i;
 
+	CAIProfileScope scope( this, AIProfileCategory::MAINTAIN_SCHEDULE, ( m_pSchedule && m_pSchedule->pName ) ? m_pSchedule->pName : "None" );
+
 	// UNDONE: Tune/fix this 10... This is just here so infinite loops are impossible
 	for ( i = 0; i < 10; i++ )
 	{
@@ -265,12 +275,42 @@ void CBaseMonster :: MaintainSchedule ( void )
 			}
 		}
 
+		bool fRestartingTask = false;
+
+		if ( m_iTaskStatus == TASKSTATUS_WAITING_FOR_PATH && g_PathRequestQueue.GetState( m_PathRequest ) != PathRequestState::PENDING )
+		{
+			// the queued path search is done, start the task again so it picks up the result.
+			m_iTaskStatus = TASKSTATUS_NEW;
+			fRestartingTask = true;
+		}
+
 		if ( m_iTaskStatus == TASKSTATUS_NEW )
 		{	
 			const Task_t* pTask = GetTask();
 			ASSERT( pTask != nullptr );
 			TaskBegin();
-			StartTask( pTask );
+
+			// only the first start may queue a search, so restarted tasks always make progress.
+			m_fCanQueuePath = !fRestartingTask && sv_nodegraph_async.value != 0;
+
+			{
+				CAIProfileScope taskScope( this, AIProfileCategory::START_TASK, pTask->iTask );
+				StartTask( pTask );
+			}
+
+			if ( IsWaitingForPath() )
+			{
+				// the task failed only because its path search was queued, so wait for it instead.
+				ClearConditions( bits_COND_TASK_FAILED );
+				RouteClear();
+				m_iTaskStatus = TASKSTATUS_WAITING_FOR_PATH;
+			}
+			else
+			{
+				ReleasePathRequest();
+			}
+
+			m_fCanQueuePath = false;
 		}
 
 		// UNDONE: Twice?!!!
@@ -287,6 +327,7 @@ void CBaseMonster :: MaintainSchedule ( void )
 	{
 		const Task_t* pTask = GetTask();
 		ASSERT( pTask != nullptr );
+		CAIProfileScope taskScope( this, AIProfileCategory::RUN_TASK, pTask->iTask );
 		RunTask( pTask );
 	}
 
@@ -25,6 +25,7 @@
 #include "animation.h"
 #include "SaveRestore.h"
 #include "entities/CSoundEnt.h"
+#include "ai/CAIProfiler.h"
 
 //=========================================================
 // SetState
@@ -80,10 +81,18 @@ void CBaseMonster :: RunAI ( void )
 		// things will happen before the player gets there!
 		// UPDATE: We now let COMBAT state monsters think and act fully outside of player PVS. This allows the player to leave 
 		// an area where monsters are fighting, and the fight will continue.
-		if ( UTIL_FindClientInPVS( this ) || ( m_MonsterState == MONSTERSTATE_COMBAT ) )
+		// Dormant monsters are out of every player's PVS and not in combat, so they don't need to either.
+		if ( m_AILOD != AILOD::DORMANT && ( UTIL_FindClientInPVS( this ) || ( m_MonsterState == MONSTERSTATE_COMBAT ) ) )
 		{
-			Look( m_flDistLook );
-			Listen();// check for audible sounds. 
+			{
+				CAIProfileScope scope( this, AIProfileCategory::LOOK );
+				Look( m_flDistLook );
+			}
+
+			{
+				CAIProfileScope scope( this, AIProfileCategory::LISTEN );
+				Listen();// check for audible sounds. 
+			}
 
 			// now filter conditions.
 			ClearConditions( IgnoreConditions() );
@@ -94,6 +103,7 @@ void CBaseMonster :: RunAI ( void )
 		// do these calculations if monster has an enemy.
 		if ( m_hEnemy != NULL )
 		{
+			CAIProfileScope scope( this, AIProfileCategory::CHECK_ENEMY );
 			CheckEnemy( m_hEnemy );
 		}
 
@@ -0,0 +1,271 @@
+#include <cmath>
+
+#include "FlockConstants.h"
+
+#include "CFlockSimulator.h"
+
+const size_t CFlockSimulator::GRID_MIN_MEMBERS;
+
+namespace
+{
+/**
+*	Normalizes a vector the same way Vector::Normalize does; zero length vectors point up.
+*/
+void NormalizeVector( float& x, float& y, float& z )
+{
+	const float flLength = std::sqrt( x * x + y * y + z * z );
+
+	if( flLength == 0 )
+	{
+		x = y = 0;
+		z = 1;
+		return;
+	}
+
+	const float flInvLength = 1 / flLength;
+
+	x *= flInvLength;
+	y *= flInvLength;
+	z *= flInvLength;
+}
+}
+
+void CFlockSimulator::ResetStats()
+{
+	m_Stats = FlockSimulatorStats_t();
+}
+
+void CFlockSimulator::SetMemberCount( const size_t uiCount )
+{
+	m_X.resize( uiCount );
+	m_Y.resize( uiCount );
+	m_Z.resize( uiCount );
+	m_VelX.resize( uiCount );
+	m_VelY.resize( uiCount );
+	m_VelZ.resize( uiCount );
+	m_Speed.resize( uiCount );
+	m_GoalSpeed.resize( uiCount );
+}
+
+void CFlockSimulator::SetMember( const size_t uiIndex, const float* vecOrigin, const float* vecVelocity, const float flSpeed, const float flGoalSpeed )
+{
+	m_X[ uiIndex ] = vecOrigin[ 0 ];
+	m_Y[ uiIndex ] = vecOrigin[ 1 ];
+	m_Z[ uiIndex ] = vecOrigin[ 2 ];
+	m_VelX[ uiIndex ] = vecVelocity[ 0 ];
+	m_VelY[ uiIndex ] = vecVelocity[ 1 ];
+	m_VelZ[ uiIndex ] = vecVelocity[ 2 ];
+	m_Speed[ uiIndex ] = flSpeed;
+	m_GoalSpeed[ uiIndex ] = flGoalSpeed;
+}
+
+void CFlockSimulator::GetMember( const size_t uiIndex, float* vecVelocity, float& flSpeed, float& flGoalSpeed ) const
+{
+	vecVelocity[ 0 ] = m_VelX[ uiIndex ];
+	vecVelocity[ 1 ] = m_VelY[ uiIndex ];
+	vecVelocity[ 2 ] = m_VelZ[ uiIndex ];
+	flSpeed = m_Speed[ uiIndex ];
+	flGoalSpeed = m_GoalSpeed[ uiIndex ];
+}
+
+void CFlockSimulator::UpdateFollowers( const float* vecLeaderForward, const float flFieldOfView, const FlockNeighborSearch search )
+{
+	const size_t uiCount = GetMemberCount();
+
+	if( uiCount < 2 )
+		return;
+
+	++m_Stats.ullUpdates;
+	m_Stats.ullFollowers += uiCount - 1;
+
+	const bool bUseGrid = search == FlockNeighborSearch::GRID || ( search == FlockNeighborSearch::AUTO && uiCount >= GRID_MIN_MEMBERS );
+
+	if( bUseGrid )
+		BuildGrid();
+
+	const float flLeaderSpeed = std::sqrt( m_VelX[ 0 ] * m_VelX[ 0 ] + m_VelY[ 0 ] * m_VelY[ 0 ] + m_VelZ[ 0 ] * m_VelZ[ 0 ] );
+
+	//Followers use the leader's velocity as it was before any of them were moved, so the order doesn't matter.
+	for( size_t uiIndex = 1; uiIndex < uiCount; ++uiIndex )
+	{
+		float flDirToLeaderX = m_X[ 0 ] - m_X[ uiIndex ];
+		float flDirToLeaderY = m_Y[ 0 ] - m_Y[ uiIndex ];
+		float flDirToLeaderZ = m_Z[ 0 ] - m_Z[ uiIndex ];
+
+		const float flDistToLeader = std::sqrt( flDirToLeaderX * flDirToLeaderX + flDirToLeaderY * flDirToLeaderY + flDirToLeaderZ * flDirToLeaderZ );
+
+		float& flGoalSpeed = m_GoalSpeed[ uiIndex ];
+
+		//Same as FInViewCone, with the follower facing the same way as the leader.
+		const float flDist2D = std::sqrt( flDirToLeaderX * flDirToLeaderX + flDirToLeaderY * flDirToLeaderY );
+
+		const float flDot = flDist2D != 0 ? ( flDirToLeaderX * vecLeaderForward[ 0 ] + flDirToLeaderY * vecLeaderForward[ 1 ] ) / flDist2D : 0;
+
+		if( flDot > flFieldOfView )
+		{
+			// if we're too far away, speed up
+			if( flDistToLeader > AFLOCK_TOO_FAR )
+				flGoalSpeed = flLeaderSpeed * 1.5;
+			// if we're too close, slow down
+			else if( flDistToLeader < AFLOCK_TOO_CLOSE )
+				flGoalSpeed = flLeaderSpeed * 0.5;
+		}
+		else
+		{
+			// wait up! the leader isn't out in front, so we slow down to let him pass
+			flGoalSpeed = flLeaderSpeed * 0.5;
+		}
+
+		SpreadMember( uiIndex, bUseGrid );
+
+		float& flVelX = m_VelX[ uiIndex ];
+		float& flVelY = m_VelY[ uiIndex ];
+		float& flVelZ = m_VelZ[ uiIndex ];
+
+		float& flSpeed = m_Speed[ uiIndex ];
+
+		flSpeed = std::sqrt( flVelX * flVelX + flVelY * flVelY + flVelZ * flVelZ );
+		NormalizeVector( flVelX, flVelY, flVelZ );
+
+		// if we are too far from leader, average a vector towards it into our current velocity
+		if( flDistToLeader > AFLOCK_TOO_FAR )
+		{
+			NormalizeVector( flDirToLeaderX, flDirToLeaderY, flDirToLeaderZ );
+
+			flVelX = ( flVelX + flDirToLeaderX ) * 0.5;
+			flVelY = ( flVelY + flDirToLeaderY ) * 0.5;
+			flVelZ = ( flVelZ + flDirToLeaderZ ) * 0.5;
+		}
+
+		// clamp speeds and handle acceleration
+		if( flGoalSpeed > AFLOCK_FLY_SPEED * 2 )
+			flGoalSpeed = AFLOCK_FLY_SPEED * 2;
+
+		if( flSpeed < flGoalSpeed )
+			flSpeed += AFLOCK_ACCELERATE;
+		else if( flSpeed > flGoalSpeed )
+			flSpeed -= AFLOCK_ACCELERATE;
+
+		flVelX *= flSpeed;
+		flVelY *= flSpeed;
+		flVelZ *= flSpeed;
+	}
+}
+
+void CFlockSimulator::BuildGrid()
+{
+	const size_t uiCount = GetMemberCount();
+
+	//At least twice as many buckets as members keeps most columns in their own bucket.
+	size_t uiBuckets = 16;
+
+	while( uiBuckets < uiCount * 2 )
+		uiBuckets *= 2;
+
+	m_CellX.resize( uiCount );
+	m_CellY.resize( uiCount );
+	m_SortedMembers.resize( uiCount );
+
+	m_BucketStart.assign( uiBuckets + 1, 0 );
+
+	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+	{
+		m_CellX[ uiIndex ] = static_cast<int>( std::floor( m_X[ uiIndex ] / AFLOCK_TOO_CLOSE ) );
+		m_CellY[ uiIndex ] = static_cast<int>( std::floor( m_Y[ uiIndex ] / AFLOCK_TOO_CLOSE ) );
+
+		++m_BucketStart[ GetBucket( m_CellX[ uiIndex ], m_CellY[ uiIndex ] ) + 1 ];
+	}
+
+	for( size_t uiBucket = 0; uiBucket < uiBuckets; ++uiBucket )
+		m_BucketStart[ uiBucket + 1 ] += m_BucketStart[ uiBucket ];
+
+	//Counting sort; members stay in index order within a bucket.
+	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+	{
+		const size_t uiBucket = GetBucket( m_CellX[ uiIndex ], m_CellY[ uiIndex ] );
+
+		m_SortedMembers[ m_BucketStart[ uiBucket ]++ ] = uiIndex;
+	}
+
+	//Filling the buckets moved each start to the next bucket's start.
+	for( size_t uiBucket = uiBuckets; uiBucket > 0; --uiBucket )
+		m_BucketStart[ uiBucket ] = m_BucketStart[ uiBucket - 1 ];
+
+	m_BucketStart[ 0 ] = 0;
+}
+
+void CFlockSimulator::SpreadMember( const size_t uiIndex, const bool bUseGrid )
+{
+	const float flTooCloseSquared = static_cast<float>( AFLOCK_TOO_CLOSE ) * AFLOCK_TOO_CLOSE;
+
+	const float flX = m_X[ uiIndex ];
+	const float flY = m_Y[ uiIndex ];
+	const float flZ = m_Z[ uiIndex ];
+
+	float flVelX = m_VelX[ uiIndex ];
+	float flVelY = m_VelY[ uiIndex ];
+	float flVelZ = m_VelZ[ uiIndex ];
+
+	unsigned long long ullPairTests = 0;
+
+	auto spread = [ & ]( const size_t uiOther )
+	{
+		if( uiOther == uiIndex )
+			return;
+
+		++ullPairTests;
+
+		float flDirX = flX - m_X[ uiOther ];
+		float flDirY = flY - m_Y[ uiOther ];
+		float flDirZ = flZ - m_Z[ uiOther ];
+
+		if( flDirX * flDirX + flDirY * flDirY + flDirZ * flDirZ > flTooCloseSquared )
+			return;
+
+		NormalizeVector( flDirX, flDirY, flDirZ );
+
+		flVelX += flDirX;
+		flVelY += flDirY;
+		flVelZ += flDirZ;
+	};
+
+	if( bUseGrid )
+	{
+		//Members within AFLOCK_TOO_CLOSE are at most one column away. Columns can share a bucket, so only members of the column being searched are used.
+		for( int iX = m_CellX[ uiIndex ] - 1; iX <= m_CellX[ uiIndex ] + 1; ++iX )
+		{
+			for( int iY = m_CellY[ uiIndex ] - 1; iY <= m_CellY[ uiIndex ] + 1; ++iY )
+			{
+				const size_t uiBucket = GetBucket( iX, iY );
+
+				for( size_t uiMember = m_BucketStart[ uiBucket ]; uiMember < m_BucketStart[ uiBucket + 1 ]; ++uiMember )
+				{
+					const size_t uiOther = m_SortedMembers[ uiMember ];
+
+					if( m_CellX[ uiOther ] == iX && m_CellY[ uiOther ] == iY )
+						spread( uiOther );
+				}
+			}
+		}
+	}
+	else
+	{
+		for( size_t uiOther = 0; uiOther < GetMemberCount(); ++uiOther )
+		{
+			spread( uiOther );
+		}
+	}
+
+	m_VelX[ uiIndex ] = flVelX;
+	m_VelY[ uiIndex ] = flVelY;
+	m_VelZ[ uiIndex ] = flVelZ;
+
+	m_Stats.ullPairTests += ullPairTests;
+}
+
+size_t CFlockSimulator::GetBucket( const int iX, const int iY ) const
+{
+	const size_t uiHash = ( static_cast<unsigned int>( iX ) * 73856093u ) ^ ( static_cast<unsigned int>( iY ) * 19349663u );
+
+	return uiHash & ( m_BucketStart.size() - 2 );
+}
@@ -0,0 +1,103 @@
+#ifndef GAME_SERVER_ENTITIES_NPCS_CFLOCKSIMULATOR_H
+#define GAME_SERVER_ENTITIES_NPCS_CFLOCKSIMULATOR_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+*	How flock members find the members near them.
+*/
+enum class FlockNeighborSearch
+{
+	/**
+	*	Use the grid for large flocks, and test every pair of members in small ones.
+	*/
+	AUTO = 0,
+	PAIRS,
+	GRID
+};
+
+/**
+*	Flock simulator statistics.
+*/
+struct FlockSimulatorStats_t
+{
+	unsigned long long ullUpdates = 0;
+	unsigned long long ullFollowers = 0;
+
+	//Number of member pairs whose distance was tested when spreading the flock.
+	unsigned long long ullPairTests = 0;
+};
+
+/**
+*	Moves all followers in a flock of monster_flyer in one pass, instead of having each follower go through the entire flock.
+*	Members are stored as arrays of positions, velocities and speeds. The leader is always member 0.
+*	Members that are close enough to push each other apart are found through a grid of AFLOCK_TOO_CLOSE wide columns, so the cost
+*	grows with the number of members instead of its square. Flocks fly mostly level, so the grid is two dimensional.
+*	Doesn't use the engine, so it can be benchmarked on its own.
+*/
+class CFlockSimulator final
+{
+public:
+	/**
+	*	Smallest flock that AUTO uses the grid for. Building the grid costs more than testing every pair of members in smaller flocks.
+	*/
+	static const size_t GRID_MIN_MEMBERS = 96;
+
+public:
+	CFlockSimulator() = default;
+
+	const FlockSimulatorStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+	size_t GetMemberCount() const { return m_X.size(); }
+
+	/**
+	*	Sets the number of members. Member data is left unset.
+	*/
+	void SetMemberCount( const size_t uiCount );
+
+	void SetMember( const size_t uiIndex, const float* vecOrigin, const float* vecVelocity, const float flSpeed, const float flGoalSpeed );
+
+	void GetMember( const size_t uiIndex, float* vecVelocity, float& flSpeed, float& flGoalSpeed ) const;
+
+	/**
+	*	Updates the velocities, speeds and goal speeds of all followers, the same way CFlockingFlyer::FlockFollowerThink does.
+	*	@param vecLeaderForward Leader's forward vector. Followers face the same way as the leader.
+	*	@param flFieldOfView Followers' field of view, as a dot product.
+	*	@param search How to find nearby members. PAIRS tests every pair of members, like the original code.
+	*/
+	void UpdateFollowers( const float* vecLeaderForward, const float flFieldOfView, const FlockNeighborSearch search = FlockNeighborSearch::AUTO );
+
+private:
+	void BuildGrid();
+
+	/**
+	*	Adds the directions away from all members within AFLOCK_TOO_CLOSE of the given member to its velocity.
+	*/
+	void SpreadMember( const size_t uiIndex, const bool bUseGrid );
+
+	size_t GetBucket( const int iX, const int iY ) const;
+
+private:
+	std::vector<float> m_X, m_Y, m_Z;
+	std::vector<float> m_VelX, m_VelY, m_VelZ;
+	std::vector<float> m_Speed;
+	std::vector<float> m_GoalSpeed;
+
+	//Grid column of each member.
+	std::vector<int> m_CellX, m_CellY;
+
+	//Members sorted by bucket, and where each bucket starts. Columns are hashed into buckets.
+	std::vector<size_t> m_BucketStart;
+	std::vector<size_t> m_SortedMembers;
+
+	FlockSimulatorStats_t m_Stats;
+
+private:
+	CFlockSimulator( const CFlockSimulator& ) = delete;
+	CFlockSimulator& operator=( const CFlockSimulator& ) = delete;
+};
+
+#endif //GAME_SERVER_ENTITIES_NPCS_CFLOCKSIMULATOR_H
@@ -1,8 +1,11 @@
+#include <vector>
+
 #include "extdll.h"
 #include "util.h"
 #include "cbase.h"
 
 #include "CFlockingFlyerFlock.h"
+#include "CFlockSimulator.h"
 
 #include "CFlockingFlyer.h"
 
@@ -29,6 +32,13 @@ END_DATADESC()
 
 LINK_ENTITY_TO_CLASS( monster_flyer, CFlockingFlyer );
 
+namespace
+{
+//Shared by all flocks, so memory is reused between leaders.
+CFlockSimulator g_FlockSimulator;
+std::vector<CFlockingFlyer*> g_FlockFollowers;
+}
+
 void CFlockingFlyer::Spawn()
 {
 	Precache();
@@ -49,7 +59,7 @@ void CFlockingFlyer::Precache()
 void CFlockingFlyer::SpawnCommonCode()
 {
 	pev->deadflag = DEAD_NO;
-	pev->classname = MAKE_STRING( "monster_flyer" );
+	SetClassname( "monster_flyer" );
 	pev->solid = SOLID_SLIDEBOX;
 	pev->movetype = MOVETYPE_FLY;
 	pev->takedamage = DAMAGE_NO;
@@ -205,6 +215,8 @@ void CFlockingFlyer::FlockLeaderThink( void )
 
 		BoidAdvanceFrame();
 
+		MoveFollowers();
+
 		return;
 	}
 
@@ -273,6 +285,8 @@ void CFlockingFlyer::FlockLeaderThink( void )
 
 	BoidAdvanceFrame();
 
+	MoveFollowers();
+
 	return;
 }
 
@@ -296,6 +310,10 @@ void CFlockingFlyer::FlockFollowerThink( void )
 		return;
 	}
 
+	// the leader moves the whole flock once it's flying.
+	if( IsFollowing() )
+		return;
+
 	vecDirToLeader = ( m_pSquadLeader->GetAbsOrigin() - GetAbsOrigin() );
 	flDistToLeader = vecDirToLeader.Length();
 
@@ -357,6 +375,57 @@ void CFlockingFlyer::FlockFollowerThink( void )
 	BoidAdvanceFrame();
 }
 
+//=========================================================
+// Leader boids move all of their flying followers in one pass
+//=========================================================
+void CFlockingFlyer::MoveFollowers( void )
+{
+	g_FlockFollowers.clear();
+
+	for( CFlockingFlyer* pList = m_pSquadNext; pList; pList = pList->m_pSquadNext )
+	{
+		if( pList->IsFollowing() )
+			g_FlockFollowers.push_back( pList );
+	}
+
+	if( g_FlockFollowers.empty() )
+		return;
+
+	g_FlockSimulator.SetMemberCount( g_FlockFollowers.size() + 1 );
+
+	g_FlockSimulator.SetMember( 0, GetAbsOrigin(), pev->velocity, pev->speed, m_flGoalSpeed );
+
+	for( size_t uiIndex = 0; uiIndex < g_FlockFollowers.size(); ++uiIndex )
+	{
+		CFlockingFlyer* pFollower = g_FlockFollowers[ uiIndex ];
+
+		g_FlockSimulator.SetMember( uiIndex + 1, pFollower->GetAbsOrigin(), pFollower->pev->velocity, pFollower->pev->speed, pFollower->m_flGoalSpeed );
+	}
+
+	// followers match heading with the leader
+	UTIL_MakeVectors( pev->angles );
+
+	g_FlockSimulator.UpdateFollowers( gpGlobals->v_forward, m_flFieldOfView );
+
+	for( size_t uiIndex = 0; uiIndex < g_FlockFollowers.size(); ++uiIndex )
+	{
+		CFlockingFlyer* pFollower = g_FlockFollowers[ uiIndex ];
+
+		pFollower->pev->angles = pev->angles;
+
+		g_FlockSimulator.GetMember( uiIndex + 1, pFollower->pev->velocity, pFollower->pev->speed, pFollower->m_flGoalSpeed );
+
+		pFollower->BoidAdvanceFrame();
+	}
+}
+
+bool CFlockingFlyer::IsFollowing() const
+{
+	return InSquad() && !IsLeader() &&
+		m_pfnThink == static_cast<BASEPTR>( &CFlockingFlyer::FlockFollowerThink ) &&
+		m_pSquadLeader->m_pfnThink == static_cast<BASEPTR>( &CFlockingFlyer::FlockLeaderThink );
+}
+
 /*
 // Is this boid's course blocked?
 if ( FBoidPathBlocked (pev) )
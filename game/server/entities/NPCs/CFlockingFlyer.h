@@ -31,6 +31,7 @@ public:
 	void Start( void );
 	void FlockLeaderThink( void );
 	void FlockFollowerThink( void );
+	void MoveFollowers( void );
 	void FallHack( void );
 	void MakeSound( void );
 	void AlertFlock( void );
@@ -41,6 +42,11 @@ public:
 	bool FPathBlocked();
 	//void KeyValue( KeyValueData *pkvd );
 
+	/**
+	*	@return Whether this flyer is being moved by its leader.
+	*/
+	bool IsFollowing() const;
+
 	bool IsLeader() const { return m_pSquadLeader == this; }
 	bool InSquad() const { return m_pSquadLeader != nullptr; }
 	int	SquadCount( void );
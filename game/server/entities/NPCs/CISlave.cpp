@@ -25,6 +25,7 @@
 #include "Effects.h"
 #include "Weapons.h"
 #include "entities/CSoundEnt.h"
+#include "entities/CEntityNameIndex.h"
 
 #include "CISlave.h"
 
@@ -400,8 +401,7 @@ bool CISlave :: CheckRangeAttack2 ( float flDot, float flDist )
 	m_hDead = NULL;
 	m_iBravery = 0;
 
-	CBaseEntity *pEntity = NULL;
-	while ((pEntity = UTIL_FindEntityByClassname( pEntity, "monster_alien_slave" )) != NULL)
+	for( auto pEntity : g_ClassnameIndex.Family( "monster_alien_slave" ) )
 	{
 		TraceResult tr;
 
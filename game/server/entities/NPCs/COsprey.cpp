@@ -19,6 +19,7 @@
 #include "Weapons.h"
 #include "nodes/Nodes.h"
 #include "entities/CSoundEnt.h"
+#include "entities/CEntityNameIndex.h"
 #include "Effects.h"
 #include "customentity.h"
 
@@ -130,11 +131,12 @@ void COsprey::CommandUse( CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYP
 
 void COsprey :: FindAllThink( void )
 {
-	CBaseEntity *pEntity = NULL;
-
 	m_iUnits = 0;
-	while (m_iUnits < MAX_CARRY && (pEntity = UTIL_FindEntityByClassname( pEntity, "monster_human_grunt" )) != NULL)
+	for( auto pEntity : g_ClassnameIndex.Entities( "monster_human_grunt" ) )
 	{
+		if( m_iUnits >= MAX_CARRY )
+			break;
+
 		if (pEntity->IsAlive())
 		{
 			m_hGrunt[m_iUnits]		= pEntity;
@@ -0,0 +1,109 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+#include "Schedule.h"
+
+#include "CScheduleRegistry.h"
+
+CScheduleRegistry g_ScheduleRegistry;
+
+namespace
+{
+//Constant initialized, so lists can be added before any other static object is constructed.
+Schedules_t* g_pScheduleLists = nullptr;
+}
+
+void Schedules_Register( Schedules_t* pSchedules )
+{
+	pSchedules->pNext = g_pScheduleLists;
+	g_pScheduleLists = pSchedules;
+}
+
+const Schedule_t* CScheduleTable::FindByName( const char* const pszName ) const
+{
+	if( !pszName )
+		return nullptr;
+
+	auto it = m_Names.find( pszName );
+
+	return it != m_Names.end() ? it->second : nullptr;
+}
+
+bool CScheduleRegistry::Initialize()
+{
+	bool bValid = true;
+
+	size_t uiLists = 0;
+
+	for( Schedules_t* pSchedules = g_pScheduleLists; pSchedules; pSchedules = pSchedules->pNext )
+	{
+		//Only check a class's own schedules; base class lists are checked when their own table is built.
+		CScheduleTable::NameMap_t names;
+
+		for( size_t uiIndex = 0; uiIndex < pSchedules->uiNumSchedules; ++uiIndex )
+		{
+			const Schedule_t* pSchedule = pSchedules->ppSchedules[ uiIndex ];
+
+			if( !pSchedule )
+			{
+				ALERT( at_error, "%s: schedule %u is null!\n", pSchedules->pszClassName, static_cast<unsigned int>( uiIndex ) );
+				bValid = false;
+				continue;
+			}
+
+			if( !pSchedule->pName )
+			{
+				ALERT( at_error, "%s: schedule %u is unnamed!\n", pSchedules->pszClassName, static_cast<unsigned int>( uiIndex ) );
+				bValid = false;
+				continue;
+			}
+
+			if( !pSchedule->pTasklist || pSchedule->cTasks == 0 )
+			{
+				ALERT( at_error, "%s: schedule %s has no tasks!\n", pSchedules->pszClassName, pSchedule->pName );
+				bValid = false;
+			}
+
+			auto result = names.emplace( pSchedule->pName, pSchedule );
+
+			if( !result.second && result.first->second != pSchedule )
+			{
+				ALERT( at_error, "%s: schedule name %s is used more than once!\n", pSchedules->pszClassName, pSchedule->pName );
+				bValid = false;
+			}
+		}
+
+		if( !pSchedules->pTable )
+			pSchedules->pTable = BuildTable( pSchedules );
+
+		++uiLists;
+	}
+
+	ALERT( at_aiconsole, "Built schedule tables for %u monster classes\n", static_cast<unsigned int>( uiLists ) );
+
+	return bValid;
+}
+
+const CScheduleTable* CScheduleRegistry::BuildTable( Schedules_t* pSchedules )
+{
+	auto table = std::make_unique<CScheduleTable>();
+
+	//Walk from the class to its base classes, so the class's own schedules are added first and hide those of its base classes.
+	for( const Schedules_t* pList = pSchedules; pList; pList = pList->pBaseList )
+	{
+		for( size_t uiIndex = 0; uiIndex < pList->uiNumSchedules; ++uiIndex )
+		{
+			const Schedule_t* pSchedule = pList->ppSchedules[ uiIndex ];
+
+			if( !pSchedule || !pSchedule->pName )
+				continue;
+
+			table->m_Names.emplace( pSchedule->pName, pSchedule );
+			table->m_Schedules.insert( pSchedule );
+		}
+	}
+
+	m_Tables.emplace_back( std::move( table ) );
+
+	return m_Tables.back().get();
+}
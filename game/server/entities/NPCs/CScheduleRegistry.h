@@ -0,0 +1,79 @@
+#ifndef GAME_SERVER_ENTITIES_NPCS_CSCHEDULEREGISTRY_H
+#define GAME_SERVER_ENTITIES_NPCS_CSCHEDULEREGISTRY_H
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "StringUtils.h"
+
+struct Schedule_t;
+struct Schedules_t;
+
+/**
+*	The schedules that a monster class can use: its own and those of its base classes.
+*/
+class CScheduleTable final
+{
+public:
+	CScheduleTable() = default;
+
+	/**
+	*	@return The schedule with the given name, or null if the class has no such schedule. Names are case insensitive.
+	*	A class's own schedule hides a base class schedule with the same name.
+	*/
+	const Schedule_t* FindByName( const char* const pszName ) const;
+
+	/**
+	*	@return Whether the given schedule is in the table.
+	*/
+	bool Contains( const Schedule_t* pSchedule ) const
+	{
+		return m_Schedules.find( pSchedule ) != m_Schedules.end();
+	}
+
+	size_t GetScheduleCount() const { return m_Schedules.size(); }
+
+private:
+	friend class CScheduleRegistry;
+
+	typedef std::unordered_map<const char*, const Schedule_t*, RawCharHashI, RawCharEqualToI> NameMap_t;
+
+	NameMap_t m_Names;
+
+	std::unordered_set<const Schedule_t*> m_Schedules;
+
+private:
+	CScheduleTable( const CScheduleTable& ) = delete;
+	CScheduleTable& operator=( const CScheduleTable& ) = delete;
+};
+
+/**
+*	Builds the schedule table of every monster class that declares schedules, and checks the lists for errors.
+*/
+class CScheduleRegistry final
+{
+public:
+	CScheduleRegistry() = default;
+
+	/**
+	*	Builds the tables of all registered schedule lists. Must be called before any monster changes schedules.
+	*	@return Whether all lists are valid. Invalid entries are reported and left out of the tables.
+	*/
+	bool Initialize();
+
+private:
+	const CScheduleTable* BuildTable( Schedules_t* pSchedules );
+
+private:
+	std::vector<std::unique_ptr<CScheduleTable>> m_Tables;
+
+private:
+	CScheduleRegistry( const CScheduleRegistry& ) = delete;
+	CScheduleRegistry& operator=( const CScheduleRegistry& ) = delete;
+};
+
+extern CScheduleRegistry g_ScheduleRegistry;
+
+#endif //GAME_SERVER_ENTITIES_NPCS_CSCHEDULEREGISTRY_H
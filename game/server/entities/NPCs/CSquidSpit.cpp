@@ -32,7 +32,7 @@ LINK_ENTITY_TO_CLASS( squidspit, CSquidSpit );
 void CSquidSpit::Spawn( void )
 {
 	pev->movetype = MOVETYPE_FLY;
-	pev->classname = MAKE_STRING( "squidspit" );
+	SetClassname( "squidspit" );
 
 	pev->solid = SOLID_BBOX;
 	pev->rendermode = kRenderTransAlpha;
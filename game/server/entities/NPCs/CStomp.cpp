@@ -25,7 +25,7 @@ LINK_ENTITY_TO_CLASS( garg_stomp, CStomp );
 void CStomp::Spawn( void )
 {
 	pev->nextthink = gpGlobals->time;
-	pev->classname = MAKE_STRING( "garg_stomp" );
+	SetClassname( "garg_stomp" );
 	pev->dmgtime = gpGlobals->time;
 
 	pev->framerate = 30;
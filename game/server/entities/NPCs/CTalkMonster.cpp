@@ -12,16 +12,22 @@
 *   use or distribution of this code by or to any unlicensed person is illegal.
 *
 ****/
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include	"extdll.h"
 #include	"util.h"
 #include	"cbase.h"
 #include	"entities/NPCs/Monsters.h"
 #include	"entities/NPCs/Schedule.h"
 #include	"CTalkMonster.h"
+#include	"CTalkMonsterRegistry.h"
 #include	"DefaultAI.h"
 #include	"entities/NPCs/scripted/Scripted.h"
 #include	"entities/CSoundEnt.h"
 #include	"animation.h"
+#include	"CBasePlayer.h"
 
 //=========================================================
 // Talking monster base class
@@ -657,7 +663,7 @@ CBaseEntity	*CTalkMonster::EnumFriends( CBaseEntity *pPrevious, int listNumber,
 	Vector vecCheck;
 
 	pszFriend = m_szFriends[ FriendNumber(listNumber) ];
-	while ((pFriend = UTIL_FindEntityByClassname( pFriend, pszFriend )))
+	while ((pFriend = g_TalkMonsterRegistry.FindNext( pFriend, pszFriend )))
 	{
 		if (pFriend == this || !pFriend->IsAlive())
 			// don't talk to self or dead people
@@ -804,70 +810,85 @@ void CTalkMonster :: TalkInit( void )
 //=========================================================
 CBaseEntity* CTalkMonster::FindNearestFriend( const bool fPlayer ) const
 {
-	CBaseEntity *pFriend = NULL;
-	CBaseEntity *pNearest = NULL;
-	float range = 10000000.0;
 	TraceResult tr;
 	Vector vecStart = GetAbsOrigin();
-	Vector vecCheck;
 	int i;
 	const char* pszFriend;
-	int cfriends;
 
 	vecStart.z = pev->absmax.z;
-	
-	if (fPlayer)
-		cfriends = 1;
-	else
-		cfriends = TLK_CFRIENDS;
 
-	// for each type of friend...
+	// friends in range, in the order they're found. Only the nearest visible one matters,
+	// so they're traced from nearest to farthest.
+	std::vector<std::pair<float, CBaseEntity*>> candidates;
 
-	for (i = cfriends-1; i > -1; i--)
+	auto addCandidate = [ & ]( CBaseEntity* pFriend )
 	{
-		if (fPlayer)
-			pszFriend = "player";
-		else
-			pszFriend = m_szFriends[FriendNumber(i)];
+		if (pFriend == this || !pFriend->IsAlive())
+			// don't talk to self or dead people
+			return;
 
-		if (!pszFriend)
-			continue;
+		CBaseMonster *pMonster = pFriend->MyMonsterPointer();
 
-		// for each friend in this bsp...
-		while ((pFriend = UTIL_FindEntityByClassname( pFriend, pszFriend )))
-		{
-			if (pFriend == this || !pFriend->IsAlive())
-				// don't talk to self or dead people
-				continue;
+		// If not a monster for some reason, or in a script, or prone
+		if ( !pMonster || pMonster->m_MonsterState == MONSTERSTATE_SCRIPT || pMonster->m_MonsterState == MONSTERSTATE_PRONE )
+			return;
 
-			CBaseMonster *pMonster = pFriend->MyMonsterPointer();
+		Vector vecCheck = pFriend->GetAbsOrigin();
+		vecCheck.z = pFriend->pev->absmax.z;
 
-			// If not a monster for some reason, or in a script, or prone
-			if ( !pMonster || pMonster->m_MonsterState == MONSTERSTATE_SCRIPT || pMonster->m_MonsterState == MONSTERSTATE_PRONE )
-				continue;
+		const float flDist = (vecStart - vecCheck).Length();
 
-			vecCheck = pFriend->GetAbsOrigin();
-			vecCheck.z = pFriend->pev->absmax.z;
+		if ( flDist < TALKRANGE_MIN )
+			candidates.emplace_back( flDist, pFriend );
+	};
 
-			// if closer than previous friend, and in range, see if he's visible
+	if (fPlayer)
+	{
+		for ( i = 1; i <= gpGlobals->maxClients; i++ )
+		{
+			if ( CBaseEntity* pPlayer = UTIL_PlayerByIndex( i ) )
+				addCandidate( pPlayer );
+		}
+	}
+	else
+	{
+		// for each type of friend...
+		for (i = TLK_CFRIENDS-1; i > -1; i--)
+		{
+			pszFriend = m_szFriends[FriendNumber(i)];
 
-			if (range > (vecStart - vecCheck).Length())
-			{
-				UTIL_TraceLine(vecStart, vecCheck, ignore_monsters, ENT(pev), &tr);
+			if (!pszFriend)
+				continue;
 
-				if (tr.flFraction == 1.0)
-				{
-					// visible and in range, this is the new nearest scientist
-					if ((vecStart - vecCheck).Length() < TALKRANGE_MIN)
-					{
-						pNearest = pFriend;
-						range = (vecStart - vecCheck).Length();
-					}
-				}
+			// for each friend in this bsp...
+			for ( auto pFriend : g_TalkMonsterRegistry.GetMonsters( pszFriend ) )
+			{
+				addCandidate( pFriend );
 			}
 		}
 	}
-	return pNearest;
+
+	// the first of equally near friends wins, like it did when every friend was traced.
+	std::stable_sort( candidates.begin(), candidates.end(),
+		[]( const std::pair<float, CBaseEntity*>& lhs, const std::pair<float, CBaseEntity*>& rhs )
+		{
+			return lhs.first < rhs.first;
+		}
+	);
+
+	for ( const auto& candidate : candidates )
+	{
+		Vector vecCheck = candidate.second->GetAbsOrigin();
+		vecCheck.z = candidate.second->pev->absmax.z;
+
+		UTIL_TraceLine(vecStart, vecCheck, ignore_monsters, ENT(pev), &tr);
+
+		// visible and in range, this is the nearest scientist
+		if (tr.flFraction == 1.0)
+			return candidate.second;
+	}
+
+	return nullptr;
 }
 
 int CTalkMonster :: GetVoicePitch( void )
@@ -1462,6 +1483,20 @@ void CTalkMonster::KeyValue( KeyValueData *pkvd )
 }
 
 
+void CTalkMonster::OnCreate()
+{
+	BaseClass::OnCreate();
+
+	g_TalkMonsterRegistry.Add( this );
+}
+
+void CTalkMonster::OnDestroy()
+{
+	g_TalkMonsterRegistry.Remove( this );
+
+	BaseClass::OnDestroy();
+}
+
 void CTalkMonster::Precache( void )
 {
 	if ( m_iszUse )
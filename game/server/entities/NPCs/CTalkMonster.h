@@ -106,6 +106,9 @@ public:
 	float			TargetDistance( void );
 	void			StopTalking( void ) { SentenceStop(); }
 	
+	void			OnCreate() override;
+	void			OnDestroy() override;
+
 	// Base Monster functions
 	void			Precache( void ) override;
 	void			OnTakeDamage( const CTakeDamageInfo& info ) override;
@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CTalkMonster.h"
+
+#include "CTalkMonsterRegistry.h"
+
+CTalkMonsterRegistry g_TalkMonsterRegistry;
+
+const CTalkMonsterRegistry::MonsterList_t CTalkMonsterRegistry::m_EmptyList;
+
+void CTalkMonsterRegistry::Add( CTalkMonster* pMonster )
+{
+	m_Monsters.push_back( pMonster );
+	m_bDirty = true;
+}
+
+void CTalkMonsterRegistry::Remove( CTalkMonster* pMonster )
+{
+	auto it = std::find( m_Monsters.begin(), m_Monsters.end(), pMonster );
+
+	if( it == m_Monsters.end() )
+		return;
+
+	*it = m_Monsters.back();
+	m_Monsters.pop_back();
+
+	//The buckets may still point to the monster.
+	m_bDirty = true;
+}
+
+const CTalkMonsterRegistry::MonsterList_t& CTalkMonsterRegistry::GetMonsters( const char* const pszClassname )
+{
+	if( m_bDirty )
+		UpdateBuckets();
+
+	auto it = m_Buckets.find( pszClassname );
+
+	return it != m_Buckets.end() ? it->second : m_EmptyList;
+}
+
+CTalkMonster* CTalkMonsterRegistry::FindNext( CBaseEntity* pPrevious, const char* const pszClassname )
+{
+	const MonsterList_t& monsters = GetMonsters( pszClassname );
+
+	if( !pPrevious )
+		return !monsters.empty() ? monsters.front() : nullptr;
+
+	const int iPrevious = pPrevious->entindex();
+
+	auto it = std::upper_bound( monsters.begin(), monsters.end(), iPrevious,
+		[]( const int iIndex, const CTalkMonster* pMonster )
+		{
+			return iIndex < pMonster->entindex();
+		}
+	);
+
+	return it != monsters.end() ? *it : nullptr;
+}
+
+void CTalkMonsterRegistry::UpdateBuckets()
+{
+	m_bDirty = false;
+
+	//Keys point to classnames in the string pool, which is freed on map change, so they can't be kept.
+	m_Buckets.clear();
+
+	for( auto pMonster : m_Monsters )
+	{
+		//Not spawned yet.
+		if( !pMonster->pev->classname )
+		{
+			m_bDirty = true;
+			continue;
+		}
+
+		m_Buckets[ pMonster->GetClassname() ].push_back( pMonster );
+	}
+
+	for( auto& bucket : m_Buckets )
+	{
+		std::sort( bucket.second.begin(), bucket.second.end(),
+			[]( const CTalkMonster* pLHS, const CTalkMonster* pRHS )
+			{
+				return pLHS->entindex() < pRHS->entindex();
+			}
+		);
+	}
+}
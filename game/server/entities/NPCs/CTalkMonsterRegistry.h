@@ -0,0 +1,62 @@
+#ifndef GAME_SERVER_ENTITIES_NPCS_CTALKMONSTERREGISTRY_H
+#define GAME_SERVER_ENTITIES_NPCS_CTALKMONSTERREGISTRY_H
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "StringUtils.h"
+
+class CBaseEntity;
+class CTalkMonster;
+
+/**
+*	Keeps track of every talk monster, grouped by classname, so talk monsters can find their friends without searching all entities.
+*	Monsters are added when they're created and removed when they're destroyed. Dead monsters stay in the registry until they're removed.
+*/
+class CTalkMonsterRegistry final
+{
+public:
+	typedef std::vector<CTalkMonster*> MonsterList_t;
+
+	CTalkMonsterRegistry() = default;
+
+	void Add( CTalkMonster* pMonster );
+
+	void Remove( CTalkMonster* pMonster );
+
+	/**
+	*	@return All talk monsters with the given classname, in entity index order.
+	*	The list is valid until the next call to Add, Remove or GetMonsters.
+	*/
+	const MonsterList_t& GetMonsters( const char* const pszClassname );
+
+	/**
+	*	@return The first talk monster with the given classname whose entity index is higher than that of pPrevious,
+	*	or the first one if pPrevious is null. Matches the order that UTIL_FindEntityByClassname uses.
+	*/
+	CTalkMonster* FindNext( CBaseEntity* pPrevious, const char* const pszClassname );
+
+private:
+	/**
+	*	Groups monsters by classname. Classnames aren't known when monsters are created, so this is done on the first query after a change.
+	*/
+	void UpdateBuckets();
+
+private:
+	MonsterList_t m_Monsters;
+
+	std::unordered_map<const char*, MonsterList_t, RawCharHash, RawCharEqualTo> m_Buckets;
+
+	bool m_bDirty = false;
+
+	static const MonsterList_t m_EmptyList;
+
+private:
+	CTalkMonsterRegistry( const CTalkMonsterRegistry& ) = delete;
+	CTalkMonsterRegistry& operator=( const CTalkMonsterRegistry& ) = delete;
+};
+
+extern CTalkMonsterRegistry g_TalkMonsterRegistry;
+
+#endif //GAME_SERVER_ENTITIES_NPCS_CTALKMONSTERREGISTRY_H
@@ -21,6 +21,7 @@
 #include	"entities/NPCs/Monsters.h"
 #include	"entities/NPCs/Schedule.h"
 #include	"DefaultAI.h"
+#include	"CScheduleRegistry.h"
 #include	"entities/CSoundEnt.h"
 #include	"nodes/Nodes.h"
 #include	"entities/NPCs/scripted/Scripted.h"
@@ -1023,6 +1024,18 @@ const Schedule_t* CBaseMonster::ScheduleFromName( const char* const pszName ) co
 {
 	const Schedules_t* pSchedules = GetSchedulesList();
 
+	if( pSchedules->pTable )
+	{
+		if ( !pszName )
+		{
+			ALERT( at_console, "%s set to unnamed schedule!\n", GetClassname() );
+			return nullptr;
+		}
+
+		return pSchedules->pTable->FindByName( pszName );
+	}
+
+	//Tables haven't been built yet.
 	while( pSchedules )
 	{
 		if( const Schedule_t* pSchedule = ScheduleInList( pszName, pSchedules->ppSchedules, pSchedules->uiNumSchedules ) )
@@ -24,6 +24,7 @@
 #include "util.h"
 #include "cbase.h"
 #include "nodes/Nodes.h"
+#include "nodes/CNodeVisibility.h"
 #include "Monsters.h"
 #include "animation.h"
 #include "SaveRestore.h"
@@ -32,7 +33,12 @@
 #include "entities/NPCs/CSquadMonster.h"
 #include "Decals.h"
 #include "entities/CSoundEnt.h"
+#include "ai/CAIProfiler.h"
+#include "ai/CLocalMoveCache.h"
+#include "ai/CSightCache.h"
+#include "ai/CThinkScheduler.h"
 #include "gamerules/GameRules.h"
+#include "Server.h"
 
 #define MONSTER_CUT_CORNER_DIST		8 // 8 means the monster's bounding box is contained without the box of the node in WC
 
@@ -52,6 +58,8 @@ bool CBaseMonster::Restore( CRestore &restore )
 	// We don't save/restore schedules yet
 	m_pSchedule = NULL;
 	m_iTaskStatus = TASKSTATUS_NEW;
+	m_PathRequest = INVALID_PATH_REQUEST;
+	m_fCanQueuePath = false;
 	
 	// Reset animation
 	m_Activity = ACT_RESET;
@@ -122,10 +130,10 @@ void CBaseMonster :: Listen ( void )
 {
 	int		iSound;
 	int		iMySounds;
-	float	hearingSensitivity;
 	CSound	*pCurrentSound;
 
 	m_iAudibleList = SOUNDLIST_EMPTY; 
+	m_iAudibleScents = SOUNDLIST_EMPTY;
 	ClearConditions(bits_COND_HEAR_SOUND | bits_COND_SMELL | bits_COND_SMELL_FOOD);
 	m_afSoundTypes = 0;
 
@@ -138,11 +146,10 @@ void CBaseMonster :: Listen ( void )
 		iMySounds &= m_pSchedule->iSoundMask;
 	}
 
-	iSound = CSoundEnt::ActiveList();
+	// the sound ent only links in the sounds that the monster cares about, and that are close enough to hear.
+	m_iAudibleList = CSoundEnt::BuildAudibleList( EarPosition(), iMySounds, HearingSensitivity(), m_iAudibleScents );
 
-	// UNDONE: Clear these here?
-	ClearConditions( bits_COND_HEAR_SOUND | bits_COND_SMELL_FOOD | bits_COND_SMELL );
-	hearingSensitivity = HearingSensitivity( );
+	iSound = m_iAudibleList;
 
 	while ( iSound != SOUNDLIST_EMPTY )
 	{
@@ -154,46 +161,31 @@ void CBaseMonster :: Listen ( void )
 			break;
 		}
 
-		if ( ( pCurrentSound->m_iType & iMySounds )	&& 
-				( pCurrentSound->m_vecOrigin - EarPosition() ).Length() <= pCurrentSound->m_iVolume * hearingSensitivity )
-
-		//if ( ( g_pSoundEnt->m_SoundPool[ iSound ].m_iType & iMySounds ) && ( g_pSoundEnt->m_SoundPool[ iSound ].m_vecOrigin - EarPosition()).Length () <= g_pSoundEnt->m_SoundPool[ iSound ].m_iVolume * hearingSensitivity ) 
+		if ( pCurrentSound->FIsSound() )
 		{
- 			// the monster cares about this sound, and it's close enough to hear.
-			//g_pSoundEnt->m_SoundPool[ iSound ].m_iNextAudible = m_iAudibleList;
-			pCurrentSound->m_iNextAudible = m_iAudibleList;
-			
-			if ( pCurrentSound->FIsSound() )
+			// this is an audible sound.
+			SetConditions( bits_COND_HEAR_SOUND );
+		}
+		else
+		{
+			// if not a sound, must be a smell - determine if it's just a scent, or if it's a food scent
+			if ( pCurrentSound->m_iType & ( bits_SOUND_MEAT | bits_SOUND_CARCASS ) )
 			{
-				// this is an audible sound.
-				SetConditions( bits_COND_HEAR_SOUND );
+				// the detected scent is a food item, so set both conditions.
+				// !!!BUGBUG - maybe a virtual function to determine whether or not the scent is food?
+				SetConditions( bits_COND_SMELL_FOOD );
+				SetConditions( bits_COND_SMELL );
 			}
 			else
 			{
-				// if not a sound, must be a smell - determine if it's just a scent, or if it's a food scent
-//				if ( g_pSoundEnt->m_SoundPool[ iSound ].m_iType & ( bits_SOUND_MEAT | bits_SOUND_CARCASS ) )
-				if ( pCurrentSound->m_iType & ( bits_SOUND_MEAT | bits_SOUND_CARCASS ) )
-				{
-					// the detected scent is a food item, so set both conditions.
-					// !!!BUGBUG - maybe a virtual function to determine whether or not the scent is food?
-					SetConditions( bits_COND_SMELL_FOOD );
-					SetConditions( bits_COND_SMELL );
-				}
-				else
-				{
-					// just a normal scent. 
-					SetConditions( bits_COND_SMELL );
-				}
+				// just a normal scent. 
+				SetConditions( bits_COND_SMELL );
 			}
-
-//			m_afSoundTypes |= g_pSoundEnt->m_SoundPool[ iSound ].m_iType;
-			m_afSoundTypes |= pCurrentSound->m_iType;
-
-			m_iAudibleList = iSound;
 		}
 
-		//		iSound = g_pSoundEnt->m_SoundPool[ iSound ].m_iNext;
-		iSound = pCurrentSound->m_iNext;
+		m_afSoundTypes |= pCurrentSound->m_iType;
+
+		iSound = pCurrentSound->m_iNextAudible;
 	}
 }
 
@@ -248,7 +240,7 @@ void CBaseMonster :: Look ( int iDistance )
 		Vector delta = Vector( iDistance, iDistance, iDistance );
 
 		// Find only monsters/clients in box, NOT limited to PVS
-		int count = UTIL_EntitiesInBox( pList, 100, GetAbsOrigin() - delta, GetAbsOrigin() + delta, FL_CLIENT|FL_MONSTER );
+		int count = g_SightCache.MonstersAndClientsInBox( pList, 100, GetAbsOrigin() - delta, GetAbsOrigin() + delta );
 		for ( int i = 0; i < count; i++ )
 		{
 			pSightEnt = pList[i];
@@ -404,7 +396,7 @@ CSound* CBaseMonster :: PBestScent ( void )
 	float flDist;
 	CSound *pSound;
 
-	iThisScent = m_iAudibleList;// smells are in the sound list.
+	iThisScent = m_iAudibleScents;// smells are in the sound list, after the sounds.
 
 	if ( iThisScent == SOUNDLIST_EMPTY )
 	{
@@ -452,8 +444,20 @@ CSound* CBaseMonster :: PBestScent ( void )
 //=========================================================
 void CBaseMonster :: MonsterThink ( void )
 {
-	pev->nextthink = gpGlobals->time + 0.1;// keep monster thinking.
+	// if the AI budget for this frame is spent, this think may have to wait until the next frame.
+	if ( !g_ThinkScheduler.BeginThink( this ) )
+	{
+		return;
+	}
+
+	// monsters that no player is near think less often.
+	m_AILOD = g_AILevelOfDetail.Classify( this );
+
+	const float flThinkInterval = g_AILevelOfDetail.GetThinkInterval( m_AILOD );
 
+	pev->nextthink = g_ThinkScheduler.GetNextThinkTime( this, flThinkInterval );// keep monster thinking.
+
+	g_AILevelOfDetail.OnThink( this, m_AILOD, flThinkInterval );
 
 	RunAI();
 
@@ -463,7 +467,7 @@ void CBaseMonster :: MonsterThink ( void )
 // start or end a fidget
 // This needs a better home -- switching animations over time should be encapsulated on a per-activity basis
 // perhaps MaintainActivity() or a ShiftAnimationOverTime() or something.
-	if ( m_MonsterState != MONSTERSTATE_SCRIPT && m_MonsterState != MONSTERSTATE_DEAD && m_Activity == ACT_IDLE && m_fSequenceFinished )
+	if ( m_AILOD != AILOD::DORMANT && m_MonsterState != MONSTERSTATE_SCRIPT && m_MonsterState != MONSTERSTATE_DEAD && m_Activity == ACT_IDLE && m_fSequenceFinished )
 	{
 		int iSequence;
 
@@ -486,7 +490,15 @@ void CBaseMonster :: MonsterThink ( void )
 		}
 	}
 
-	DispatchAnimEvents( flInterval );
+	// nobody is near enough to see or hear the events of a dormant monster.
+	if ( m_AILOD == AILOD::DORMANT )
+	{
+		SkipAnimEvents( flInterval );
+	}
+	else
+	{
+		DispatchAnimEvents( flInterval );
+	}
 
 	if ( !MovementIsComplete() )
 	{
@@ -495,10 +507,12 @@ void CBaseMonster :: MonsterThink ( void )
 #if _DEBUG	
 	else 
 	{
-		if ( !TaskIsRunning() && !TaskIsComplete() )
+		if ( !TaskIsRunning() && !TaskIsComplete() && m_iTaskStatus != TASKSTATUS_WAITING_FOR_PATH )
 			ALERT( at_error, "Schedule stalled!!\n" );
 	}
 #endif
+
+	g_ThinkScheduler.EndThink();
 }
 
 //=========================================================
@@ -1232,6 +1246,23 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 	float	flDist;
 	float	flStep, stepSize;
 	int		iReturn;
+	LocalMoveResult_t result;
+
+	if ( g_LocalMoveCache.Find( this, vecStart, vecEnd, pTarget, LOCAL_STEP_SIZE, result ) )
+	{
+		// this move was already checked this frame.
+		if ( result.fBlocked )
+		{
+			if ( pflDist != NULL )
+			{
+				*pflDist = result.flDist;
+			}
+
+			gpGlobals->trace_ent = result.pBlocker;
+		}
+
+		return result.iReturn;
+	}
 
 	vecStartPos = GetAbsOrigin();
 	
@@ -1274,9 +1305,16 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 		
 //		UTIL_ParticleEffect ( GetAbsOrigin(), g_vecZero, 255, 25 );
 
+		++result.cWalkMoves;
+
 		if ( !UTIL_WalkMove( this, flYaw, stepSize, WALKMOVE_CHECKONLY ) )
 		{// can't take the next step, fail!
 
+			result.fBlocked = true;
+			result.flDist = flStep;
+			result.pBlocker = gpGlobals->trace_ent;
+			result.fFullStep = stepSize == LOCAL_STEP_SIZE;
+
 			if ( pflDist != NULL )
 			{
 				*pflDist = flStep;
@@ -1324,6 +1362,9 @@ int CBaseMonster::CheckLocalMove( const Vector &vecStart, const Vector &vecEnd,
 	// since we've actually moved the monster during the check, undo the move.
 	SetAbsOrigin( vecStartPos );
 
+	result.iReturn = iReturn;
+	g_LocalMoveCache.Add( this, vecStart, vecEnd, pTarget, result );
+
 	return iReturn;
 }
 
@@ -1400,13 +1441,13 @@ void CBaseMonster :: AdvanceRoute ( float distance )
 				int iLink;
 				WorldGraph.HashSearch(iSrcNode, iDestNode, iLink);
 
-				if ( iLink >= 0 && WorldGraph.m_pLinkPool[iLink].m_pLinkEnt != NULL )
+				if ( iLink >= 0 && WorldGraph.m_ppLinkEnts[iLink] != NULL )
 				{
 					//ALERT(at_aiconsole, "A link. ");
-					if ( WorldGraph.HandleLinkEnt ( iSrcNode, WorldGraph.m_pLinkPool[iLink].m_pLinkEnt, m_afCapability, CGraph::NODEGRAPH_DYNAMIC ) )
+					if ( WorldGraph.IsLinkPassable ( iLink, m_afCapability, CGraph::NODEGRAPH_DYNAMIC ) )
 					{
 						//ALERT(at_aiconsole, "usable.");
-						if( entvars_t *pevDoor = WorldGraph.m_pLinkPool[ iLink ].m_pLinkEnt )
+						if( entvars_t *pevDoor = WorldGraph.m_ppLinkEnts[ iLink ] )
 						{
 							if( auto pDoor = Instance( pevDoor ) )
 							{
@@ -1456,10 +1497,18 @@ int CBaseMonster :: RouteClassify( int iMoveFlag )
 //=========================================================
 bool CBaseMonster::BuildRoute( const Vector &vecGoal, int iMoveFlag, const CBaseEntity* const pTarget )
 {
+	CAIProfileScope scope( this, AIProfileCategory::BUILD_ROUTE );
+
 	float	flDist;
 	Vector	vecApex;
 	int		iLocalMove;
 
+	if ( IsWaitingForPath() )
+	{
+		// this task already queued a path search, don't try anything else until it's done.
+		return false;
+	}
+
 	RouteNew();
 	m_movementGoal = RouteClassify( iMoveFlag );
 
@@ -2108,7 +2157,8 @@ void CBaseMonster :: MovementComplete( void )
 bool CBaseMonster::TaskIsRunning() const
 {
 	if ( m_iTaskStatus != TASKSTATUS_COMPLETE && 
-		 m_iTaskStatus != TASKSTATUS_RUNNING_MOVEMENT )
+		 m_iTaskStatus != TASKSTATUS_RUNNING_MOVEMENT &&
+		 m_iTaskStatus != TASKSTATUS_WAITING_FOR_PATH )
 		 return true;
 
 	return false;
@@ -2156,6 +2206,8 @@ int CBaseMonster::IRelationship ( CBaseEntity *pTarget )
 
 bool CBaseMonster::FindCover( Vector vecThreat, Vector vecViewOffset, float flMinDist, float flMaxDist )
 {
+	CAIProfileScope scope( this, AIProfileCategory::FIND_COVER );
+
 	int i;
 	int iMyHullIndex;
 	int iMyNode;
@@ -2163,6 +2215,7 @@ bool CBaseMonster::FindCover( Vector vecThreat, Vector vecViewOffset, float flMi
 	float flDist;
 	Vector	vecLookersOffset;
 	TraceResult tr;
+	bool fThreatHasNode = true;
 
 	if ( !flMaxDist )
 	{
@@ -2197,6 +2250,7 @@ bool CBaseMonster::FindCover( Vector vecThreat, Vector vecViewOffset, float flMi
 	{
 		// ALERT ( at_aiconsole, "FindCover() - Threat has no nearest node!\n" );
 		iThreatNode = iMyNode;
+		fThreatHasNode = false;
 		// return false;
 	}
 
@@ -2217,6 +2271,12 @@ bool CBaseMonster::FindCover( Vector vecThreat, Vector vecViewOffset, float flMi
 		// provide cover! Also make sure the node is within the mins/maxs of the search.
 		if ( flDist >= flMinDist && flDist < flMaxDist )
 		{
+			// a node that can see the threat's node won't hide us, so don't bother tracing from it.
+			if ( fThreatHasNode && g_NodeVisibility.Test( WorldGraph, nodeNumber, iThreatNode ) == NodeVisibility::VISIBLE )
+			{
+				continue;
+			}
+
 			UTIL_TraceLine ( node.m_vecOrigin + vecViewOffset, vecLookersOffset, ignore_monsters, ignore_glass,  ENT(pev), &tr );
 
 			// if this node will block the threat's line of sight to me...
@@ -2262,13 +2322,21 @@ bool CBaseMonster::FindCover( Vector vecThreat, Vector vecViewOffset, float flMi
 //=========================================================
 bool CBaseMonster::BuildNearestRoute( Vector vecThreat, Vector vecViewOffset, float flMinDist, float flMaxDist )
 {
+	CAIProfileScope scope( this, AIProfileCategory::BUILD_NEAREST_ROUTE );
+
 	int i;
 	int iMyHullIndex;
 	int iMyNode;
+	int iThreatNode;
 	float flDist;
 	Vector	vecLookersOffset;
 	TraceResult tr;
 
+	if ( IsWaitingForPath() )
+	{
+		return false;
+	}
+
 	if ( !flMaxDist )
 	{
 		// user didn't supply a MaxDist, so work up a crazy one.
@@ -2298,6 +2366,9 @@ bool CBaseMonster::BuildNearestRoute( Vector vecThreat, Vector vecViewOffset, fl
 		return false;
 	}
 
+	// only used to skip nodes that can't see the target's node.
+	iThreatNode = g_NodeVisibility.IsBuilt() ? WorldGraph.FindNearestNode( vecThreat, this ) : NO_NODE;
+
 	vecLookersOffset = vecThreat + vecViewOffset;// calculate location of enemy's eyes
 
 	// we'll do a rough sample to find nodes that are relatively nearby
@@ -2316,6 +2387,12 @@ bool CBaseMonster::BuildNearestRoute( Vector vecThreat, Vector vecViewOffset, fl
 			// is it close?
 			if ( flDist > flMinDist && flDist < flMaxDist)
 			{
+				// nodes that can't see the target's node almost never see the target.
+				if ( iThreatNode != NO_NODE && g_NodeVisibility.Test( WorldGraph, nodeNumber, iThreatNode ) == NodeVisibility::HIDDEN )
+				{
+					continue;
+				}
+
 				// can I see where I want to be from there?
 				UTIL_TraceLine( node.m_vecOrigin + pev->view_ofs, vecLookersOffset, ignore_monsters, edict(), &tr );
 
@@ -2704,7 +2781,27 @@ bool CBaseMonster::FGetNodeRoute( const Vector& vecDest )
 	// valid src and dest nodes were found, so it's safe to proceed with
 	// find shortest path
 	int iNodeHull = WorldGraph.HullIndex( this ); // make this a monster virtual function
-	iResult = WorldGraph.FindShortestPath ( iPath, iSrcNode, iDestNode, iNodeHull, m_afCapability );
+
+	if ( m_PathRequest != INVALID_PATH_REQUEST &&
+		 g_PathRequestQueue.GetState( m_PathRequest ) == PathRequestState::DONE &&
+		 g_PathRequestQueue.IsRequestFor( m_PathRequest, iSrcNode, iDestNode, iNodeHull, m_afCapability ) )
+	{
+		// the search queued when this task started has finished.
+		iResult = g_PathRequestQueue.TakeResult( m_PathRequest, iPath, ARRAYSIZE( iPath ) );
+		m_PathRequest = INVALID_PATH_REQUEST;
+	}
+	else if ( m_fCanQueuePath && ( sv_nodegraph_async.value >= 2 || !WorldGraph.m_fRoutingComplete ) )
+	{
+		// searches can take a while without routing tables, so spread them across frames.
+		// MaintainSchedule starts the task again once the search is done.
+		ReleasePathRequest();
+		m_PathRequest = g_PathRequestQueue.Submit( iSrcNode, iDestNode, iNodeHull, m_afCapability );
+		return false;
+	}
+	else
+	{
+		iResult = WorldGraph.FindShortestPath ( iPath, iSrcNode, iDestNode, iNodeHull, m_afCapability );
+	}
 
 	if ( !iResult )
 	{
@@ -2757,6 +2854,29 @@ bool CBaseMonster::FGetNodeRoute( const Vector& vecDest )
 	return true;
 }
 
+//=========================================================
+// IsWaitingForPath - returns true if the task that is
+// starting has queued a path search.
+//=========================================================
+bool CBaseMonster::IsWaitingForPath() const
+{
+	return m_fCanQueuePath &&
+		m_PathRequest != INVALID_PATH_REQUEST &&
+		g_PathRequestQueue.GetState( m_PathRequest ) == PathRequestState::PENDING;
+}
+
+//=========================================================
+// ReleasePathRequest - drops the queued path search, if any.
+//=========================================================
+void CBaseMonster::ReleasePathRequest()
+{
+	if ( m_PathRequest != INVALID_PATH_REQUEST )
+	{
+		g_PathRequestQueue.Release( m_PathRequest );
+		m_PathRequest = INVALID_PATH_REQUEST;
+	}
+}
+
 //=========================================================
 // FindHintNode
 //=========================================================
@@ -3051,6 +3171,8 @@ bool CBaseMonster::CanPlaySequence( const bool fDisregardMonsterState, int inter
 
 bool CBaseMonster::FindLateralCover( const Vector &vecThreat, const Vector &vecViewOffset )
 {
+	CAIProfileScope scope( this, AIProfileCategory::FIND_LATERAL_COVER );
+
 	TraceResult	tr;
 	Vector	vecBestOnLeft;
 	Vector	vecBestOnRight;
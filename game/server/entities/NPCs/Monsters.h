@@ -26,6 +26,7 @@
 */
 
 struct Schedule_t;
+class CScheduleTable;
 
 // CHECKLOCALMOVE result types 
 enum LocalMove
@@ -391,8 +392,28 @@ struct Schedules_t
 	const Schedule_t* const* ppSchedules;
 
 	size_t uiNumSchedules;
+
+	/**
+	*	Name of the class that defined this list.
+	*/
+	const char* pszClassName;
+
+	/**
+	*	Lookup table for this list and its base lists. Built by g_ScheduleRegistry when the server starts.
+	*/
+	const CScheduleTable* pTable;
+
+	/**
+	*	Next list that was registered.
+	*/
+	Schedules_t* pNext;
 };
 
+/**
+*	Adds a schedule list to the registry. Called while static objects are constructed, so it must not depend on any.
+*/
+void Schedules_Register( Schedules_t* pSchedules );
+
 /**
 *	Specialized for every monster that defines custom schedules. - Solokiller
 *	@tparam T Monster class.
@@ -442,6 +463,7 @@ template<>														\
 bool InitSchedules<thisClass>()									\
 {																\
 	typedef thisClass ThisClass;								\
+	const char* const pszThisClassName = #thisClass;			\
 																\
 	static Schedule_t* schedules[] =							\
 	{
@@ -478,6 +500,9 @@ __BEGIN_SCHEDULES( thisClass )
 	pSchedules->pBaseList = ThisClass::GetBaseSchedulesList();	\
 	pSchedules->ppSchedules = schedules;						\
 	pSchedules->uiNumSchedules = ARRAYSIZE( schedules );		\
+	pSchedules->pszClassName = pszThisClassName;				\
+																\
+	Schedules_Register( pSchedules );							\
 																\
 	return true;												\
 }
@@ -45,6 +45,11 @@ enum TaskStatus
 	*	Completed, get next task
 	*/
 	TASKSTATUS_COMPLETE			= 4,
+
+	/**
+	*	Waiting for a queued path search, start the task again once it's done
+	*/
+	TASKSTATUS_WAITING_FOR_PATH	= 5,
 };
 
 
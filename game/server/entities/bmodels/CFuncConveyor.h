@@ -23,6 +23,8 @@
 class CFuncConveyor : public CFuncWall
 {
 public:
+	DECLARE_CLASS( CFuncConveyor, CFuncWall );
+
 	void	Spawn( void ) override;
 	void	Use( CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE useType, float value ) override;
 	void	UpdateSpeed( float speed );
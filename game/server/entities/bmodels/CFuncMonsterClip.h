@@ -31,6 +31,8 @@
 class CFuncMonsterClip : public CFuncWall
 {
 public:
+	DECLARE_CLASS( CFuncMonsterClip, CFuncWall );
+
 	void	Spawn( void ) override;
 	void	Use( CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE useType, float value ) override {}		// Clear out func_wall's use function
 };
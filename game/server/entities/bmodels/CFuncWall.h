@@ -21,6 +21,8 @@ This is just a solid wall if not inhibited
 class CFuncWall : public CBaseEntity
 {
 public:
+	DECLARE_CLASS( CFuncWall, CBaseEntity );
+
 	void	Spawn( void ) override;
 	void	Use( CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE useType, float value ) override;
 
@@ -22,6 +22,8 @@
 class CFuncWallToggle : public CFuncWall
 {
 public:
+	DECLARE_CLASS( CFuncWallToggle, CFuncWall );
+
 	void	Spawn( void ) override;
 	void	Use( CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE useType, float value ) override;
 	void	TurnOff( void );
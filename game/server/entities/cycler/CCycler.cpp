@@ -41,7 +41,7 @@ void CCycler :: GenericCyclerSpawn(char *szModel, Vector vecMin, Vector vecMax)
 		return;
 	}
 
-	pev->classname		= MAKE_STRING("cycler");
+	SetClassname( "cycler" );
 	PRECACHE_MODEL( szModel );
 	SetModel(	szModel);
 
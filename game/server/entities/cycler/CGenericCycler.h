@@ -23,6 +23,8 @@
 class CGenericCycler : public CCycler
 {
 public:
+	DECLARE_CLASS( CGenericCycler, CCycler );
+
 	void Spawn( void ) override { GenericCyclerSpawn( ( char * ) STRING( pev->model ), Vector( -16, -16, 0 ), Vector( 16, 16, 72 ) ); }
 };
 
@@ -205,7 +205,7 @@ CBeam *CBeam::BeamCreate( const char *pSpriteName, int width )
 {
 	// Create a new entity with CBeam private data
 	CBeam *pBeam = GetClassPtr( ( CBeam * ) NULL );
-	pBeam->pev->classname = MAKE_STRING( "beam" );
+	pBeam->SetClassname( "beam" );
 
 	pBeam->BeamInit( pSpriteName, width );
 
@@ -32,7 +32,7 @@ void CGib::Spawn( const char *szGibModel )
 	pev->rendermode = kRenderNormal;
 	pev->renderfx = kRenderFxNone;
 	pev->solid = SOLID_SLIDEBOX;/// hopefully this will fix the VELOCITY TOO LOW crap
-	pev->classname = MAKE_STRING( "gib" );
+	SetClassname( "gib" );
 
 	SetModel( szGibModel );
 	SetSize( Vector( 0, 0, 0 ), Vector( 0, 0, 0 ) );
@@ -161,7 +161,7 @@ CSprite *CSprite::SpriteCreate( const char *pSpriteName, const Vector &origin, c
 {
 	CSprite *pSprite = GetClassPtr( ( CSprite * ) NULL );
 	pSprite->SpriteInit( pSpriteName, origin );
-	pSprite->pev->classname = MAKE_STRING( "env_sprite" );
+	pSprite->SetClassname( "env_sprite" );
 	pSprite->pev->solid = SOLID_NOT;
 	pSprite->pev->movetype = MOVETYPE_NOCLIP;
 	if( animate )
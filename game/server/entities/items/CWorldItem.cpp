@@ -44,7 +44,7 @@ void CWorldItem::Spawn( void )
 	else
 	{
 		pEntity->pev->target = pev->target;
-		pEntity->pev->targetname = pev->targetname;
+		pEntity->SetTargetname( pev->targetname );
 		pEntity->pev->spawnflags = pev->spawnflags;
 	}
 
@@ -130,7 +130,7 @@ void CBasePlayer::InitialSpawn()
 
 void CBasePlayer::Spawn()
 {
-	pev->classname		= MAKE_STRING( "player" );
+	SetClassname( "player" );
 	pev->health			= 100;
 	pev->armorvalue		= 0;
 	pev->takedamage		= DAMAGE_AIM;
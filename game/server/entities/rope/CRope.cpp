@@ -122,7 +122,7 @@ void CRope::Precache()
 
 void CRope::Spawn()
 {
-	pev->classname = MAKE_STRING( "env_rope" );
+	SetClassname( "env_rope" );
 
 	m_bMakeSound = true;
 
@@ -33,7 +33,7 @@ LINK_ENTITY_TO_CLASS( rope_sample, CRopeSample );
 
 void CRopeSample::Spawn()
 {
-	pev->classname = MAKE_STRING( "rope_sample" );
+	SetClassname( "rope_sample" );
 
 	GetEffects() |= EF_NODRAW;
 }
@@ -48,7 +48,7 @@ void CRopeSegment::Precache()
 
 void CRopeSegment::Spawn()
 {
-	pev->classname = MAKE_STRING( "rope_segment" );
+	SetClassname( "rope_segment" );
 
 	Precache();
 
@@ -8,7 +8,7 @@ LINK_ENTITY_TO_CLASS( fireanddie, CFireAndDie );
 
 void CFireAndDie::Spawn( void )
 {
-	pev->classname = MAKE_STRING( "fireanddie" );
+	SetClassname( "fireanddie" );
 	// Don't call Precache() - it should be called on restore
 }
 
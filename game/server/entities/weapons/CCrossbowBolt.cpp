@@ -33,7 +33,7 @@ CCrossbowBolt *CCrossbowBolt::BoltCreate()
 	// Create a new entity with CCrossbowBolt private data
 	CCrossbowBolt *pBolt = GetClassPtr( ( CCrossbowBolt * ) NULL );
 	//TODO: classname doesn't match LINK_ENTITY_TO_CLASS. - Solokiller
-	pBolt->pev->classname = MAKE_STRING( "bolt" );
+	pBolt->SetClassname( "bolt" );
 	pBolt->Spawn();
 
 	return pBolt;
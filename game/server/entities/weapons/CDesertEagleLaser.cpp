@@ -28,7 +28,7 @@ CDesertEagleLaser *CDesertEagleLaser::CreateSpot()
 	CDesertEagleLaser *pSpot = GetClassPtr( ( CDesertEagleLaser* ) NULL );
 	pSpot->Spawn();
 
-	pSpot->pev->classname = MAKE_STRING( "eagle_laser" );
+	pSpot->SetClassname( "eagle_laser" );
 
 	return pSpot;
 }
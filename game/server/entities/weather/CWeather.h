@@ -4,6 +4,7 @@
 class CWeather : public CBaseTrigger
 {
 public:
+	DECLARE_CLASS( CWeather, CBaseTrigger );
 
 	void Spawn() override;
 };
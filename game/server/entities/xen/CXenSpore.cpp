@@ -120,7 +120,7 @@ CXenHull *CXenHull::CreateHull( CBaseEntity *source, const Vector &mins, const V
 	pHull->SetAbsOrigin( source->GetAbsOrigin() + offset );
 	pHull->SetModel( STRING( source->pev->model ) );
 	pHull->pev->solid = SOLID_BBOX;
-	pHull->pev->classname = MAKE_STRING( "xen_hull" );
+	pHull->SetClassname( "xen_hull" );
 	pHull->pev->movetype = MOVETYPE_NONE;
 	pHull->pev->owner = source->edict();
 	pHull->SetSize( mins, maxs );
@@ -33,7 +33,7 @@ CXenTreeTrigger *CXenTreeTrigger::TriggerCreate( CBaseEntity* pOwner, const Vect
 {
 	CXenTreeTrigger *pTrigger = GetClassPtr( ( CXenTreeTrigger * ) NULL );
 	pTrigger->pev->origin = position;
-	pTrigger->pev->classname = MAKE_STRING( "xen_ttrigger" );
+	pTrigger->SetClassname( "xen_ttrigger" );
 	pTrigger->pev->solid = SOLID_TRIGGER;
 	pTrigger->pev->movetype = MOVETYPE_NONE;
 	pTrigger->pev->owner = pOwner->edict();
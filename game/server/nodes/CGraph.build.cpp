@@ -0,0 +1,669 @@
+/***
+*
+*	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   This source code contains proprietary and confidential information of
+*   Valve LLC and its suppliers.  Access to this code is restricted to
+*   persons who have executed a written SDK license with Valve.  Any access,
+*   use or distribution of this code by or to any unlicensed person is illegal.
+*
+****/
+//=========================================================
+// CGraph.build.cpp - the parts of the node graph that prune
+// its links, sort it, build its lookup tables, compress and
+// decode its routes and write it to disk. They don't use
+// entities or the engine, other than to print messages, so
+// the offline node graph compiler shares them.
+//=========================================================
+
+#include <vector>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+
+// Renumber nodes so that nodes that link together are together.
+//
+#define UNNUMBERED_NODE -1
+void CGraph::SortNodes(void)
+{
+	// aiNewNode holds the new node number of each node.
+	// After assigning new node numbers to everything, we move
+	// things and patchup the links.
+	//
+	std::vector<int> aiNewNode( max( m_cNodes, 1 ), UNNUMBERED_NODE );
+	int iNodeCnt = 0;
+	int i;
+	aiNewNode[0] = iNodeCnt++;
+
+	for (i = 0; i < m_cNodes; i++)
+	{
+		// Run through all of this node's neighbors
+		//
+		for (int j = 0 ; j < m_pNodes[i].m_cNumLinks; j++ )
+		{
+			int iDestNode = INodeLink(i, j);
+			if (aiNewNode[iDestNode] == UNNUMBERED_NODE)
+			{
+				aiNewNode[iDestNode] = iNodeCnt++;
+			}
+		}
+	}
+
+	// Assign remaining node numbers to unlinked nodes.
+	//
+	for (i = 0; i < m_cNodes; i++)
+	{
+		if (aiNewNode[i] == UNNUMBERED_NODE)
+		{
+			aiNewNode[i] = iNodeCnt++;
+		}
+	}
+
+	// Alter links to reflect new node numbers.
+	//
+	for (i = 0; i < m_cLinks; i++)
+	{
+		m_pLinkPool[i].m_iSrcNode  = aiNewNode[m_pLinkPool[i].m_iSrcNode];
+		m_pLinkPool[i].m_iDestNode = aiNewNode[m_pLinkPool[i].m_iDestNode];
+	}
+
+	// Rearrange nodes to reflect new node numbering.
+	//
+	for (i = 0; i < m_cNodes; i++)
+	{
+		while (aiNewNode[i] != i)
+		{
+			// Move current node off to where it should be, and bring
+			// that other node back into the current slot.
+			//
+			int iDestNode = aiNewNode[i];
+			CNode TempNode = m_pNodes[iDestNode];
+			m_pNodes[iDestNode] = m_pNodes[i];
+			m_pNodes[i] = TempNode;
+
+			aiNewNode[i] = aiNewNode[iDestNode];
+			aiNewNode[iDestNode] = iDestNode;
+		}
+	}
+}
+
+//=========================================================
+// CGraph - RejectInlineLinks - expects a pointer to a link
+// pool, and a pointer to and already-open file ( if you
+// want status reports written to disk ). RETURNS the number
+// of connections that were rejected
+//=========================================================
+int	CGraph :: RejectInlineLinks ( CLink *pLinkPool, FILE *file )
+{
+	int		i,j,k;
+
+	int		cRejectedLinks;
+
+	bool	fRestartLoop;// have to restart the J loop if we eliminate a link.
+
+	CNode	*pSrcNode;
+	CNode	*pCheckNode;// the node we are testing for (one of pSrcNode's connections)
+	CNode	*pTestNode;// the node we are checking against ( also one of pSrcNode's connections)
+
+	float	flDistToTestNode, flDistToCheckNode;
+
+	Vector2D	vec2DirToTestNode, vec2DirToCheckNode;
+
+	if ( file )
+	{
+		fprintf ( file, "----------------------------------------------------------------------------\n" );
+		fprintf ( file, "InLine Rejection:\n" );
+		fprintf ( file, "----------------------------------------------------------------------------\n" );
+	}
+
+	cRejectedLinks = 0;
+
+	for ( i = 0 ; i < m_cNodes ; i++ )
+	{
+		pSrcNode = &m_pNodes[ i ];
+
+		if ( file )
+		{
+			fprintf ( file, "Node %3d:\n", i );
+		}
+
+		for ( j = 0 ; j < pSrcNode->m_cNumLinks ; j++ )
+		{
+			pCheckNode = &m_pNodes[ pLinkPool[ pSrcNode->m_iFirstLink + j ].m_iDestNode ];
+
+			vec2DirToCheckNode = ( pCheckNode->m_vecOrigin - pSrcNode->m_vecOrigin ).Make2D(); 
+			flDistToCheckNode = vec2DirToCheckNode.Length();
+			vec2DirToCheckNode = vec2DirToCheckNode.Normalize();
+
+			pLinkPool[ pSrcNode->m_iFirstLink + j ].m_flWeight = flDistToCheckNode;
+
+			fRestartLoop = false;
+			for ( k = 0 ; k < pSrcNode->m_cNumLinks && !fRestartLoop ; k++ )
+			{
+				if ( k == j )
+				{// don't check against same node
+					continue;
+				}
+
+				pTestNode = &m_pNodes [ pLinkPool[ pSrcNode->m_iFirstLink + k ].m_iDestNode ];
+
+				vec2DirToTestNode = ( pTestNode->m_vecOrigin - pSrcNode->m_vecOrigin ).Make2D(); 
+
+				flDistToTestNode = vec2DirToTestNode.Length();
+				vec2DirToTestNode = vec2DirToTestNode.Normalize();
+
+				if ( DotProduct ( vec2DirToCheckNode, vec2DirToTestNode ) >= 0.998 )
+				{
+					// there's a chance that TestNode intersects the line to CheckNode. If so, we should disconnect the link to CheckNode. 
+					if ( flDistToTestNode < flDistToCheckNode )
+					{
+						if ( file )
+						{
+							fprintf ( file, "REJECTED NODE %3d through Node %3d, Dot = %8f\n", pLinkPool[ pSrcNode->m_iFirstLink + j ].m_iDestNode, pLinkPool[ pSrcNode->m_iFirstLink + k ].m_iDestNode, DotProduct ( vec2DirToCheckNode, vec2DirToTestNode ) );
+						}
+
+						pLinkPool[ pSrcNode->m_iFirstLink + j ] = pLinkPool[ pSrcNode->m_iFirstLink + ( pSrcNode->m_cNumLinks - 1 ) ];
+						pSrcNode->m_cNumLinks--;
+						j--;
+
+						cRejectedLinks++;// keeping track of how many links are cut, so that we can return that value.
+
+						fRestartLoop = true;
+					}
+				}
+			}
+		}
+
+		if ( file )
+		{
+			fprintf ( file, "----------------------------------------------------------------------------\n\n" );
+		}
+	}
+
+	return cRejectedLinks;
+}
+
+//=========================================================
+// CGraph - BuildRangeTables - sorts the nodes by region so
+// FindNearestNode can search the ranges around a point.
+//=========================================================
+void CGraph::BuildRangeTables(void)
+{
+	if (m_di) free(m_di);
+
+	// Go ahead and setup for range searching the nodes for FindNearestNodes
+	//
+	m_di = (DIST_INFO *)calloc(sizeof(DIST_INFO), m_cNodes);
+	if (!m_di)
+	{
+		ALERT(at_aiconsole, "Couldn't allocated node ordering array.\n");
+		return;
+	}
+
+	// Calculate regions for all the nodes.
+	//
+	//
+	int i;
+	for (i = 0; i < 3; i++)
+	{
+		m_RegionMin[i] =  999999999.0; // just a big number out there;
+		m_RegionMax[i] = -999999999.0; // just a big number out there;
+	}
+	for (i = 0; i < m_cNodes; i++)
+	{
+		if (m_pNodes[i].m_vecOrigin.x < m_RegionMin[0])
+			m_RegionMin[0] = m_pNodes[i].m_vecOrigin.x;
+		if (m_pNodes[i].m_vecOrigin.y < m_RegionMin[1])
+			m_RegionMin[1] = m_pNodes[i].m_vecOrigin.y;
+		if (m_pNodes[i].m_vecOrigin.z < m_RegionMin[2])
+			m_RegionMin[2] = m_pNodes[i].m_vecOrigin.z;
+
+		if (m_pNodes[i].m_vecOrigin.x > m_RegionMax[0])
+			m_RegionMax[0] = m_pNodes[i].m_vecOrigin.x;
+		if (m_pNodes[i].m_vecOrigin.y > m_RegionMax[1])
+			m_RegionMax[1] = m_pNodes[i].m_vecOrigin.y;
+		if (m_pNodes[i].m_vecOrigin.z > m_RegionMax[2])
+			m_RegionMax[2] = m_pNodes[i].m_vecOrigin.z;
+	}
+	for (i = 0; i < m_cNodes; i++)
+	{
+		m_pNodes[i].m_Region[0] = CALC_RANGE(m_pNodes[i].m_vecOrigin.x, m_RegionMin[0], m_RegionMax[0]);
+		m_pNodes[i].m_Region[1] = CALC_RANGE(m_pNodes[i].m_vecOrigin.y, m_RegionMin[1], m_RegionMax[1]);
+		m_pNodes[i].m_Region[2] = CALC_RANGE(m_pNodes[i].m_vecOrigin.z, m_RegionMin[2], m_RegionMax[2]);
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		int j;
+		for (j = 0; j < NUM_RANGES; j++)
+		{
+			m_RangeStart[i][j] = 255;
+			m_RangeEnd[i][j] = 0;
+		}
+		for (j = 0; j < m_cNodes; j++)
+		{
+			m_di[j].m_SortedBy[i] = j;
+		}
+
+		for (j = 0; j < m_cNodes - 1; j++)
+		{
+			int jNode = m_di[j].m_SortedBy[i];
+			int jCodeX = m_pNodes[jNode].m_Region[0];
+			int jCodeY = m_pNodes[jNode].m_Region[1];
+			int jCodeZ = m_pNodes[jNode].m_Region[2];
+			int jCode;
+			switch (i)
+			{
+			case 0:
+				jCode = (jCodeX << 16) + (jCodeY << 8) + jCodeZ;
+				break;
+			case 1:
+				jCode = (jCodeY << 16) + (jCodeZ << 8) + jCodeX;
+				break;
+			case 2:
+				jCode = (jCodeZ << 16) + (jCodeX << 8) + jCodeY;
+				break;
+			}
+
+			for (int k = j+1; k < m_cNodes; k++)
+			{
+				int kNode = m_di[k].m_SortedBy[i];
+				int kCodeX = m_pNodes[kNode].m_Region[0];
+				int kCodeY = m_pNodes[kNode].m_Region[1];
+				int kCodeZ = m_pNodes[kNode].m_Region[2];
+				int kCode;
+				switch (i)
+				{
+				case 0:
+					kCode = (kCodeX << 16) + (kCodeY << 8) + kCodeZ;
+					break;
+				case 1:
+					kCode = (kCodeY << 16) + (kCodeZ << 8) + kCodeX;
+					break;
+				case 2:
+					kCode = (kCodeZ << 16) + (kCodeX << 8) + kCodeY;
+					break;
+				}
+
+				if (kCode < jCode)
+				{
+					// Swap j and k entries.
+					//
+					int Tmp = m_di[j].m_SortedBy[i];
+					m_di[j].m_SortedBy[i] = m_di[k].m_SortedBy[i];
+					m_di[k].m_SortedBy[i] = Tmp;
+				}
+			}
+		}
+	}
+
+	// Generate lookup tables.
+	//
+	for (i = 0; i < m_cNodes; i++)
+	{
+		int CodeX = m_pNodes[m_di[i].m_SortedBy[0]].m_Region[0];
+		int CodeY = m_pNodes[m_di[i].m_SortedBy[1]].m_Region[1];
+		int CodeZ = m_pNodes[m_di[i].m_SortedBy[2]].m_Region[2];
+
+        if (i < m_RangeStart[0][CodeX])
+        {
+            m_RangeStart[0][CodeX] = i;
+        }
+        if (i < m_RangeStart[1][CodeY])
+        {
+            m_RangeStart[1][CodeY] = i;
+        }
+        if (i < m_RangeStart[2][CodeZ])
+        {
+            m_RangeStart[2][CodeZ] = i;
+        }
+        if (m_RangeEnd[0][CodeX] < i)
+        {
+            m_RangeEnd[0][CodeX] = i;
+        }
+        if (m_RangeEnd[1][CodeY] < i)
+        {
+            m_RangeEnd[1][CodeY] = i;
+        }
+        if (m_RangeEnd[2][CodeZ] < i)
+        {
+            m_RangeEnd[2][CodeZ] = i;
+        }
+	}
+
+	// Initialize the cache.
+	//
+	memset(m_Cache, 0, sizeof(m_Cache));
+}
+
+int CGraph::HullLinkMask( int iHull )
+{
+	switch( iHull )
+	{
+	default:
+	case NODE_SMALL_HULL:	return bits_LINK_SMALL_HULL;
+	case NODE_HUMAN_HULL:	return bits_LINK_HUMAN_HULL;
+	case NODE_LARGE_HULL:	return bits_LINK_LARGE_HULL;
+	case NODE_FLY_HULL:		return bits_LINK_FLY_HULL;
+	}
+}
+
+//=========================================================
+// CGraph - CompressRoute
+//
+// run-length compresses a node's row of the routing table
+// into pRoute, which must hold at least 2 * cNodes bytes.
+// each phrase is either a sequence of nodes whose best next
+// node is the node itself, or a repeat of the same best next
+// node, stored as an offset from iFrom.
+// returns the number of bytes written.
+//=========================================================
+int CGraph::CompressRoute( const unsigned short *pBestNextNodes, int cNodes, int iFrom, char *pRoute )
+{
+	int iLastNode = 9999999; // just really big.
+	int cSequence = 0;
+	int cRepeats = 0;
+	char *p = pRoute;
+	for (int i = 0; i < cNodes; i++)
+	{
+		const bool CanRepeat = ((pBestNextNodes[i] == iLastNode) && cRepeats < 127);
+		const bool CanSequence = (pBestNextNodes[i] == i && cSequence < 128);
+
+		if (cRepeats)
+		{
+			if (CanRepeat)
+			{
+				cRepeats++;
+			}
+			else
+			{
+				// Emit the repeat phrase.
+				//
+				*p++ = cRepeats - 1;
+				int a = iLastNode - iFrom;
+				int b = iLastNode - iFrom + cNodes;
+				int c = iLastNode - iFrom - cNodes;
+				if (-128 <= a && a <= 127)
+				{
+					*p++ = a;
+				}
+				else if (-128 <= b && b <= 127)
+				{
+					*p++ = b;
+				}
+				else if (-128 <= c && c <= 127)
+				{
+					*p++ = c;
+				}
+				else
+				{
+					ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom);
+				}
+				cRepeats = 0;
+
+				if (CanSequence)
+				{
+					// Start a sequence.
+					//
+					cSequence++;
+				}
+				else
+				{
+					// Start another repeat.
+					//
+					cRepeats++;
+				}
+			}
+		}
+		else if (cSequence)
+		{
+			if (CanSequence)
+			{
+				cSequence++;
+			}
+			else
+			{
+				// It may be advantageous to combine
+				// a single-entry sequence phrase with the
+				// next repeat phrase.
+				//
+				if (cSequence == 1 && CanRepeat)
+				{
+					// Combine with repeat phrase.
+					//
+					cRepeats = 2;
+					cSequence = 0;
+				}
+				else
+				{
+					// Emit the sequence phrase.
+					//
+					*p++ = -cSequence;
+					cSequence = 0;
+
+					// Start a repeat sequence.
+					//
+					cRepeats++;
+				}
+			}
+		}
+		else
+		{
+			if (CanSequence)
+			{
+				// Start a sequence phrase.
+				//
+				cSequence++;
+			}
+			else
+			{
+				// Start a repeat sequence.
+				//
+				cRepeats++;
+			}
+		}
+		iLastNode = pBestNextNodes[i];
+	}
+	if (cRepeats)
+	{
+		// Emit the repeat phrase.
+		//
+		*p++ = cRepeats - 1;
+#if 0
+		iLastNode = iFrom + *pRoute;
+		if (iLastNode >= cNodes) iLastNode -= cNodes;
+		else if (iLastNode < 0) iLastNode += cNodes;
+#endif
+		int a = iLastNode - iFrom;
+		int b = iLastNode - iFrom + cNodes;
+		int c = iLastNode - iFrom - cNodes;
+		if (-128 <= a && a <= 127)
+		{
+			*p++ = a;
+		}
+		else if (-128 <= b && b <= 127)
+		{
+			*p++ = b;
+		}
+		else if (-128 <= c && c <= 127)
+		{
+			*p++ = c;
+		}
+		else
+		{
+			ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom);
+		}
+	}
+	if (cSequence)
+	{
+		// Emit the Sequence phrase.
+		//
+		*p++ = -cSequence;
+	}
+
+	return p - pRoute;
+}
+
+// Decode a row compressed by CompressRoute. Nodes are relative to the row's node.
+int CGraph::DecodeRoute( const char *pRoute, int iCurrentNode, int iDest, int cNodes )
+{
+	int iNext = iCurrentNode;
+	int nCount = iDest+1;
+
+	// Until we decode the next best node
+	//
+	while (nCount > 0)
+	{
+		char ch = *pRoute++;
+		//ALERT(at_aiconsole, "C(%d)", ch);
+		if (ch < 0)
+		{
+			// Sequence phrase
+			//
+			ch = -ch;
+			if (nCount <= ch)
+			{
+				iNext = iDest;
+				nCount = 0;
+				//ALERT(at_aiconsole, "SEQ: iNext/iDest=%d\n", iNext);
+			}
+			else
+			{
+				//ALERT(at_aiconsole, "SEQ: nCount + ch (%d + %d)\n", nCount, ch);
+				nCount = nCount - ch;
+			}
+		}
+		else
+		{
+			//ALERT(at_aiconsole, "C(%d)", *pRoute);
+
+			// Repeat phrase
+			//
+			if (nCount <= ch+1)
+			{
+				iNext = iCurrentNode + *pRoute;
+				if (iNext >= cNodes) iNext -= cNodes;
+				else if (iNext < 0) iNext += cNodes;
+				nCount = 0;
+				//ALERT(at_aiconsole, "REP: iNext=%d\n", iNext);
+			}
+			else
+			{
+				//ALERT(at_aiconsole, "REP: nCount - ch+1 (%d - %d+1)\n", nCount, ch);
+				nCount = nCount - ch - 1;
+			}
+			pRoute++;
+		}
+	}
+
+	return iNext;
+}
+
+//=========================================================
+// CGraph - WriteGraphFile - writes the graph to the given
+// file. The file is written under a temporary name and then
+// renamed, so processes that still map the old file are
+// not affected.
+//=========================================================
+bool CGraph::WriteGraphFile( const char* const pszFilename, const std::vector<unsigned char>& hierarchyData, const std::vector<unsigned char>& visibilityData ) const
+{
+	char	szTempFilename[MAX_PATH];
+	FILE	*file;
+
+	snprintf( szTempFilename, sizeof( szTempFilename ), "%s.tmp", pszFilename );
+
+	file = fopen ( szTempFilename, "wb" );
+
+	if ( !file )
+	{// couldn't create
+		ALERT ( at_aiconsole, "Couldn't Create: %s\n", szTempFilename );
+		return false;
+	}
+
+	const void *pSectionData[ NODE_SECTION_COUNT ] =
+	{
+		this,
+		m_pNodes,
+		m_pLinkPool,
+		m_di,
+		m_pRouteInfo,
+		m_pHashLinks,
+		hierarchyData.data(),
+		visibilityData.data()
+	};
+
+	NodeGraphHeader_t header;
+	memset( &header, 0, sizeof( header ) );
+
+	header.iVersion = GRAPH_VERSION;
+	header.iPointerSize = sizeof( void* );
+	header.cSections = NODE_SECTION_COUNT;
+
+	header.sections[ NODE_SECTION_GRAPH ].uiSize = sizeof( CGraph );
+	header.sections[ NODE_SECTION_NODES ].uiSize = sizeof( CNode ) * m_cNodes;
+	header.sections[ NODE_SECTION_LINKS ].uiSize = sizeof( CLink ) * m_cLinks;
+	header.sections[ NODE_SECTION_DIST_INFO ].uiSize = sizeof( DIST_INFO ) * m_cNodes;
+	header.sections[ NODE_SECTION_ROUTE_INFO ].uiSize = m_pRouteInfo ? sizeof( char ) * m_nRouteInfo : 0;
+	header.sections[ NODE_SECTION_HASH_LINKS ].uiSize = m_pHashLinks ? sizeof( int ) * m_nHashLinks : 0;
+	header.sections[ NODE_SECTION_HIERARCHY ].uiSize = hierarchyData.size();
+	header.sections[ NODE_SECTION_VISIBILITY ].uiSize = visibilityData.size();
+
+	unsigned int uiOffset = sizeof( header );
+
+	int i;
+	for ( i = 0; i < NODE_SECTION_COUNT; i++ )
+	{
+		uiOffset = ( uiOffset + NODE_SECTION_ALIGNMENT - 1 ) & ~( NODE_SECTION_ALIGNMENT - 1 );
+		header.sections[ i ].uiOffset = uiOffset;
+		uiOffset += header.sections[ i ].uiSize;
+	}
+
+	bool fSuccess = fwrite( &header, sizeof( header ), 1, file ) == 1;
+
+	static const byte padding[ NODE_SECTION_ALIGNMENT ] = {};
+
+	for ( i = 0; i < NODE_SECTION_COUNT && fSuccess; i++ )
+	{
+		const size_t cbPadding = header.sections[ i ].uiOffset - ftell( file );
+
+		if ( cbPadding > 0 )
+		{
+			fSuccess = fwrite( padding, cbPadding, 1, file ) == 1;
+		}
+
+		if ( fSuccess && header.sections[ i ].uiSize > 0 )
+		{
+			fSuccess = fwrite( pSectionData[ i ], header.sections[ i ].uiSize, 1, file ) == 1;
+		}
+	}
+
+	if ( fclose ( file ) != 0 )
+	{
+		fSuccess = false;
+	}
+
+	if ( fSuccess )
+	{
+#ifdef WIN32
+		// rename won't replace an existing file on Windows.
+		remove( pszFilename );
+#endif
+		fSuccess = rename( szTempFilename, pszFilename ) == 0;
+	}
+
+	if ( !fSuccess )
+	{
+		ALERT ( at_aiconsole, "Couldn't Create: %s\n", pszFilename );
+		remove( szTempFilename );
+		return false;
+	}
+
+	return true;
+}
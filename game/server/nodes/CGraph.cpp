@@ -16,6 +16,9 @@
 // nodes.cpp - AI node tree stuff.
 //=========================================================
 
+#include <memory>
+#include <vector>
+
 #include "extdll.h"
 #include "util.h"
 #include "cbase.h"
@@ -24,6 +27,16 @@
 #include "animation.h"
 #include "entities/DoorConstants.h"
 #include "CQueuePriority.h"
+#include "CLinkStateCache.h"
+#include "CMappedFile.h"
+#include "CNodeGrid.h"
+#include "CNodeHierarchy.h"
+#include "CNodeVisibility.h"
+#include "CPathCache.h"
+#include "CPathRequestQueue.h"
+#include "CGraphQueryTrace.h"
+#include "CRoutingTableBuilder.h"
+#include "Server.h"
 
 #if !defined ( _WIN32 )
 #include <sys/stat.h>
@@ -36,6 +49,23 @@ extern DLL_GLOBAL CBaseEntity* g_pBodyQueueHead;
 
 CGraph	WorldGraph;
 
+// Search scratch memory for queries made on the main thread.
+static CGraphSearch g_GraphSearch;
+
+// Spatial index used by FindNearestNode. Built along with the region tables.
+static CNodeGrid g_NodeGrid;
+
+// Number of traces CheckNode has performed during the current region table lookup.
+static int g_cNearestNodeTraces = 0;
+
+// Routing tables for graphs that are too large for the flat tables.
+static CNodeHierarchy g_NodeHierarchy;
+
+// The loaded node graph file, if it could be memory mapped.
+static CMappedFile g_GraphFile;
+
+static void FreeGraphArray( void *pArray );
+
 //=========================================================
 // CGraph - InitGraph - prepares the graph for use. Frees any
 // memory currently in use by the world graph, NULLs 
@@ -54,7 +84,7 @@ void CGraph :: InitGraph( void)
 	//
 	if ( m_pLinkPool )
 	{
-		free ( m_pLinkPool );
+		FreeGraphArray ( m_pLinkPool );
 		m_pLinkPool = NULL;
 	}
 		
@@ -62,13 +92,13 @@ void CGraph :: InitGraph( void)
 	//
 	if ( m_pNodes )
 	{
-		free ( m_pNodes );
+		FreeGraphArray ( m_pNodes );
 		m_pNodes = NULL;
 	}
 
 	if ( m_di )
 	{
-		free ( m_di );
+		FreeGraphArray ( m_di );
 		m_di = NULL;
 	}
 
@@ -76,16 +106,44 @@ void CGraph :: InitGraph( void)
 	//
 	if ( m_pRouteInfo )
 	{
-		free ( m_pRouteInfo );
+		FreeGraphArray ( m_pRouteInfo );
 		m_pRouteInfo = NULL;
 	}
 
 	if (m_pHashLinks)
 	{
-		free(m_pHashLinks);
+		FreeGraphArray(m_pHashLinks);
 		m_pHashLinks = NULL;
 	}
 
+	// Free the runtime state.
+	//
+	free( m_pSearchState );
+	m_pSearchState = NULL;
+
+	free( m_pCheckedEvent );
+	m_pCheckedEvent = NULL;
+
+	free( m_ppLinkEnts );
+	m_ppLinkEnts = NULL;
+
+	// Nothing points into the file anymore.
+	g_GraphFile.Close();
+
+	g_NodeGrid.Clear();
+
+	g_NodeHierarchy.Clear();
+
+	g_NodeVisibility.Clear();
+
+	// Queued requests, cached paths and link states refer to nodes and links in this graph.
+	g_PathRequestQueue.Clear();
+	g_PathCache.Clear();
+	g_LinkStateCache.Clear();
+
+	// Recorded queries refer to nodes in this graph.
+	g_GraphQueryTrace.Close();
+
 	// Zero node and link counts
 	//
 	m_cNodes = 0;
@@ -116,6 +174,34 @@ bool CGraph::AllocNodes()
 	return true;
 }
 
+//=========================================================
+// CGraph - AllocGraphState - mallocs the arrays that hold
+// the graph's runtime state, once the node and link counts
+// are known. Link entities start out NULL until
+// FSetGraphPointers finds them.
+//=========================================================
+bool CGraph::AllocGraphState()
+{
+	free( m_pSearchState );
+	free( m_pCheckedEvent );
+	free( m_ppLinkEnts );
+
+	// calloc( 0 ) may return NULL, which would look like a failure.
+	m_pSearchState = ( NodeSearchState_t * )calloc( sizeof( NodeSearchState_t ), max( m_cNodes, 1 ) );
+	m_pCheckedEvent = ( int * )calloc( sizeof( int ), max( m_cNodes, 1 ) );
+	m_ppLinkEnts = ( entvars_t ** )calloc( sizeof( entvars_t * ), max( m_cLinks, 1 ) );
+
+	m_CheckedCounter = 0;
+
+	if ( !m_pSearchState || !m_pCheckedEvent || !m_ppLinkEnts )
+	{
+		ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc graph state for %d nodes!\n", m_cNodes );
+		return false;
+	}
+
+	return true;
+}
+
 //=========================================================
 // CGraph - LinkEntForLink - sometimes the ent that blocks
 // a path is a usable door, in which case the monster just
@@ -131,7 +217,7 @@ bool CGraph::AllocNodes()
 //=========================================================
 entvars_t* CGraph :: LinkEntForLink ( CLink *pLink, CNode *pNode )
 {
-	entvars_t* const pevLinkEnt = pLink->m_pLinkEnt;
+	entvars_t* const pevLinkEnt = m_ppLinkEnts[ pLink - m_pLinkPool ];
 
 	if ( !pevLinkEnt )
 		return nullptr;
@@ -259,6 +345,71 @@ bool CGraph::HandleLinkEnt( int iNode, entvars_t *pevLinkEnt, int afCapMask, NOD
 	return false;
 }
 
+//=========================================================
+// CGraph - IsLinkPassable - same as HandleLinkEnt, but reads
+// the link's cached state instead of looking at the entity.
+// Links without an entity can always be passed.
+//=========================================================
+bool CGraph::IsLinkPassable( int iLink, int afCapMask, NODEQUERY queryType )
+{
+	if ( m_ppLinkEnts[ iLink ] == NULL )
+	{
+		return true;
+	}
+
+	if ( !m_fGraphPresent || !m_fGraphPointersSet )
+	{// protect us in the case that the node graph isn't available
+		ALERT ( at_aiconsole, "Graph not ready!\n" );
+		return false;
+	}
+
+	if ( !g_LinkStateCache.IsBuilt() )
+	{
+		g_LinkStateCache.Build( *this );
+	}
+
+	return g_LinkStateCache.IsPassable( iLink, ( afCapMask & bits_CAP_OPEN_DOORS ) != 0, queryType == NODEGRAPH_STATIC );
+}
+
+//=========================================================
+// CGraph - LinkEntStateChanged - called by entities that
+// links pass through when their state changes in a way that
+// changes what HandleLinkEnt returns for them, such as a
+// door opening or closing, and for every entity that spawns,
+// since it may have reused a link entity's edict. Updates
+// the cached link states, and throws away cached paths if
+// any of them changed.
+//=========================================================
+void CGraph::LinkEntStateChanged( const entvars_t *pevLinkEnt )
+{
+	if ( !m_fGraphPresent || !m_fGraphPointersSet )
+	{
+		return;
+	}
+
+	if ( g_LinkStateCache.EntityChanged( pevLinkEnt ) )
+	{
+		g_PathCache.Invalidate();
+	}
+}
+
+//=========================================================
+// CGraph - LinkEntRemoved - called when an entity is freed.
+// Links that passed through it no longer have an entity.
+//=========================================================
+void CGraph::LinkEntRemoved( const entvars_t *pevLinkEnt )
+{
+	if ( !m_fGraphPresent || !m_fGraphPointersSet )
+	{
+		return;
+	}
+
+	if ( g_LinkStateCache.EntityRemoved( pevLinkEnt ) )
+	{
+		g_PathCache.Invalidate();
+	}
+}
+
 #if 0
 //=========================================================
 // FindNearestLink - finds the connection (line) nearest
@@ -456,6 +607,20 @@ float CGraph::PathLength( int iStart, int iDest, int iHull, int afCapMask )
 	int iCurrentNode = iStart;
 	int iCap = CapIndex( afCapMask );
 
+	CGraphQueryTrace::CScope traceScope( g_GraphQueryTrace );
+
+	if ( traceScope.ShouldRecord() )
+	{
+		g_GraphQueryTrace.RecordPathLength( iStart, iDest, iHull, afCapMask );
+	}
+
+	g_PathCache.SetCapacity( max( 0, static_cast<int>( sv_nodegraph_pathcache.value ) ) );
+
+	if ( g_PathCache.FindLength( iStart, iDest, iHull, iCap, distance ) )
+	{
+		return distance;
+	}
+
 	while (iCurrentNode != iDest)
 	{
 		if (iMaxLoop-- <= 0)
@@ -484,6 +649,8 @@ float CGraph::PathLength( int iStart, int iDest, int iHull, int afCapMask )
 		iCurrentNode = iNext;
 	}
 
+	g_PathCache.AddLength( iStart, iDest, iHull, iCap, distance );
+
 	return distance;
 }
 
@@ -491,57 +658,24 @@ float CGraph::PathLength( int iStart, int iDest, int iHull, int afCapMask )
 // Parse the routing table at iCurrentNode for the next node on the shortest path to iDest
 int CGraph::NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap )
 {
-	int iNext = iCurrentNode;
-	int nCount = iDest+1;
-	char *pRoute = m_pRouteInfo + m_pNodes[ iCurrentNode ].m_pNextBestNode[iHull][iCap];
+	CGraphQueryTrace::CScope traceScope( g_GraphQueryTrace );
 
-	// Until we decode the next best node
-	//
-	while (nCount > 0)
+	if ( traceScope.ShouldRecord() )
 	{
-		char ch = *pRoute++;
-		//ALERT(at_aiconsole, "C(%d)", ch);
-		if (ch < 0)
-		{
-			// Sequence phrase
-			//
-			ch = -ch;
-			if (nCount <= ch)
-			{
-				iNext = iDest;
-				nCount = 0;
-				//ALERT(at_aiconsole, "SEQ: iNext/iDest=%d\n", iNext);
-			}
-			else
-			{
-				//ALERT(at_aiconsole, "SEQ: nCount + ch (%d + %d)\n", nCount, ch);
-				nCount = nCount - ch;
-			}
-		}
-		else
-		{
-			//ALERT(at_aiconsole, "C(%d)", *pRoute);
+		g_GraphQueryTrace.RecordNextNodeInRoute( iCurrentNode, iDest, iHull, iCap );
+	}
 
-			// Repeat phrase
-			//
-			if (nCount <= ch+1)
-			{
-				iNext = iCurrentNode + *pRoute;
-				if (iNext >= m_cNodes) iNext -= m_cNodes;
-				else if (iNext < 0) iNext += m_cNodes;
-				nCount = 0;
-				//ALERT(at_aiconsole, "REP: iNext=%d\n", iNext);
-			}
-			else
-			{
-				//ALERT(at_aiconsole, "REP: nCount - ch+1 (%d - %d+1)\n", nCount, ch);
-				nCount = nCount - ch - 1;
-			}
-			pRoute++;
-		}
+	if ( g_NodeHierarchy.IsBuilt() )
+	{
+		return g_NodeHierarchy.NextNodeInRoute( *this, iCurrentNode, iDest, iHull, iCap );
+	}
+
+	if ( m_nRouteInfo <= 0 )
+	{
+		return iCurrentNode;
 	}
 
-	return iNext;
+	return DecodeRoute( m_pRouteInfo + m_pNodes[ iCurrentNode ].m_pNextBestNode[iHull][iCap], iCurrentNode, iDest, m_cNodes );
 }
 
 
@@ -551,13 +685,25 @@ int CGraph::NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap )
 // accepts a capability mask (afCapMask), and will only 
 // find a path usable by a monster with those capabilities
 // returns the number of nodes copied into supplied array
+//
+// if the routing tables aren't available, the path is searched
+// for using the given mode. GraphSearchMode::DEFAULT uses the
+// mode selected by sv_nodegraph_search and is the only mode
+// that is counted in the search statistics.
 //=========================================================
-int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask)
+int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask, GraphSearchMode mode )
 {
-	int		iVisitNode;
 	int		iCurrentNode;
 	int		iNumPathNodes;
-	int		iHullMask;
+
+	CGraphQueryTrace::CScope traceScope( g_GraphQueryTrace );
+
+	// Searches used to build and test the routing tables aren't recorded.
+	//
+	if ( traceScope.ShouldRecord() && mode == GraphSearchMode::DEFAULT )
+	{
+		g_GraphQueryTrace.RecordFindShortestPath( iStart, iDest, iHull, afCapMask );
+	}
 
 	if ( !m_fGraphPresent || !m_fGraphPointersSet )
 	{// protect us in the case that the node graph isn't available or built
@@ -578,6 +724,20 @@ int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull,
 		return 2;
 	}
 
+	// Only cache paths that monsters ask for, not the ones used to build and test the routing tables.
+	//
+	const bool bUseCache = mode == GraphSearchMode::DEFAULT;
+
+	if ( bUseCache )
+	{
+		g_PathCache.SetCapacity( max( 0, static_cast<int>( sv_nodegraph_pathcache.value ) ) );
+
+		if ( g_PathCache.FindPath( iStart, iDest, iHull, afCapMask, piPath, iNumPathNodes ) )
+		{
+			return iNumPathNodes;
+		}
+	}
+
 	// Is routing information present.
 	//
 	if (m_fRoutingComplete)
@@ -599,7 +759,7 @@ int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull,
 			if (iCurrentNode == iNext)
 			{
 				//ALERT(at_aiconsole, "SVD: Can't get there from here..\n");
-				return 0;
+				iNumPathNodes = 0;
 				break;
 			}
 			if (iNumPathNodes >= MAX_PATH_SIZE) 
@@ -614,100 +774,34 @@ int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull,
 	}
 	else
 	{
-		CQueuePriority	queue;
+		const bool bRecordStats = mode == GraphSearchMode::DEFAULT;
 
-		switch( iHull )
+		if ( bRecordStats )
 		{
-		case NODE_SMALL_HULL:
-			iHullMask = bits_LINK_SMALL_HULL;
-			break;
-		case NODE_HUMAN_HULL:
-			iHullMask = bits_LINK_HUMAN_HULL;
-			break;
-		case NODE_LARGE_HULL:
-			iHullMask = bits_LINK_LARGE_HULL;
-			break;
-		case NODE_FLY_HULL:
-			iHullMask = bits_LINK_FLY_HULL;
-			break;
+			mode = sv_nodegraph_search.value != 0 ? GraphSearchMode::ASTAR : GraphSearchMode::DIJKSTRA;
 		}
 
-		// Mark all the nodes as unvisited.
-		//
-		int i;
-		for ( i = 0; i < m_cNodes; i++)
-		{
-			m_pNodes[ i ].m_flClosestSoFar = -1.0;
-		}
+		int cNodesExpanded = 0;
 
-		m_pNodes[ iStart ].m_flClosestSoFar = 0.0;
-		m_pNodes[ iStart ].m_iPreviousNode = iStart;// tag this as the origin node
-		queue.Insert( iStart, 0.0 );// insert start node 
-		
-		while ( !queue.Empty() )
+		if ( mode == GraphSearchMode::ASTAR )
 		{
-			// now pull a node out of the queue
-			float flCurrentDistance;
-			iCurrentNode = queue.Remove(flCurrentDistance);
-
-			// For straight-line weights, the following Shortcut works. For arbitrary weights,
-			// it doesn't.
-			//
-			if (iCurrentNode == iDest) break;
-
-			CNode *pCurrentNode = &m_pNodes[ iCurrentNode ];
-			
-			for ( i = 0 ; i < pCurrentNode->m_cNumLinks ; i++ )
-			{// run through all of this node's neighbors
-				
-				iVisitNode = INodeLink ( iCurrentNode, i );
-				if ( ( m_pLinkPool[  m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo & iHullMask ) != iHullMask )
-				{// monster is too large to walk this connection
-					//ALERT ( at_aiconsole, "fat ass %d/%d\n",m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo, iMonsterHull );
-					continue;
-				}
-				// check the connection from the current node to the node we're about to mark visited and push into the queue				
-				if ( m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_pLinkEnt != NULL )
-				{// there's a brush ent in the way! Don't mark this node or put it into the queue unless the monster can negotiate it
-					
-					if ( !HandleLinkEnt ( iCurrentNode, m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_pLinkEnt, afCapMask, NODEGRAPH_STATIC ) )
-					{// monster should not try to go this way.
-						continue;
-					}
-				}
-				float flOurDistance = flCurrentDistance + m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i].m_flWeight;
-				if (  m_pNodes[ iVisitNode ].m_flClosestSoFar < -0.5
-				   || flOurDistance < m_pNodes[ iVisitNode ].m_flClosestSoFar - 0.001 )
-				{
-					m_pNodes[iVisitNode].m_flClosestSoFar = flOurDistance;
-					m_pNodes[iVisitNode].m_iPreviousNode = iCurrentNode;
-
-					queue.Insert ( iVisitNode, flOurDistance );
-				}
-			}
-		}
-		if ( m_pNodes[iDest].m_flClosestSoFar < -0.5 )
-		{// Destination is unreachable, no path found.
-			return 0;
+			iNumPathNodes = g_GraphSearch.FindShortestPath( *this, piPath, iStart, iDest, iHull, afCapMask );
+			cNodesExpanded = g_GraphSearch.GetNodesExpanded();
 		}
-
-	// the queue is not empty
-		
-		// now we must walk backwards through the m_iPreviousNode field, and count how many connections there are in the path
-		iCurrentNode = iDest;
-		iNumPathNodes = 1;// count the dest
-		
-		while ( iCurrentNode != iStart )
+		else
 		{
-			iNumPathNodes++;
-			iCurrentNode = m_pNodes[ iCurrentNode ].m_iPreviousNode;
+			iNumPathNodes = FindShortestPathDijkstra( piPath, iStart, iDest, iHull, afCapMask, cNodesExpanded );
 		}
 
-		iCurrentNode = iDest;
-		for ( i = iNumPathNodes - 1 ; i >= 0 ; i-- )
+		if ( bRecordStats )
 		{
-			piPath[ i ] = iCurrentNode;
-			iCurrentNode = m_pNodes [ iCurrentNode ].m_iPreviousNode;
+			CGraphSearch::RecordSearch( mode, cNodesExpanded, iNumPathNodes > 0 );
+
+			if ( sv_nodegraph_search_debug.value != 0 )
+			{
+				ALERT( at_console, "FindShortestPath (%s): %d to %d, hull %d: %d nodes, %d expanded\n",
+					mode == GraphSearchMode::ASTAR ? "A*" : "Dijkstra", iStart, iDest, iHull, iNumPathNodes, cNodesExpanded );
+			}
 		}
 	}
 
@@ -748,6 +842,111 @@ int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull,
 	MESSAGE_END();
 #endif
 
+	if ( bUseCache )
+	{
+		g_PathCache.AddPath( iStart, iDest, iHull, afCapMask, piPath, iNumPathNodes );
+	}
+
+	return iNumPathNodes;
+}
+
+//=========================================================
+// CGraph - FindShortestPathDijkstra - the original search
+// used by FindShortestPath. Uses the graph's search state,
+// so it can only be used on the main thread.
+// The routing tables are built with this search.
+//=========================================================
+int CGraph :: FindShortestPathDijkstra ( int *piPath, int iStart, int iDest, int iHull, int afCapMask, int& cNodesExpanded )
+{
+	int		iVisitNode;
+	int		iCurrentNode;
+	int		iNumPathNodes;
+
+	CQueuePriority	queue;
+
+	const int iHullMask = HullLinkMask( iHull );
+
+	cNodesExpanded = 0;
+
+	// Mark all the nodes as unvisited.
+	//
+	int i;
+	for ( i = 0; i < m_cNodes; i++)
+	{
+		m_pSearchState[ i ].m_flClosestSoFar = -1.0;
+	}
+
+	m_pSearchState[ iStart ].m_flClosestSoFar = 0.0;
+	m_pSearchState[ iStart ].m_iPreviousNode = iStart;// tag this as the origin node
+	queue.Insert( iStart, 0.0 );// insert start node 
+	
+	while ( !queue.Empty() )
+	{
+		// now pull a node out of the queue
+		float flCurrentDistance;
+		iCurrentNode = queue.Remove(flCurrentDistance);
+		++cNodesExpanded;
+
+		// For straight-line weights, the following Shortcut works. For arbitrary weights,
+		// it doesn't.
+		//
+		if (iCurrentNode == iDest) break;
+
+		CNode *pCurrentNode = &m_pNodes[ iCurrentNode ];
+		
+		for ( i = 0 ; i < pCurrentNode->m_cNumLinks ; i++ )
+		{// run through all of this node's neighbors
+			
+			iVisitNode = INodeLink ( iCurrentNode, i );
+			if ( ( m_pLinkPool[  m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo & iHullMask ) != iHullMask )
+			{// monster is too large to walk this connection
+				//ALERT ( at_aiconsole, "fat ass %d/%d\n",m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo, iMonsterHull );
+				continue;
+			}
+			// check the connection from the current node to the node we're about to mark visited and push into the queue				
+			if ( m_ppLinkEnts[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ] != NULL )
+			{// there's a brush ent in the way! Don't mark this node or put it into the queue unless the monster can negotiate it
+				
+				if ( !IsLinkPassable ( m_pNodes[ iCurrentNode ].m_iFirstLink + i, afCapMask, NODEGRAPH_STATIC ) )
+				{// monster should not try to go this way.
+					continue;
+				}
+			}
+			float flOurDistance = flCurrentDistance + m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i].m_flWeight;
+			if (  m_pSearchState[ iVisitNode ].m_flClosestSoFar < -0.5
+			   || flOurDistance < m_pSearchState[ iVisitNode ].m_flClosestSoFar - 0.001 )
+			{
+				m_pSearchState[iVisitNode].m_flClosestSoFar = flOurDistance;
+				m_pSearchState[iVisitNode].m_iPreviousNode = iCurrentNode;
+
+				queue.Insert ( iVisitNode, flOurDistance );
+			}
+		}
+	}
+	if ( m_pSearchState[iDest].m_flClosestSoFar < -0.5 )
+	{// Destination is unreachable, no path found.
+		return 0;
+	}
+
+// the queue is not empty
+	
+	// now we must walk backwards through the m_iPreviousNode field, and count how many connections there are in the path
+	iCurrentNode = iDest;
+	iNumPathNodes = 1;// count the dest
+	
+	while ( iCurrentNode != iStart )
+	{
+		iNumPathNodes++;
+		iCurrentNode = m_pSearchState[ iCurrentNode ].m_iPreviousNode;
+	}
+
+	iCurrentNode = iDest;
+	for ( i = iNumPathNodes - 1 ; i >= 0 ; i-- )
+	{
+		piPath[ i ] = iCurrentNode;
+		iCurrentNode = m_pSearchState [ iCurrentNode ].m_iPreviousNode;
+	}
+
 	return iNumPathNodes;
 }
 
@@ -774,14 +973,6 @@ void inline CalcBounds(int &Lower, int &Upper, int Goal, int Best)
     }
 }
 
-// Convert from [-8192,8192] to [0, 255]
-//
-inline int CALC_RANGE(int x, int lower, int upper)
-{
-	return NUM_RANGES*(x-lower)/((upper-lower+1));
-}
-
-
 void inline UpdateRange(int &minValue, int &maxValue, int Goal, int Best)
 {
     int Lower, Upper;
@@ -794,8 +985,8 @@ void CGraph :: CheckNode(Vector vecOrigin, int iNode)
 {
     // Have we already seen this point before?.
     //
-    if (m_di[iNode].m_CheckedEvent == m_CheckedCounter) return;
-    m_di[iNode].m_CheckedEvent = m_CheckedCounter;
+    if (m_pCheckedEvent[iNode] == m_CheckedCounter) return;
+    m_pCheckedEvent[iNode] = m_CheckedCounter;
 
 	float flDist = ( vecOrigin - m_pNodes[ iNode ].m_vecOriginPeek ).Length();
 
@@ -803,6 +994,8 @@ void CGraph :: CheckNode(Vector vecOrigin, int iNode)
 	{
 		TraceResult tr;
 
+		++g_cNearestNodeTraces;
+
 		// make sure that vecOrigin can trace to this node!
 		UTIL_TraceLine ( vecOrigin, m_pNodes[ iNode ].m_vecOriginPeek, ignore_monsters, 0, &tr );
 
@@ -832,6 +1025,9 @@ void CGraph :: CheckNode(Vector vecOrigin, int iNode)
 // CGraph - FindNearestNode - returns the index of the node nearest
 // the given vector -1 is failure (couldn't find a valid
 // near node )
+//
+// sv_nodegraph_nearest selects whether the node grid or the
+// region tables are used to find the node.
 //=========================================================
 int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  const CBaseEntity* const pEntity )
 {
@@ -840,8 +1036,12 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  const CBaseEntity* con
 
 int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 {
-	int	i;
-	TraceResult tr;
+	CGraphQueryTrace::CScope traceScope( g_GraphQueryTrace );
+
+	if ( traceScope.ShouldRecord() )
+	{
+		g_GraphQueryTrace.RecordFindNearestNode( vecOrigin, afNodeTypes );
+	}
 
 	if ( !m_fGraphPresent || !m_fGraphPointersSet )
 	{// protect us in the case that the node graph isn't available
@@ -849,12 +1049,15 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 		return -1;
 	}
 
+	const NearestNodeMode mode = ( sv_nodegraph_nearest.value != 0 && g_NodeGrid.IsBuilt() ) ? NearestNodeMode::GRID : NearestNodeMode::RANGE_TABLES;
+
 	// Check with the cache
 	//
 	CRC32_t iHash = ( NODE_CACHE_SIZE -1) & Hash((void *)(const float *)vecOrigin, sizeof(vecOrigin));
 	if (m_Cache[iHash].v == vecOrigin)
 	{
 		//ALERT(at_aiconsole, "Cache Hit.\n");
+		CNodeGrid::RecordQuery( mode, true, 0 );
 		return m_Cache[iHash].n;
 	}
 	else
@@ -862,6 +1065,36 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 		//ALERT(at_aiconsole, "Cache Miss.\n");
 	}
 
+	int cTraces;
+
+	if ( mode == NearestNodeMode::GRID )
+	{
+		m_iNearest = g_NodeGrid.FindNearestNode( *this, vecOrigin, afNodeTypes, cTraces );
+	}
+	else
+	{
+		g_cNearestNodeTraces = 0;
+		FindNearestNodeInRegions( vecOrigin, afNodeTypes );
+		cTraces = g_cNearestNodeTraces;
+	}
+
+	CNodeGrid::RecordQuery( mode, false, cTraces );
+
+	m_Cache[iHash].v = vecOrigin;
+	m_Cache[iHash].n = m_iNearest;
+	return m_iNearest;
+}
+
+//=========================================================
+// CGraph - FindNearestNodeInRegions - the original nearest
+// node search, using the region tables. Leaves the result
+// in m_iNearest.
+//=========================================================
+void CGraph :: FindNearestNodeInRegions ( const Vector &vecOrigin, int afNodeTypes )
+{
+	int	i;
+	TraceResult tr;
+
 	// Mark all points as unchecked.
 	//
 	m_CheckedCounter++;
@@ -869,7 +1102,7 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 	{
 		for (int i = 0; i < m_cNodes; i++)
 		{
-			m_di[i].m_CheckedEvent = 0;
+			m_pCheckedEvent[i] = 0;
 		}
 		m_CheckedCounter++;
 	}
@@ -1043,9 +1276,6 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 		ALERT(at_aiconsole, "All that work for nothing.\n");
 	}
 #endif
-	m_Cache[iHash].v = vecOrigin;
-	m_Cache[iHash].n = m_iNearest;
-	return m_iNearest;
 }
 
 //=========================================================
@@ -1165,7 +1395,7 @@ int CGraph :: LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode )
 		{// clear out the important fields in the link pool for this node
 			pLinkPool [ cTotalLinks + z ].m_iSrcNode = i;// so each link knows which node it originates from
 			pLinkPool [ cTotalLinks + z ].m_iDestNode = 0;
-			pLinkPool [ cTotalLinks + z ].m_pLinkEnt = NULL;
+			memset( pLinkPool [ cTotalLinks + z ].m_szLinkEntModelname, 0, sizeof( pLinkPool [ cTotalLinks + z ].m_szLinkEntModelname ) );
 		}
 
 		m_pNodes [ i ].m_iFirstLink = cTotalLinks;
@@ -1224,10 +1454,8 @@ int CGraph :: LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode )
 // graphs are prepared for use.
 				if ( tr.pHit == pTraceEnt && !FClassnameIs( tr.pHit, "worldspawn" ) )
 				{
-					// get a pointer
-					pLinkPool [ cTotalLinks ].m_pLinkEnt = VARS( tr.pHit );
-
-					// record the modelname, so that we can save/load node trees
+					// record the modelname, so that we can save/load node trees. The pointer is found
+					// by FSetGraphPointers.
 					memcpy( pLinkPool [ cTotalLinks ].m_szLinkEntModelname, STRING( VARS(tr.pHit)->model ), 4 );
 
 					// set the flag for this ent that indicates that it is attached to the world graph
@@ -1248,7 +1476,7 @@ int CGraph :: LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode )
 			{
 				fprintf ( file, "%4d", j );
 
-				if ( !FNullEnt( pLinkPool[ cTotalLinks ].m_pLinkEnt ) )
+				if ( pLinkPool[ cTotalLinks ].HasLinkEnt() )
 				{// record info about the ent in the way, if any.
 					fprintf ( file, "  Entity on connection: %s, name: %s  Model: %s", STRING( VARS( pTraceEnt )->classname ), STRING ( VARS( pTraceEnt )->targetname ), STRING ( VARS(tr.pHit)->model ) );
 				}
@@ -1309,114 +1537,54 @@ int CGraph :: LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode )
 }
 
 //=========================================================
-// CGraph - RejectInlineLinks - expects a pointer to a link
-// pool, and a pointer to and already-open file ( if you
-// want status reports written to disk ). RETURNS the number
-// of connections that were rejected
+// Section helpers for the node graph file.
 //=========================================================
-int	CGraph :: RejectInlineLinks ( CLink *pLinkPool, FILE *file )
-{
-	int		i,j,k;
-
-	int		cRejectedLinks;
-
-	bool	fRestartLoop;// have to restart the J loop if we eliminate a link.
 
-	CNode	*pSrcNode;
-	CNode	*pCheckNode;// the node we are testing for (one of pSrcNode's connections)
-	CNode	*pTestNode;// the node we are checking against ( also one of pSrcNode's connections)
-
-	float	flDistToTestNode, flDistToCheckNode;
-
-	Vector2D	vec2DirToTestNode, vec2DirToCheckNode;
-
-	if ( file )
+// Frees an array owned by the graph. Arrays that point into
+// the mapped graph file belong to the mapping.
+static void FreeGraphArray( void *pArray )
+{
+	if ( !g_GraphFile.Contains( pArray ) )
 	{
-		fprintf ( file, "----------------------------------------------------------------------------\n" );
-		fprintf ( file, "InLine Rejection:\n" );
-		fprintf ( file, "----------------------------------------------------------------------------\n" );
+		free( pArray );
 	}
+}
 
-	cRejectedLinks = 0;
+// Copies a section into a new allocation, for arrays that are
+// modified at runtime or when the file couldn't be mapped.
+static void *CopyGraphSection( const byte *pFile, const NodeGraphSection_t &section )
+{
+	// calloc( 0 ) may return NULL, which would look like a failure.
+	void *pCopy = malloc( max( section.uiSize, 1U ) );
 
-	for ( i = 0 ; i < m_cNodes ; i++ )
+	if ( pCopy )
 	{
-		pSrcNode = &m_pNodes[ i ];
-
-		if ( file )
-		{
-			fprintf ( file, "Node %3d:\n", i );
-		}
+		memcpy( pCopy, pFile + section.uiOffset, section.uiSize );
+	}
 
-		for ( j = 0 ; j < pSrcNode->m_cNumLinks ; j++ )
-		{
-			pCheckNode = &m_pNodes[ pLinkPool[ pSrcNode->m_iFirstLink + j ].m_iDestNode ];
-
-			vec2DirToCheckNode = ( pCheckNode->m_vecOrigin - pSrcNode->m_vecOrigin ).Make2D(); 
-			flDistToCheckNode = vec2DirToCheckNode.Length();
-			vec2DirToCheckNode = vec2DirToCheckNode.Normalize();
-
-			pLinkPool[ pSrcNode->m_iFirstLink + j ].m_flWeight = flDistToCheckNode;
-
-			fRestartLoop = false;
-			for ( k = 0 ; k < pSrcNode->m_cNumLinks && !fRestartLoop ; k++ )
-			{
-				if ( k == j )
-				{// don't check against same node
-					continue;
-				}
-
-				pTestNode = &m_pNodes [ pLinkPool[ pSrcNode->m_iFirstLink + k ].m_iDestNode ];
-
-				vec2DirToTestNode = ( pTestNode->m_vecOrigin - pSrcNode->m_vecOrigin ).Make2D(); 
-
-				flDistToTestNode = vec2DirToTestNode.Length();
-				vec2DirToTestNode = vec2DirToTestNode.Normalize();
-
-				if ( DotProduct ( vec2DirToCheckNode, vec2DirToTestNode ) >= 0.998 )
-				{
-					// there's a chance that TestNode intersects the line to CheckNode. If so, we should disconnect the link to CheckNode. 
-					if ( flDistToTestNode < flDistToCheckNode )
-					{
-						if ( file )
-						{
-							fprintf ( file, "REJECTED NODE %3d through Node %3d, Dot = %8f\n", pLinkPool[ pSrcNode->m_iFirstLink + j ].m_iDestNode, pLinkPool[ pSrcNode->m_iFirstLink + k ].m_iDestNode, DotProduct ( vec2DirToCheckNode, vec2DirToTestNode ) );
-						}
-
-						pLinkPool[ pSrcNode->m_iFirstLink + j ] = pLinkPool[ pSrcNode->m_iFirstLink + ( pSrcNode->m_cNumLinks - 1 ) ];
-						pSrcNode->m_cNumLinks--;
-						j--;
-
-						cRejectedLinks++;// keeping track of how many links are cut, so that we can return that value.
-
-						fRestartLoop = true;
-					}
-				}
-			}
-		}
-
-		if ( file )
-		{
-			fprintf ( file, "----------------------------------------------------------------------------\n\n" );
-		}
-	}
-
-	return cRejectedLinks;
-}
+	return pCopy;
+}
 
 //=========================================================
 // CGraph - FLoadGraph - attempts to load a node graph from disk.
 // if the current level is maps/snar.bsp, maps/graphs/snar.nod
 // will be loaded. If file cannot be loaded, the node tree
 // will be created and saved to disk.
+//
+// If the file is in the game directory it is memory mapped,
+// and the routing info and hash links are used in place.
+// The nodes, links and sorting info are copied, since those
+// are modified at runtime.
 //=========================================================
 bool CGraph::FLoadGraph( const char* const pszMapName )
 {
 	char	szFilename[MAX_PATH];
-	int		iVersion;
 	int     length;
-	byte    *aMemFile;
-	byte    *pMemFile;
+	byte    *aMemFile = NULL;
+	const byte *pFile;
+	size_t	cbFile;
+	NodeGraphHeader_t header;
+	int		i;
 
 	// make sure the directories have been made
 	char	szDirName[MAX_PATH];
@@ -1426,170 +1594,207 @@ bool CGraph::FLoadGraph( const char* const pszMapName )
 	strcat( szDirName, "/graphs" );
 	MakeDirectory( szDirName );
 
-	strcpy ( szFilename, "maps/graphs/" );
-	strcat ( szFilename, pszMapName );
-	strcat( szFilename, ".nod" );
+	snprintf( szFilename, sizeof( szFilename ), "%s/%s.nod", szDirName, pszMapName );
 
-	pMemFile = aMemFile = LOAD_FILE_FOR_ME(szFilename, &length);
-
-	if ( !aMemFile )
+	if ( g_GraphFile.Open( szFilename ) )
 	{
-		return false;
+		pFile = g_GraphFile.GetData();
+		cbFile = g_GraphFile.GetSize();
 	}
 	else
 	{
-		// Read the graph version number
-		//
-		length -= sizeof(int);
-		if (length < 0) goto ShortFile;
-		memcpy(&iVersion, pMemFile, sizeof(int));
-		pMemFile += sizeof(int);
+		// Not in the game directory, let the engine find it.
+		strcpy ( szFilename, "maps/graphs/" );
+		strcat ( szFilename, pszMapName );
+		strcat( szFilename, ".nod" );
 
-		if ( iVersion != GRAPH_VERSION )
+		aMemFile = LOAD_FILE_FOR_ME(szFilename, &length);
+
+		if ( !aMemFile )
 		{
-			// This file was written by a different build of the dll!
-			//
-			ALERT ( at_aiconsole, "**ERROR** Graph version is %d, expected %d\n",iVersion, GRAPH_VERSION );
-			goto ShortFile;
+			return false;
 		}
 
-		// Read the graph class
-		//
-		length -= sizeof(CGraph);
-		if (length < 0) goto ShortFile;
-		memcpy(this, pMemFile, sizeof(CGraph));
-		pMemFile += sizeof(CGraph);
+		pFile = aMemFile;
+		cbFile = length;
+	}
 
-		// Set the pointers to zero, just in case we run out of memory.
-		//
-		m_pNodes     = NULL;
-		m_pLinkPool  = NULL;
-		m_di         = NULL;
-		m_pRouteInfo = NULL;
-		m_pHashLinks = NULL;
+	const bool fMapped = g_GraphFile.IsOpen();
 
+	// Read the header
+	//
+	if ( cbFile < sizeof( header ) ) goto ShortFile;
+	memcpy( &header, pFile, sizeof( header ) );
 
-		// Malloc for the nodes
+	if ( header.iVersion != GRAPH_VERSION )
+	{
+		// This file was written by a different build of the dll!
 		//
-		m_pNodes = ( CNode * )calloc ( sizeof ( CNode ), m_cNodes );
+		ALERT ( at_aiconsole, "**ERROR** Graph version is %d, expected %d\n", header.iVersion, GRAPH_VERSION );
+		goto BadFile;
+	}
 
-		if ( !m_pNodes )
+	if ( header.iPointerSize != sizeof( void* ) || header.cSections != NODE_SECTION_COUNT )
+	{
+		ALERT ( at_aiconsole, "**ERROR** Graph was written by an incompatible build\n" );
+		goto BadFile;
+	}
+
+	for ( i = 0; i < NODE_SECTION_COUNT; i++ )
+	{
+		const NodeGraphSection_t &section = header.sections[ i ];
+
+		if ( section.uiOffset % NODE_SECTION_ALIGNMENT || section.uiOffset > cbFile || section.uiSize > cbFile - section.uiOffset )
 		{
-			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d nodes!\n", m_cNodes );
-			goto NoMemory;
+			goto ShortFile;
 		}
+	}
 
-		// Read in all the nodes
-		//
-		length -= sizeof(CNode) * m_cNodes;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pNodes, pMemFile, sizeof(CNode)*m_cNodes);
-		pMemFile += sizeof(CNode) * m_cNodes;
+	// Read the graph class
+	//
+	if ( header.sections[ NODE_SECTION_GRAPH ].uiSize != sizeof( CGraph ) ) goto ShortFile;
+	memcpy( this, pFile + header.sections[ NODE_SECTION_GRAPH ].uiOffset, sizeof( CGraph ) );
 
-		
-		// Malloc for the link pool
-		//
-		m_pLinkPool = ( CLink * )calloc ( sizeof ( CLink ), m_cLinks );
+	// Set the pointers to zero, just in case we run out of memory.
+	//
+	m_pNodes     = NULL;
+	m_pLinkPool  = NULL;
+	m_di         = NULL;
+	m_pRouteInfo = NULL;
+	m_pHashLinks = NULL;
+	m_pSearchState  = NULL;
+	m_pCheckedEvent = NULL;
+	m_ppLinkEnts    = NULL;
+
+	if ( m_cNodes < 0 || m_cLinks < 0 || m_nRouteInfo < 0 || m_nHashLinks < 0
+		|| header.sections[ NODE_SECTION_NODES ].uiSize != sizeof( CNode ) * m_cNodes
+		|| header.sections[ NODE_SECTION_LINKS ].uiSize != sizeof( CLink ) * m_cLinks
+		|| header.sections[ NODE_SECTION_DIST_INFO ].uiSize != sizeof( DIST_INFO ) * m_cNodes
+		|| header.sections[ NODE_SECTION_ROUTE_INFO ].uiSize != sizeof( char ) * m_nRouteInfo
+		|| header.sections[ NODE_SECTION_HASH_LINKS ].uiSize != sizeof( int ) * m_nHashLinks )
+	{
+		goto ShortFile;
+	}
+
+	// Nothing writes to the saved arrays once the graph is loaded; searches and link entities use
+	// the graph state instead. The route info and hash links are only ever replaced.
+	// Empty sections can point at the end of the file, so they aren't used.
+	//
+	if ( fMapped )
+	{
+		m_pNodes     = m_cNodes > 0 ? ( CNode * )( pFile + header.sections[ NODE_SECTION_NODES ].uiOffset ) : NULL;
+		m_pLinkPool  = m_cLinks > 0 ? ( CLink * )( pFile + header.sections[ NODE_SECTION_LINKS ].uiOffset ) : NULL;
+		m_di         = m_cNodes > 0 ? ( DIST_INFO * )( pFile + header.sections[ NODE_SECTION_DIST_INFO ].uiOffset ) : NULL;
+		m_pRouteInfo = m_nRouteInfo > 0 ? ( char * )( pFile + header.sections[ NODE_SECTION_ROUTE_INFO ].uiOffset ) : NULL;
+		m_pHashLinks = m_nHashLinks > 0 ? ( int * )( pFile + header.sections[ NODE_SECTION_HASH_LINKS ].uiOffset ) : NULL;
+	}
+	else
+	{
+		m_pNodes     = ( CNode * )CopyGraphSection( pFile, header.sections[ NODE_SECTION_NODES ] );
+		m_pLinkPool  = ( CLink * )CopyGraphSection( pFile, header.sections[ NODE_SECTION_LINKS ] );
+		m_di         = ( DIST_INFO * )CopyGraphSection( pFile, header.sections[ NODE_SECTION_DIST_INFO ] );
+		m_pRouteInfo = ( char * )CopyGraphSection( pFile, header.sections[ NODE_SECTION_ROUTE_INFO ] );
+		m_pHashLinks = ( int * )CopyGraphSection( pFile, header.sections[ NODE_SECTION_HASH_LINKS ] );
 
-		if ( !m_pLinkPool )
+		if ( !m_pNodes || !m_pLinkPool || !m_di || !m_pRouteInfo || !m_pHashLinks )
 		{
-			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d link!\n", m_cLinks );
+			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d nodes!\n", m_cNodes );
 			goto NoMemory;
 		}
+	}
 
-		// Read in all the links
-		//
-		length -= sizeof(CLink)*m_cLinks;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pLinkPool, pMemFile, sizeof(CLink)*m_cLinks);
-		pMemFile += sizeof(CLink)*m_cLinks;
+	// Link entity pointers are set by FSetGraphPointers.
+	//
+	if ( !AllocGraphState() )
+	{
+		goto NoMemory;
+	}
 
-		// Malloc for the sorting info.
-		//
-		m_di = (DIST_INFO *)calloc( sizeof(DIST_INFO), m_cNodes );
-		if ( !m_di )
-		{
-			ALERT ( at_aiconsole, "***ERROR**\nCouldn't malloc %d entries sorting nodes!\n", m_cNodes );
-			goto NoMemory;
-		}
+	// Large graphs store hierarchical routing tables instead of flat ones.
+	//
+	if ( header.sections[ NODE_SECTION_HIERARCHY ].uiSize > 0
+		&& !g_NodeHierarchy.Deserialize( *this, pFile + header.sections[ NODE_SECTION_HIERARCHY ].uiOffset, header.sections[ NODE_SECTION_HIERARCHY ].uiSize ) )
+	{
+		ALERT ( at_aiconsole, "**ERROR** Graph has invalid routing tables\n" );
+		goto BadFile;
+	}
 
-		// Read it in.
-		//
-		length -= sizeof(DIST_INFO)*m_cNodes;
-		if (length < 0) goto ShortFile;
-		memcpy(m_di, pMemFile, sizeof(DIST_INFO)*m_cNodes);
-		pMemFile += sizeof(DIST_INFO)*m_cNodes;
+	m_fRoutingComplete = m_nRouteInfo > 0 || g_NodeHierarchy.IsBuilt();
 
-		// Malloc for the routing info.
-		//
-		m_fRoutingComplete = false;
-		m_pRouteInfo = (char *)calloc( sizeof(char), m_nRouteInfo );
-		if ( !m_pRouteInfo )
-		{
-			ALERT ( at_aiconsole, "***ERROR**\nCounldn't malloc %d route bytes!\n", m_nRouteInfo );
-			goto NoMemory;
-		}
-		m_CheckedCounter = 0;
-		for (int i = 0; i < m_cNodes; i++)
-		{
-			m_di[i].m_CheckedEvent = 0;
-		}
-		
-		// Read in the route information.
-		//
-		length -= sizeof(char)*m_nRouteInfo;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pRouteInfo, pMemFile, sizeof(char)*m_nRouteInfo);
-		pMemFile += sizeof(char)*m_nRouteInfo;
-		m_fRoutingComplete = true;
+	// Without routing tables, ComputeStaticRoutingTables writes the route offsets into the nodes.
+	//
+	if ( fMapped && !m_fRoutingComplete && m_cNodes > 0 )
+	{
+		m_pNodes = ( CNode * )CopyGraphSection( pFile, header.sections[ NODE_SECTION_NODES ] );
 
-		// malloc for the hash links
-		//
-		m_pHashLinks = (short *)calloc(sizeof(short), m_nHashLinks);
-		if (!m_pHashLinks)
+		if ( !m_pNodes )
 		{
-			ALERT ( at_aiconsole, "***ERROR**\nCounldn't malloc %d hash link bytes!\n", m_nHashLinks );
+			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d nodes!\n", m_cNodes );
 			goto NoMemory;
 		}
+	}
 
-		// Read in the hash link information
-		//
-		length -= sizeof(short)*m_nHashLinks;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pHashLinks, pMemFile, sizeof(short)*m_nHashLinks);
-		pMemFile += sizeof(short)*m_nHashLinks;
-
-		// Set the graph present flag, clear the pointers set flag
-		//
-		m_fGraphPresent = true;
-		m_fGraphPointersSet = false;
-		
-		FREE_FILE(aMemFile);
+	// The visibility matrix is optional. Without one, it's built once the world is loaded.
+	//
+	if ( header.sections[ NODE_SECTION_VISIBILITY ].uiSize > 0
+		&& !g_NodeVisibility.Deserialize( *this, pFile + header.sections[ NODE_SECTION_VISIBILITY ].uiOffset, header.sections[ NODE_SECTION_VISIBILITY ].uiSize ) )
+	{
+		ALERT ( at_aiconsole, "Graph has an unusable visibility matrix, ignoring\n" );
+	}
 
-		if (length != 0)
-		{
-			ALERT ( at_aiconsole, "***WARNING***:Node graph was longer than expected by %d bytes.!\n", length);
-		}
+	// Graphs written by the node graph compiler don't have the link lookup
+	// table, because it hashes with the engine's CRC functions.
+	//
+	if ( m_nHashLinks == 0 && m_cLinks > 0 )
+	{
+		FreeGraphArray( m_pHashLinks );
+		m_pHashLinks = NULL;
+		BuildLinkLookups();
+	}
 
-		return true;
+	if ( aMemFile )
+	{
+		FREE_FILE( aMemFile );
 	}
 
+	// The grid isn't saved, so build it now.
+	//
+	g_NodeGrid.Build( *this );
+
+	// Set the graph present flag, clear the pointers set flag
+	//
+	m_fGraphPresent = true;
+	m_fGraphPointersSet = false;
+
+	ALERT ( at_aiconsole, "Loaded %s (%s)\n", szFilename, fMapped ? "mapped" : "copied" );
+
+	return true;
+
 ShortFile:
+	ALERT ( at_aiconsole, "**ERROR** Graph file is truncated or corrupt\n" );
+BadFile:
 NoMemory:
-	FREE_FILE(aMemFile);
+	if ( aMemFile )
+	{
+		FREE_FILE( aMemFile );
+	}
+
+	// Frees any arrays that were loaded and unmaps the file.
+	InitGraph();
 	return false;
 }
 
 //=========================================================
 // CGraph - FSaveGraph - It's not rocket science.
 // this WILL overwrite existing files.
+//
+// The file is written under a temporary name first and then
+// renamed, so other servers that have the old file mapped
+// keep using it.
 //=========================================================
 bool CGraph::FSaveGraph( const char* const pszMapName ) const
 {
-	
-	int		iVersion = GRAPH_VERSION;
 	char	szFilename[MAX_PATH];
-	FILE	*file;
 
 	if ( !m_fGraphPresent || !m_fGraphPointersSet )
 	{// protect us in the case that the node graph isn't available or built
@@ -1608,67 +1813,45 @@ bool CGraph::FSaveGraph( const char* const pszMapName ) const
 	strcat( szFilename, pszMapName );
 	strcat( szFilename, ".nod" );
 
-	file = fopen ( szFilename, "wb" );
+	std::vector<unsigned char> hierarchyData;
+	g_NodeHierarchy.Serialize( hierarchyData );
 
-	ALERT ( at_aiconsole, "Created: %s\n", szFilename );
+	std::vector<unsigned char> visibilityData;
+	g_NodeVisibility.Serialize( visibilityData );
 
-	if ( !file )
-	{// couldn't create
-		ALERT ( at_aiconsole, "Couldn't Create: %s\n", szFilename );
+	if ( !WriteGraphFile( szFilename, hierarchyData, visibilityData ) )
+	{
 		return false;
 	}
-	else
-	{
-	// write the version
-		fwrite ( &iVersion, sizeof ( int ), 1, file );
-
-	// write the CGraph class
-		fwrite ( this, sizeof ( CGraph ), 1, file );
-
-	// write the nodes
-		fwrite ( m_pNodes, sizeof ( CNode ), m_cNodes, file );
-
-	// write the links
-		fwrite ( m_pLinkPool, sizeof ( CLink ), m_cLinks, file );
-
-		fwrite ( m_di, sizeof(DIST_INFO), m_cNodes, file );
-
-		// Write the route info.
-		//
-		if ( m_pRouteInfo && m_nRouteInfo )
-		{
-			fwrite ( m_pRouteInfo, sizeof( char ), m_nRouteInfo, file );
-		}
 
-		if (m_pHashLinks && m_nHashLinks)
-		{
-			fwrite(m_pHashLinks, sizeof(short), m_nHashLinks, file);
-		}
-		fclose ( file );
-		return true;
-	}
+	ALERT ( at_aiconsole, "Created: %s\n", szFilename );
+	return true;
 }
 
 //=========================================================
 // CGraph - FSetGraphPointers - Takes the modelnames of 
 // all of the brush ents that block connections in the node
 // graph and resolves them into pointers to those entities.
-// this is done after loading the graph from disk, whereupon
-// the pointers are not valid.
+// this is done after loading or building the graph. The
+// pointers go in m_ppLinkEnts; the links aren't modified.
 //=========================================================
 bool CGraph::FSetGraphPointers()
 {
 	CBaseEntity* pLinkEnt;
 
+	// link states are built from the pointers once they're set.
+	g_LinkStateCache.Clear();
+
 	for ( int i = 0 ; i < m_cLinks ; i++ )
 	{// go through all of the links
 		
-		if ( m_pLinkPool[ i ].m_pLinkEnt != NULL )
+		m_ppLinkEnts[ i ] = nullptr;
+
+		if ( m_pLinkPool[ i ].HasLinkEnt() )
 		{
 			char name[5];
-			// when graphs are saved, any valid pointers are will be non-zero, signifying that we should
-			// reset those pointers upon reloading. Any pointers that were NULL when the graph was saved
-			// will be NULL when reloaded, and will ignored by this function.
+			// links that were blocked by an entity when the graph was built have its model name.
+			// Links without one have no entity, and are ignored by this function.
 
 			// m_szLinkEntModelname is not necessarily NULL terminated (so we can store it in a more alignment-friendly 4 bytes)
 			memcpy( name, m_pLinkPool[ i ].m_szLinkEntModelname, 4 );
@@ -1680,15 +1863,14 @@ bool CGraph::FSetGraphPointers()
 			// the ent isn't around anymore? Either there is a major problem, or it was removed from the world
 			// ( like a func_breakable that's been destroyed or something ). Make sure that LinkEnt is null.
 				ALERT ( at_aiconsole, "**Could not find model %s\n", name );
-				m_pLinkPool[ i ].m_pLinkEnt = nullptr;
 			}
 			else
 			{
-				m_pLinkPool[ i ].m_pLinkEnt = pLinkEnt->pev;
+				m_ppLinkEnts[ i ] = pLinkEnt->pev;
 
-				if ( !FBitSet( m_pLinkPool[ i ].m_pLinkEnt->flags, FL_GRAPHED ) )
+				if ( !FBitSet( m_ppLinkEnts[ i ]->flags, FL_GRAPHED ) )
 				{
-					m_pLinkPool[ i ].m_pLinkEnt->flags += FL_GRAPHED;
+					m_ppLinkEnts[ i ]->flags += FL_GRAPHED;
 				}
 			}
 		}
@@ -1883,79 +2065,12 @@ void CGraph::HashChoosePrimes(int TableSize)
     }
 }
 
-// Renumber nodes so that nodes that link together are together.
-//
-#define UNNUMBERED_NODE -1
-void CGraph::SortNodes(void)
-{
-	// We are using m_iPreviousNode to be the new node number.
-	// After assigning new node numbers to everything, we move
-	// things and patchup the links.
-	//
-	int iNodeCnt = 0;
-	int i;
-	m_pNodes[0].m_iPreviousNode = iNodeCnt++;
-
-	for (i = 1; i < m_cNodes; i++)
-	{
-		m_pNodes[i].m_iPreviousNode = UNNUMBERED_NODE;
-	}
-
-	for (i = 0; i < m_cNodes; i++)
-	{
-		// Run through all of this node's neighbors
-		//
-		for (int j = 0 ; j < m_pNodes[i].m_cNumLinks; j++ )
-		{
-			int iDestNode = INodeLink(i, j);
-			if (m_pNodes[iDestNode].m_iPreviousNode == UNNUMBERED_NODE)
-			{
-				m_pNodes[iDestNode].m_iPreviousNode = iNodeCnt++;
-			}
-		}
-	}
-
-	// Assign remaining node numbers to unlinked nodes.
-	//
-	for (i = 0; i < m_cNodes; i++)
-	{
-		if (m_pNodes[i].m_iPreviousNode == UNNUMBERED_NODE)
-		{
-			m_pNodes[i].m_iPreviousNode = iNodeCnt++;
-		}
-	}
-
-	// Alter links to reflect new node numbers.
-	//
-	for (i = 0; i < m_cLinks; i++)
-	{
-		m_pLinkPool[i].m_iSrcNode  = m_pNodes[m_pLinkPool[i].m_iSrcNode].m_iPreviousNode;
-		m_pLinkPool[i].m_iDestNode = m_pNodes[m_pLinkPool[i].m_iDestNode].m_iPreviousNode;
-	}
-
-	// Rearrange nodes to reflect new node numbering.
-	//
-	for (i = 0; i < m_cNodes; i++)
-	{
-		while (m_pNodes[i].m_iPreviousNode != i)
-		{
-			// Move current node off to where it should be, and bring
-			// that other node back into the current slot.
-			//
-			int iDestNode = m_pNodes[i].m_iPreviousNode;
-			CNode TempNode = m_pNodes[iDestNode];
-			m_pNodes[iDestNode] = m_pNodes[i];
-			m_pNodes[i] = TempNode;
-		}
-	}
-}
-
 void CGraph::BuildLinkLookups(void)
 {
 	m_nHashLinks = 3*m_cLinks/2 + 3;
 
 	HashChoosePrimes(m_nHashLinks);
-	m_pHashLinks = (short *)calloc(sizeof(short), m_nHashLinks);
+	m_pHashLinks = (int *)calloc(sizeof(int), m_nHashLinks);
 	if (!m_pHashLinks)
 	{
 		ALERT(at_aiconsole, "Couldn't allocated Link Lookup Table.\n");
@@ -1986,157 +2101,34 @@ void CGraph::BuildLinkLookups(void)
 #endif
 }
 
+//=========================================================
+// CGraph - BuildRegionTables - builds the tables used by
+// FindNearestNode.
+//=========================================================
 void CGraph::BuildRegionTables(void)
 {
-	if (m_di) free(m_di);
-
-	// Go ahead and setup for range searching the nodes for FindNearestNodes
-	//
-	m_di = (DIST_INFO *)calloc(sizeof(DIST_INFO), m_cNodes);
-	if (!m_di)
-	{
-		ALERT(at_aiconsole, "Couldn't allocated node ordering array.\n");
-		return;
-	}
-
-	// Calculate regions for all the nodes.
-	//
-	//
-	int i;
-	for (i = 0; i < 3; i++)
-	{
-		m_RegionMin[i] =  999999999.0; // just a big number out there;
-		m_RegionMax[i] = -999999999.0; // just a big number out there;
-	}
-	for (i = 0; i < m_cNodes; i++)
-	{
-		if (m_pNodes[i].m_vecOrigin.x < m_RegionMin[0])
-			m_RegionMin[0] = m_pNodes[i].m_vecOrigin.x;
-		if (m_pNodes[i].m_vecOrigin.y < m_RegionMin[1])
-			m_RegionMin[1] = m_pNodes[i].m_vecOrigin.y;
-		if (m_pNodes[i].m_vecOrigin.z < m_RegionMin[2])
-			m_RegionMin[2] = m_pNodes[i].m_vecOrigin.z;
-
-		if (m_pNodes[i].m_vecOrigin.x > m_RegionMax[0])
-			m_RegionMax[0] = m_pNodes[i].m_vecOrigin.x;
-		if (m_pNodes[i].m_vecOrigin.y > m_RegionMax[1])
-			m_RegionMax[1] = m_pNodes[i].m_vecOrigin.y;
-		if (m_pNodes[i].m_vecOrigin.z > m_RegionMax[2])
-			m_RegionMax[2] = m_pNodes[i].m_vecOrigin.z;
-	}
-	for (i = 0; i < m_cNodes; i++)
-	{
-		m_pNodes[i].m_Region[0] = CALC_RANGE(m_pNodes[i].m_vecOrigin.x, m_RegionMin[0], m_RegionMax[0]);
-		m_pNodes[i].m_Region[1] = CALC_RANGE(m_pNodes[i].m_vecOrigin.y, m_RegionMin[1], m_RegionMax[1]);
-		m_pNodes[i].m_Region[2] = CALC_RANGE(m_pNodes[i].m_vecOrigin.z, m_RegionMin[2], m_RegionMax[2]);
-	}
-
-	for (i = 0; i < 3; i++)
-	{
-		int j;
-		for (j = 0; j < NUM_RANGES; j++)
-		{
-			m_RangeStart[i][j] = 255;
-			m_RangeEnd[i][j] = 0;
-		}
-		for (j = 0; j < m_cNodes; j++)
-		{
-			m_di[j].m_SortedBy[i] = j;
-		}
-
-		for (j = 0; j < m_cNodes - 1; j++)
-		{
-			int jNode = m_di[j].m_SortedBy[i];
-			int jCodeX = m_pNodes[jNode].m_Region[0];
-			int jCodeY = m_pNodes[jNode].m_Region[1];
-			int jCodeZ = m_pNodes[jNode].m_Region[2];
-			int jCode;
-			switch (i)
-			{
-			case 0:
-				jCode = (jCodeX << 16) + (jCodeY << 8) + jCodeZ;
-				break;
-			case 1:
-				jCode = (jCodeY << 16) + (jCodeZ << 8) + jCodeX;
-				break;
-			case 2:
-				jCode = (jCodeZ << 16) + (jCodeX << 8) + jCodeY;
-				break;
-			}
+	BuildRangeTables();
 
-			for (int k = j+1; k < m_cNodes; k++)
-			{
-				int kNode = m_di[k].m_SortedBy[i];
-				int kCodeX = m_pNodes[kNode].m_Region[0];
-				int kCodeY = m_pNodes[kNode].m_Region[1];
-				int kCodeZ = m_pNodes[kNode].m_Region[2];
-				int kCode;
-				switch (i)
-				{
-				case 0:
-					kCode = (kCodeX << 16) + (kCodeY << 8) + kCodeZ;
-					break;
-				case 1:
-					kCode = (kCodeY << 16) + (kCodeZ << 8) + kCodeX;
-					break;
-				case 2:
-					kCode = (kCodeZ << 16) + (kCodeX << 8) + kCodeY;
-					break;
-				}
+	g_NodeGrid.Build( *this );
+}
 
-				if (kCode < jCode)
-				{
-					// Swap j and k entries.
-					//
-					int Tmp = m_di[j].m_SortedBy[i];
-					m_di[j].m_SortedBy[i] = m_di[k].m_SortedBy[i];
-					m_di[k].m_SortedBy[i] = Tmp;
-				}
-			}
-		}
-	}
+void CGraph :: ComputeStaticRoutingTables( void )
+{
+	g_NodeHierarchy.Clear();
 
-	// Generate lookup tables.
+	// The flat tables need m_cNodes * m_cNodes entries while they are being built,
+	// so large graphs route through regions of nodes instead.
 	//
-	for (i = 0; i < m_cNodes; i++)
+	if ( m_cNodes > FLAT_ROUTING_MAX_NODES || sv_nodegraph_hierarchy.value != 0 )
 	{
-		int CodeX = m_pNodes[m_di[i].m_SortedBy[0]].m_Region[0];
-		int CodeY = m_pNodes[m_di[i].m_SortedBy[1]].m_Region[1];
-		int CodeZ = m_pNodes[m_di[i].m_SortedBy[2]].m_Region[2];
+		ALERT( at_aiconsole, "Computing hierarchical routing tables for %d nodes\n", m_cNodes );
 
-        if (i < m_RangeStart[0][CodeX])
-        {
-            m_RangeStart[0][CodeX] = i;
-        }
-        if (i < m_RangeStart[1][CodeY])
-        {
-            m_RangeStart[1][CodeY] = i;
-        }
-        if (i < m_RangeStart[2][CodeZ])
-        {
-            m_RangeStart[2][CodeZ] = i;
-        }
-        if (m_RangeEnd[0][CodeX] < i)
-        {
-            m_RangeEnd[0][CodeX] = i;
-        }
-        if (m_RangeEnd[1][CodeY] < i)
-        {
-            m_RangeEnd[1][CodeY] = i;
-        }
-        if (m_RangeEnd[2][CodeZ] < i)
-        {
-            m_RangeEnd[2][CodeZ] = i;
-        }
+		m_fRoutingComplete = g_NodeHierarchy.Build( *this,
+			[ this ]( int iLink, int afCapMask ) { return IsLinkPassable( iLink, afCapMask, NODEGRAPH_STATIC ); },
+			CRoutingTableBuilder::GetDesiredThreadCount() );
+		return;
 	}
 
-	// Initialize the cache.
-	//
-	memset(m_Cache, 0, sizeof(m_Cache));
-}
-
-void CGraph :: ComputeStaticRoutingTables( void )
-{
 	int nRoutes = m_cNodes*m_cNodes;
 #define FROM_TO(x,y) ((x)*m_cNodes+(y))
 	short *Routes = new( std::nothrow ) short[nRoutes];
@@ -2146,6 +2138,17 @@ void CGraph :: ComputeStaticRoutingTables( void )
 	char *pRoute = new( std::nothrow ) char[m_cNodes*2];
 
 
+	// Searches are independent of each other, so they can be spread across threads.
+	std::unique_ptr<CRoutingTableBuilder> builder;
+
+	const int iNumThreads = CRoutingTableBuilder::GetDesiredThreadCount();
+
+	if ( iNumThreads > 1 )
+	{
+		builder = std::make_unique<CRoutingTableBuilder>( *this, iNumThreads );
+		ALERT( at_aiconsole, "Computing routing tables using %d threads\n", iNumThreads );
+	}
+
 	if (Routes && pMyPath && BestNextNodes && pRoute)
 	{
 		int nTotalCompressedSize = 0;
@@ -2166,6 +2169,11 @@ void CGraph :: ComputeStaticRoutingTables( void )
 				}
 
 
+				if ( builder && !builder->BuildPathTrees( iHull, iCapMask ) )
+				{// fall back to searching on this thread.
+					builder.reset();
+				}
+
 				// Initialize Routing table to uncalculated.
 				//
 				int iFrom;
@@ -2183,7 +2191,7 @@ void CGraph :: ComputeStaticRoutingTables( void )
 					{
 						if (Routes[FROM_TO(iFrom, iTo)] != -1) continue;
 
-						int cPathSize = FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask);
+						int cPathSize = builder ? builder->GetPath(pMyPath, iFrom, iTo) : FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask, GraphSearchMode::DIJKSTRA);
 
 						// Use the computed path to update the routing table.
 						//
@@ -2234,155 +2242,10 @@ void CGraph :: ComputeStaticRoutingTables( void )
 
 					// Compress this node's routing table.
 					//
-					int iLastNode = 9999999; // just really big.
-					int cSequence = 0;
-					int cRepeats = 0;
-					int CompressedSize = 0;
-					char *p = pRoute;
-					for (int i = 0; i < m_cNodes; i++)
-					{
-						const bool CanRepeat = ((BestNextNodes[i] == iLastNode) && cRepeats < 127);
-						const bool CanSequence = (BestNextNodes[i] == i && cSequence < 128);
-
-						if (cRepeats)
-						{
-							if (CanRepeat)
-							{
-								cRepeats++;
-							}
-							else
-							{
-								// Emit the repeat phrase.
-								//
-								CompressedSize += 2; // (count-1, iLastNode-i)
-								*p++ = cRepeats - 1;
-								int a = iLastNode - iFrom;
-								int b = iLastNode - iFrom + m_cNodes;
-								int c = iLastNode - iFrom - m_cNodes;
-								if (-128 <= a && a <= 127)
-								{
-									*p++ = a;
-								}
-								else if (-128 <= b && b <= 127)
-								{
-									*p++ = b;
-								}
-								else if (-128 <= c && c <= 127)
-								{
-									*p++ = c;
-								}
-								else
-								{
-									ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom);
-								}
-								cRepeats = 0;
-
-								if (CanSequence)
-								{
-									// Start a sequence.
-									//
-									cSequence++;
-								}
-								else
-								{
-									// Start another repeat.
-									//
-									cRepeats++;
-								}
-							}
-						}
-						else if (cSequence)
-						{
-							if (CanSequence)
-							{
-								cSequence++;
-							}
-							else
-							{
-								// It may be advantageous to combine
-								// a single-entry sequence phrase with the
-								// next repeat phrase.
-								//
-								if (cSequence == 1 && CanRepeat)
-								{
-									// Combine with repeat phrase.
-									//
-									cRepeats = 2;
-									cSequence = 0;
-								}
-								else
-								{
-									// Emit the sequence phrase.
-									//
-									CompressedSize += 1; // (-count)
-									*p++ = -cSequence;
-									cSequence = 0;
-
-									// Start a repeat sequence.
-									//
-									cRepeats++;
-								}
-							}
-						}
-						else
-						{
-							if (CanSequence)
-							{
-								// Start a sequence phrase.
-								//
-								cSequence++;
-							}
-							else
-							{
-								// Start a repeat sequence.
-								//
-								cRepeats++;
-							}
-						}
-						iLastNode = BestNextNodes[i];
-					}
-					if (cRepeats)
-					{
-						// Emit the repeat phrase.
-						//
-						CompressedSize += 2;
-						*p++ = cRepeats - 1;
-#if 0
-						iLastNode = iFrom + *pRoute;
-						if (iLastNode >= m_cNodes) iLastNode -= m_cNodes;
-						else if (iLastNode < 0) iLastNode += m_cNodes;
-#endif
-						int a = iLastNode - iFrom;
-						int b = iLastNode - iFrom + m_cNodes;
-						int c = iLastNode - iFrom - m_cNodes;
-						if (-128 <= a && a <= 127)
-						{
-							*p++ = a;
-						}
-						else if (-128 <= b && b <= 127)
-						{
-							*p++ = b;
-						}
-						else if (-128 <= c && c <= 127)
-						{
-							*p++ = c;
-						}
-						else
-						{
-							ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom);
-						}
-					}
-					if (cSequence)
-					{
-						// Emit the Sequence phrase.
-						//
-						CompressedSize += 1;
-						*p++ = -cSequence;
-					}
+					int nRoute = CompressRoute(BestNextNodes, m_cNodes, iFrom, pRoute);
 
 					// Go find a place to store this thing and point to it.
 					//
-					int nRoute = p - pRoute;
 					if (m_pRouteInfo)
 					{
 						int i;
@@ -2401,12 +2264,12 @@ void CGraph :: ComputeStaticRoutingTables( void )
 						{
 							char *Tmp = (char *)calloc(sizeof(char), (m_nRouteInfo + nRoute));
 							memcpy(Tmp, m_pRouteInfo, m_nRouteInfo);
-							free(m_pRouteInfo);
+							FreeGraphArray(m_pRouteInfo);
 							m_pRouteInfo = Tmp;
 							memcpy(m_pRouteInfo + m_nRouteInfo, pRoute, nRoute);
 							m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = m_nRouteInfo;
 							m_nRouteInfo += nRoute;
-							nTotalCompressedSize += CompressedSize;
+							nTotalCompressedSize += nRoute;
 						}
 					}
 					else
@@ -2415,7 +2278,7 @@ void CGraph :: ComputeStaticRoutingTables( void )
 						m_pRouteInfo = (char *)calloc(sizeof(char), nRoute);
 						memcpy(m_pRouteInfo, pRoute, nRoute);
 						m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = 0;
-						nTotalCompressedSize += CompressedSize;
+						nTotalCompressedSize += nRoute;
 					}
 				}
 			}
@@ -2466,7 +2329,7 @@ void CGraph :: TestRoutingTables( void )
 					for (int iTo = 0; iTo < m_cNodes; iTo++)
 					{
 						m_fRoutingComplete = false;
-						int cPathSize1 = FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask);
+						int cPathSize1 = FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask, GraphSearchMode::DIJKSTRA);
 						m_fRoutingComplete = true;
 						int cPathSize2 = FindShortestPath(pMyPath2, iFrom, iTo, iHull, iCapMask);
 
@@ -2543,7 +2406,7 @@ void CGraph :: TestRoutingTables( void )
 							}
 							ALERT(at_aiconsole, "\n");
 							m_fRoutingComplete = false;
-							cPathSize1 = FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask);
+							cPathSize1 = FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask, GraphSearchMode::DIJKSTRA);
 							m_fRoutingComplete = true;
 							cPathSize2 = FindShortestPath(pMyPath2, iFrom, iTo, iHull, iCapMask);
 							goto EnoughSaid;
@@ -18,13 +18,15 @@
 #ifndef GAME_SERVER_NODES_CGRAPH_H
 #define GAME_SERVER_NODES_CGRAPH_H
 
+#include <vector>
+
 #include "CNode.h"
 #include "CLink.h"
+#include "CGraphSearch.h"
 
 struct DIST_INFO
 {
 	int m_SortedBy[3];
-	int m_CheckedEvent;
 };
 
 struct CACHE_ENTRY
@@ -40,7 +42,49 @@ struct CACHE_ENTRY
 enum GraphVersion
 {
 	HL_SDK_GRAPH_VERSION = 16,
-	GRAPH_VERSION				// !!!increment this whever graph/node/link classes change, to obsolesce older disk files.
+	HLE_GRAPH_VERSION,			// HLEnhanced class layouts.
+	MAPPED_GRAPH_VERSION,		// Arrays are stored in aligned sections, described by NodeGraphHeader_t.
+	HIERARCHY_GRAPH_VERSION,	// Hierarchical routing tables, int hash links.
+	VISIBILITY_GRAPH_VERSION,	// Node to node visibility matrix.
+	READ_ONLY_GRAPH_VERSION,	// Search state and link entity pointers moved out of the nodes, links and dist info.
+	GRAPH_VERSION = READ_ONLY_GRAPH_VERSION	// !!!increment this whever graph/node/link classes change, to obsolesce older disk files.
+};
+
+//=========================================================
+// Node graph file layout. The header is followed by one
+// section per array, each starting at an offset that is a
+// multiple of NODE_SECTION_ALIGNMENT. Offsets are relative
+// to the start of the file, so the file can be memory mapped
+// and the sections used in place.
+//=========================================================
+enum NodeGraphSection
+{
+	NODE_SECTION_GRAPH = 0,		// the CGraph class
+	NODE_SECTION_NODES,			// m_pNodes
+	NODE_SECTION_LINKS,			// m_pLinkPool
+	NODE_SECTION_DIST_INFO,		// m_di
+	NODE_SECTION_ROUTE_INFO,	// m_pRouteInfo
+	NODE_SECTION_HASH_LINKS,	// m_pHashLinks
+	NODE_SECTION_HIERARCHY,		// CNodeHierarchy tables, empty if the graph uses flat routing tables
+	NODE_SECTION_VISIBILITY,	// CNodeVisibility matrix, empty if it wasn't built
+
+	NODE_SECTION_COUNT
+};
+
+#define NODE_SECTION_ALIGNMENT 64
+
+struct NodeGraphSection_t
+{
+	unsigned int uiOffset;
+	unsigned int uiSize;
+};
+
+struct NodeGraphHeader_t
+{
+	int iVersion;		// GRAPH_VERSION. Must come first so older files are rejected.
+	int iPointerSize;	// sizeof( void* ) of the build that wrote the file. CGraph contains pointers.
+	int cSections;		// NODE_SECTION_COUNT
+	NodeGraphSection_t sections[ NODE_SECTION_COUNT ];
 };
 
 class CGraph
@@ -56,6 +100,11 @@ public:
 	CLink	*m_pLinkPool;// big list of all node connections
 	char    *m_pRouteInfo; // compressed routing information the nodes use.
 
+	// Runtime state that isn't saved. It's kept apart from the nodes and links,
+	// so those can stay in the mapped graph file. See AllocGraphState.
+	NodeSearchState_t	*m_pSearchState;// m_cNodes long, used by FindShortestPathDijkstra
+	entvars_t			**m_ppLinkEnts;// m_cLinks long, the entity that blocks each link (doors, etc). Set by FSetGraphPointers.
+
 	int		m_cNodes;// total number of nodes
 	int		m_cLinks;// total number of links
 	int     m_nRouteInfo; // size of m_pRouteInfo in bytes.
@@ -79,12 +128,13 @@ public:
 	int m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ;
 	int m_minBoxX, m_minBoxY, m_minBoxZ, m_maxBoxX, m_maxBoxY, m_maxBoxZ;
 	int m_CheckedCounter;
+	int *m_pCheckedEvent;	// m_cNodes long. The value of m_CheckedCounter when CheckNode last looked at each node.
 	Vector m_RegionMin, m_RegionMax; // The range of nodes.
 	CACHE_ENTRY m_Cache[ NODE_CACHE_SIZE ];
 
 
 	int m_HashPrimes[16];
-	short *m_pHashLinks;
+	int *m_pHashLinks;
 	int m_nHashLinks;
 
 
@@ -99,9 +149,11 @@ public:
 	// functions to create the graph
 	int		LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode );
 	int		RejectInlineLinks ( CLink *pLinkPool, FILE *file );
-	int		FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask);
+	int		FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask, GraphSearchMode mode = GraphSearchMode::DEFAULT );
+	int		FindShortestPathDijkstra ( int *piPath, int iStart, int iDest, int iHull, int afCapMask, int& cNodesExpanded );
 	int		FindNearestNode ( const Vector &vecOrigin, const CBaseEntity* const pEntity );
 	int		FindNearestNode ( const Vector &vecOrigin, int afNodeTypes );
+	void	FindNearestNodeInRegions ( const Vector &vecOrigin, int afNodeTypes );
 	//int		FindNearestLink ( const Vector &vecTestPoint, int *piNearestLink, bool *pfAlongLine );
 	float	PathLength( int iStart, int iDest, int iHull, int afCapMask );
 	int		NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap );
@@ -111,18 +163,26 @@ public:
 	// A dynamic query means we're asking about it RIGHT NOW.  So we should query the current state
 	bool	HandleLinkEnt ( int iNode, entvars_t *pevLinkEnt, int afCapMask, NODEQUERY queryType );
 	entvars_t*	LinkEntForLink ( CLink *pLink, CNode *pNode );
+	bool	IsLinkPassable ( int iLink, int afCapMask, NODEQUERY queryType );
+	void	LinkEntStateChanged ( const entvars_t *pevLinkEnt );
+	void	LinkEntRemoved ( const entvars_t *pevLinkEnt );
 	void	ShowNodeConnections ( int iNode );
 	void	InitGraph( void );
 	bool	AllocNodes();
+	bool	AllocGraphState();
 	
 	bool	CheckNODFile( const char* const pszMapName ) const;
 	bool	FLoadGraph( const char* pszMapName );
 	bool	FSaveGraph( const char* pszMapName ) const;
+	bool	WriteGraphFile( const char* pszFilename, const std::vector<unsigned char>& hierarchyData, const std::vector<unsigned char>& visibilityData ) const;
 	bool	FSetGraphPointers();
 	void	CheckNode(Vector vecOrigin, int iNode);
 
 	void    BuildRegionTables(void);
+	void    BuildRangeTables(void);
 	void    ComputeStaticRoutingTables(void);
+	static int	CompressRoute( const unsigned short *pBestNextNodes, int cNodes, int iFrom, char *pRoute );
+	static int	DecodeRoute( const char *pRoute, int iCurrentNode, int iDest, int cNodes );
 	void    TestRoutingTables(void);
 
 	void	HashInsert(int iSrcNode, int iDestNode, int iKey);
@@ -132,6 +192,7 @@ public:
 
 	void    SortNodes(void);
 
+	static int	HullLinkMask( int iHull );					// link bits a hull needs to pass through a connection
 	int			HullIndex( const CBaseEntity *pEntity );	// what hull the monster uses
 	int			NodeType( const CBaseEntity *pEntity );		// what node type the monster uses
 	inline int	CapIndex( int afCapMask ) 
@@ -193,6 +254,13 @@ public:
 #endif
 };
 
+// Convert from [-8192,8192] to [0, 255]
+//
+inline int CALC_RANGE(int x, int lower, int upper)
+{
+	return NUM_RANGES*(x-lower)/((upper-lower+1));
+}
+
 extern CGraph WorldGraph;
 
 #endif //GAME_SERVER_NODES_CGRAPH_H
\ No newline at end of file
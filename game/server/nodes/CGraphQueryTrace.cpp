@@ -0,0 +1,171 @@
+#include <cstring>
+#include <vector>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+#include "Server.h"
+
+#include "CGraphQueryTrace.h"
+
+CGraphQueryTrace g_GraphQueryTrace;
+
+CGraphQueryTrace::~CGraphQueryTrace()
+{
+	Close();
+}
+
+void CGraphQueryTrace::RunFrame( CGraph& graph )
+{
+	const bool bWantRecording = sv_nodegraph_trace.value != 0;
+
+	if( bWantRecording != IsRecording() )
+	{
+		if( bWantRecording )
+		{
+			//Wait for the graph to be usable; it may still be loading or building.
+			if( !graph.m_fGraphPresent || !graph.m_fGraphPointersSet || !Open( graph ) )
+				return;
+		}
+		else
+		{
+			Close();
+			return;
+		}
+	}
+
+	if( IsRecording() )
+	{
+		Write( GraphQueryType::FRAME, 0, 0, 0, 0 );
+	}
+}
+
+void CGraphQueryTrace::Close()
+{
+	if( !m_pFile )
+		return;
+
+	fclose( m_pFile );
+	m_pFile = nullptr;
+
+	ALERT( at_console, "Node graph query trace stopped, %u records\n", m_uiRecords );
+}
+
+void CGraphQueryTrace::RecordFindNearestNode( const float* vecOrigin, const int afNodeTypes )
+{
+	Write( GraphQueryType::FIND_NEAREST_NODE, afNodeTypes, 0, 0, 0, vecOrigin );
+}
+
+void CGraphQueryTrace::RecordFindShortestPath( const int iStart, const int iDest, const int iHull, const int afCapMask )
+{
+	Write( GraphQueryType::FIND_SHORTEST_PATH, iStart, iDest, iHull, afCapMask );
+}
+
+void CGraphQueryTrace::RecordNextNodeInRoute( const int iCurrentNode, const int iDest, const int iHull, const int iCap )
+{
+	Write( GraphQueryType::NEXT_NODE_IN_ROUTE, iCurrentNode, iDest, iHull, iCap );
+}
+
+void CGraphQueryTrace::RecordPathLength( const int iStart, const int iDest, const int iHull, const int afCapMask )
+{
+	Write( GraphQueryType::PATH_LENGTH, iStart, iDest, iHull, afCapMask );
+}
+
+bool CGraphQueryTrace::Open( CGraph& graph )
+{
+	const char* const pszMapName = STRING( gpGlobals->mapname );
+
+	char szFilename[ MAX_PATH ];
+
+	GET_GAME_DIR( szFilename );
+	strcat( szFilename, "/maps" );
+	MakeDirectory( szFilename );
+	strcat( szFilename, "/graphs" );
+	MakeDirectory( szFilename );
+
+	const size_t uiLength = strlen( szFilename );
+	snprintf( szFilename + uiLength, sizeof( szFilename ) - uiLength, "/%s.nqt", pszMapName );
+
+	//Record what the link entities are, so the benchmark can evaluate links the same way without the entities.
+	std::vector<GraphQueryTraceLinkEnt_t> linkEnts;
+
+	for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+	{
+		entvars_t* pevLinkEnt = graph.m_ppLinkEnts[ iLink ];
+
+		if( !pevLinkEnt )
+			continue;
+
+		GraphQueryTraceLinkEnt_t linkEnt;
+
+		memset( &linkEnt, 0, sizeof( linkEnt ) );
+
+		linkEnt.iLink = iLink;
+
+		if( !FNullEnt( pevLinkEnt ) )
+		{
+			linkEnt.iSpawnFlags = pevLinkEnt->spawnflags;
+			strncpy( linkEnt.szClassname, STRING( pevLinkEnt->classname ), sizeof( linkEnt.szClassname ) - 1 );
+		}
+
+		linkEnts.push_back( linkEnt );
+	}
+
+	GraphQueryTraceHeader_t header;
+
+	memset( &header, 0, sizeof( header ) );
+
+	memcpy( header.szId, GRAPH_QUERY_TRACE_ID, sizeof( header.szId ) );
+	header.iVersion = GRAPH_QUERY_TRACE_VERSION;
+	header.cNodes = graph.m_cNodes;
+	header.cLinks = graph.m_cLinks;
+	header.cLinkEnts = static_cast<int>( linkEnts.size() );
+	strncpy( header.szMapName, pszMapName, sizeof( header.szMapName ) - 1 );
+
+	m_pFile = fopen( szFilename, "wb" );
+
+	if( !m_pFile )
+	{
+		ALERT( at_console, "Couldn't open node graph query trace \"%s\"\n", szFilename );
+		return false;
+	}
+
+	fwrite( &header, sizeof( header ), 1, m_pFile );
+
+	if( !linkEnts.empty() )
+		fwrite( linkEnts.data(), sizeof( GraphQueryTraceLinkEnt_t ), linkEnts.size(), m_pFile );
+
+	m_uiRecords = 0;
+
+	ALERT( at_console, "Recording node graph queries to \"%s\"\n", szFilename );
+
+	return true;
+}
+
+void CGraphQueryTrace::Write( const GraphQueryType type, const int iArg0, const int iArg1, const int iArg2, const int iArg3, const float* vecOrigin )
+{
+	GraphQueryRecord_t record;
+
+	record.iType = static_cast<int>( type );
+	record.iArg0 = iArg0;
+	record.iArg1 = iArg1;
+	record.iArg2 = iArg2;
+	record.iArg3 = iArg3;
+
+	if( vecOrigin )
+	{
+		record.vecOrigin[ 0 ] = vecOrigin[ 0 ];
+		record.vecOrigin[ 1 ] = vecOrigin[ 1 ];
+		record.vecOrigin[ 2 ] = vecOrigin[ 2 ];
+	}
+	else
+	{
+		record.vecOrigin[ 0 ] = record.vecOrigin[ 1 ] = record.vecOrigin[ 2 ] = 0;
+	}
+
+	fwrite( &record, sizeof( record ), 1, m_pFile );
+
+	++m_uiRecords;
+}
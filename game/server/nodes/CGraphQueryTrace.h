@@ -0,0 +1,147 @@
+#ifndef GAME_SERVER_NODES_CGRAPHQUERYTRACE_H
+#define GAME_SERVER_NODES_CGRAPHQUERYTRACE_H
+
+#include <cstdio>
+
+class CGraph;
+
+#define GRAPH_QUERY_TRACE_ID "NQTR"
+#define GRAPH_QUERY_TRACE_VERSION 1
+
+/**
+*	Query trace file layout. The header is followed by cLinkEnts GraphQueryTraceLinkEnt_t, then by GraphQueryRecord_t until the end of the file.
+*	The file is written in the byte order of the server that recorded it, and replays against the .nod file the server was using.
+*/
+struct GraphQueryTraceHeader_t
+{
+	char szId[ 4 ];		//GRAPH_QUERY_TRACE_ID
+	int iVersion;		//GRAPH_QUERY_TRACE_VERSION
+	int cNodes;			//Node and link counts of the graph, used to check that the trace matches the graph it is replayed against.
+	int cLinks;
+	int cLinkEnts;
+	char szMapName[ 64 ];
+};
+
+/**
+*	The entity that a link passes through, as it was when recording started.
+*/
+struct GraphQueryTraceLinkEnt_t
+{
+	int iLink;
+	int iSpawnFlags;
+	char szClassname[ 32 ];
+};
+
+enum class GraphQueryType
+{
+	/**
+	*	A server frame started.
+	*/
+	FRAME = 0,
+	FIND_NEAREST_NODE,
+	FIND_SHORTEST_PATH,
+	NEXT_NODE_IN_ROUTE,
+	PATH_LENGTH,
+
+	COUNT
+};
+
+struct GraphQueryRecord_t
+{
+	int iType;			//GraphQueryType
+
+	//FindNearestNode: iArg0 is the node types.
+	//FindShortestPath, PathLength: start, destination, hull, capability mask.
+	//NextNodeInRoute: current node, destination, hull, capability index.
+	int iArg0;
+	int iArg1;
+	int iArg2;
+	int iArg3;
+
+	//FindNearestNode: the origin.
+	float vecOrigin[ 3 ];
+};
+
+/**
+*	Records the node graph queries that the game makes, so they can be replayed by the node graph benchmark.
+*	Recording is controlled by sv_nodegraph_trace. Only queries made from outside the graph are recorded; the calls that
+*	FindShortestPath and PathLength make to NextNodeInRoute are part of the query that made them.
+*/
+class CGraphQueryTrace final
+{
+public:
+	/**
+	*	Marks a query for the duration of its scope, so nested queries aren't recorded.
+	*/
+	class CScope final
+	{
+	public:
+		explicit CScope( CGraphQueryTrace& trace )
+			: m_Trace( trace )
+		{
+			++m_Trace.m_iDepth;
+		}
+
+		~CScope()
+		{
+			--m_Trace.m_iDepth;
+		}
+
+		/**
+		*	@return Whether this query should be recorded.
+		*/
+		bool ShouldRecord() const { return m_Trace.m_pFile && m_Trace.m_iDepth == 1; }
+
+	private:
+		CGraphQueryTrace& m_Trace;
+
+	private:
+		CScope( const CScope& ) = delete;
+		CScope& operator=( const CScope& ) = delete;
+	};
+
+public:
+	CGraphQueryTrace() = default;
+	~CGraphQueryTrace();
+
+	bool IsRecording() const { return m_pFile != nullptr; }
+
+	/**
+	*	Starts or stops recording to follow sv_nodegraph_trace, and marks the start of a frame in the trace.
+	*/
+	void RunFrame( CGraph& graph );
+
+	/**
+	*	Stops recording. Called when the graph is freed, since recorded node indices only apply to that graph.
+	*/
+	void Close();
+
+	void RecordFindNearestNode( const float* vecOrigin, const int afNodeTypes );
+
+	void RecordFindShortestPath( const int iStart, const int iDest, const int iHull, const int afCapMask );
+
+	void RecordNextNodeInRoute( const int iCurrentNode, const int iDest, const int iHull, const int iCap );
+
+	void RecordPathLength( const int iStart, const int iDest, const int iHull, const int afCapMask );
+
+private:
+	bool Open( CGraph& graph );
+
+	void Write( const GraphQueryType type, const int iArg0, const int iArg1, const int iArg2, const int iArg3, const float* vecOrigin = nullptr );
+
+private:
+	FILE* m_pFile = nullptr;
+
+	//Number of queries currently running.
+	int m_iDepth = 0;
+
+	unsigned int m_uiRecords = 0;
+
+private:
+	CGraphQueryTrace( const CGraphQueryTrace& ) = delete;
+	CGraphQueryTrace& operator=( const CGraphQueryTrace& ) = delete;
+};
+
+extern CGraphQueryTrace g_GraphQueryTrace;
+
+#endif //GAME_SERVER_NODES_CGRAPHQUERYTRACE_H
@@ -0,0 +1,248 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+
+#include "CGraphSearch.h"
+
+namespace
+{
+GraphSearchStats_t g_SearchStats[ static_cast<int>( GraphSearchMode::COUNT ) ];
+}
+
+int CGraphSearch::FindShortestPath( CGraph& graph, int* piPath, const int iStart, const int iDest, const int iHull, const int afCapMask )
+{
+	const int iHullMask = CGraph::HullLinkMask( iHull );
+
+	BeginSearch( graph.m_cNodes );
+
+	const Vector2D vecDest = graph.m_pNodes[ iDest ].m_vecOrigin.Make2D();
+
+	NodeState_t& start = m_States[ iStart ];
+
+	start.uiGeneration = m_uiGeneration;
+	start.flCost = 0;
+	start.flEstimate = ( graph.m_pNodes[ iStart ].m_vecOrigin.Make2D() - vecDest ).Length();
+	start.iPrevious = iStart;
+	HeapPush( iStart );
+
+	bool bFound = false;
+
+	while( !m_Heap.empty() )
+	{
+		const int iCurrentNode = HeapPop();
+
+		++m_cNodesExpanded;
+
+		if( iCurrentNode == iDest )
+		{
+			bFound = true;
+			break;
+		}
+
+		const CNode& currentNode = graph.m_pNodes[ iCurrentNode ];
+		const float flCurrentCost = m_States[ iCurrentNode ].flCost;
+
+		for( int i = 0; i < currentNode.m_cNumLinks; ++i )
+		{
+			CLink& link = graph.m_pLinkPool[ currentNode.m_iFirstLink + i ];
+
+			if( ( link.m_afLinkInfo & iHullMask ) != iHullMask )
+			{// monster is too large to walk this connection
+				continue;
+			}
+
+			if( !graph.IsLinkPassable( currentNode.m_iFirstLink + i, afCapMask, CGraph::NODEGRAPH_STATIC ) )
+			{// monster should not try to go this way.
+				continue;
+			}
+
+			const int iVisitNode = link.m_iDestNode;
+			const float flCost = flCurrentCost + link.m_flWeight;
+
+			NodeState_t& visit = m_States[ iVisitNode ];
+
+			if( visit.uiGeneration != m_uiGeneration )
+			{
+				visit.uiGeneration = m_uiGeneration;
+				visit.flCost = flCost;
+				visit.flEstimate = flCost + ( graph.m_pNodes[ iVisitNode ].m_vecOrigin.Make2D() - vecDest ).Length();
+				visit.iPrevious = iCurrentNode;
+				HeapPush( iVisitNode );
+			}
+			else if( flCost < visit.flCost )
+			{
+				//Decrease the key. The heuristic is constant per node, so the difference in cost carries over.
+				visit.flEstimate -= visit.flCost - flCost;
+				visit.flCost = flCost;
+				visit.iPrevious = iCurrentNode;
+
+				if( visit.iHeapIndex == NOT_IN_HEAP )
+				{
+					//Rounding in link weights can make the heuristic slightly inconsistent, so reopen the node.
+					HeapPush( iVisitNode );
+				}
+				else
+				{
+					HeapSiftUp( visit.iHeapIndex );
+				}
+			}
+		}
+	}
+
+	if( !bFound )
+	{// Destination is unreachable, no path found.
+		return 0;
+	}
+
+	// now we must walk backwards through the previous nodes, and count how many connections there are in the path
+	int iCurrentNode = iDest;
+	int iNumPathNodes = 1;// count the dest
+
+	while( iCurrentNode != iStart )
+	{
+		++iNumPathNodes;
+		iCurrentNode = m_States[ iCurrentNode ].iPrevious;
+	}
+
+	iCurrentNode = iDest;
+
+	for( int i = iNumPathNodes - 1; i >= 0; --i )
+	{
+		piPath[ i ] = iCurrentNode;
+		iCurrentNode = m_States[ iCurrentNode ].iPrevious;
+	}
+
+	return iNumPathNodes;
+}
+
+const GraphSearchStats_t& CGraphSearch::GetStats( const GraphSearchMode mode )
+{
+	return g_SearchStats[ static_cast<int>( mode ) ];
+}
+
+void CGraphSearch::RecordSearch( const GraphSearchMode mode, const int cNodesExpanded, const bool bFoundPath )
+{
+	auto& stats = g_SearchStats[ static_cast<int>( mode ) ];
+
+	++stats.uiQueries;
+
+	if( bFoundPath )
+		++stats.uiPathsFound;
+
+	stats.ullNodesExpanded += cNodesExpanded;
+	stats.iMaxNodesExpanded = max( stats.iMaxNodesExpanded, cNodesExpanded );
+}
+
+void CGraphSearch::ResetStats()
+{
+	for( auto& stats : g_SearchStats )
+	{
+		stats = GraphSearchStats_t();
+	}
+}
+
+void CGraphSearch::BeginSearch( const int cNodes )
+{
+	if( static_cast<int>( m_States.size() ) < cNodes )
+	{
+		//New entries start out at generation 0, which is never used by a search.
+		m_States.resize( cNodes, NodeState_t{} );
+		m_Heap.reserve( cNodes );
+	}
+
+	++m_uiGeneration;
+
+	if( m_uiGeneration == 0 )
+	{
+		//Wrapped around, old entries could look like they belong to this search.
+		for( auto& state : m_States )
+		{
+			state.uiGeneration = 0;
+		}
+
+		m_uiGeneration = 1;
+	}
+
+	m_Heap.clear();
+	m_cNodesExpanded = 0;
+}
+
+void CGraphSearch::HeapPush( const int iNode )
+{
+	m_Heap.push_back( iNode );
+	m_States[ iNode ].iHeapIndex = static_cast<int>( m_Heap.size() ) - 1;
+	HeapSiftUp( m_States[ iNode ].iHeapIndex );
+}
+
+int CGraphSearch::HeapPop()
+{
+	const int iNode = m_Heap.front();
+
+	m_States[ iNode ].iHeapIndex = NOT_IN_HEAP;
+
+	const int iLast = m_Heap.back();
+	m_Heap.pop_back();
+
+	if( !m_Heap.empty() )
+	{
+		m_Heap[ 0 ] = iLast;
+		m_States[ iLast ].iHeapIndex = 0;
+		HeapSiftDown( 0 );
+	}
+
+	return iNode;
+}
+
+void CGraphSearch::HeapSiftUp( int iIndex )
+{
+	const int iNode = m_Heap[ iIndex ];
+	const float flEstimate = m_States[ iNode ].flEstimate;
+
+	while( iIndex > 0 )
+	{
+		const int iParent = ( iIndex - 1 ) / 2;
+		const int iParentNode = m_Heap[ iParent ];
+
+		if( m_States[ iParentNode ].flEstimate <= flEstimate )
+			break;
+
+		m_Heap[ iIndex ] = iParentNode;
+		m_States[ iParentNode ].iHeapIndex = iIndex;
+		iIndex = iParent;
+	}
+
+	m_Heap[ iIndex ] = iNode;
+	m_States[ iNode ].iHeapIndex = iIndex;
+}
+
+void CGraphSearch::HeapSiftDown( int iIndex )
+{
+	const int iSize = static_cast<int>( m_Heap.size() );
+	const int iNode = m_Heap[ iIndex ];
+	const float flEstimate = m_States[ iNode ].flEstimate;
+
+	for( ;; )
+	{
+		int iChild = 2 * iIndex + 1;
+
+		if( iChild >= iSize )
+			break;
+
+		if( iChild + 1 < iSize && m_States[ m_Heap[ iChild + 1 ] ].flEstimate < m_States[ m_Heap[ iChild ] ].flEstimate )
+			++iChild;
+
+		const int iChildNode = m_Heap[ iChild ];
+
+		if( flEstimate <= m_States[ iChildNode ].flEstimate )
+			break;
+
+		m_Heap[ iIndex ] = iChildNode;
+		m_States[ iChildNode ].iHeapIndex = iIndex;
+		iIndex = iChild;
+	}
+
+	m_Heap[ iIndex ] = iNode;
+	m_States[ iNode ].iHeapIndex = iIndex;
+}
@@ -0,0 +1,116 @@
+#ifndef GAME_SERVER_NODES_CGRAPHSEARCH_H
+#define GAME_SERVER_NODES_CGRAPHSEARCH_H
+
+#include <vector>
+
+class CGraph;
+
+/**
+*	Search algorithms that CGraph::FindShortestPath can use when routing tables aren't available.
+*/
+enum class GraphSearchMode
+{
+	/**
+	*	Use the mode selected by sv_nodegraph_search.
+	*/
+	DEFAULT = -1,
+
+	/**
+	*	The original Dijkstra search. Routing tables are always built with this so they don't change.
+	*/
+	DIJKSTRA = 0,
+
+	/**
+	*	A* search using CGraphSearch.
+	*/
+	ASTAR = 1,
+
+	COUNT
+};
+
+/**
+*	Per mode search statistics, used to compare search modes on real maps.
+*/
+struct GraphSearchStats_t
+{
+	unsigned int uiQueries = 0;
+	unsigned int uiPathsFound = 0;
+	unsigned long long ullNodesExpanded = 0;
+	int iMaxNodesExpanded = 0;
+};
+
+/**
+*	A* search over the node graph.
+*	Uses an indexed binary heap with decrease-key, and per node scratch entries that are tagged with the generation of
+*	the search that last wrote them, so no clear pass is needed between searches.
+*	The graph itself is never written to, so each thread can run searches with its own instance.
+*/
+class CGraphSearch final
+{
+public:
+	CGraphSearch() = default;
+	~CGraphSearch() = default;
+
+	/**
+	*	Finds the shortest path from iStart to iDest. Has the same contract as CGraph::FindShortestPath without routing tables.
+	*	The heuristic is the horizontal distance to the destination, which never overestimates since link weights are 2D lengths.
+	*	@return Number of nodes written to piPath, or 0 if no path exists.
+	*/
+	int FindShortestPath( CGraph& graph, int* piPath, const int iStart, const int iDest, const int iHull, const int afCapMask );
+
+	/**
+	*	@return The number of nodes that were removed from the open list during the last search.
+	*/
+	int GetNodesExpanded() const { return m_cNodesExpanded; }
+
+	/**
+	*	@return The statistics for the given mode.
+	*/
+	static const GraphSearchStats_t& GetStats( const GraphSearchMode mode );
+
+	/**
+	*	Records a search in the statistics for the given mode.
+	*/
+	static void RecordSearch( const GraphSearchMode mode, const int cNodesExpanded, const bool bFoundPath );
+
+	/**
+	*	Resets all statistics.
+	*/
+	static void ResetStats();
+
+private:
+	struct NodeState_t
+	{
+		unsigned int uiGeneration;
+		float flCost;		//Cost from the start node.
+		float flEstimate;	//Cost plus heuristic. This is the heap key.
+		int iPrevious;
+		int iHeapIndex;		//Index in the heap, or NOT_IN_HEAP if closed.
+	};
+
+	static const int NOT_IN_HEAP = -1;
+
+	/**
+	*	Makes sure the scratch buffers can hold cNodes, and starts a new generation.
+	*/
+	void BeginSearch( const int cNodes );
+
+	void HeapPush( const int iNode );
+	int HeapPop();
+	void HeapSiftUp( int iIndex );
+	void HeapSiftDown( int iIndex );
+
+private:
+	std::vector<NodeState_t> m_States;
+	std::vector<int> m_Heap;
+
+	unsigned int m_uiGeneration = 0;
+
+	int m_cNodesExpanded = 0;
+
+private:
+	CGraphSearch( const CGraphSearch& ) = delete;
+	CGraphSearch& operator=( const CGraphSearch& ) = delete;
+};
+
+#endif //GAME_SERVER_NODES_CGRAPHSEARCH_H
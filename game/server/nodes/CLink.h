@@ -30,14 +30,15 @@ public:
 	int		m_iSrcNode;// the node that 'owns' this link ( keeps us from having to make reverse lookups )
 	int		m_iDestNode;// the node on the other end of the link. 
 
-	entvars_t	*m_pLinkEnt;// the entity that blocks this connection (doors, etc)
-
-							// m_szLinkEntModelname is not necessarily NULL terminated (so we can store it in a more alignment-friendly 4 bytes)
+	// m_szLinkEntModelname is not necessarily NULL terminated (so we can store it in a more alignment-friendly 4 bytes)
 	//TODO: what if there are more than 1000 brush models? - Solokiller
 	char	m_szLinkEntModelname[ 4 ];// the unique name of the brush model that blocks the connection (this is kept for save/restore)
 
 	int		m_afLinkInfo;// information about this link
 	float	m_flWeight;// length of the link line segment
+
+	// Whether a brush entity blocks this connection (doors, etc). The entity itself is in CGraph::m_ppLinkEnts.
+	bool	HasLinkEnt() const { return m_szLinkEntModelname[ 0 ] != '\0'; }
 };
 
 #endif //GAME_SERVER_NODES_CLINK_H
\ No newline at end of file
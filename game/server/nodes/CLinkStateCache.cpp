@@ -0,0 +1,148 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "entities/DoorConstants.h"
+
+#include "CGraph.h"
+
+#include "CLinkStateCache.h"
+
+CLinkStateCache g_LinkStateCache;
+
+void CLinkStateCache::Build( CGraph& graph )
+{
+	Clear();
+
+	m_States.resize( graph.m_cLinks, LINKSTATE_NONE );
+
+	for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+	{
+		entvars_t* pevLinkEnt = graph.m_ppLinkEnts[ iLink ];
+
+		if( !pevLinkEnt )
+			continue;
+
+		m_States[ iLink ] = ClassifyLinkEnt( pevLinkEnt );
+
+		m_LinksByEnt[ pevLinkEnt ].push_back( iLink );
+	}
+
+	m_bBuilt = true;
+}
+
+void CLinkStateCache::Clear()
+{
+	m_bBuilt = false;
+	m_States.clear();
+	m_LinksByEnt.clear();
+}
+
+bool CLinkStateCache::EntityChanged( const entvars_t* pevLinkEnt )
+{
+	if( !m_bBuilt || m_LinksByEnt.find( pevLinkEnt ) == m_LinksByEnt.end() )
+		return false;
+
+	return SetEntityState( pevLinkEnt, ClassifyLinkEnt( const_cast<entvars_t*>( pevLinkEnt ) ) );
+}
+
+bool CLinkStateCache::EntityRemoved( const entvars_t* pevLinkEnt )
+{
+	if( !m_bBuilt || m_LinksByEnt.find( pevLinkEnt ) == m_LinksByEnt.end() )
+		return false;
+
+	return SetEntityState( pevLinkEnt, LINKSTATE_NONE );
+}
+
+size_t CLinkStateCache::GetLinkEntCount() const
+{
+	size_t uiCount = 0;
+
+	for( const auto& links : m_LinksByEnt )
+	{
+		uiCount += links.second.size();
+	}
+
+	return uiCount;
+}
+
+size_t CLinkStateCache::GetOpenDoorCount() const
+{
+	size_t uiCount = 0;
+
+	for( auto state : m_States )
+	{
+		if( ( state & LINKSTATE_TYPE_MASK ) == LINKSTATE_DOOR && ( state & LINKSTATE_DOOR_OPEN ) )
+			++uiCount;
+	}
+
+	return uiCount;
+}
+
+void CLinkStateCache::ResetStats()
+{
+	m_Stats = LinkStateStats_t();
+}
+
+unsigned char CLinkStateCache::ClassifyLinkEnt( entvars_t* pevLinkEnt )
+{
+	//The edict stays valid after the entity is removed, so check whether it's still in use.
+	if( FNullEnt( pevLinkEnt ) || ENT( pevLinkEnt )->free )
+		return LINKSTATE_NONE;
+
+	if( FClassnameIs( pevLinkEnt, "func_door" ) || FClassnameIs( pevLinkEnt, "func_door_rotating" ) )
+	{
+		unsigned char state = LINKSTATE_DOOR;
+
+		if( pevLinkEnt->spawnflags & SF_DOOR_USE_ONLY )
+			state |= LINKSTATE_DOOR_USE_ONLY;
+
+		if( pevLinkEnt->spawnflags & SF_DOOR_NOMONSTERS )
+			state |= LINKSTATE_DOOR_NOMONSTERS;
+
+		if( IsDoorOpen( pevLinkEnt ) )
+			state |= LINKSTATE_DOOR_OPEN;
+
+		return state;
+	}
+
+	if( FClassnameIs( pevLinkEnt, "func_breakable" ) )
+		return LINKSTATE_BREAKABLE;
+
+	ALERT( at_aiconsole, "Unhandled Ent in Path %s\n", STRING( pevLinkEnt->classname ) );
+
+	return LINKSTATE_UNHANDLED;
+}
+
+bool CLinkStateCache::SetEntityState( const entvars_t* pevLinkEnt, const unsigned char newState )
+{
+	++m_Stats.uiUpdates;
+
+	bool bChanged = false;
+
+	for( auto iLink : m_LinksByEnt[ pevLinkEnt ] )
+	{
+		unsigned char& state = m_States[ iLink ];
+
+		if( newState != state )
+		{
+			state = newState;
+			bChanged = true;
+		}
+	}
+
+	if( bChanged )
+		++m_Stats.uiChanges;
+
+	return bChanged;
+}
+
+bool CLinkStateCache::IsDoorOpen( entvars_t* pevLinkEnt )
+{
+	if( !( pevLinkEnt->spawnflags & SF_DOOR_NO_AUTO_RETURN ) )
+		return false;
+
+	CBaseToggle* pDoor = static_cast<CBaseToggle*>( CBaseEntity::Instance( pevLinkEnt ) );
+
+	return pDoor && pDoor->GetToggleState() == TS_AT_TOP;
+}
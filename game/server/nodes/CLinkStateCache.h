@@ -0,0 +1,146 @@
+#ifndef GAME_SERVER_NODES_CLINKSTATECACHE_H
+#define GAME_SERVER_NODES_CLINKSTATECACHE_H
+
+#include <unordered_map>
+#include <vector>
+
+class CGraph;
+struct entvars_t;
+
+/**
+*	Link state cache statistics.
+*/
+struct LinkStateStats_t
+{
+	//Number of times link entities reported a state change.
+	unsigned int uiUpdates = 0;
+
+	//Updates that changed whether a link can be passed.
+	unsigned int uiChanges = 0;
+};
+
+/**
+*	Caches what CGraph::HandleLinkEnt would return for every link that passes through an entity.
+*	The kind of entity and its spawnflags are stored when the cache is built. Doors report opening and closing through CGraph::LinkEntStateChanged,
+*	entities are classified again when they spawn, since their edict may have been reused, and removed entities no longer block their links.
+*	Searches read a few bits per link instead of looking up the entity.
+*/
+class CLinkStateCache final
+{
+public:
+	CLinkStateCache() = default;
+	~CLinkStateCache() = default;
+
+	bool IsBuilt() const { return m_bBuilt; }
+
+	/**
+	*	Classifies the entity of every link in the graph. The graph's link entity pointers must be set.
+	*/
+	void Build( CGraph& graph );
+
+	/**
+	*	Drops all link states. Link indices are only valid for the graph the cache was built for.
+	*/
+	void Clear();
+
+	/**
+	*	@param bCanOpenDoors Whether the monster has bits_CAP_OPEN_DOORS.
+	*	@return Whether a monster can pass through the given link. Has the same result as CGraph::HandleLinkEnt.
+	*/
+	bool IsPassable( const int iLink, const bool bCanOpenDoors, const bool bStaticQuery ) const
+	{
+		const unsigned char state = m_States[ iLink ];
+
+		switch( state & LINKSTATE_TYPE_MASK )
+		{
+		case LINKSTATE_NONE:		return true;
+
+		case LINKSTATE_DOOR:
+			{
+				//Monster should try for it if the door is open and looks as if it will stay that way.
+				if( state & LINKSTATE_DOOR_OPEN )
+					return true;
+
+				if( !bCanOpenDoors )
+					return false;
+
+				return ( state & LINKSTATE_DOOR_USE_ONLY ) || !( state & LINKSTATE_DOOR_NOMONSTERS ) || bStaticQuery;
+			}
+
+		case LINKSTATE_BREAKABLE:	return bStaticQuery;
+
+		default:					return false;
+		}
+	}
+
+	/**
+	*	Classifies the given entity again and updates the state of every link that passes through it.
+	*	@return Whether the result of IsPassable changed for any of them.
+	*/
+	bool EntityChanged( const entvars_t* pevLinkEnt );
+
+	/**
+	*	Called when the given entity is about to be freed. Links that pass through it no longer have an entity.
+	*	@return Whether the result of IsPassable changed for any of them.
+	*/
+	bool EntityRemoved( const entvars_t* pevLinkEnt );
+
+	/**
+	*	@return Number of links that pass through an entity.
+	*/
+	size_t GetLinkEntCount() const;
+
+	/**
+	*	@return Number of links that pass through a door that is currently open.
+	*/
+	size_t GetOpenDoorCount() const;
+
+	const LinkStateStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+private:
+	enum LinkState : unsigned char
+	{
+		//No entity, or the entity was removed.
+		LINKSTATE_NONE			= 0,
+		LINKSTATE_DOOR			= 1,
+		LINKSTATE_BREAKABLE		= 2,
+		LINKSTATE_UNHANDLED		= 3,
+
+		LINKSTATE_TYPE_MASK		= 3,
+
+		LINKSTATE_DOOR_USE_ONLY		= 1 << 2,
+		LINKSTATE_DOOR_NOMONSTERS	= 1 << 3,
+
+		//Door is open and won't close by itself.
+		LINKSTATE_DOOR_OPEN			= 1 << 4
+	};
+
+	static unsigned char ClassifyLinkEnt( entvars_t* pevLinkEnt );
+
+	/**
+	*	Sets the state of every link that passes through the given entity.
+	*/
+	bool SetEntityState( const entvars_t* pevLinkEnt, const unsigned char newState );
+
+	static bool IsDoorOpen( entvars_t* pevLinkEnt );
+
+private:
+	bool m_bBuilt = false;
+
+	std::vector<unsigned char> m_States;
+
+	//Links that pass through each entity.
+	std::unordered_map<const entvars_t*, std::vector<int>> m_LinksByEnt;
+
+	LinkStateStats_t m_Stats;
+
+private:
+	CLinkStateCache( const CLinkStateCache& ) = delete;
+	CLinkStateCache& operator=( const CLinkStateCache& ) = delete;
+};
+
+extern CLinkStateCache g_LinkStateCache;
+
+#endif //GAME_SERVER_NODES_CLINKSTATECACHE_H
@@ -0,0 +1,93 @@
+#include "extdll.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "CMappedFile.h"
+
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+bool CMappedFile::Open( const char* const pszFilename )
+{
+	Close();
+
+#ifdef WIN32
+	HANDLE hFile = CreateFileA( pszFilename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+	if( hFile == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER size;
+
+	if( !GetFileSizeEx( hFile, &size ) || size.QuadPart <= 0 || static_cast<unsigned long long>( size.QuadPart ) > SIZE_MAX )
+	{
+		CloseHandle( hFile );
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+	//The view keeps the mapping alive, so the handles aren't needed anymore.
+	CloseHandle( hFile );
+
+	if( !hMapping )
+		return false;
+
+	void* pData = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+
+	CloseHandle( hMapping );
+
+	if( !pData )
+		return false;
+
+	m_pData = reinterpret_cast<const unsigned char*>( pData );
+	m_uiSize = static_cast<size_t>( size.QuadPart );
+#else
+	const int iFile = open( pszFilename, O_RDONLY );
+
+	if( iFile == -1 )
+		return false;
+
+	struct stat fileStat;
+
+	if( fstat( iFile, &fileStat ) == -1 || fileStat.st_size <= 0 )
+	{
+		close( iFile );
+		return false;
+	}
+
+	void* pData = mmap( nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, iFile, 0 );
+
+	//The mapping keeps its own reference to the file.
+	close( iFile );
+
+	if( pData == MAP_FAILED )
+		return false;
+
+	m_pData = reinterpret_cast<const unsigned char*>( pData );
+	m_uiSize = static_cast<size_t>( fileStat.st_size );
+#endif
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if( !m_pData )
+		return;
+
+#ifdef WIN32
+	UnmapViewOfFile( m_pData );
+#else
+	munmap( const_cast<unsigned char*>( m_pData ), m_uiSize );
+#endif
+
+	m_pData = nullptr;
+	m_uiSize = 0;
+}
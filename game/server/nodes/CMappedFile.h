@@ -0,0 +1,54 @@
+#ifndef GAME_SERVER_NODES_CMAPPEDFILE_H
+#define GAME_SERVER_NODES_CMAPPEDFILE_H
+
+#include <cstddef>
+
+/**
+*	Read-only memory mapping of a file. Pages are shared with every other process that maps the same file.
+*	Writing to the mapped data will crash, so only data that is never modified should be used directly.
+*/
+class CMappedFile final
+{
+public:
+	CMappedFile() = default;
+	~CMappedFile();
+
+	/**
+	*	@return Whether a file is currently mapped.
+	*/
+	bool IsOpen() const { return m_pData != nullptr; }
+
+	const unsigned char* GetData() const { return m_pData; }
+
+	size_t GetSize() const { return m_uiSize; }
+
+	/**
+	*	@return Whether the given pointer points into the mapped data.
+	*/
+	bool Contains( const void* pPointer ) const
+	{
+		return IsOpen() && pPointer >= m_pData && pPointer < m_pData + m_uiSize;
+	}
+
+	/**
+	*	Maps the given file. Any previously mapped file is unmapped first.
+	*	@param pszFilename Absolute path to the file.
+	*	@return Whether the file was mapped. Empty files can't be mapped.
+	*/
+	bool Open( const char* const pszFilename );
+
+	/**
+	*	Unmaps the file, if one is mapped.
+	*/
+	void Close();
+
+private:
+	const unsigned char* m_pData = nullptr;
+	size_t m_uiSize = 0;
+
+private:
+	CMappedFile( const CMappedFile& ) = delete;
+	CMappedFile& operator=( const CMappedFile& ) = delete;
+};
+
+#endif //GAME_SERVER_NODES_CMAPPEDFILE_H
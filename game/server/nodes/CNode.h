@@ -36,16 +36,24 @@ public:
 						 //
 	int		m_pNextBestNode[ MAX_NODE_HULLS ][ 2 ];
 
+	short	m_sHintType;// there is something interesting in the world at this node's position
+	short	m_sHintActivity;// there is something interesting in the world at this node's position
+	float	m_flHintYaw;// monster on this node should face this yaw to face the hint.
+};
+
+//=========================================================
+// Progress of a shortest path search through a node. Kept in
+// CGraph::m_pSearchState, apart from the nodes, so the nodes
+// can be used in place from a mapped graph file.
+//=========================================================
+struct NodeSearchState_t
+{
 	// Used in finding the shortest path. m_fClosestSoFar is -1 if not visited.
 	// Then it is the distance to the source. If another path uses this node
 	// and has a closer distance, then m_iPreviousNode is also updated.
 	//
 	float   m_flClosestSoFar; // Used in finding the shortest path.
 	int		m_iPreviousNode;
-
-	short	m_sHintType;// there is something interesting in the world at this node's position
-	short	m_sHintActivity;// there is something interesting in the world at this node's position
-	float	m_flHintYaw;// monster on this node should face this yaw to face the hint.
 };
 
 #endif //GAME_SERVER_NODES_CNODE_H
\ No newline at end of file
@@ -48,6 +48,10 @@ enum
 //=========================================================
 class CNodeEnt : public CBaseEntity
 {
+public:
+	DECLARE_CLASS( CNodeEnt, CBaseEntity );
+
+private:
 	void Spawn() override;
 	void KeyValue( KeyValueData *pkvd ) override;
 	virtual int	ObjectCaps() const override { return CBaseEntity::ObjectCaps() & ~FCAP_ACROSS_TRANSITION; }
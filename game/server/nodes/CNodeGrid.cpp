@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+
+#include "CNodeGrid.h"
+
+namespace
+{
+NearestNodeStats_t g_NearestNodeStats[ static_cast<int>( NearestNodeMode::COUNT ) ];
+}
+
+//min and max take their arguments by reference, so these need definitions.
+const int CNodeGrid::MAX_CELLS_PER_AXIS;
+constexpr float CNodeGrid::MIN_CELL_SIZE;
+
+void CNodeGrid::Build( const CGraph& graph )
+{
+	Clear();
+
+	const int cNodes = graph.m_cNodes;
+
+	if( cNodes <= 0 || !graph.m_pNodes )
+		return;
+
+	Vector vecMaxs;
+
+	m_vecMins = vecMaxs = graph.m_pNodes[ 0 ].m_vecOriginPeek;
+
+	for( int i = 1; i < cNodes; ++i )
+	{
+		const Vector& vecOrigin = graph.m_pNodes[ i ].m_vecOriginPeek;
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			m_vecMins[ iAxis ] = min( m_vecMins[ iAxis ], vecOrigin[ iAxis ] );
+			vecMaxs[ iAxis ] = max( vecMaxs[ iAxis ], vecOrigin[ iAxis ] );
+		}
+	}
+
+	const Vector vecExtents = vecMaxs - m_vecMins;
+
+	//Aim for about one node per cell, assuming nodes are spread out evenly.
+	const float flVolume = max( vecExtents.x, MIN_CELL_SIZE ) * max( vecExtents.y, MIN_CELL_SIZE ) * max( vecExtents.z, MIN_CELL_SIZE );
+
+	m_flCellSize = max( MIN_CELL_SIZE, static_cast<float>( std::cbrt( flVolume / cNodes ) ) );
+
+	const float flLargestExtent = max( vecExtents.x, max( vecExtents.y, vecExtents.z ) );
+
+	m_flCellSize = max( m_flCellSize, flLargestExtent / ( MAX_CELLS_PER_AXIS - 1 ) );
+
+	for( int iAxis = 0; iAxis < 3; ++iAxis )
+	{
+		m_iCells[ iAxis ] = min( MAX_CELLS_PER_AXIS, static_cast<int>( vecExtents[ iAxis ] / m_flCellSize ) + 1 );
+	}
+
+	const int cCells = m_iCells[ 0 ] * m_iCells[ 1 ] * m_iCells[ 2 ];
+
+	std::vector<int> nodeCells( cNodes );
+
+	m_CellStart.assign( cCells + 1, 0 );
+	m_CellNodes.resize( cNodes );
+
+	//Counting sort the nodes into their cells.
+	for( int i = 0; i < cNodes; ++i )
+	{
+		const Vector vecOffset = graph.m_pNodes[ i ].m_vecOriginPeek - m_vecMins;
+
+		int iCell[ 3 ];
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			iCell[ iAxis ] = clamp( static_cast<int>( vecOffset[ iAxis ] / m_flCellSize ), 0, m_iCells[ iAxis ] - 1 );
+		}
+
+		nodeCells[ i ] = CellIndex( iCell[ 0 ], iCell[ 1 ], iCell[ 2 ] );
+
+		++m_CellStart[ nodeCells[ i ] + 1 ];
+	}
+
+	for( int i = 0; i < cCells; ++i )
+	{
+		m_CellStart[ i + 1 ] += m_CellStart[ i ];
+	}
+
+	std::vector<int> cellFill( m_CellStart.begin(), m_CellStart.end() - 1 );
+
+	for( int i = 0; i < cNodes; ++i )
+	{
+		m_CellNodes[ cellFill[ nodeCells[ i ] ]++ ] = i;
+	}
+
+	m_Candidates.reserve( cNodes );
+
+	ALERT( at_aiconsole, "Node grid: %d x %d x %d cells of %.0f units\n", m_iCells[ 0 ], m_iCells[ 1 ], m_iCells[ 2 ], m_flCellSize );
+}
+
+void CNodeGrid::Clear()
+{
+	m_flCellSize = 0;
+	m_iCells[ 0 ] = m_iCells[ 1 ] = m_iCells[ 2 ] = 0;
+
+	m_CellStart.clear();
+	m_CellStart.shrink_to_fit();
+	m_CellNodes.clear();
+	m_CellNodes.shrink_to_fit();
+	m_Candidates.clear();
+	m_Candidates.shrink_to_fit();
+}
+
+int CNodeGrid::FindNearestNode( const CGraph& graph, const Vector& vecOrigin, const int afNodeTypes, int& cTraces )
+{
+	cTraces = 0;
+
+	if( !IsBuilt() )
+		return -1;
+
+	int iCenter[ 3 ];
+	int iMaxRing = 0;
+
+	for( int iAxis = 0; iAxis < 3; ++iAxis )
+	{
+		iCenter[ iAxis ] = clamp( static_cast<int>( std::floor( ( vecOrigin[ iAxis ] - m_vecMins[ iAxis ] ) / m_flCellSize ) ), 0, m_iCells[ iAxis ] - 1 );
+		iMaxRing = max( iMaxRing, max( iCenter[ iAxis ], m_iCells[ iAxis ] - 1 - iCenter[ iAxis ] ) );
+	}
+
+	m_Candidates.clear();
+
+	TraceResult tr;
+
+	for( int iRing = 0; iRing <= iMaxRing; ++iRing )
+	{
+		AddRing( graph, vecOrigin, afNodeTypes, iCenter, iRing );
+
+		//Nodes in cells that haven't been added yet are at least this far away.
+		float flBound = FLT_MAX;
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			const int iLow = iCenter[ iAxis ] - iRing;
+			const int iHigh = iCenter[ iAxis ] + iRing;
+
+			if( iLow > 0 )
+				flBound = min( flBound, max( 0.0f, vecOrigin[ iAxis ] - ( m_vecMins[ iAxis ] + iLow * m_flCellSize ) ) );
+
+			if( iHigh < m_iCells[ iAxis ] - 1 )
+				flBound = min( flBound, max( 0.0f, m_vecMins[ iAxis ] + ( iHigh + 1 ) * m_flCellSize - vecOrigin[ iAxis ] ) );
+		}
+
+		//Any candidate within the bound is closer than every node that hasn't been added, so it can be checked now.
+		while( !m_Candidates.empty() && m_Candidates.front().first <= flBound )
+		{
+			std::pop_heap( m_Candidates.begin(), m_Candidates.end(), std::greater<std::pair<float, int>>() );
+
+			const int iNode = m_Candidates.back().second;
+
+			m_Candidates.pop_back();
+
+			++cTraces;
+
+			// make sure that vecOrigin can trace to this node!
+			UTIL_TraceLine( vecOrigin, graph.m_pNodes[ iNode ].m_vecOriginPeek, ignore_monsters, 0, &tr );
+
+			if( tr.flFraction == 1.0 )
+				return iNode;
+		}
+	}
+
+	return -1;
+}
+
+const NearestNodeStats_t& CNodeGrid::GetStats( const NearestNodeMode mode )
+{
+	return g_NearestNodeStats[ static_cast<int>( mode ) ];
+}
+
+void CNodeGrid::RecordQuery( const NearestNodeMode mode, const bool bCacheHit, const int cTraces )
+{
+	auto& stats = g_NearestNodeStats[ static_cast<int>( mode ) ];
+
+	++stats.uiQueries;
+
+	if( bCacheHit )
+		++stats.uiCacheHits;
+	else
+		++stats.uiCacheMisses;
+
+	stats.ullTraces += cTraces;
+}
+
+void CNodeGrid::ResetStats()
+{
+	for( auto& stats : g_NearestNodeStats )
+	{
+		stats = NearestNodeStats_t();
+	}
+}
+
+void CNodeGrid::AddRing( const CGraph& graph, const Vector& vecOrigin, const int afNodeTypes, const int* iCenter, const int iRing )
+{
+	const int iMinX = iCenter[ 0 ] - iRing, iMaxX = iCenter[ 0 ] + iRing;
+	const int iMinY = max( 0, iCenter[ 1 ] - iRing ), iMaxY = min( m_iCells[ 1 ] - 1, iCenter[ 1 ] + iRing );
+	const int iMinZ = max( 0, iCenter[ 2 ] - iRing ), iMaxZ = min( m_iCells[ 2 ] - 1, iCenter[ 2 ] + iRing );
+
+	for( int iZ = iMinZ; iZ <= iMaxZ; ++iZ )
+	{
+		const bool bZEdge = abs( iZ - iCenter[ 2 ] ) == iRing;
+
+		for( int iY = iMinY; iY <= iMaxY; ++iY )
+		{
+			//Cells that aren't on the ring's edge in Y or Z were added by an earlier ring, except for the 2 X edges.
+			const bool bFullRow = bZEdge || abs( iY - iCenter[ 1 ] ) == iRing;
+
+			const int iStep = bFullRow ? 1 : max( 1, iMaxX - iMinX );
+
+			for( int iX = iMinX; iX <= iMaxX; iX += iStep )
+			{
+				if( iX < 0 || iX >= m_iCells[ 0 ] )
+					continue;
+
+				const int iCell = CellIndex( iX, iY, iZ );
+
+				for( int i = m_CellStart[ iCell ]; i < m_CellStart[ iCell + 1 ]; ++i )
+				{
+					const int iNode = m_CellNodes[ i ];
+					const CNode& node = graph.m_pNodes[ iNode ];
+
+					if( !( node.m_afNodeInfo & afNodeTypes ) )
+						continue;
+
+					m_Candidates.emplace_back( ( vecOrigin - node.m_vecOriginPeek ).Length(), iNode );
+					std::push_heap( m_Candidates.begin(), m_Candidates.end(), std::greater<std::pair<float, int>>() );
+				}
+			}
+		}
+	}
+}
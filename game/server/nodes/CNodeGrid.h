@@ -0,0 +1,122 @@
+#ifndef GAME_SERVER_NODES_CNODEGRID_H
+#define GAME_SERVER_NODES_CNODEGRID_H
+
+#include <utility>
+#include <vector>
+
+class CGraph;
+
+/**
+*	Methods that CGraph::FindNearestNode can use to find candidate nodes.
+*/
+enum class NearestNodeMode
+{
+	/**
+	*	The original coordinate sorted range tables.
+	*/
+	RANGE_TABLES = 0,
+
+	/**
+	*	CNodeGrid.
+	*/
+	GRID = 1,
+
+	COUNT
+};
+
+/**
+*	Per mode nearest node statistics, used to compare lookup methods on real maps.
+*/
+struct NearestNodeStats_t
+{
+	unsigned int uiQueries = 0;
+	unsigned int uiCacheHits = 0;
+	unsigned int uiCacheMisses = 0;
+	unsigned long long ullTraces = 0;
+};
+
+/**
+*	Uniform 3D grid over node positions, used to find the nearest visible node.
+*	Candidates are visited in order of distance, so visibility traces stop at the first node that can be seen.
+*	Nodes are stored per cell in a single array, indexed by the cell's start offset.
+*/
+class CNodeGrid final
+{
+public:
+	CNodeGrid() = default;
+	~CNodeGrid() = default;
+
+	/**
+	*	@return Whether the grid has been built.
+	*/
+	bool IsBuilt() const { return !m_CellStart.empty(); }
+
+	/**
+	*	Builds the grid from the peek origins of all nodes in the graph.
+	*/
+	void Build( const CGraph& graph );
+
+	/**
+	*	Frees all memory used by the grid.
+	*/
+	void Clear();
+
+	/**
+	*	Finds the nearest node of the given types that vecOrigin can trace to.
+	*	@param[ out ] cTraces Number of traces performed.
+	*	@return Index of the node, or -1 if no node could be found.
+	*/
+	int FindNearestNode( const CGraph& graph, const Vector& vecOrigin, const int afNodeTypes, int& cTraces );
+
+	/**
+	*	@return The statistics for the given mode.
+	*/
+	static const NearestNodeStats_t& GetStats( const NearestNodeMode mode );
+
+	/**
+	*	Records a query in the statistics for the given mode.
+	*	@param bCacheHit Whether the query was answered by the graph's nearest node cache.
+	*	@param cTraces Number of visibility traces the lookup performed.
+	*/
+	static void RecordQuery( const NearestNodeMode mode, const bool bCacheHit, const int cTraces );
+
+	/**
+	*	Resets all statistics.
+	*/
+	static void ResetStats();
+
+private:
+	//Grids are never larger than this on any axis.
+	static const int MAX_CELLS_PER_AXIS = 64;
+
+	//Cells are never smaller than this on any axis.
+	static constexpr float MIN_CELL_SIZE = 64;
+
+	int CellIndex( const int iX, const int iY, const int iZ ) const
+	{
+		return ( iZ * m_iCells[ 1 ] + iY ) * m_iCells[ 0 ] + iX;
+	}
+
+	/**
+	*	Adds the nodes in the cells of the box around iCenter with the given radius, excluding the cells within a radius of iRing - 1.
+	*/
+	void AddRing( const CGraph& graph, const Vector& vecOrigin, const int afNodeTypes, const int* iCenter, const int iRing );
+
+private:
+	Vector m_vecMins;
+	float m_flCellSize = 0;
+	int m_iCells[ 3 ] = { 0, 0, 0 };
+
+	//Offset in m_CellNodes of each cell's first node. Has one more entry than there are cells.
+	std::vector<int> m_CellStart;
+	std::vector<int> m_CellNodes;
+
+	//Min heap of candidates, keyed by distance.
+	std::vector<std::pair<float, int>> m_Candidates;
+
+private:
+	CNodeGrid( const CNodeGrid& ) = delete;
+	CNodeGrid& operator=( const CNodeGrid& ) = delete;
+};
+
+#endif //GAME_SERVER_NODES_CNODEGRID_H
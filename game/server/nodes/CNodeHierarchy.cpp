@@ -0,0 +1,801 @@
+#include <cfloat>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <new>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <ctpl_stl.h>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+
+#include "CNodeHierarchy.h"
+
+namespace
+{
+typedef std::pair<float, int> QueueEntry_t;
+typedef std::priority_queue<QueueEntry_t, std::vector<QueueEntry_t>, std::greater<QueueEntry_t>> PriorityQueue_t;
+
+void WriteInt( std::vector<unsigned char>& data, const int iValue )
+{
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>( &iValue );
+	data.insert( data.end(), pBytes, pBytes + sizeof( iValue ) );
+}
+
+void WriteInts( std::vector<unsigned char>& data, const std::vector<int>& values )
+{
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>( values.data() );
+	data.insert( data.end(), pBytes, pBytes + values.size() * sizeof( int ) );
+}
+
+/**
+*	Reads values written by WriteInt and WriteInts. Stops reading once the end has been passed.
+*/
+class CReader final
+{
+public:
+	CReader( const unsigned char* pData, const size_t uiSize )
+		: m_pData( pData )
+		, m_uiSize( uiSize )
+	{
+	}
+
+	bool IsValid() const { return m_bValid; }
+
+	int ReadInt()
+	{
+		int iValue = 0;
+		ReadBytes( &iValue, sizeof( iValue ) );
+		return iValue;
+	}
+
+	/**
+	*	Reads cCount values, each of which must be in the range [ iMin, iMax ).
+	*/
+	void ReadInts( std::vector<int>& values, const int cCount, const int iMin, const int iMax )
+	{
+		if( cCount < 0 || static_cast<size_t>( cCount ) > ( m_uiSize - m_uiOffset ) / sizeof( int ) )
+		{
+			m_bValid = false;
+			return;
+		}
+
+		values.resize( cCount );
+		ReadBytes( values.data(), cCount * sizeof( int ) );
+
+		for( auto iValue : values )
+		{
+			if( iValue < iMin || iValue >= iMax )
+			{
+				m_bValid = false;
+				break;
+			}
+		}
+	}
+
+	void ReadBytes( void* pDest, const size_t uiSize )
+	{
+		if( !m_bValid || uiSize > m_uiSize - m_uiOffset )
+		{
+			m_bValid = false;
+			return;
+		}
+
+		memcpy( pDest, m_pData + m_uiOffset, uiSize );
+		m_uiOffset += uiSize;
+	}
+
+private:
+	const unsigned char* const m_pData;
+	const size_t m_uiSize;
+	size_t m_uiOffset = 0;
+	bool m_bValid = true;
+};
+}
+
+size_t CNodeHierarchy::GetMemoryUsage() const
+{
+	size_t uiSize = ( m_RegionOfNode.size() + m_LocalIndex.size() + m_RegionStart.size() + m_RegionNodes.size() ) * sizeof( int );
+
+	for( const auto& hullTables : m_Tables )
+	{
+		for( const auto& table : hullTables )
+		{
+			uiSize += ( table.AreaOfNode.size() + table.RouteOffset.size() + table.ExitLinks.size() ) * sizeof( int );
+			uiSize += table.Routes.size();
+		}
+	}
+
+	return uiSize;
+}
+
+bool CNodeHierarchy::Build( const CGraph& graph, const LinkPassableFn& isLinkPassable, const int iNumThreads )
+{
+	Clear();
+
+	if( graph.m_cNodes <= 0 )
+		return false;
+
+	try
+	{
+		BuildRegions( graph );
+		BuildLocalIndices();
+
+		std::vector<char> linkPassable( graph.m_cLinks );
+
+		for( int iHull = 0; iHull < MAX_NODE_HULLS; ++iHull )
+		{
+			const int iHullMask = CGraph::HullLinkMask( iHull );
+
+			for( int iCap = 0; iCap < 2; ++iCap )
+			{
+				const int afCapMask = iCap ? ( bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE ) : 0;
+
+				//Link states may be built on first use, so they have to be evaluated on this thread.
+				for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+				{
+					const CLink& link = graph.m_pLinkPool[ iLink ];
+
+					linkPassable[ iLink ] = ( link.m_afLinkInfo & iHullMask ) == iHullMask
+						&& isLinkPassable( iLink, afCapMask );
+				}
+
+				if( !BuildRouteTable( graph, m_Tables[ iHull ][ iCap ], linkPassable, iNumThreads ) )
+				{
+					Clear();
+					return false;
+				}
+			}
+		}
+	}
+	catch( const std::bad_alloc& )
+	{
+		ALERT( at_aiconsole, "CNodeHierarchy: Couldn't allocate routing tables for %d nodes!\n", graph.m_cNodes );
+		Clear();
+		return false;
+	}
+
+	m_cNodes = graph.m_cNodes;
+
+	ALERT( at_aiconsole, "Hierarchical routing: %d nodes in %d regions, %u bytes\n",
+		m_cNodes, GetRegionCount(), static_cast<unsigned int>( GetMemoryUsage() ) );
+
+	return true;
+}
+
+void CNodeHierarchy::Clear()
+{
+	m_cNodes = 0;
+
+	m_RegionOfNode.clear();
+	m_RegionOfNode.shrink_to_fit();
+	m_LocalIndex.clear();
+	m_LocalIndex.shrink_to_fit();
+	m_RegionStart.clear();
+	m_RegionStart.shrink_to_fit();
+	m_RegionNodes.clear();
+	m_RegionNodes.shrink_to_fit();
+
+	for( auto& hullTables : m_Tables )
+	{
+		for( auto& table : hullTables )
+		{
+			table = RouteTable_t();
+		}
+	}
+}
+
+int CNodeHierarchy::NextNodeInRoute( const CGraph& graph, const int iCurrentNode, const int iDest, const int iHull, const int iCap ) const
+{
+	if( iCurrentNode == iDest )
+		return iDest;
+
+	const RouteTable_t& table = m_Tables[ iHull ][ iCap ];
+
+	const int iSrcArea = table.AreaOfNode[ iCurrentNode ];
+	const int iDestArea = table.AreaOfNode[ iDest ];
+
+	int iTarget = iDest;
+
+	if( iSrcArea != iDestArea )
+	{
+		//Only areas with links to other areas can reach them.
+		if( iSrcArea >= table.cExitAreas || iDestArea >= table.cExitAreas )
+			return iCurrentNode;
+
+		const int iLink = table.ExitLinks[ iSrcArea * table.cExitAreas + iDestArea ];
+
+		if( iLink == -1 )
+			return iCurrentNode;
+
+		const CLink& link = graph.m_pLinkPool[ iLink ];
+
+		if( link.m_iSrcNode == iCurrentNode )
+			return link.m_iDestNode;
+
+		//Head for the node that leaves this area.
+		iTarget = link.m_iSrcNode;
+	}
+
+	const int iRegion = m_RegionOfNode[ iCurrentNode ];
+	const int iFirst = m_RegionStart[ iRegion ];
+
+	const int iNext = CGraph::DecodeRoute( &table.Routes[ table.RouteOffset[ iCurrentNode ] ],
+		m_LocalIndex[ iCurrentNode ], m_LocalIndex[ iTarget ], m_RegionStart[ iRegion + 1 ] - iFirst );
+
+	return m_RegionNodes[ iFirst + iNext ];
+}
+
+void CNodeHierarchy::Serialize( std::vector<unsigned char>& data ) const
+{
+	if( !IsBuilt() )
+		return;
+
+	WriteInt( data, m_cNodes );
+	WriteInt( data, GetRegionCount() );
+	WriteInts( data, m_RegionStart );
+	WriteInts( data, m_RegionNodes );
+
+	for( const auto& hullTables : m_Tables )
+	{
+		for( const auto& table : hullTables )
+		{
+			WriteInt( data, table.cAreas );
+			WriteInt( data, table.cExitAreas );
+			WriteInts( data, table.AreaOfNode );
+			WriteInt( data, static_cast<int>( table.Routes.size() ) );
+			WriteInts( data, table.RouteOffset );
+			data.insert( data.end(), table.Routes.begin(), table.Routes.end() );
+			WriteInts( data, table.ExitLinks );
+		}
+	}
+}
+
+bool CNodeHierarchy::Deserialize( const CGraph& graph, const unsigned char* pData, const size_t uiSize )
+{
+	Clear();
+
+	if( uiSize == 0 )
+		return false;
+
+	CReader reader( pData, uiSize );
+
+	const int cNodes = reader.ReadInt();
+	const int cRegions = reader.ReadInt();
+
+	if( cNodes != graph.m_cNodes || cRegions <= 0 || cRegions > cNodes )
+		return false;
+
+	reader.ReadInts( m_RegionStart, cRegions + 1, 0, cNodes + 1 );
+	reader.ReadInts( m_RegionNodes, cNodes, 0, cNodes );
+
+	if( !reader.IsValid() || m_RegionStart.front() != 0 || m_RegionStart.back() != cNodes )
+	{
+		Clear();
+		return false;
+	}
+
+	for( int iRegion = 0; iRegion < cRegions; ++iRegion )
+	{
+		const int cRegionNodes = m_RegionStart[ iRegion + 1 ] - m_RegionStart[ iRegion ];
+
+		if( cRegionNodes <= 0 || cRegionNodes > MAX_REGION_NODES )
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	BuildLocalIndices();
+
+	for( auto& hullTables : m_Tables )
+	{
+		for( auto& table : hullTables )
+		{
+			table.cAreas = reader.ReadInt();
+			table.cExitAreas = reader.ReadInt();
+
+			if( table.cAreas < 0 || table.cAreas > cNodes || table.cExitAreas < 0 || table.cExitAreas > table.cAreas )
+			{
+				Clear();
+				return false;
+			}
+
+			reader.ReadInts( table.AreaOfNode, cNodes, 0, table.cAreas );
+
+			const int cbRoutes = reader.ReadInt();
+
+			reader.ReadInts( table.RouteOffset, cNodes, 0, max( cbRoutes, 1 ) );
+
+			if( cbRoutes < 0 || !reader.IsValid() )
+			{
+				Clear();
+				return false;
+			}
+
+			table.Routes.resize( cbRoutes );
+			reader.ReadBytes( table.Routes.data(), cbRoutes );
+
+			reader.ReadInts( table.ExitLinks, table.cExitAreas * table.cExitAreas, -1, graph.m_cLinks );
+
+			if( !reader.IsValid() )
+			{
+				Clear();
+				return false;
+			}
+		}
+	}
+
+	m_cNodes = cNodes;
+
+	return true;
+}
+
+void CNodeHierarchy::BuildRegions( const CGraph& graph )
+{
+	const int cNodes = graph.m_cNodes;
+
+	m_RegionOfNode.assign( cNodes, -1 );
+	m_RegionStart.clear();
+	m_RegionNodes.clear();
+	m_RegionNodes.reserve( cNodes );
+
+	//Nodes are sorted so linked nodes have nearby indices, so seeding in index order keeps regions compact.
+	for( int iSeed = 0; iSeed < cNodes; ++iSeed )
+	{
+		if( m_RegionOfNode[ iSeed ] != -1 )
+			continue;
+
+		const int iRegion = static_cast<int>( m_RegionStart.size() );
+		const size_t uiFirst = m_RegionNodes.size();
+
+		m_RegionStart.push_back( static_cast<int>( uiFirst ) );
+
+		m_RegionOfNode[ iSeed ] = iRegion;
+		m_RegionNodes.push_back( iSeed );
+
+		for( size_t uiHead = uiFirst; uiHead < m_RegionNodes.size() && m_RegionNodes.size() - uiFirst < MAX_REGION_NODES; ++uiHead )
+		{
+			const CNode& node = graph.m_pNodes[ m_RegionNodes[ uiHead ] ];
+
+			for( int i = 0; i < node.m_cNumLinks && m_RegionNodes.size() - uiFirst < MAX_REGION_NODES; ++i )
+			{
+				const int iDest = graph.m_pLinkPool[ node.m_iFirstLink + i ].m_iDestNode;
+
+				if( m_RegionOfNode[ iDest ] == -1 )
+				{
+					m_RegionOfNode[ iDest ] = iRegion;
+					m_RegionNodes.push_back( iDest );
+				}
+			}
+		}
+	}
+
+	m_RegionStart.push_back( cNodes );
+}
+
+void CNodeHierarchy::BuildLocalIndices()
+{
+	const int cRegions = GetRegionCount();
+
+	m_RegionOfNode.resize( m_RegionNodes.size() );
+	m_LocalIndex.resize( m_RegionNodes.size() );
+
+	for( int iRegion = 0; iRegion < cRegions; ++iRegion )
+	{
+		for( int i = m_RegionStart[ iRegion ]; i < m_RegionStart[ iRegion + 1 ]; ++i )
+		{
+			m_RegionOfNode[ m_RegionNodes[ i ] ] = iRegion;
+			m_LocalIndex[ m_RegionNodes[ i ] ] = i - m_RegionStart[ iRegion ];
+		}
+	}
+}
+
+int CNodeHierarchy::FindStrongComponents( const CGraph& graph, const std::vector<char>& linkPassable, std::vector<int>& components ) const
+{
+	const int cNodes = graph.m_cNodes;
+
+	//Tarjan's algorithm, using an explicit stack of nodes and the next link to visit from them.
+	std::vector<int> index( cNodes, -1 );
+	std::vector<int> lowLink( cNodes );
+	std::vector<char> onStack( cNodes, false );
+	std::vector<int> stack;
+	std::vector<std::pair<int, int>> callStack;
+
+	components.assign( cNodes, -1 );
+
+	int cComponents = 0;
+	int iNextIndex = 0;
+
+	for( int iRoot = 0; iRoot < cNodes; ++iRoot )
+	{
+		if( index[ iRoot ] != -1 )
+			continue;
+
+		index[ iRoot ] = lowLink[ iRoot ] = iNextIndex++;
+		stack.push_back( iRoot );
+		onStack[ iRoot ] = true;
+		callStack.emplace_back( iRoot, 0 );
+
+		while( !callStack.empty() )
+		{
+			const int iNode = callStack.back().first;
+			const CNode& node = graph.m_pNodes[ iNode ];
+
+			if( callStack.back().second < node.m_cNumLinks )
+			{
+				const int iLink = node.m_iFirstLink + callStack.back().second++;
+				const int iDest = graph.m_pLinkPool[ iLink ].m_iDestNode;
+
+				if( !linkPassable[ iLink ] || m_RegionOfNode[ iDest ] != m_RegionOfNode[ iNode ] )
+					continue;
+
+				if( index[ iDest ] == -1 )
+				{
+					index[ iDest ] = lowLink[ iDest ] = iNextIndex++;
+					stack.push_back( iDest );
+					onStack[ iDest ] = true;
+					callStack.emplace_back( iDest, 0 );
+				}
+				else if( onStack[ iDest ] )
+				{
+					lowLink[ iNode ] = min( lowLink[ iNode ], index[ iDest ] );
+				}
+
+				continue;
+			}
+
+			if( lowLink[ iNode ] == index[ iNode ] )
+			{
+				int iMember;
+
+				do
+				{
+					iMember = stack.back();
+					stack.pop_back();
+					onStack[ iMember ] = false;
+					components[ iMember ] = cComponents;
+				}
+				while( iMember != iNode );
+
+				++cComponents;
+			}
+
+			callStack.pop_back();
+
+			if( !callStack.empty() )
+			{
+				const int iParent = callStack.back().first;
+				lowLink[ iParent ] = min( lowLink[ iParent ], lowLink[ iNode ] );
+			}
+		}
+	}
+
+	return cComponents;
+}
+
+bool CNodeHierarchy::BuildRouteTable( const CGraph& graph, RouteTable_t& table, const std::vector<char>& linkPassable, const int iNumThreads )
+{
+	const int cNodes = graph.m_cNodes;
+	const int cRegions = GetRegionCount();
+
+	//Nodes in a region that can reach each other without leaving the region form an area.
+	std::vector<int> components;
+
+	const int cComponents = FindStrongComponents( graph, linkPassable, components );
+
+	std::vector<char> hasExit( cComponents, false );
+
+	for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+	{
+		const CLink& link = graph.m_pLinkPool[ iLink ];
+
+		if( linkPassable[ iLink ] && components[ link.m_iSrcNode ] != components[ link.m_iDestNode ] )
+			hasExit[ components[ link.m_iSrcNode ] ] = hasExit[ components[ link.m_iDestNode ] ] = true;
+	}
+
+	//Areas that connect to other areas come first, so the exit table only needs to cover those.
+	std::vector<int> areaOfComponent( cComponents );
+
+	table.cAreas = 0;
+
+	for( int iPass = 0; iPass < 2; ++iPass )
+	{
+		for( int i = 0; i < cComponents; ++i )
+		{
+			if( hasExit[ i ] == ( iPass == 0 ) )
+				areaOfComponent[ i ] = table.cAreas++;
+		}
+
+		if( iPass == 0 )
+			table.cExitAreas = table.cAreas;
+	}
+
+	table.AreaOfNode.resize( cNodes );
+
+	for( int i = 0; i < cNodes; ++i )
+	{
+		table.AreaOfNode[ i ] = areaOfComponent[ components[ i ] ];
+	}
+
+	//Compute and compress the routes between nodes in the same region. Regions are independent, so they are spread across threads.
+	ctpl::thread_pool pool( max( 1, iNumThreads ) );
+
+	std::vector<std::vector<char>> regionRoutes( cRegions );
+	std::vector<int> localOffsets( cNodes );
+
+	{
+		std::vector<std::future<void>> results;
+		results.reserve( cRegions );
+
+		for( int iRegion = 0; iRegion < cRegions; ++iRegion )
+		{
+			results.emplace_back( pool.push(
+				[ &, iRegion ]( int )
+				{
+					const int iFirst = m_RegionStart[ iRegion ];
+					const int cRegionNodes = m_RegionStart[ iRegion + 1 ] - iFirst;
+
+					float flDistance[ MAX_REGION_NODES ];
+					int iFirstHop[ MAX_REGION_NODES ];
+					unsigned short bestNextNodes[ MAX_REGION_NODES ];
+					char route[ MAX_REGION_NODES * 2 ];
+
+					PriorityQueue_t queue;
+
+					auto& routes = regionRoutes[ iRegion ];
+
+					for( int iFrom = 0; iFrom < cRegionNodes; ++iFrom )
+					{
+						for( int i = 0; i < cRegionNodes; ++i )
+						{
+							flDistance[ i ] = FLT_MAX;
+							iFirstHop[ i ] = iFrom;
+						}
+
+						flDistance[ iFrom ] = 0;
+						queue.emplace( 0.0f, iFrom );
+
+						while( !queue.empty() )
+						{
+							const QueueEntry_t entry = queue.top();
+							queue.pop();
+
+							const int iCurrent = entry.second;
+
+							if( entry.first > flDistance[ iCurrent ] )
+								continue;
+
+							const CNode& node = graph.m_pNodes[ m_RegionNodes[ iFirst + iCurrent ] ];
+
+							for( int i = 0; i < node.m_cNumLinks; ++i )
+							{
+								const int iLink = node.m_iFirstLink + i;
+								const int iDest = graph.m_pLinkPool[ iLink ].m_iDestNode;
+
+								if( !linkPassable[ iLink ] || m_RegionOfNode[ iDest ] != iRegion )
+									continue;
+
+								const int iLocalDest = m_LocalIndex[ iDest ];
+								const float flNewDistance = flDistance[ iCurrent ] + graph.m_pLinkPool[ iLink ].m_flWeight;
+
+								if( flNewDistance < flDistance[ iLocalDest ] )
+								{
+									flDistance[ iLocalDest ] = flNewDistance;
+									iFirstHop[ iLocalDest ] = iCurrent == iFrom ? iLocalDest : iFirstHop[ iCurrent ];
+									queue.emplace( flNewDistance, iLocalDest );
+								}
+							}
+						}
+
+						//Unreachable nodes route to the node itself, which means there is no route.
+						for( int i = 0; i < cRegionNodes; ++i )
+						{
+							bestNextNodes[ i ] = iFirstHop[ i ];
+						}
+
+						const int cbRoute = CGraph::CompressRoute( bestNextNodes, cRegionNodes, iFrom, route );
+
+						localOffsets[ iFirst + iFrom ] = static_cast<int>( routes.size() );
+						routes.insert( routes.end(), route, route + cbRoute );
+					}
+				}
+			) );
+		}
+
+		for( auto& result : results )
+		{
+			result.get();
+		}
+	}
+
+	//Merge the routes, sharing identical ones.
+	std::unordered_map<std::string, int> routeOffsets;
+
+	table.RouteOffset.resize( cNodes );
+	table.Routes.clear();
+
+	for( int iRegion = 0; iRegion < cRegions; ++iRegion )
+	{
+		const auto& routes = regionRoutes[ iRegion ];
+
+		for( int i = m_RegionStart[ iRegion ]; i < m_RegionStart[ iRegion + 1 ]; ++i )
+		{
+			const int iStart = localOffsets[ i ];
+			const int iEnd = i + 1 < m_RegionStart[ iRegion + 1 ] ? localOffsets[ i + 1 ] : static_cast<int>( routes.size() );
+
+			std::string key( routes.data() + iStart, iEnd - iStart );
+
+			auto it = routeOffsets.find( key );
+
+			if( it == routeOffsets.end() )
+			{
+				it = routeOffsets.emplace( std::move( key ), static_cast<int>( table.Routes.size() ) ).first;
+				table.Routes.insert( table.Routes.end(), routes.begin() + iStart, routes.begin() + iEnd );
+			}
+
+			table.RouteOffset[ m_RegionNodes[ i ] ] = it->second;
+		}
+
+		std::vector<char>().swap( regionRoutes[ iRegion ] );
+	}
+
+	table.Routes.shrink_to_fit();
+
+	//Build the graph of areas. Each area is treated as a point at its center,
+	//and the cheapest link between 2 areas is used to get from one to the other.
+	const int cExitAreas = table.cExitAreas;
+
+	std::vector<Vector> centers( cExitAreas, Vector( 0, 0, 0 ) );
+	std::vector<int> centerCounts( cExitAreas, 0 );
+
+	for( int i = 0; i < cNodes; ++i )
+	{
+		const int iArea = table.AreaOfNode[ i ];
+
+		if( iArea < cExitAreas )
+		{
+			centers[ iArea ] = centers[ iArea ] + graph.m_pNodes[ i ].m_vecOrigin;
+			++centerCounts[ iArea ];
+		}
+	}
+
+	for( int i = 0; i < cExitAreas; ++i )
+	{
+		centers[ i ] = centers[ i ] / centerCounts[ i ];
+	}
+
+	struct AreaEdge_t
+	{
+		int iSrcArea;
+		int iDestArea;
+		float flWeight;
+		int iLink;
+	};
+
+	std::vector<AreaEdge_t> edges;
+	std::unordered_map<long long, size_t> edgeIndices;
+
+	for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+	{
+		const CLink& link = graph.m_pLinkPool[ iLink ];
+
+		if( !linkPassable[ iLink ] )
+			continue;
+
+		const int iSrcArea = table.AreaOfNode[ link.m_iSrcNode ];
+		const int iDestArea = table.AreaOfNode[ link.m_iDestNode ];
+
+		if( iSrcArea == iDestArea )
+			continue;
+
+		const float flWeight = ( graph.m_pNodes[ link.m_iSrcNode ].m_vecOrigin - centers[ iSrcArea ] ).Length()
+			+ link.m_flWeight
+			+ ( centers[ iDestArea ] - graph.m_pNodes[ link.m_iDestNode ].m_vecOrigin ).Length();
+
+		const long long key = static_cast<long long>( iSrcArea ) * cExitAreas + iDestArea;
+
+		auto it = edgeIndices.find( key );
+
+		if( it == edgeIndices.end() )
+		{
+			edgeIndices.emplace( key, edges.size() );
+			edges.push_back( { iSrcArea, iDestArea, flWeight, iLink } );
+		}
+		else if( flWeight < edges[ it->second ].flWeight )
+		{
+			edges[ it->second ].flWeight = flWeight;
+			edges[ it->second ].iLink = iLink;
+		}
+	}
+
+	//Incoming edges for each area.
+	std::vector<int> incomingStart( cExitAreas + 1, 0 );
+	std::vector<int> incomingEdges( edges.size() );
+
+	for( const auto& edge : edges )
+	{
+		++incomingStart[ edge.iDestArea + 1 ];
+	}
+
+	for( int i = 0; i < cExitAreas; ++i )
+	{
+		incomingStart[ i + 1 ] += incomingStart[ i ];
+	}
+
+	{
+		std::vector<int> fill( incomingStart.begin(), incomingStart.end() - 1 );
+
+		for( size_t i = 0; i < edges.size(); ++i )
+		{
+			incomingEdges[ fill[ edges[ i ].iDestArea ]++ ] = static_cast<int>( i );
+		}
+	}
+
+	table.ExitLinks.assign( static_cast<size_t>( cExitAreas ) * cExitAreas, -1 );
+
+	//Search backwards from every area. The link that first reaches an area leads to the next area on its route.
+	//Every step moves to an area that is closer to the destination, so routes can't loop.
+	{
+		std::vector<std::vector<float>> distances( pool.size() );
+
+		std::vector<std::future<void>> results;
+		results.reserve( cExitAreas );
+
+		for( int iDestArea = 0; iDestArea < cExitAreas; ++iDestArea )
+		{
+			results.emplace_back( pool.push(
+				[ &, iDestArea ]( int iThread )
+				{
+					auto& distance = distances[ iThread ];
+
+					distance.assign( cExitAreas, FLT_MAX );
+
+					PriorityQueue_t queue;
+
+					distance[ iDestArea ] = 0;
+					queue.emplace( 0.0f, iDestArea );
+
+					while( !queue.empty() )
+					{
+						const QueueEntry_t entry = queue.top();
+						queue.pop();
+
+						const int iArea = entry.second;
+
+						if( entry.first > distance[ iArea ] )
+							continue;
+
+						for( int i = incomingStart[ iArea ]; i < incomingStart[ iArea + 1 ]; ++i )
+						{
+							const AreaEdge_t& edge = edges[ incomingEdges[ i ] ];
+
+							const float flNewDistance = distance[ iArea ] + edge.flWeight;
+
+							if( flNewDistance < distance[ edge.iSrcArea ] )
+							{
+								distance[ edge.iSrcArea ] = flNewDistance;
+								table.ExitLinks[ static_cast<size_t>( edge.iSrcArea ) * cExitAreas + iDestArea ] = edge.iLink;
+								queue.emplace( flNewDistance, edge.iSrcArea );
+							}
+						}
+					}
+				}
+			) );
+		}
+
+		for( auto& result : results )
+		{
+			result.get();
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,135 @@
+#ifndef GAME_SERVER_NODES_CNODEHIERARCHY_H
+#define GAME_SERVER_NODES_CNODEHIERARCHY_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "NodeConstants.h"
+
+class CGraph;
+
+/**
+*	Two level routing tables for graphs that are too large for the flat per node tables, which grow with the square of the node count.
+*
+*	Nodes are clustered into connected regions of up to MAX_REGION_NODES nodes. For each hull and capability, the nodes in a region
+*	that can reach each other form an area. Full routes are only stored between nodes in the same region,
+*	compressed the same way as the flat tables. Routes between areas are stored as the link to take out of an area towards another area,
+*	chosen by a search over the graph of areas.
+*	Memory grows linearly with the node count, plus the square of the number of areas that have links to other areas.
+*
+*	Routes between areas aren't guaranteed to be the shortest, since areas are treated as single points.
+*/
+class CNodeHierarchy final
+{
+public:
+	/**
+	*	Maximum number of nodes in a region. Local node offsets must fit in a char for the route compression to work.
+	*/
+	static const int MAX_REGION_NODES = 128;
+
+	CNodeHierarchy() = default;
+	~CNodeHierarchy() = default;
+
+	/**
+	*	@return Whether the tables have been built or loaded.
+	*/
+	bool IsBuilt() const { return m_cNodes > 0; }
+
+	/**
+	*	@return Number of regions.
+	*/
+	int GetRegionCount() const { return static_cast<int>( m_RegionStart.size() ) - 1; }
+
+	/**
+	*	@return Approximate number of bytes used by the tables.
+	*/
+	size_t GetMemoryUsage() const;
+
+	/**
+	*	Tells whether a link can be used by monsters with the given capabilities, ignoring hulls.
+	*	Parameters are the link index and the capability mask.
+	*/
+	using LinkPassableFn = std::function<bool( int, int )>;
+
+	/**
+	*	Builds the tables for all hulls and capabilities. isLinkPassable is only called on the calling thread.
+	*	@param iNumThreads Number of threads to compute routes within regions on.
+	*	@return Whether the tables were built. Fails only if memory could not be allocated.
+	*/
+	bool Build( const CGraph& graph, const LinkPassableFn& isLinkPassable, const int iNumThreads );
+
+	/**
+	*	Frees all memory used by the tables.
+	*/
+	void Clear();
+
+	/**
+	*	Has the same contract as CGraph::NextNodeInRoute.
+	*	@return The next node to move to, or iCurrentNode if iDest can't be reached.
+	*/
+	int NextNodeInRoute( const CGraph& graph, const int iCurrentNode, const int iDest, const int iHull, const int iCap ) const;
+
+	/**
+	*	Appends the tables to the given buffer, for saving in the node graph file.
+	*/
+	void Serialize( std::vector<unsigned char>& data ) const;
+
+	/**
+	*	Loads tables written by Serialize.
+	*	@return Whether the tables were valid for the given graph. If not, the hierarchy is left empty.
+	*/
+	bool Deserialize( const CGraph& graph, const unsigned char* pData, const size_t uiSize );
+
+private:
+	struct RouteTable_t
+	{
+		//Area of each node. Areas below cExitAreas have links to other areas.
+		std::vector<int> AreaOfNode;
+		int cAreas = 0;
+		int cExitAreas = 0;
+
+		//Offset of each node's compressed routes to the other nodes in its region.
+		std::vector<int> RouteOffset;
+		std::vector<char> Routes;
+
+		//cExitAreas * cExitAreas links to take out of an area towards another area, or -1 if there is no route.
+		std::vector<int> ExitLinks;
+	};
+
+	/**
+	*	Clusters the nodes into regions by walking their links breadth first.
+	*/
+	void BuildRegions( const CGraph& graph );
+
+	/**
+	*	Fills in the offset of each node in its region.
+	*/
+	void BuildLocalIndices();
+
+	/**
+	*	Finds the strongly connected components of each region, using only passable links.
+	*	@return Number of components.
+	*/
+	int FindStrongComponents( const CGraph& graph, const std::vector<char>& linkPassable, std::vector<int>& components ) const;
+
+	bool BuildRouteTable( const CGraph& graph, RouteTable_t& table, const std::vector<char>& linkPassable, const int iNumThreads );
+
+private:
+	int m_cNodes = 0;
+
+	std::vector<int> m_RegionOfNode;
+	std::vector<int> m_LocalIndex;
+
+	//Index in m_RegionNodes of each region's first node. Has one more entry than there are regions.
+	std::vector<int> m_RegionStart;
+	std::vector<int> m_RegionNodes;
+
+	RouteTable_t m_Tables[ MAX_NODE_HULLS ][ 2 ];
+
+private:
+	CNodeHierarchy( const CNodeHierarchy& ) = delete;
+	CNodeHierarchy& operator=( const CNodeHierarchy& ) = delete;
+};
+
+#endif //GAME_SERVER_NODES_CNODEHIERARCHY_H
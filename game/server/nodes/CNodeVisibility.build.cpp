@@ -0,0 +1,115 @@
+//=========================================================
+// CNodeVisibility.build.cpp - the parts of the visibility
+// matrix that build it and read and write it. Lines of sight
+// are tested by the caller, so the offline node graph
+// compiler shares them.
+//=========================================================
+
+#include <cstring>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+
+#include "CNodeVisibility.h"
+
+void CNodeVisibility::Build( const CGraph& graph, const LineOfSightFn& isVisible )
+{
+	Clear();
+
+	if( graph.m_cNodes <= 0 || graph.m_cNodes > MAX_MATRIX_NODES )
+		return;
+
+	m_cNodes = graph.m_cNodes;
+	m_cWordsPerRow = ( m_cNodes + 31 ) / 32;
+	m_Bits.resize( m_cNodes * m_cWordsPerRow );
+
+	const Vector vecEyeOffset( 0, 0, EYE_HEIGHT );
+
+	const float flMaxDistSquared = static_cast<float>( MAX_DISTANCE ) * MAX_DISTANCE;
+
+	unsigned int uiTraces = 0;
+
+	for( int iNode = 0; iNode < m_cNodes; ++iNode )
+	{
+		const Vector vecStart = graph.m_pNodes[ iNode ].m_vecOrigin + vecEyeOffset;
+
+		//A node can always see itself.
+		SetBit( iNode, iNode );
+
+		//Lines of sight go both ways, so each pair is traced once.
+		for( int iOther = iNode + 1; iOther < m_cNodes; ++iOther )
+		{
+			const Vector vecEnd = graph.m_pNodes[ iOther ].m_vecOrigin + vecEyeOffset;
+
+			const Vector vecDelta = vecEnd - vecStart;
+
+			if( DotProduct( vecDelta, vecDelta ) > flMaxDistSquared )
+				continue;
+
+			++uiTraces;
+
+			if( isVisible( vecStart, vecEnd ) )
+			{
+				SetBit( iNode, iOther );
+				SetBit( iOther, iNode );
+			}
+		}
+	}
+
+	ALERT( at_aiconsole, "Built node visibility for %d nodes, %u traces, %u bytes\n", m_cNodes, uiTraces, static_cast<unsigned int>( GetMemoryUsage() ) );
+}
+
+void CNodeVisibility::Clear()
+{
+	m_cNodes = 0;
+	m_cWordsPerRow = 0;
+	m_Bits.clear();
+	m_Bits.shrink_to_fit();
+}
+
+void CNodeVisibility::Serialize( std::vector<unsigned char>& data ) const
+{
+	if( !IsBuilt() )
+		return;
+
+	const int header[] = { m_cNodes, EYE_HEIGHT, MAX_DISTANCE };
+
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>( header );
+	data.insert( data.end(), pBytes, pBytes + sizeof( header ) );
+
+	pBytes = reinterpret_cast<const unsigned char*>( m_Bits.data() );
+	data.insert( data.end(), pBytes, pBytes + GetMemoryUsage() );
+}
+
+bool CNodeVisibility::Deserialize( const CGraph& graph, const unsigned char* pData, const size_t uiSize )
+{
+	Clear();
+
+	int header[ 3 ];
+
+	if( uiSize < sizeof( header ) )
+		return false;
+
+	memcpy( header, pData, sizeof( header ) );
+
+	if( header[ 0 ] != graph.m_cNodes || header[ 0 ] <= 0 || header[ 0 ] > MAX_MATRIX_NODES || header[ 1 ] != EYE_HEIGHT || header[ 2 ] != MAX_DISTANCE )
+		return false;
+
+	const int cWordsPerRow = ( header[ 0 ] + 31 ) / 32;
+
+	const size_t uiBitsSize = static_cast<size_t>( header[ 0 ] ) * cWordsPerRow * sizeof( uint32_t );
+
+	if( uiSize != sizeof( header ) + uiBitsSize )
+		return false;
+
+	m_cNodes = header[ 0 ];
+	m_cWordsPerRow = cWordsPerRow;
+	m_Bits.resize( m_cNodes * m_cWordsPerRow );
+
+	memcpy( m_Bits.data(), pData + sizeof( header ), uiBitsSize );
+
+	return true;
+}
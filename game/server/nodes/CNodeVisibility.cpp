@@ -0,0 +1,44 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+#include "Server.h"
+
+#include "CNodeVisibility.h"
+
+CNodeVisibility g_NodeVisibility;
+
+bool CNodeVisibility::ShouldBuild( const CGraph& graph )
+{
+	return sv_nodegraph_visibility.value != 0 && graph.m_cNodes > 1 && graph.m_cNodes <= MAX_MATRIX_NODES;
+}
+
+void CNodeVisibility::Build( const CGraph& graph )
+{
+	Build( graph,
+		[]( const Vector& vecStart, const Vector& vecEnd )
+		{
+			TraceResult tr;
+
+			UTIL_TraceLine( vecStart, vecEnd, ignore_monsters, nullptr, &tr );
+
+			return tr.flFraction == 1.0;
+		} );
+}
+
+NodeVisibility CNodeVisibility::Test( const CGraph& graph, const int iNode, const int iOther ) const
+{
+	if( sv_nodegraph_visibility.value == 0 || m_cNodes != graph.m_cNodes )
+		return NodeVisibility::UNKNOWN;
+
+	if( iNode < 0 || iNode >= m_cNodes || iOther < 0 || iOther >= m_cNodes )
+		return NodeVisibility::UNKNOWN;
+
+	const Vector vecDelta = graph.m_pNodes[ iOther ].m_vecOrigin - graph.m_pNodes[ iNode ].m_vecOrigin;
+
+	if( DotProduct( vecDelta, vecDelta ) > static_cast<float>( MAX_DISTANCE ) * MAX_DISTANCE )
+		return NodeVisibility::UNKNOWN;
+
+	return GetBit( iNode, iOther ) ? NodeVisibility::VISIBLE : NodeVisibility::HIDDEN;
+}
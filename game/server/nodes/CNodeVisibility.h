@@ -0,0 +1,126 @@
+#ifndef GAME_SERVER_NODES_CNODEVISIBILITY_H
+#define GAME_SERVER_NODES_CNODEVISIBILITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class CGraph;
+class Vector;
+
+/**
+*	Result of a node to node visibility test.
+*/
+enum class NodeVisibility
+{
+	/**
+	*	The pair wasn't traced, because the nodes are too far apart or no matrix was built.
+	*/
+	UNKNOWN = 0,
+	VISIBLE,
+	HIDDEN
+};
+
+/**
+*	Precomputed line of sight between nodes, one bit per pair of nodes, traced at eye height.
+*	Only pairs that are within MAX_DISTANCE of each other are traced; other pairs are unknown.
+*	Used by cover searches to skip candidate nodes before tracing from them, so it only needs to be right most of the time.
+*/
+class CNodeVisibility final
+{
+public:
+	/**
+	*	Height above node origins that lines of sight are traced from.
+	*/
+	static const int EYE_HEIGHT = 64;
+
+	/**
+	*	Nodes farther apart than this aren't traced.
+	*/
+	static const int MAX_DISTANCE = 2048;
+
+	/**
+	*	Graphs with more nodes than this don't get a matrix. The matrix grows with the square of the node count.
+	*/
+	static const int MAX_MATRIX_NODES = 4096;
+
+	CNodeVisibility() = default;
+	~CNodeVisibility() = default;
+
+	/**
+	*	@return Whether the matrix has been built or loaded.
+	*/
+	bool IsBuilt() const { return m_cNodes > 0; }
+
+	/**
+	*	@return Whether a matrix can be built for the given graph, and sv_nodegraph_visibility allows it.
+	*/
+	static bool ShouldBuild( const CGraph& graph );
+
+	/**
+	*	@return Number of bytes used by the matrix.
+	*/
+	size_t GetMemoryUsage() const { return m_Bits.size() * sizeof( uint32_t ); }
+
+	/**
+	*	Tells whether there is a line of sight between 2 points. Parameters are the start and end points.
+	*/
+	using LineOfSightFn = std::function<bool( const Vector&, const Vector& )>;
+
+	/**
+	*	Traces between all pairs of nodes that are close enough. Must be called on the main thread, since it traces.
+	*/
+	void Build( const CGraph& graph );
+
+	/**
+	*	Tests all pairs of nodes that are close enough with isVisible, which is only called on the calling thread.
+	*/
+	void Build( const CGraph& graph, const LineOfSightFn& isVisible );
+
+	/**
+	*	Frees all memory used by the matrix.
+	*/
+	void Clear();
+
+	/**
+	*	@return Whether node iNode can see node iOther. Unknown if sv_nodegraph_visibility is 0.
+	*/
+	NodeVisibility Test( const CGraph& graph, const int iNode, const int iOther ) const;
+
+	/**
+	*	Appends the matrix to the given buffer, for saving in the node graph file.
+	*/
+	void Serialize( std::vector<unsigned char>& data ) const;
+
+	/**
+	*	Loads a matrix written by Serialize. Matrices written with different constants are ignored.
+	*	@return Whether the matrix was valid for the given graph. If not, the matrix is left empty.
+	*/
+	bool Deserialize( const CGraph& graph, const unsigned char* pData, const size_t uiSize );
+
+private:
+	bool GetBit( const int iNode, const int iOther ) const
+	{
+		return ( m_Bits[ iNode * m_cWordsPerRow + iOther / 32 ] & ( 1u << ( iOther % 32 ) ) ) != 0;
+	}
+
+	void SetBit( const int iNode, const int iOther )
+	{
+		m_Bits[ iNode * m_cWordsPerRow + iOther / 32 ] |= 1u << ( iOther % 32 );
+	}
+
+private:
+	int m_cNodes = 0;
+	int m_cWordsPerRow = 0;
+
+	std::vector<uint32_t> m_Bits;
+
+private:
+	CNodeVisibility( const CNodeVisibility& ) = delete;
+	CNodeVisibility& operator=( const CNodeVisibility& ) = delete;
+};
+
+extern CNodeVisibility g_NodeVisibility;
+
+#endif //GAME_SERVER_NODES_CNODEVISIBILITY_H
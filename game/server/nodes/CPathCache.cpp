@@ -0,0 +1,139 @@
+#include <iterator>
+
+#include "CPathCache.h"
+
+CPathCache g_PathCache;
+
+void CPathCache::SetCapacity( const size_t uiCapacity )
+{
+	m_uiCapacity = uiCapacity;
+
+	while( m_Entries.size() > m_uiCapacity )
+	{
+		m_Index.erase( m_Entries.back().key );
+		m_Entries.pop_back();
+		++m_Stats.uiEvictions;
+	}
+}
+
+bool CPathCache::FindPath( const int iStart, const int iDest, const int iHull, const int afCapMask, int* piPath, int& cPathNodes )
+{
+	++m_Stats.uiPathLookups;
+
+	const Entry_t* pEntry = Find( { iStart, iDest, iHull, afCapMask, false } );
+
+	if( !pEntry )
+		return false;
+
+	++m_Stats.uiPathHits;
+
+	cPathNodes = static_cast<int>( pEntry->path.size() );
+
+	for( int i = 0; i < cPathNodes; ++i )
+	{
+		piPath[ i ] = pEntry->path[ i ];
+	}
+
+	return true;
+}
+
+void CPathCache::AddPath( const int iStart, const int iDest, const int iHull, const int afCapMask, const int* piPath, const int cPathNodes )
+{
+	if( Entry_t* pEntry = Add( { iStart, iDest, iHull, afCapMask, false } ) )
+	{
+		pEntry->path.assign( piPath, piPath + cPathNodes );
+	}
+}
+
+bool CPathCache::FindLength( const int iStart, const int iDest, const int iHull, const int iCap, float& flLength )
+{
+	++m_Stats.uiLengthLookups;
+
+	const Entry_t* pEntry = Find( { iStart, iDest, iHull, iCap, true } );
+
+	if( !pEntry )
+		return false;
+
+	++m_Stats.uiLengthHits;
+
+	flLength = pEntry->flLength;
+
+	return true;
+}
+
+void CPathCache::AddLength( const int iStart, const int iDest, const int iHull, const int iCap, const float flLength )
+{
+	if( Entry_t* pEntry = Add( { iStart, iDest, iHull, iCap, true } ) )
+	{
+		pEntry->flLength = flLength;
+	}
+}
+
+void CPathCache::Invalidate()
+{
+	if( m_Entries.empty() )
+		return;
+
+	Clear();
+
+	++m_Stats.uiInvalidations;
+}
+
+void CPathCache::Clear()
+{
+	m_Entries.clear();
+	m_Index.clear();
+}
+
+void CPathCache::ResetStats()
+{
+	m_Stats = PathCacheStats_t();
+}
+
+CPathCache::Entry_t* CPathCache::Find( const Key_t& key )
+{
+	auto it = m_Index.find( key );
+
+	if( it == m_Index.end() )
+		return nullptr;
+
+	m_Entries.splice( m_Entries.begin(), m_Entries, it->second );
+
+	return &m_Entries.front();
+}
+
+CPathCache::Entry_t* CPathCache::Add( const Key_t& key )
+{
+	if( m_uiCapacity == 0 )
+		return nullptr;
+
+	auto it = m_Index.find( key );
+
+	if( it != m_Index.end() )
+	{
+		m_Entries.splice( m_Entries.begin(), m_Entries, it->second );
+		return &m_Entries.front();
+	}
+
+	if( m_Entries.size() >= m_uiCapacity )
+	{
+		//Reuse the least recently used entry's memory.
+		m_Index.erase( m_Entries.back().key );
+		m_Entries.splice( m_Entries.begin(), m_Entries, std::prev( m_Entries.end() ) );
+		++m_Stats.uiEvictions;
+	}
+	else
+	{
+		m_Entries.emplace_front();
+	}
+
+	Entry_t& entry = m_Entries.front();
+
+	entry.key = key;
+	entry.path.clear();
+	entry.flLength = 0;
+
+	m_Index.emplace( key, m_Entries.begin() );
+
+	return &entry;
+}
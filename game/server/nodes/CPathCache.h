@@ -0,0 +1,140 @@
+#ifndef GAME_SERVER_NODES_CPATHCACHE_H
+#define GAME_SERVER_NODES_CPATHCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+*	Path cache statistics, used to size the cache.
+*/
+struct PathCacheStats_t
+{
+	unsigned int uiPathLookups = 0;
+	unsigned int uiPathHits = 0;
+	unsigned int uiLengthLookups = 0;
+	unsigned int uiLengthHits = 0;
+
+	//Entries removed to make room for new ones.
+	unsigned int uiEvictions = 0;
+
+	//Number of times the cache was emptied because link entities changed state.
+	unsigned int uiInvalidations = 0;
+};
+
+/**
+*	Least recently used cache of the results of CGraph::FindShortestPath and CGraph::PathLength.
+*	Monsters in the same squad or room often ask for the same paths within a few seconds of each other.
+*	Results depend on the state of link entities such as doors, so the whole cache is emptied when one of them changes state.
+*/
+class CPathCache final
+{
+public:
+	CPathCache() = default;
+	~CPathCache() = default;
+
+	size_t GetSize() const { return m_Entries.size(); }
+
+	size_t GetCapacity() const { return m_uiCapacity; }
+
+	/**
+	*	Sets the maximum number of entries. Entries are evicted if there are more than that. 0 disables the cache.
+	*/
+	void SetCapacity( const size_t uiCapacity );
+
+	/**
+	*	Looks up a path found by CGraph::FindShortestPath.
+	*	@param[ out ] cPathNodes Number of nodes written to piPath, or 0 if no path exists.
+	*	@return Whether the path was in the cache.
+	*/
+	bool FindPath( const int iStart, const int iDest, const int iHull, const int afCapMask, int* piPath, int& cPathNodes );
+
+	void AddPath( const int iStart, const int iDest, const int iHull, const int afCapMask, const int* piPath, const int cPathNodes );
+
+	/**
+	*	Looks up a length computed by CGraph::PathLength.
+	*	@return Whether the length was in the cache.
+	*/
+	bool FindLength( const int iStart, const int iDest, const int iHull, const int iCap, float& flLength );
+
+	void AddLength( const int iStart, const int iDest, const int iHull, const int iCap, const float flLength );
+
+	/**
+	*	Empties the cache because a link entity changed state.
+	*/
+	void Invalidate();
+
+	/**
+	*	Empties the cache without counting it as an invalidation.
+	*/
+	void Clear();
+
+	const PathCacheStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+private:
+	struct Key_t
+	{
+		int iStart;
+		int iDest;
+		int iHull;
+		int afCapMask;
+		bool bLength;
+
+		bool operator==( const Key_t& other ) const
+		{
+			return iStart == other.iStart && iDest == other.iDest && iHull == other.iHull && afCapMask == other.afCapMask && bLength == other.bLength;
+		}
+	};
+
+	struct KeyHash_t
+	{
+		size_t operator()( const Key_t& key ) const
+		{
+			size_t hash = static_cast<size_t>( key.iStart ) * 73856093u;
+			hash ^= static_cast<size_t>( key.iDest ) * 19349663u;
+			hash ^= static_cast<size_t>( key.iHull ) * 83492791u;
+			hash ^= static_cast<size_t>( static_cast<unsigned int>( key.afCapMask ) ) * 2654435761u;
+			return hash ^ static_cast<size_t>( key.bLength );
+		}
+	};
+
+	struct Entry_t
+	{
+		Key_t key;
+		std::vector<int> path;
+		float flLength;
+	};
+
+	using EntryList_t = std::list<Entry_t>;
+
+	/**
+	*	Finds an entry and marks it as the most recently used.
+	*/
+	Entry_t* Find( const Key_t& key );
+
+	/**
+	*	Adds an entry as the most recently used, evicting the least recently used if the cache is full.
+	*/
+	Entry_t* Add( const Key_t& key );
+
+private:
+	size_t m_uiCapacity = 0;
+
+	//Most recently used first.
+	EntryList_t m_Entries;
+
+	std::unordered_map<Key_t, EntryList_t::iterator, KeyHash_t> m_Index;
+
+	PathCacheStats_t m_Stats;
+
+private:
+	CPathCache( const CPathCache& ) = delete;
+	CPathCache& operator=( const CPathCache& ) = delete;
+};
+
+extern CPathCache g_PathCache;
+
+#endif //GAME_SERVER_NODES_CPATHCACHE_H
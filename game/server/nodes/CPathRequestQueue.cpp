@@ -0,0 +1,203 @@
+#include <chrono>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CGraph.h"
+#include "Server.h"
+
+#include "CPathRequestQueue.h"
+
+extern DLL_GLOBAL unsigned int g_ulFrameCount;
+
+CPathRequestQueue g_PathRequestQueue;
+
+PathRequestId CPathRequestQueue::Submit( const int iStart, const int iDest, const int iHull, const int afCapMask )
+{
+	++m_Stats.uiSubmitted;
+
+	const RequestKey_t key( iStart, iDest, iHull, afCapMask );
+
+	auto pending = m_Pending.find( key );
+
+	if( pending != m_Pending.end() )
+	{
+		++m_Requests[ pending->second ].cSubscribers;
+		++m_Stats.uiMerged;
+		return pending->second;
+	}
+
+	const PathRequestId id = m_NextId++;
+
+	if( m_NextId == INVALID_PATH_REQUEST )
+		m_NextId = INVALID_PATH_REQUEST + 1;
+
+	Request_t request;
+
+	request.key = key;
+	request.flSubmitTime = gpGlobals->time;
+	request.uiSubmitFrame = g_ulFrameCount;
+
+	m_Requests.emplace( id, std::move( request ) );
+	m_Pending.emplace( key, id );
+	m_Queue.push_back( id );
+
+	m_Stats.uiMaxDepth = max( m_Stats.uiMaxDepth, static_cast<unsigned int>( m_Queue.size() ) );
+
+	return id;
+}
+
+PathRequestState CPathRequestQueue::GetState( const PathRequestId id ) const
+{
+	auto it = m_Requests.find( id );
+
+	if( it == m_Requests.end() )
+		return PathRequestState::UNKNOWN;
+
+	return it->second.bDone ? PathRequestState::DONE : PathRequestState::PENDING;
+}
+
+bool CPathRequestQueue::IsRequestFor( const PathRequestId id, const int iStart, const int iDest, const int iHull, const int afCapMask ) const
+{
+	auto it = m_Requests.find( id );
+
+	return it != m_Requests.end() && it->second.key == RequestKey_t( iStart, iDest, iHull, afCapMask );
+}
+
+int CPathRequestQueue::TakeResult( const PathRequestId id, int* piPath, const int iMaxPath )
+{
+	auto it = m_Requests.find( id );
+
+	if( it == m_Requests.end() || !it->second.bDone )
+		return 0;
+
+	const auto& path = it->second.path;
+
+	const int cPath = min( static_cast<int>( path.size() ), max( 0, iMaxPath ) );
+
+	for( int i = 0; i < cPath; ++i )
+	{
+		piPath[ i ] = path[ i ];
+	}
+
+	Unsubscribe( id );
+
+	return cPath;
+}
+
+void CPathRequestQueue::Release( const PathRequestId id )
+{
+	if( m_Requests.find( id ) != m_Requests.end() )
+		Unsubscribe( id );
+}
+
+void CPathRequestQueue::RunFrame()
+{
+	DropExpiredResults();
+
+	if( m_Queue.empty() )
+		return;
+
+	using Clock = std::chrono::steady_clock;
+
+	const auto frameStart = Clock::now();
+	const long long iBudget = max( 0, static_cast<int>( sv_nodegraph_path_budget.value ) );
+
+	bool bSearched = false;
+
+	m_SearchPath.resize( max( WorldGraph.m_cNodes, MAX_PATH_SIZE ) );
+
+	while( !m_Queue.empty() )
+	{
+		const auto searchStart = Clock::now();
+
+		if( bSearched && std::chrono::duration_cast<std::chrono::microseconds>( searchStart - frameStart ).count() >= iBudget )
+		{
+			++m_Stats.uiBudgetExceeded;
+			break;
+		}
+
+		const PathRequestId id = m_Queue.front();
+		m_Queue.pop_front();
+
+		auto it = m_Requests.find( id );
+
+		//Released before it was searched.
+		if( it == m_Requests.end() )
+			continue;
+
+		auto& request = it->second;
+
+		m_Pending.erase( request.key );
+
+		const int cPath = WorldGraph.FindShortestPath( m_SearchPath.data(),
+			std::get<0>( request.key ), std::get<1>( request.key ), std::get<2>( request.key ), std::get<3>( request.key ) );
+
+		m_Stats.ullSearchMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - searchStart ).count();
+
+		request.path.assign( m_SearchPath.begin(), m_SearchPath.begin() + cPath );
+		request.bDone = true;
+		request.flDoneTime = gpGlobals->time;
+
+		const float flWait = gpGlobals->time - request.flSubmitTime;
+		const unsigned int uiWaitFrames = g_ulFrameCount - request.uiSubmitFrame;
+
+		++m_Stats.uiSearched;
+		m_Stats.flTotalWait += flWait;
+		m_Stats.flMaxWait = max( m_Stats.flMaxWait, flWait );
+		m_Stats.ullTotalWaitFrames += uiWaitFrames;
+		m_Stats.uiMaxWaitFrames = max( m_Stats.uiMaxWaitFrames, uiWaitFrames );
+
+		bSearched = true;
+	}
+}
+
+void CPathRequestQueue::Clear()
+{
+	//Ids aren't reused, so monsters that still hold one will see it as unknown.
+	m_Requests.clear();
+	m_Queue.clear();
+	m_Pending.clear();
+}
+
+void CPathRequestQueue::ResetStats()
+{
+	m_Stats = PathRequestStats_t();
+}
+
+void CPathRequestQueue::Unsubscribe( const PathRequestId id )
+{
+	auto it = m_Requests.find( id );
+
+	if( --it->second.cSubscribers > 0 )
+		return;
+
+	if( !it->second.bDone )
+	{
+		//Nobody is waiting for it anymore, so don't search it.
+		m_Pending.erase( it->second.key );
+		++m_Stats.uiDropped;
+	}
+
+	m_Requests.erase( it );
+}
+
+void CPathRequestQueue::DropExpiredResults()
+{
+	for( auto it = m_Requests.begin(); it != m_Requests.end(); )
+	{
+		const auto& request = it->second;
+
+		//Monsters that were removed while waiting never take their result.
+		if( request.bDone && ( gpGlobals->time - request.flDoneTime > RESULT_LIFETIME || gpGlobals->time < request.flDoneTime ) )
+		{
+			++m_Stats.uiDropped;
+			it = m_Requests.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
@@ -0,0 +1,173 @@
+#ifndef GAME_SERVER_NODES_CPATHREQUESTQUEUE_H
+#define GAME_SERVER_NODES_CPATHREQUESTQUEUE_H
+
+#include <deque>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/**
+*	Identifies a request made to CPathRequestQueue. Requests for the same path share an id.
+*/
+using PathRequestId = unsigned int;
+
+const PathRequestId INVALID_PATH_REQUEST = 0;
+
+enum class PathRequestState
+{
+	/**
+	*	The request doesn't exist, or its result has already been taken.
+	*/
+	UNKNOWN = 0,
+
+	/**
+	*	Waiting to be searched.
+	*/
+	PENDING,
+
+	/**
+	*	The search has finished, the result can be taken.
+	*/
+	DONE
+};
+
+/**
+*	Path request queue statistics.
+*/
+struct PathRequestStats_t
+{
+	unsigned int uiSubmitted = 0;
+
+	//Requests that were merged with an identical pending request.
+	unsigned int uiMerged = 0;
+
+	unsigned int uiSearched = 0;
+
+	//Requests that were dropped before they were searched, or whose result was never taken.
+	unsigned int uiDropped = 0;
+
+	//Frames that ran out of time with requests left in the queue.
+	unsigned int uiBudgetExceeded = 0;
+
+	unsigned int uiMaxDepth = 0;
+
+	//Time between submitting a request and its search finishing.
+	double flTotalWait = 0;
+	float flMaxWait = 0;
+	unsigned long long ullTotalWaitFrames = 0;
+	unsigned int uiMaxWaitFrames = 0;
+
+	unsigned long long ullSearchMicroseconds = 0;
+};
+
+/**
+*	Spreads node graph path searches made by monsters across frames.
+*	Monsters submit a request and take the result on a later think. Identical pending requests (same start, destination, hull and capabilities)
+*	are merged so the search only runs once. Requests are searched at the start of each frame until sv_nodegraph_path_budget is used up.
+*/
+class CPathRequestQueue final
+{
+public:
+	/**
+	*	Finished requests whose result isn't taken within this many seconds are dropped.
+	*/
+	static constexpr float RESULT_LIFETIME = 5;
+
+	CPathRequestQueue() = default;
+	~CPathRequestQueue() = default;
+
+	/**
+	*	@return Number of requests waiting to be searched.
+	*/
+	size_t GetDepth() const { return m_Queue.size(); }
+
+	/**
+	*	Queues a path search. Has the same parameters as CGraph::FindShortestPath.
+	*	Every call must be matched by a call to TakeResult or Release with the returned id.
+	*/
+	PathRequestId Submit( const int iStart, const int iDest, const int iHull, const int afCapMask );
+
+	PathRequestState GetState( const PathRequestId id ) const;
+
+	/**
+	*	@return Whether the given request is for the given path.
+	*/
+	bool IsRequestFor( const PathRequestId id, const int iStart, const int iDest, const int iHull, const int afCapMask ) const;
+
+	/**
+	*	Copies the path found for a finished request and releases it.
+	*	Paths can be longer than MAX_PATH_SIZE when there are no routing tables; only the first iMaxPath nodes are copied.
+	*	@param piPath Destination for the path.
+	*	@param iMaxPath Number of nodes that piPath can hold.
+	*	@return Number of nodes written to piPath, or 0 if no path exists.
+	*/
+	int TakeResult( const PathRequestId id, int* piPath, const int iMaxPath );
+
+	/**
+	*	Releases a request without taking the result. Pending requests that nobody is waiting for are never searched.
+	*/
+	void Release( const PathRequestId id );
+
+	/**
+	*	Searches queued requests until the frame's budget is used up. At least one request is searched each frame.
+	*/
+	void RunFrame();
+
+	/**
+	*	Drops all requests. Node indices are only valid for the graph they were submitted for.
+	*/
+	void Clear();
+
+	const PathRequestStats_t& GetStats() const { return m_Stats; }
+
+	void ResetStats();
+
+private:
+	using RequestKey_t = std::tuple<int, int, int, int>;
+
+	struct Request_t
+	{
+		RequestKey_t key;
+
+		//Number of Submit calls that haven't been matched by TakeResult or Release yet.
+		int cSubscribers = 1;
+
+		bool bDone = false;
+
+		float flSubmitTime = 0;
+		unsigned int uiSubmitFrame = 0;
+
+		float flDoneTime = 0;
+
+		std::vector<int> path;
+	};
+
+	void Unsubscribe( const PathRequestId id );
+
+	void DropExpiredResults();
+
+private:
+	PathRequestId m_NextId = INVALID_PATH_REQUEST + 1;
+
+	std::unordered_map<PathRequestId, Request_t> m_Requests;
+
+	//Requests waiting to be searched, in submission order.
+	std::deque<PathRequestId> m_Queue;
+
+	//Pending request for each path, used to merge identical requests.
+	std::map<RequestKey_t, PathRequestId> m_Pending;
+
+	//Path written by searches. Searches without routing tables can visit every node.
+	std::vector<int> m_SearchPath;
+
+	PathRequestStats_t m_Stats;
+
+private:
+	CPathRequestQueue( const CPathRequestQueue& ) = delete;
+	CPathRequestQueue& operator=( const CPathRequestQueue& ) = delete;
+};
+
+extern CPathRequestQueue g_PathRequestQueue;
+
+#endif //GAME_SERVER_NODES_CPATHREQUESTQUEUE_H
@@ -0,0 +1,174 @@
+#include <future>
+#include <new>
+#include <thread>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CGraph.h"
+#include "CQueuePriority.h"
+
+#include "CRoutingTableBuilder.h"
+
+CRoutingTableBuilder::CRoutingTableBuilder( CGraph& graph, const int iNumThreads )
+	: m_Graph( graph )
+	, m_Pool( iNumThreads )
+	, m_ClosestSoFar( iNumThreads )
+{
+}
+
+bool CRoutingTableBuilder::BuildPathTrees( const int iHull, const int afCapMask )
+{
+	const int cNodes = m_Graph.m_cNodes;
+
+	const int iHullMask = CGraph::HullLinkMask( iHull );
+
+	try
+	{
+		m_Previous.resize( static_cast<size_t>( cNodes ) * cNodes );
+		m_LinkPassable.resize( m_Graph.m_cLinks );
+
+		for( auto& closest : m_ClosestSoFar )
+		{
+			closest.resize( cNodes );
+		}
+	}
+	catch( const std::bad_alloc& )
+	{
+		ALERT( at_aiconsole, "CRoutingTableBuilder: Couldn't allocate path trees for %d nodes!\n", cNodes );
+		return false;
+	}
+
+	//Link states may be built on first use and may print messages, so they have to be evaluated on this thread.
+	//A static query only depends on the entity and the capabilities, so the result is the same for every search.
+	for( int iLink = 0; iLink < m_Graph.m_cLinks; ++iLink )
+	{
+		m_LinkPassable[ iLink ] = m_Graph.m_ppLinkEnts[ iLink ] && m_Graph.IsLinkPassable( iLink, afCapMask, CGraph::NODEGRAPH_STATIC );
+	}
+
+	std::vector<std::future<void>> results;
+
+	results.reserve( cNodes );
+
+	for( int iStart = 0; iStart < cNodes; ++iStart )
+	{
+		results.emplace_back( m_Pool.push(
+			[ this, iStart, iHullMask, cNodes ]( int iThread )
+			{
+				BuildPathTree( m_ClosestSoFar[ iThread ], &m_Previous[ static_cast<size_t>( iStart ) * cNodes ], iStart, iHullMask, m_LinkPassable.data() );
+			}
+		) );
+	}
+
+	for( auto& result : results )
+	{
+		result.get();
+	}
+
+	return true;
+}
+
+int CRoutingTableBuilder::GetPath( int* piPath, const int iStart, const int iDest ) const
+{
+	if( iStart == iDest )
+	{
+		piPath[ 0 ] = iStart;
+		piPath[ 1 ] = iDest;
+		return 2;
+	}
+
+	const int* piPrevious = &m_Previous[ static_cast<size_t>( iStart ) * m_Graph.m_cNodes ];
+
+	if( piPrevious[ iDest ] == NO_NODE )
+	{// Destination is unreachable, no path found.
+		return 0;
+	}
+
+	int iCurrentNode = iDest;
+	int iNumPathNodes = 1;// count the dest
+
+	while( iCurrentNode != iStart )
+	{
+		++iNumPathNodes;
+		iCurrentNode = piPrevious[ iCurrentNode ];
+	}
+
+	iCurrentNode = iDest;
+
+	for( int i = iNumPathNodes - 1; i >= 0; --i )
+	{
+		piPath[ i ] = iCurrentNode;
+		iCurrentNode = piPrevious[ iCurrentNode ];
+	}
+
+	return iNumPathNodes;
+}
+
+int CRoutingTableBuilder::GetDesiredThreadCount()
+{
+	int iThreads = static_cast<int>( sv_nodegraph_threads.value );
+
+	if( iThreads <= 0 )
+		iThreads = static_cast<int>( std::thread::hardware_concurrency() );
+
+	return max( 1, iThreads );
+}
+
+void CRoutingTableBuilder::BuildPathTree( std::vector<float>& closestSoFar, int* piPrevious, const int iStart, const int iHullMask, const char* pfLinkPassable ) const
+{
+	const int cNodes = m_Graph.m_cNodes;
+
+	CQueuePriority queue;
+
+	// Mark all the nodes as unvisited.
+	for( int i = 0; i < cNodes; ++i )
+	{
+		closestSoFar[ i ] = -1.0;
+	}
+
+	closestSoFar[ iStart ] = 0.0;
+	piPrevious[ iStart ] = iStart;// tag this as the origin node
+	queue.Insert( iStart, 0.0 );// insert start node
+
+	//This must match the Dijkstra search in CGraph::FindShortestPath exactly, including the order of insertions, or the tables will differ.
+	while( !queue.Empty() )
+	{
+		float flCurrentDistance;
+		const int iCurrentNode = queue.Remove( flCurrentDistance );
+
+		const CNode& currentNode = m_Graph.m_pNodes[ iCurrentNode ];
+
+		for( int i = 0; i < currentNode.m_cNumLinks; ++i )
+		{
+			const int iLink = currentNode.m_iFirstLink + i;
+			const CLink& link = m_Graph.m_pLinkPool[ iLink ];
+
+			if( ( link.m_afLinkInfo & iHullMask ) != iHullMask )
+				continue;
+
+			if( m_Graph.m_ppLinkEnts[ iLink ] != nullptr && !pfLinkPassable[ iLink ] )
+				continue;
+
+			const int iVisitNode = link.m_iDestNode;
+
+			float flOurDistance = flCurrentDistance + link.m_flWeight;
+			if( closestSoFar[ iVisitNode ] < -0.5
+				|| flOurDistance < closestSoFar[ iVisitNode ] - 0.001 )
+			{
+				closestSoFar[ iVisitNode ] = flOurDistance;
+				piPrevious[ iVisitNode ] = iCurrentNode;
+
+				queue.Insert( iVisitNode, flOurDistance );
+			}
+		}
+	}
+
+	for( int i = 0; i < cNodes; ++i )
+	{
+		if( closestSoFar[ i ] < -0.5 )
+			piPrevious[ i ] = NO_NODE;
+	}
+}
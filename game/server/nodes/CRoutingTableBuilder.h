@@ -0,0 +1,77 @@
+#ifndef GAME_SERVER_NODES_CROUTINGTABLEBUILDER_H
+#define GAME_SERVER_NODES_CROUTINGTABLEBUILDER_H
+
+#include <vector>
+
+#include <ctpl_stl.h>
+
+class CGraph;
+
+/**
+*	Computes the shortest path trees used to fill the static routing tables on a pool of worker threads.
+*	The serial builder runs one search per (from, to) pair that is still unrouted; this builder instead runs a single search
+*	from every node per hull and capability, which yields the exact same paths because a node's predecessor never changes
+*	once it has been removed from the priority queue.
+*	Workers only use their own scratch memory, so no graph state is written while searches are in flight.
+*/
+class CRoutingTableBuilder final
+{
+public:
+	/**
+	*	@param graph Graph to build trees for. Must stay unmodified while the builder is in use.
+	*	@param iNumThreads Number of worker threads to use.
+	*/
+	CRoutingTableBuilder( CGraph& graph, const int iNumThreads );
+	~CRoutingTableBuilder() = default;
+
+	/**
+	*	@return The number of worker threads.
+	*/
+	int GetNumThreads() const { return m_Pool.size(); }
+
+	/**
+	*	Computes the shortest path trees rooted at every node for the given hull and capability mask.
+	*	Blocks until all workers have finished.
+	*	@return Whether the trees were built. Fails only if memory could not be allocated.
+	*/
+	bool BuildPathTrees( const int iHull, const int afCapMask );
+
+	/**
+	*	Retrieves a path from the trees computed by the last call to BuildPathTrees.
+	*	Has the same contract as CGraph::FindShortestPath without routing tables.
+	*	@return Number of nodes written to piPath, or 0 if iDest can't be reached.
+	*/
+	int GetPath( int* piPath, const int iStart, const int iDest ) const;
+
+	/**
+	*	Gets the number of threads to use when building routing tables. Based on the sv_nodegraph_threads cvar.
+	*/
+	static int GetDesiredThreadCount();
+
+private:
+	/**
+	*	Runs the same Dijkstra search as CGraph::FindShortestPath, but never stops at a destination and writes to scratch memory only.
+	*	Nodes that can't be reached get NO_NODE as their previous node.
+	*/
+	void BuildPathTree( std::vector<float>& closestSoFar, int* piPrevious, const int iStart, const int iHullMask, const char* pfLinkPassable ) const;
+
+private:
+	CGraph& m_Graph;
+
+	ctpl::thread_pool m_Pool;
+
+	//One distance array per worker thread.
+	std::vector<std::vector<float>> m_ClosestSoFar;
+
+	//m_cNodes * m_cNodes previous node indices, one row per start node.
+	std::vector<int> m_Previous;
+
+	//Whether the entity on a link can be passed, for each link. Only valid for links that have an entity.
+	std::vector<char> m_LinkPassable;
+
+private:
+	CRoutingTableBuilder( const CRoutingTableBuilder& ) = delete;
+	CRoutingTableBuilder& operator=( const CRoutingTableBuilder& ) = delete;
+};
+
+#endif //GAME_SERVER_NODES_CROUTINGTABLEBUILDER_H
@@ -17,6 +17,7 @@
 #include "cbase.h"
 #include "NodeConstants.h"
 #include "CGraph.h"
+#include "CNodeVisibility.h"
 
 #include "CTestHull.h"
 
@@ -538,13 +539,23 @@ void CTestHull::BuildNodeGraph()
 	// We now have some graphing capabilities.
 	//
 	WorldGraph.m_fGraphPresent = true;//graph is in memory.
-	WorldGraph.m_fGraphPointersSet = true;// since the graph was generated, the pointers are ready
 	WorldGraph.m_fRoutingComplete = false; // Optimal routes aren't computed, yet.
 
+	// Find the entities that block links from their model names, the same way a loaded graph does.
+	//
+	if( !WorldGraph.AllocGraphState() || !WorldGraph.FSetGraphPointers() )
+	{
+		ALERT( at_aiconsole, "**Graph pointers were not set!\n" );
+		return;
+	}
+
 										   // Compute and compress the routing information.
 										   //
 	WorldGraph.ComputeStaticRoutingTables();
 
+	if( CNodeVisibility::ShouldBuild( WorldGraph ) )
+		g_NodeVisibility.Build( WorldGraph );
+
 	// save the node graph for this level	
 	WorldGraph.FSaveGraph( STRING( gpGlobals->mapname ) );
 	ALERT( at_console, "Done.\n" );
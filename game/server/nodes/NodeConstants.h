@@ -38,6 +38,10 @@
 // to help eliminate node clutter by level designers, this is used to cap how many other nodes
 // any given node is allowed to 'see' in the first stage of graph creation "LinkVisibleNodes()".
 #define	MAX_NODE_INITIAL_LINKS	128
-#define	MAX_NODES               1024
+// the nearest node cache and the routing tables store node indices in shorts, so this can't be raised any further.
+#define	MAX_NODES               32767
+
+// graphs with more nodes than this use hierarchical routing tables, since the flat tables grow with the square of the node count.
+#define	FLAT_ROUTING_MAX_NODES	1024
 
 #endif //GAME_SERVER_NODES_NODECONSTANTS_H
\ No newline at end of file
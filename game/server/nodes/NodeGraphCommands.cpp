@@ -0,0 +1,181 @@
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "Server.h"
+
+#include "CGraph.h"
+#include "CGraphSearch.h"
+#include "CLinkStateCache.h"
+#include "CNodeGrid.h"
+#include "CPathCache.h"
+#include "CPathRequestQueue.h"
+
+#include "NodeGraphCommands.h"
+
+namespace
+{
+void PrintSearchStats( const char* const pszName, const GraphSearchMode mode )
+{
+	const auto& stats = CGraphSearch::GetStats( mode );
+
+	const double flAverage = stats.uiQueries > 0 ? static_cast<double>( stats.ullNodesExpanded ) / stats.uiQueries : 0;
+
+	Alert( at_console, "%-9s %u queries, %u paths found, %llu nodes expanded (%.1f average, %d max)\n",
+		   pszName, stats.uiQueries, stats.uiPathsFound, stats.ullNodesExpanded, flAverage, stats.iMaxNodesExpanded );
+}
+
+void PrintNearestNodeStats( const char* const pszName, const NearestNodeMode mode )
+{
+	const auto& stats = CNodeGrid::GetStats( mode );
+
+	const double flHitRate = stats.uiQueries > 0 ? 100.0 * stats.uiCacheHits / stats.uiQueries : 0;
+	const double flAverage = stats.uiCacheMisses > 0 ? static_cast<double>( stats.ullTraces ) / stats.uiCacheMisses : 0;
+
+	Alert( at_console, "%-14s %u queries, %u cache hits, %u cache misses (%.1f%% hit rate), %llu traces (%.1f per miss)\n",
+		   pszName, stats.uiQueries, stats.uiCacheHits, stats.uiCacheMisses, flHitRate, stats.ullTraces, flAverage );
+}
+}
+
+void ServerCommand_NodeSearchStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		CGraphSearch::ResetStats();
+		Alert( at_console, "Node graph search statistics reset\n" );
+		return;
+	}
+
+	Alert( at_console, "Node graph searches (sv_nodegraph_search is %d):\n", static_cast<int>( sv_nodegraph_search.value ) );
+	PrintSearchStats( "Dijkstra:", GraphSearchMode::DIJKSTRA );
+	PrintSearchStats( "A*:", GraphSearchMode::ASTAR );
+}
+
+void ServerCommand_NodeNearestStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		CNodeGrid::ResetStats();
+		Alert( at_console, "Nearest node statistics reset\n" );
+		return;
+	}
+
+	Alert( at_console, "Nearest node lookups (sv_nodegraph_nearest is %d):\n", static_cast<int>( sv_nodegraph_nearest.value ) );
+	PrintNearestNodeStats( "Region tables:", NearestNodeMode::RANGE_TABLES );
+	PrintNearestNodeStats( "Grid:", NearestNodeMode::GRID );
+}
+
+void ServerCommand_NodePathQueueStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_PathRequestQueue.ResetStats();
+		Alert( at_console, "Path request queue statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = g_PathRequestQueue.GetStats();
+
+	const double flAverageWait = stats.uiSearched > 0 ? 1000.0 * stats.flTotalWait / stats.uiSearched : 0;
+	const double flAverageFrames = stats.uiSearched > 0 ? static_cast<double>( stats.ullTotalWaitFrames ) / stats.uiSearched : 0;
+	const double flAverageSearch = stats.uiSearched > 0 ? static_cast<double>( stats.ullSearchMicroseconds ) / stats.uiSearched : 0;
+
+	Alert( at_console, "Path request queue (sv_nodegraph_async is %d, budget %d microseconds):\n",
+		   static_cast<int>( sv_nodegraph_async.value ), static_cast<int>( sv_nodegraph_path_budget.value ) );
+	Alert( at_console, "Depth: %u now, %u max\n", static_cast<unsigned int>( g_PathRequestQueue.GetDepth() ), stats.uiMaxDepth );
+	Alert( at_console, "Requests: %u submitted, %u merged, %u searched, %u dropped\n",
+		   stats.uiSubmitted, stats.uiMerged, stats.uiSearched, stats.uiDropped );
+	Alert( at_console, "Wait: %.1f ms average, %.1f ms max, %.1f frames average, %u frames max\n",
+		   flAverageWait, 1000.0 * stats.flMaxWait, flAverageFrames, stats.uiMaxWaitFrames );
+	Alert( at_console, "Searches: %.1f microseconds average, %u frames over budget\n", flAverageSearch, stats.uiBudgetExceeded );
+}
+
+void ServerCommand_NodePathCacheStats()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_PathCache.ResetStats();
+		Alert( at_console, "Path cache statistics reset\n" );
+		return;
+	}
+
+	const auto& stats = g_PathCache.GetStats();
+
+	const double flPathHitRate = stats.uiPathLookups > 0 ? 100.0 * stats.uiPathHits / stats.uiPathLookups : 0;
+	const double flLengthHitRate = stats.uiLengthLookups > 0 ? 100.0 * stats.uiLengthHits / stats.uiLengthLookups : 0;
+
+	Alert( at_console, "Path cache (sv_nodegraph_pathcache is %d): %u entries\n",
+		   static_cast<int>( sv_nodegraph_pathcache.value ), static_cast<unsigned int>( g_PathCache.GetSize() ) );
+	Alert( at_console, "Paths:   %u lookups, %u hits (%.1f%% hit rate)\n", stats.uiPathLookups, stats.uiPathHits, flPathHitRate );
+	Alert( at_console, "Lengths: %u lookups, %u hits (%.1f%% hit rate)\n", stats.uiLengthLookups, stats.uiLengthHits, flLengthHitRate );
+	Alert( at_console, "%u evictions, %u invalidations\n", stats.uiEvictions, stats.uiInvalidations );
+}
+
+void ServerCommand_NodeLinkStates()
+{
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "reset" ) )
+	{
+		g_LinkStateCache.ResetStats();
+		Alert( at_console, "Link state statistics reset\n" );
+		return;
+	}
+
+	if( !WorldGraph.m_fGraphPresent || !WorldGraph.m_fGraphPointersSet )
+	{
+		Alert( at_console, "Graph not ready!\n" );
+		return;
+	}
+
+	//Make sure the cache is built.
+	for( int iLink = 0; iLink < WorldGraph.m_cLinks && !g_LinkStateCache.IsBuilt(); ++iLink )
+	{
+		WorldGraph.IsLinkPassable( iLink, 0, CGraph::NODEGRAPH_STATIC );
+	}
+
+	const auto& stats = g_LinkStateCache.GetStats();
+
+	Alert( at_console, "Link states: %u links with entities, %u through open doors\n",
+		   static_cast<unsigned int>( g_LinkStateCache.GetLinkEntCount() ), static_cast<unsigned int>( g_LinkStateCache.GetOpenDoorCount() ) );
+	Alert( at_console, "%u state updates, %u changed a link\n", stats.uiUpdates, stats.uiChanges );
+
+	if( CMD_ARGC() >= 2 && FStrEq( CMD_ARGV( 1 ), "check" ) )
+	{
+		//Compare the cached states against the entities.
+		const int afCapMasks[] = { 0, bits_CAP_OPEN_DOORS };
+		const CGraph::NODEQUERY queryTypes[] = { CGraph::NODEGRAPH_DYNAMIC, CGraph::NODEGRAPH_STATIC };
+
+		int cMismatches = 0;
+
+		for( int iLink = 0; iLink < WorldGraph.m_cLinks; ++iLink )
+		{
+			const CLink& link = WorldGraph.Link( iLink );
+			entvars_t* pevLinkEnt = WorldGraph.m_ppLinkEnts[ iLink ];
+
+			if( !pevLinkEnt )
+				continue;
+
+			for( auto afCapMask : afCapMasks )
+			{
+				for( auto queryType : queryTypes )
+				{
+					if( WorldGraph.IsLinkPassable( iLink, afCapMask, queryType ) != WorldGraph.HandleLinkEnt( link.m_iSrcNode, pevLinkEnt, afCapMask, queryType ) )
+					{
+						Alert( at_console, "Link %d (%s): cached state is out of date\n", iLink, STRING( pevLinkEnt->classname ) );
+						++cMismatches;
+					}
+				}
+			}
+		}
+
+		Alert( at_console, "%d mismatches\n", cMismatches );
+	}
+}
+
+void NodeGraph_RegisterCommands()
+{
+	g_engfuncs.pfnAddServerCommand( "node_searchstats", &::ServerCommand_NodeSearchStats );
+	g_engfuncs.pfnAddServerCommand( "node_neareststats", &::ServerCommand_NodeNearestStats );
+	g_engfuncs.pfnAddServerCommand( "node_pathqueuestats", &::ServerCommand_NodePathQueueStats );
+	g_engfuncs.pfnAddServerCommand( "node_pathcachestats", &::ServerCommand_NodePathCacheStats );
+	g_engfuncs.pfnAddServerCommand( "node_linkstates", &::ServerCommand_NodeLinkStates );
+}
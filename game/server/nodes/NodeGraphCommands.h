@@ -0,0 +1,9 @@
+#ifndef GAME_SERVER_NODES_NODEGRAPHCOMMANDS_H
+#define GAME_SERVER_NODES_NODEGRAPHCOMMANDS_H
+
+/**
+*	Registers the node graph server commands.
+*/
+void NodeGraph_RegisterCommands();
+
+#endif //GAME_SERVER_NODES_NODEGRAPHCOMMANDS_H
@@ -30,6 +30,9 @@
 #include "CBasePlayer.h"
 #include "Weapons.h"
 #include "gamerules/GameRules.h"
+#include "ai/CAIProfiler.h"
+#include "entities/CEntityNameIndex.h"
+#include "entities/CSpatialPartition.h"
 
 void UTIL_ParametricRocket( entvars_t *pev, Vector vecOrigin, Vector vecAngles, edict_t *owner )
 {	
@@ -124,127 +127,30 @@ bool UTIL_GetNextBestWeapon( CBasePlayer *pPlayer, CBasePlayerWeapon *pCurrentWe
 
 int UTIL_EntitiesInBox( CBaseEntity **pList, int listMax, const Vector &mins, const Vector &maxs, int flagMask )
 {
-	edict_t		*pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
-	CBaseEntity *pEntity;
-	int			count;
-
-	count = 0;
-
-	if ( !pEdict )
-		return count;
-
-	for ( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
-	{
-		if ( pEdict->free )	// Not in use
-			continue;
-		
-		if ( flagMask && !(pEdict->v.flags & flagMask) )	// Does it meet the criteria?
-			continue;
-
-		if ( mins.x > pEdict->v.absmax.x ||
-			 mins.y > pEdict->v.absmax.y ||
-			 mins.z > pEdict->v.absmax.z ||
-			 maxs.x < pEdict->v.absmin.x ||
-			 maxs.y < pEdict->v.absmin.y ||
-			 maxs.z < pEdict->v.absmin.z )
-			 continue;
-
-		pEntity = CBaseEntity::Instance(pEdict);
-		if ( !pEntity )
-			continue;
-
-		pList[ count ] = pEntity;
-		count++;
-
-		if ( count >= listMax )
-			return count;
-	}
-
-	return count;
+	return g_SpatialPartition.EntitiesInBox( pList, listMax, mins, maxs, flagMask );
 }
 
 
 int UTIL_MonstersInSphere( CBaseEntity **pList, int listMax, const Vector &center, float radius )
 {
-	edict_t		*pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
-	CBaseEntity *pEntity;
-	int			count;
-	float		distance, delta;
-
-	count = 0;
-	float radiusSquared = radius * radius;
-
-	if ( !pEdict )
-		return count;
-
-	for ( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
-	{
-		if ( pEdict->free )	// Not in use
-			continue;
-		
-		if ( !(pEdict->v.flags & (FL_CLIENT|FL_MONSTER)) )	// Not a client/monster ?
-			continue;
-
-		// Use origin for X & Y since they are centered for all monsters
-		// Now X
-		delta = center.x - pEdict->v.origin.x;//(pEdict->v.absmin.x + pEdict->v.absmax.x)*0.5;
-		delta *= delta;
-
-		if ( delta > radiusSquared )
-			continue;
-		distance = delta;
-		
-		// Now Y
-		delta = center.y - pEdict->v.origin.y;//(pEdict->v.absmin.y + pEdict->v.absmax.y)*0.5;
-		delta *= delta;
-
-		distance += delta;
-		if ( distance > radiusSquared )
-			continue;
-
-		// Now Z
-		delta = center.z - (pEdict->v.absmin.z + pEdict->v.absmax.z)*0.5;
-		delta *= delta;
-
-		distance += delta;
-		if ( distance > radiusSquared )
-			continue;
-
-		pEntity = CBaseEntity::Instance(pEdict);
-		if ( !pEntity )
-			continue;
-
-		pList[ count ] = pEntity;
-		count++;
-
-		if ( count >= listMax )
-			return count;
-	}
-
-
-	return count;
+	return g_SpatialPartition.MonstersInSphere( pList, listMax, center, radius );
 }
 
 
 CBaseEntity *UTIL_FindEntityInSphere( CBaseEntity *pStartEntity, const Vector &vecCenter, float flRadius )
 {
-	edict_t	*pentEntity;
-
-	if (pStartEntity)
-		pentEntity = pStartEntity->edict();
-	else
-		pentEntity = NULL;
-
-	pentEntity = FIND_ENTITY_IN_SPHERE( pentEntity, vecCenter, flRadius);
-
-	if (!FNullEnt(pentEntity))
-		return CBaseEntity::Instance(pentEntity);
-	return NULL;
+	return g_SpatialPartition.FindEntityInSphere( pStartEntity, vecCenter, flRadius );
 }
 
 
 CBaseEntity *UTIL_FindEntityByString( CBaseEntity *pStartEntity, const char *szKeyword, const char *szValue )
 {
+	if( FStrEq( szKeyword, "classname" ) )
+		return g_ClassnameIndex.Find( pStartEntity, szValue );
+
+	if( FStrEq( szKeyword, "targetname" ) )
+		return g_TargetnameIndex.Find( pStartEntity, szValue );
+
 	edict_t	*pentEntity;
 
 	if (pStartEntity)
@@ -261,12 +167,12 @@ CBaseEntity *UTIL_FindEntityByString( CBaseEntity *pStartEntity, const char *szK
 
 CBaseEntity *UTIL_FindEntityByClassname( CBaseEntity *pStartEntity, const char *szName )
 {
-	return UTIL_FindEntityByString( pStartEntity, "classname", szName );
+	return g_ClassnameIndex.Find( pStartEntity, szName );
 }
 
 CBaseEntity *UTIL_FindEntityByTargetname( CBaseEntity *pStartEntity, const char *szName )
 {
-	return UTIL_FindEntityByString( pStartEntity, "targetname", szName );
+	return g_TargetnameIndex.Find( pStartEntity, szName );
 }
 
 
@@ -620,27 +526,32 @@ void UTIL_ShowMessageAll( const char *pString )
 // Overloaded to add IGNORE_GLASS
 void UTIL_TraceLine( const Vector &vecStart, const Vector &vecEnd, IGNORE_MONSTERS igmon, IGNORE_GLASS ignoreGlass, edict_t *pentIgnore, TraceResult *ptr )
 {
+	g_AIProfiler.CountTrace();
 	TRACE_LINE( vecStart, vecEnd, ( igmon == ignore_monsters ? TRF_IGNORE_MONSTERS : TRF_NONE ) | ( ignoreGlass ? TRF_IGNORE_GLASS : 0 ), pentIgnore, ptr );
 }
 
 void UTIL_TraceMonsterHull( CBaseEntity* pEntity, const Vector& v1, const Vector& v2, IGNORE_MONSTERS igmon, CBaseEntity* pentToSkip, TraceResult& tr )
 {
+	g_AIProfiler.CountTrace();
 	TRACE_MONSTER_HULL( pEntity->edict(), v1, v2, ( igmon == ignore_monsters ? TRF_IGNORE_MONSTERS : TRF_NONE ), pentToSkip ? pentToSkip->edict() : nullptr, &tr );
 }
 
 void UTIL_TraceLine( const Vector &vecStart, const Vector &vecEnd, IGNORE_MONSTERS igmon, edict_t *pentIgnore, TraceResult *ptr )
 {
+	g_AIProfiler.CountTrace();
 	TRACE_LINE( vecStart, vecEnd, ( igmon == ignore_monsters ? TRF_IGNORE_MONSTERS : TRF_NONE ), pentIgnore, ptr );
 }
 
 
 void UTIL_TraceHull( const Vector &vecStart, const Vector &vecEnd, IGNORE_MONSTERS igmon, const Hull::Hull hullNumber, edict_t *pentIgnore, TraceResult *ptr )
 {
+	g_AIProfiler.CountTrace();
 	TRACE_HULL( vecStart, vecEnd, ( igmon == ignore_monsters ? TRF_IGNORE_MONSTERS : TRF_NONE ), static_cast<int>( hullNumber ), pentIgnore, ptr );
 }
 
 void UTIL_TraceModel( const Vector &vecStart, const Vector &vecEnd, const Hull::Hull hullNumber, edict_t *pentModel, TraceResult *ptr )
 {
+	g_AIProfiler.CountTrace();
 	g_engfuncs.pfnTraceModel( vecStart, vecEnd, static_cast<int>( hullNumber ), pentModel, ptr );
 }
 
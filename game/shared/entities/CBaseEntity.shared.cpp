@@ -22,6 +22,10 @@
 #include "Angelscript/CHLASServerManager.h"
 #endif
 
+#ifdef SERVER_DLL
+#include "entities/CEntityNameIndex.h"
+#endif
+
 // Global Savedata for Delay
 BEGIN_DATADESC_NOBASE( CBaseEntity )
 	DEFINE_FIELD( m_pGoalEnt, FIELD_CLASSPTR ),
@@ -254,6 +258,33 @@ BEGIN_DATADESC( CBasePlayer )
 	//DEFINE_FIELD( m_nCustomSprayFrames, FIELD_INTEGER ), // Don't need to restore
 END_DATADESC()
 
+void CBaseEntity::SetClassname( const string_t iszClassName )
+{
+	pev->classname = iszClassName;
+
+#ifdef SERVER_DLL
+	g_ClassnameIndex.Update( this );
+#endif
+}
+
+void CBaseEntity::SetTargetname( const string_t iszTargetName )
+{
+	pev->targetname = iszTargetName;
+
+#ifdef SERVER_DLL
+	g_TargetnameIndex.Update( this );
+#endif
+}
+
+void CBaseEntity::ClearTargetname()
+{
+	pev->targetname = iStringNull;
+
+#ifdef SERVER_DLL
+	g_TargetnameIndex.Remove( this );
+#endif
+}
+
 void CBaseEntity::TakeDamage( const CTakeDamageInfo& info )
 {
 	//This method exists so we can intercept damage events in the base class unconditionally.
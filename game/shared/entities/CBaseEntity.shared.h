@@ -87,6 +87,21 @@ public:
 	*/
 	const char* GetClassname() const { return STRING( pev->classname ); }
 
+	/**
+	*	Sets the classname.
+	*	@param iszClassName Name to set.
+	*/
+	void SetClassname( const string_t iszClassName );
+
+	/**
+	*	Sets the classname.
+	*	@param pszClassName Name to set.
+	*/
+	void SetClassname( const char* const pszClassName )
+	{
+		SetClassname( MAKE_STRING( pszClassName ) );
+	}
+
 	/**
 	*	@return Whether this entity's classname matches the given classname.
 	*/
@@ -159,10 +174,7 @@ public:
 	*	Sets the targetname.
 	*	@param iszTargetName Name to set.
 	*/
-	void SetTargetname( const string_t iszTargetName )
-	{
-		pev->targetname = iszTargetName;
-	}
+	void SetTargetname( const string_t iszTargetName );
 
 	/**
 	*	Sets the targetname.
@@ -176,10 +188,7 @@ public:
 	/**
 	*	Clears the targetname.
 	*/
-	void ClearTargetname()
-	{
-		pev->targetname = iStringNull;
-	}
+	void ClearTargetname();
 
 	/**
 	*	@return Whether this entity has a target.
@@ -2376,6 +2385,11 @@ public:
 */
 void Server_EntityCreated( entvars_t* pev );
 
+/**
+*	Notify the main server interface when an entity's instance has been created and its OnCreate method has been called.
+*/
+void Server_EntityInstanceCreated( CBaseEntity* pEntity );
+
 /**
 *	Converts a entvars_t * to a class pointer
 *	It will allocate the class and entity if necessary
@@ -2400,6 +2414,8 @@ T* GetClassPtr( T* a )
 		a->pev = pev;
 		//Now calls OnCreate - Solokiller
 		a->OnCreate();
+
+		Server_EntityInstanceCreated( a );
 	}
 
 	return a;
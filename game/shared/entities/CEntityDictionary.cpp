@@ -42,6 +42,8 @@ bool CEntityDictionary::AddEntityClass( CBaseEntityRegistry* pEntity )
 
 	auto result = m_Entities.insert( std::make_pair( pEntity->GetEntityname(), pEntity ) );
 
+	m_Families.clear();
+
 	if( !result.second )
 	{
 		Alert( at_error, "CEntityDictionary::AddEntityClass: Failed to insert entity class \"%s\" (C++ class: \"%s\")!\n", pEntity->GetEntityname(), pEntity->GetClassname() );
@@ -86,4 +88,25 @@ void CEntityDictionary::EnumEntityClasses( EntityEnumCallback pCallback )
 		if( !pCallback( *reg.second ) )
 			break;
 	}
-}
\ No newline at end of file
+}
+
+const std::vector<const char*>* CEntityDictionary::GetClassFamily( const char* const pszEntityName )
+{
+	auto pClass = FindEntityClassByEntityName( pszEntityName );
+
+	if( !pClass )
+		return nullptr;
+
+	auto result = m_Families.emplace( pClass->GetClassType(), std::vector<const char*>() );
+
+	if( result.second )
+	{
+		for( auto& reg : m_Entities )
+		{
+			if( reg.second->DerivesFrom( pClass->GetClassType() ) )
+				result.first->second.push_back( reg.second->GetEntityname() );
+		}
+	}
+
+	return &result.first->second;
+}
@@ -2,10 +2,12 @@
 #define GAME_SHARED_ENTITIES_CENTITYDICTIONARY_H
 
 #include <unordered_map>
+#include <vector>
 
 #include "StringUtils.h"
 
-class CBaseEntityRegistry;
+#include "CEntityRegistry.h"
+
 class CBaseEntity;
 
 /**
@@ -76,9 +78,19 @@ public:
 	*/
 	void EnumEntityClasses( EntityEnumCallback pCallback );
 
+	/**
+	*	Gets the family of an entity class: the names of all entity classes whose C++ class is the given class's C++ class or derives from it.
+	*	@param pszEntityName Name of the entity class.
+	*	@return The family, including the given class, or null if the class doesn't exist. Valid until the next call to AddEntityClass.
+	*/
+	const std::vector<const char*>* GetClassFamily( const char* const pszEntityName );
+
 private:
 	Entities_t m_Entities;
 
+	//Families by C++ class. Built on first use.
+	std::unordered_map<EntityClassType_t, std::vector<const char*>> m_Families;
+
 private:
 	CEntityDictionary( const CEntityDictionary& ) = delete;
 	CEntityDictionary& operator=( const CEntityDictionary& ) = delete;
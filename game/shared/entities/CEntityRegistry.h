@@ -1,11 +1,63 @@
 #ifndef GAME_SHARED_ENTITIES_CENTITYREGISTRY_H
 #define GAME_SHARED_ENTITIES_CENTITYREGISTRY_H
 
+#include <type_traits>
+
 struct entvars_t;
 struct edict_t;
 
 class CBaseEntity;
 
+/**
+*	Identifies a C++ entity class. Only compared by address.
+*/
+using EntityClassType_t = const void*;
+
+namespace EntityClass
+{
+template<typename T>
+struct Type final
+{
+	static const char Tag;
+};
+
+template<typename T>
+const char Type<T>::Tag = 0;
+
+template<typename T, typename = void>
+struct HasBaseClass : std::false_type
+{
+};
+
+template<typename T>
+struct HasBaseClass<T, typename std::conditional<true, void, typename T::BaseClass>::type> : std::true_type
+{
+};
+
+/**
+*	Walks the classes that T derives from through the BaseClass typedefs that DECLARE_CLASS adds.
+*/
+template<typename T, bool HAS_BASE = HasBaseClass<T>::value>
+struct Hierarchy final
+{
+	static_assert( std::is_same<typename T::ThisClass, T>::value, "Entity classes and their base classes must use DECLARE_CLASS" );
+
+	static bool DerivesFrom( const EntityClassType_t type )
+	{
+		return type == &Type<T>::Tag || Hierarchy<typename T::BaseClass>::DerivesFrom( type );
+	}
+};
+
+template<typename T>
+struct Hierarchy<T, false> final
+{
+	static bool DerivesFrom( const EntityClassType_t type )
+	{
+		return type == &Type<T>::Tag;
+	}
+};
+}
+
 /**
 *	Represents an entity class.
 */
@@ -34,6 +86,16 @@ public:
 	*/
 	virtual size_t GetSize() const = 0;
 
+	/**
+	*	@return The C++ class.
+	*/
+	virtual EntityClassType_t GetClassType() const = 0;
+
+	/**
+	*	@return Whether the C++ class is the given class or derives from it.
+	*/
+	virtual bool DerivesFrom( const EntityClassType_t type ) const = 0;
+
 	/**
 	*	Creates a new instance of the entity, using the given entvars_t instance.
 	*	@param pev Entvars instance that will be assigned to the entity.
@@ -80,6 +142,10 @@ public:
 
 	size_t GetSize() const override { return sizeof( T ); }
 
+	EntityClassType_t GetClassType() const override { return &EntityClass::Type<T>::Tag; }
+
+	bool DerivesFrom( const EntityClassType_t type ) const override { return EntityClass::Hierarchy<T>::DerivesFrom( type ); }
+
 	CBaseEntity* CreateInstance( entvars_t* pev ) override
 	{
 		// allocate private data 
@@ -89,6 +155,8 @@ public:
 		//Now calls OnCreate - Solokiller
 		pEntity->OnCreate();
 
+		Server_EntityInstanceCreated( pEntity );
+
 		return pEntity;
 	}
 
@@ -32,7 +32,7 @@ CGlock::CGlock()
 
 void CGlock::Spawn( )
 {
-	pev->classname = MAKE_STRING("weapon_9mmhandgun"); // hack to allow for old names
+	SetClassname( "weapon_9mmhandgun" ); // hack to allow for old names
 	Precache( );
 
 	SetModel( "models/w_9mmhandgun.mdl");
@@ -209,6 +209,9 @@ void CGlock::WeaponIdle( void )
 
 class CGlockAmmo : public CBasePlayerAmmo
 {
+public:
+	DECLARE_CLASS( CGlockAmmo, CBasePlayerAmmo );
+
 	void Spawn( void ) override
 	{ 
 		Precache( );
@@ -44,7 +44,7 @@ void CSniperRifle::Spawn()
 	Precache();
 
 	//Give it a name so it works on the client side - Solokiller
-	pev->classname = MAKE_STRING( "weapon_sniperrifle" );
+	SetClassname( "weapon_sniperrifle" );
 
 	SetModel( "models/w_m40a1.mdl" );
 
@@ -13,6 +13,10 @@
 #include "bspfile.h"
 #include "scriplib.h"
 
+#ifndef WIN32
+#define _rotl( value, shift ) ( ( (unsigned int)( value ) << ( shift ) ) | ( (unsigned int)( value ) >> ( 32 - ( shift ) ) ) )
+#endif
+
 //=============================================================================
 
 int			nummodels;
@@ -87,9 +91,10 @@ FastChecksum
 int FastChecksum(void *buffer, int bytes)
 {
 	int	checksum = 0;
+	char	*p = (char *)buffer;
 
-	while( bytes-- )  
-		checksum = _rotl(checksum, 4) ^ *((char *)buffer)++;
+	while( bytes-- )
+		checksum = _rotl(checksum, 4) ^ *p++;
 
 	return checksum;
 }
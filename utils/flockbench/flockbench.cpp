@@ -0,0 +1,206 @@
+//=========================================================
+// flockbench - measures how the cost of moving a flock of
+// monster_flyer grows with the size of the flock, with the
+// flock simulator's grid and with the original test of
+// every pair of members.
+//
+// Usage: flockbench [-iterations <count>] [-seed <seed>] [<flock size> ...]
+//
+// Each flock is spread out like monster_flyer_flock does,
+// in a square that grows with the flock so the number of
+// neighbors stays about the same, and flown for <count>
+// updates. Both methods start from the same flock; the
+// largest difference in the velocities they produce after
+// the first update is reported as a check.
+//=========================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "entities/NPCs/FlockConstants.h"
+#include "entities/NPCs/CFlockSimulator.h"
+
+namespace
+{
+//Think interval of flock members.
+const float FLOCK_INTERVAL = 0.1f;
+
+//Field of view of monster_flyer.
+const float FLOCK_FIELD_OF_VIEW = 0.2f;
+
+struct Member_t
+{
+	float vecOrigin[ 3 ];
+	float vecVelocity[ 3 ];
+	float flSpeed;
+	float flGoalSpeed;
+};
+
+struct RunResult_t
+{
+	double flMicrosecondsPerUpdate = 0;
+	double flPairTestsPerFollower = 0;
+};
+
+void PrintUsage()
+{
+	printf( "Usage: flockbench [-iterations <count>] [-seed <seed>] [<flock size> ...]\n" );
+}
+
+std::vector<Member_t> CreateFlock( const int cMembers, const unsigned int uiSeed )
+{
+	std::mt19937 random( uiSeed );
+
+	//Roughly the density of a default flock.
+	const float flRadius = 64 * std::sqrt( static_cast<float>( cMembers ) );
+
+	std::uniform_real_distribution<float> horizontal( -flRadius, flRadius );
+	std::uniform_real_distribution<float> vertical( 0, 16 );
+
+	std::vector<Member_t> flock( cMembers );
+
+	for( auto& member : flock )
+	{
+		member.vecOrigin[ 0 ] = horizontal( random );
+		member.vecOrigin[ 1 ] = horizontal( random );
+		member.vecOrigin[ 2 ] = vertical( random );
+		member.vecVelocity[ 0 ] = member.vecVelocity[ 1 ] = member.vecVelocity[ 2 ] = 0;
+		member.flSpeed = AFLOCK_FLY_SPEED;
+		member.flGoalSpeed = 0;
+	}
+
+	//The leader flies straight ahead.
+	flock[ 0 ].vecVelocity[ 0 ] = AFLOCK_FLY_SPEED;
+
+	return flock;
+}
+
+void Update( CFlockSimulator& simulator, std::vector<Member_t>& flock, const FlockNeighborSearch search )
+{
+	const float vecForward[ 3 ] = { 1, 0, 0 };
+
+	simulator.SetMemberCount( flock.size() );
+
+	for( size_t uiIndex = 0; uiIndex < flock.size(); ++uiIndex )
+	{
+		const auto& member = flock[ uiIndex ];
+
+		simulator.SetMember( uiIndex, member.vecOrigin, member.vecVelocity, member.flSpeed, member.flGoalSpeed );
+	}
+
+	simulator.UpdateFollowers( vecForward, FLOCK_FIELD_OF_VIEW, search );
+
+	for( size_t uiIndex = 0; uiIndex < flock.size(); ++uiIndex )
+	{
+		auto& member = flock[ uiIndex ];
+
+		simulator.GetMember( uiIndex, member.vecVelocity, member.flSpeed, member.flGoalSpeed );
+
+		//Move the way MOVETYPE_FLY does until the next think.
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+			member.vecOrigin[ iAxis ] += member.vecVelocity[ iAxis ] * FLOCK_INTERVAL;
+	}
+}
+
+RunResult_t Run( std::vector<Member_t> flock, const int iIterations, const FlockNeighborSearch search )
+{
+	CFlockSimulator simulator;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for( int iIteration = 0; iIteration < iIterations; ++iIteration )
+		Update( simulator, flock, search );
+
+	const auto end = std::chrono::steady_clock::now();
+
+	const auto& stats = simulator.GetStats();
+
+	RunResult_t result;
+
+	result.flMicrosecondsPerUpdate = std::chrono::duration<double, std::micro>( end - start ).count() / iIterations;
+	result.flPairTestsPerFollower = stats.ullFollowers > 0 ? static_cast<double>( stats.ullPairTests ) / stats.ullFollowers : 0;
+
+	return result;
+}
+
+/**
+*	@return Largest difference between the velocities that both methods produce for the same flock.
+*/
+float CompareMethods( const std::vector<Member_t>& flock )
+{
+	CFlockSimulator simulator;
+
+	std::vector<Member_t> pairs = flock;
+	std::vector<Member_t> grid = flock;
+
+	Update( simulator, pairs, FlockNeighborSearch::PAIRS );
+	Update( simulator, grid, FlockNeighborSearch::GRID );
+
+	float flMaxDifference = 0;
+
+	for( size_t uiIndex = 0; uiIndex < flock.size(); ++uiIndex )
+	{
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+			flMaxDifference = std::max( flMaxDifference, std::fabs( pairs[ uiIndex ].vecVelocity[ iAxis ] - grid[ uiIndex ].vecVelocity[ iAxis ] ) );
+	}
+
+	return flMaxDifference;
+}
+}
+
+int main( int argc, char* argv[] )
+{
+	int iIterations = 100;
+	unsigned int uiSeed = 1;
+
+	std::vector<int> flockSizes;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( !strcmp( argv[ i ], "-iterations" ) && i + 1 < argc )
+		{
+			iIterations = std::max( 1, atoi( argv[ ++i ] ) );
+		}
+		else if( !strcmp( argv[ i ], "-seed" ) && i + 1 < argc )
+		{
+			uiSeed = static_cast<unsigned int>( strtoul( argv[ ++i ], nullptr, 10 ) );
+		}
+		else if( argv[ i ][ 0 ] != '-' && atoi( argv[ i ] ) >= 2 )
+		{
+			flockSizes.push_back( atoi( argv[ i ] ) );
+		}
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if( flockSizes.empty() )
+		flockSizes = { 8, 16, 32, 64, 128, 256, 512, 1024 };
+
+	printf( "%d updates per flock, seed %u\n", iIterations, uiSeed );
+	printf( "%8s %14s %12s %14s %12s %10s %12s\n", "Members", "Pairs us/upd", "Pairs/boid", "Grid us/upd", "Grid/boid", "Speedup", "Max diff" );
+
+	for( const int cMembers : flockSizes )
+	{
+		const std::vector<Member_t> flock = CreateFlock( cMembers, uiSeed );
+
+		const RunResult_t pairs = Run( flock, iIterations, FlockNeighborSearch::PAIRS );
+		const RunResult_t grid = Run( flock, iIterations, FlockNeighborSearch::GRID );
+
+		const double flSpeedup = grid.flMicrosecondsPerUpdate > 0 ? pairs.flMicrosecondsPerUpdate / grid.flMicrosecondsPerUpdate : 0;
+
+		printf( "%8d %14.2f %12.1f %14.2f %12.1f %9.2fx %12g\n",
+				cMembers, pairs.flMicrosecondsPerUpdate, pairs.flPairTestsPerFollower, grid.flMicrosecondsPerUpdate, grid.flPairTestsPerFollower,
+				flSpeedup, CompareMethods( flock ) );
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,405 @@
+//=========================================================
+// gridbench - measures how the cost of finding the entities
+// in a box grows with the number of entities, with the
+// entity grid and with the original test of every entity.
+//
+// Usage: gridbench [-queries <count>] [-seed <seed>] [-cellsize <size>] [<entity count> ...]
+//
+// Entities are spread out over a map sized area, mostly as
+// monster and item sized boxes with some large brush
+// entities. Each method answers the same <count> queries,
+// sized like explosions and monster searches. The grid is
+// built again for every 100 queries, like it is every
+// frame. The sorted results of both methods are compared
+// as a check. Sphere searches like UTIL_FindEntityInSphere,
+// which filter the grid's entities before the engine's
+// test, are also compared with the engine's search.
+//=========================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "entities/CLooseGrid.h"
+
+namespace
+{
+//Half the size of the area that entities are spread over. Maps are much wider than they are tall.
+const float MAP_EXTENT = 4096;
+const float MAP_HEIGHT = 512;
+
+//Queries between rebuilds of the grid.
+const int QUERIES_PER_FRAME = 100;
+
+struct Box_t
+{
+	float vecMins[ 3 ];
+	float vecMaxs[ 3 ];
+};
+
+struct RunResult_t
+{
+	double flMicrosecondsPerQuery = 0;
+	double flTestsPerQuery = 0;
+	double flResultsPerQuery = 0;
+};
+
+void PrintUsage()
+{
+	printf( "Usage: gridbench [-queries <count>] [-seed <seed>] [-cellsize <size>] [<entity count> ...]\n" );
+}
+
+Box_t CreateBox( std::mt19937& random, const float flMinSize, const float flMaxSize )
+{
+	std::uniform_real_distribution<float> position( -MAP_EXTENT, MAP_EXTENT );
+	std::uniform_real_distribution<float> height( -MAP_HEIGHT, MAP_HEIGHT );
+	std::uniform_real_distribution<float> size( flMinSize, flMaxSize );
+
+	Box_t box;
+
+	for( int iAxis = 0; iAxis < 3; ++iAxis )
+	{
+		const float flHalfSize = size( random ) * 0.5f;
+		const float flCenter = iAxis == 2 ? height( random ) : position( random );
+
+		box.vecMins[ iAxis ] = flCenter - flHalfSize;
+		box.vecMaxs[ iAxis ] = flCenter + flHalfSize;
+	}
+
+	return box;
+}
+
+std::vector<Box_t> CreateEntities( const int cEntities, const unsigned int uiSeed )
+{
+	std::mt19937 random( uiSeed );
+	std::uniform_int_distribution<int> kind( 0, 9 );
+
+	std::vector<Box_t> entities;
+
+	entities.reserve( cEntities );
+
+	for( int iEntity = 0; iEntity < cEntities; ++iEntity )
+	{
+		//One in ten is a brush entity, like a door, trigger or func_wall.
+		if( kind( random ) == 0 )
+			entities.push_back( CreateBox( random, 32, 512 ) );
+		else
+			entities.push_back( CreateBox( random, 16, 64 ) );
+	}
+
+	return entities;
+}
+
+std::vector<Box_t> CreateQueries( const int cQueries, const unsigned int uiSeed )
+{
+	std::mt19937 random( uiSeed + 1 );
+
+	std::vector<Box_t> queries;
+
+	queries.reserve( cQueries );
+
+	for( int iQuery = 0; iQuery < cQueries; ++iQuery )
+		queries.push_back( CreateBox( random, 64, 512 ) );
+
+	return queries;
+}
+
+void BuildGrid( CLooseGrid& grid, const std::vector<Box_t>& entities )
+{
+	grid.Clear();
+
+	for( size_t uiIndex = 0; uiIndex < entities.size(); ++uiIndex )
+		grid.Add( static_cast<int>( uiIndex ), entities[ uiIndex ].vecMins, entities[ uiIndex ].vecMaxs );
+
+	grid.Build();
+}
+
+void QueryAll( const std::vector<Box_t>& entities, const Box_t& query, std::vector<int>& list )
+{
+	//Same test as UTIL_EntitiesInBox.
+	for( size_t uiIndex = 0; uiIndex < entities.size(); ++uiIndex )
+	{
+		const auto& box = entities[ uiIndex ];
+
+		if( query.vecMins[ 0 ] > box.vecMaxs[ 0 ] ||
+			query.vecMins[ 1 ] > box.vecMaxs[ 1 ] ||
+			query.vecMins[ 2 ] > box.vecMaxs[ 2 ] ||
+			query.vecMaxs[ 0 ] < box.vecMins[ 0 ] ||
+			query.vecMaxs[ 1 ] < box.vecMins[ 1 ] ||
+			query.vecMaxs[ 2 ] < box.vecMins[ 2 ] )
+			continue;
+
+		list.push_back( static_cast<int>( uiIndex ) );
+	}
+}
+
+/**
+*	Same test as the engine's FindEntityInSphere: the distance from the center to the box.
+*/
+float DistanceToBoxSquared( const Box_t& box, const float* vecPoint )
+{
+	float flDistance = 0;
+
+	for( int iAxis = 0; iAxis < 3; ++iAxis )
+	{
+		float flDelta = 0;
+
+		if( vecPoint[ iAxis ] < box.vecMins[ iAxis ] )
+			flDelta = vecPoint[ iAxis ] - box.vecMins[ iAxis ];
+		else if( vecPoint[ iAxis ] > box.vecMaxs[ iAxis ] )
+			flDelta = vecPoint[ iAxis ] - box.vecMaxs[ iAxis ];
+
+		flDistance += flDelta * flDelta;
+	}
+
+	return flDistance;
+}
+
+/**
+*	Same search as the engine's FindEntityInSphere.
+*	@return Index of the first entity after iStart that touches the sphere, or -1.
+*/
+int FindInSphereAll( const std::vector<Box_t>& entities, const int iStart, const float* vecCenter, const float flRadius )
+{
+	for( int iIndex = iStart + 1; iIndex < static_cast<int>( entities.size() ); ++iIndex )
+	{
+		if( DistanceToBoxSquared( entities[ iIndex ], vecCenter ) <= flRadius * flRadius )
+			return iIndex;
+	}
+
+	return -1;
+}
+
+/**
+*	Same search as CSpatialPartition::FindEntityInSphereFromCandidates.
+*	The first candidate that passes the filter is handed to the engine's search.
+*/
+int FindInSphereGrid( const std::vector<Box_t>& entities, const std::vector<int>& candidates, const int iStart, const float* vecCenter, const float flRadius )
+{
+	const float flTestRadiusSquared = ( flRadius + 1 ) * ( flRadius + 1 );
+
+	for( auto it = std::upper_bound( candidates.begin(), candidates.end(), iStart ); it != candidates.end(); ++it )
+	{
+		if( DistanceToBoxSquared( entities[ *it ], vecCenter ) > flTestRadiusSquared )
+			continue;
+
+		return FindInSphereAll( entities, *it - 1, vecCenter, flRadius );
+	}
+
+	return -1;
+}
+
+RunResult_t RunAll( const std::vector<Box_t>& entities, const std::vector<Box_t>& queries )
+{
+	std::vector<int> list;
+
+	size_t uiResults = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for( const auto& query : queries )
+	{
+		list.clear();
+		QueryAll( entities, query, list );
+		uiResults += list.size();
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	RunResult_t result;
+
+	result.flMicrosecondsPerQuery = std::chrono::duration<double, std::micro>( end - start ).count() / queries.size();
+	result.flTestsPerQuery = static_cast<double>( entities.size() );
+	result.flResultsPerQuery = static_cast<double>( uiResults ) / queries.size();
+
+	return result;
+}
+
+RunResult_t RunGrid( const std::vector<Box_t>& entities, const std::vector<Box_t>& queries, const float flCellSize )
+{
+	CLooseGrid grid;
+
+	grid.SetCellSize( flCellSize );
+
+	std::vector<int> list;
+
+	size_t uiResults = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for( size_t uiQuery = 0; uiQuery < queries.size(); ++uiQuery )
+	{
+		if( uiQuery % QUERIES_PER_FRAME == 0 )
+			BuildGrid( grid, entities );
+
+		list.clear();
+		grid.Query( queries[ uiQuery ].vecMins, queries[ uiQuery ].vecMaxs, list );
+
+		//Callers need the results in entity index order.
+		std::sort( list.begin(), list.end() );
+
+		uiResults += list.size();
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	RunResult_t result;
+
+	result.flMicrosecondsPerQuery = std::chrono::duration<double, std::micro>( end - start ).count() / queries.size();
+	result.flTestsPerQuery = static_cast<double>( grid.GetStats().ullBoxTests ) / queries.size();
+	result.flResultsPerQuery = static_cast<double>( uiResults ) / queries.size();
+
+	return result;
+}
+
+/**
+*	@return Number of queries for which both methods found different entities.
+*/
+int CompareMethods( const std::vector<Box_t>& entities, const std::vector<Box_t>& queries, const float flCellSize )
+{
+	CLooseGrid grid;
+
+	grid.SetCellSize( flCellSize );
+
+	BuildGrid( grid, entities );
+
+	std::vector<int> all;
+	std::vector<int> found;
+
+	int cMismatches = 0;
+
+	for( const auto& query : queries )
+	{
+		all.clear();
+		found.clear();
+
+		QueryAll( entities, query, all );
+		grid.Query( query.vecMins, query.vecMaxs, found );
+
+		std::sort( found.begin(), found.end() );
+
+		if( all != found )
+			++cMismatches;
+	}
+
+	return cMismatches;
+}
+
+/**
+*	Runs every query as a sphere search loop, with the sphere inside the query box.
+*	@return Number of queries for which the grid's search found different entities than the engine's.
+*/
+int CompareSphereSearches( const std::vector<Box_t>& entities, const std::vector<Box_t>& queries, const float flCellSize )
+{
+	CLooseGrid grid;
+
+	grid.SetCellSize( flCellSize );
+
+	BuildGrid( grid, entities );
+
+	std::vector<int> candidates;
+
+	int cMismatches = 0;
+
+	for( const auto& query : queries )
+	{
+		float vecCenter[ 3 ];
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+			vecCenter[ iAxis ] = ( query.vecMins[ iAxis ] + query.vecMaxs[ iAxis ] ) * 0.5f;
+
+		const float flRadius = ( query.vecMaxs[ 0 ] - query.vecMins[ 0 ] ) * 0.5f;
+
+		//Same box as CSpatialPartition::FindEntityInSphereFromCandidates.
+		float vecMins[ 3 ];
+		float vecMaxs[ 3 ];
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			vecMins[ iAxis ] = vecCenter[ iAxis ] - ( flRadius + 1 );
+			vecMaxs[ iAxis ] = vecCenter[ iAxis ] + ( flRadius + 1 );
+		}
+
+		candidates.clear();
+		grid.Query( vecMins, vecMaxs, candidates );
+
+		std::sort( candidates.begin(), candidates.end() );
+
+		int iAll = -1;
+		int iGrid = -1;
+
+		do
+		{
+			iAll = FindInSphereAll( entities, iAll, vecCenter, flRadius );
+			iGrid = FindInSphereGrid( entities, candidates, iGrid, vecCenter, flRadius );
+		}
+		while( iAll == iGrid && iAll != -1 );
+
+		if( iAll != iGrid )
+			++cMismatches;
+	}
+
+	return cMismatches;
+}
+}
+
+int main( int argc, char* argv[] )
+{
+	int iQueries = 10000;
+	unsigned int uiSeed = 1;
+	float flCellSize = CLooseGrid::DEFAULT_CELL_SIZE;
+
+	std::vector<int> entityCounts;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( !strcmp( argv[ i ], "-queries" ) && i + 1 < argc )
+		{
+			iQueries = std::max( 1, atoi( argv[ ++i ] ) );
+		}
+		else if( !strcmp( argv[ i ], "-seed" ) && i + 1 < argc )
+		{
+			uiSeed = static_cast<unsigned int>( strtoul( argv[ ++i ], nullptr, 10 ) );
+		}
+		else if( !strcmp( argv[ i ], "-cellsize" ) && i + 1 < argc )
+		{
+			flCellSize = std::max( 1.0f, static_cast<float>( atof( argv[ ++i ] ) ) );
+		}
+		else if( argv[ i ][ 0 ] != '-' && atoi( argv[ i ] ) >= 1 )
+		{
+			entityCounts.push_back( atoi( argv[ i ] ) );
+		}
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if( entityCounts.empty() )
+		entityCounts = { 128, 256, 512, 900, 2048 };
+
+	printf( "%d queries per map, grid rebuilt every %d queries, cell size %g, seed %u\n", iQueries, QUERIES_PER_FRAME, flCellSize, uiSeed );
+	printf( "%8s %10s %12s %12s %12s %12s %10s %11s %11s\n", "Entities", "Results", "All us/qry", "All tests", "Grid us/qry", "Grid tests", "Speedup", "Mismatches", "Sphere mism" );
+
+	for( const int cEntities : entityCounts )
+	{
+		const std::vector<Box_t> entities = CreateEntities( cEntities, uiSeed );
+		const std::vector<Box_t> queries = CreateQueries( iQueries, uiSeed );
+
+		const RunResult_t all = RunAll( entities, queries );
+		const RunResult_t grid = RunGrid( entities, queries, flCellSize );
+
+		const double flSpeedup = grid.flMicrosecondsPerQuery > 0 ? all.flMicrosecondsPerQuery / grid.flMicrosecondsPerQuery : 0;
+
+		printf( "%8d %10.2f %12.3f %12.1f %12.3f %12.1f %9.2fx %11d %11d\n",
+				cEntities, all.flResultsPerQuery, all.flMicrosecondsPerQuery, all.flTestsPerQuery, grid.flMicrosecondsPerQuery, grid.flTestsPerQuery,
+				flSpeedup, CompareMethods( entities, queries, flCellSize ), CompareSphereSearches( entities, queries, flCellSize ) );
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,294 @@
+//=========================================================
+// The parts of the engine and the server that the node
+// graph code calls, without the entities. Traces go to the
+// map's brush geometry if it was loaded, and are otherwise
+// unobstructed.
+//=========================================================
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "../nodegraph/CBSPWorld.h"
+
+#include "ServerStubs.h"
+
+enginefuncs_t g_engfuncs;
+globalvars_t* gpGlobals = nullptr;
+
+DLL_GLOBAL const Vector g_vecZero = Vector( 0, 0, 0 );
+DLL_GLOBAL CBaseEntity* g_pBodyQueueHead = nullptr;
+DLL_GLOBAL unsigned int g_ulFrameCount = 0;
+
+//Defaults match the server's.
+cvar_t	sv_nodegraph_threads = { "sv_nodegraph_threads", "0" };
+cvar_t	sv_nodegraph_search = { "sv_nodegraph_search", "1" };
+cvar_t	sv_nodegraph_search_debug = { "sv_nodegraph_search_debug", "0" };
+cvar_t	sv_nodegraph_nearest = { "sv_nodegraph_nearest", "1" };
+cvar_t	sv_nodegraph_hierarchy = { "sv_nodegraph_hierarchy", "0" };
+cvar_t	sv_nodegraph_path_budget = { "sv_nodegraph_path_budget", "1000" };
+cvar_t	sv_nodegraph_pathcache = { "sv_nodegraph_pathcache", "256" };
+cvar_t	sv_nodegraph_trace = { "sv_nodegraph_trace", "0" };
+cvar_t	sv_nodegraph_visibility = { "sv_nodegraph_visibility", "1" };
+
+namespace
+{
+cvar_t* const g_Cvars[] =
+{
+	&sv_nodegraph_threads,
+	&sv_nodegraph_search,
+	&sv_nodegraph_search_debug,
+	&sv_nodegraph_nearest,
+	&sv_nodegraph_hierarchy,
+	&sv_nodegraph_path_budget,
+	&sv_nodegraph_pathcache,
+	&sv_nodegraph_trace,
+	&sv_nodegraph_visibility
+};
+
+globalvars_t g_Globals;
+
+std::string g_szGameDir;
+
+const CBSPWorld* g_pTraceWorld = nullptr;
+
+unsigned long long g_ullTraces = 0;
+
+//Strings are offsets from pStringBase. The pool is large enough for every classname a map can have.
+char g_szStringPool[ 8192 ];
+size_t g_uiStringPoolSize = 1;
+
+//Link entities. Deques don't move their elements.
+std::deque<edict_t> g_Edicts;
+
+CRC32_t g_CRCTable[ 256 ];
+
+//Fixed seed, so the link lookup table is the same every run.
+std::minstd_rand g_Random;
+
+void AlertMessage( ALERT_TYPE aType, const char* pszFormat, ... )
+{
+	//Only show what a server with developer 0 would show.
+	if( aType == at_aiconsole || aType == at_notice )
+		return;
+
+	va_list list;
+
+	va_start( list, pszFormat );
+	vprintf( pszFormat, list );
+	va_end( list );
+}
+
+void GetGameDir( char* pszGetGameDir )
+{
+	strcpy( pszGetGameDir, g_szGameDir.c_str() );
+}
+
+byte* LoadFileForMe( const char* pszFilename, int* pLength )
+{
+	if( pLength )
+		*pLength = 0;
+
+	return nullptr;
+}
+
+void FreeFile( void* pBuffer )
+{
+}
+
+EOFFSET EntOffsetOfPEntity( const edict_t* pEdict )
+{
+	//Offset 0 is the world, which FNullEnt treats as no entity.
+	return pEdict ? 1 : 0;
+}
+
+int32 RandomLong( int32 lLow, int32 lHigh )
+{
+	return std::uniform_int_distribution<int32>( lLow, lHigh )( g_Random );
+}
+
+//The engine's CRC32. The graph's link lookup table is hashed with it.
+void CRCInit( CRC32_t* pulCRC )
+{
+	*pulCRC = 0xFFFFFFFF;
+}
+
+void CRCProcessBuffer( CRC32_t* pulCRC, void* pBuffer, int len )
+{
+	CRC32_t ulCRC = *pulCRC;
+
+	const unsigned char* pData = reinterpret_cast<const unsigned char*>( pBuffer );
+
+	while( len-- > 0 )
+	{
+		ulCRC = g_CRCTable[ ( ulCRC ^ *pData++ ) & 0xFF ] ^ ( ulCRC >> 8 );
+	}
+
+	*pulCRC = ulCRC;
+}
+
+CRC32_t CRCFinal( CRC32_t ulCRC )
+{
+	return ulCRC ^ 0xFFFFFFFF;
+}
+
+string_t AllocString( const char* const pszString )
+{
+	const size_t uiLength = strlen( pszString ) + 1;
+
+	if( g_uiStringPoolSize + uiLength > sizeof( g_szStringPool ) )
+		return 0;
+
+	const string_t iString = static_cast<string_t>( g_uiStringPoolSize );
+
+	memcpy( g_szStringPool + g_uiStringPoolSize, pszString, uiLength );
+	g_uiStringPoolSize += uiLength;
+
+	return iString;
+}
+}
+
+void Stubs_Init( const char* const pszGameDir )
+{
+	for( CRC32_t i = 0; i < 256; ++i )
+	{
+		CRC32_t ulCRC = i;
+
+		for( int iBit = 0; iBit < 8; ++iBit )
+		{
+			ulCRC = ( ulCRC & 1 ) ? ( ( ulCRC >> 1 ) ^ 0xEDB88320 ) : ( ulCRC >> 1 );
+		}
+
+		g_CRCTable[ i ] = ulCRC;
+	}
+
+	g_szGameDir = pszGameDir;
+
+	memset( &g_engfuncs, 0, sizeof( g_engfuncs ) );
+
+	g_engfuncs.pfnAlertMessage = &AlertMessage;
+	g_engfuncs.pfnGetGameDir = &GetGameDir;
+	g_engfuncs.pfnLoadFileForMe = &LoadFileForMe;
+	g_engfuncs.pfnFreeFile = &FreeFile;
+	g_engfuncs.pfnEntOffsetOfPEntity = &EntOffsetOfPEntity;
+	g_engfuncs.pfnRandomLong = &RandomLong;
+	g_engfuncs.pfnCRC32_Init = &CRCInit;
+	g_engfuncs.pfnCRC32_ProcessBuffer = &CRCProcessBuffer;
+	g_engfuncs.pfnCRC32_Final = &CRCFinal;
+
+	memset( &g_Globals, 0, sizeof( g_Globals ) );
+
+	g_Globals.pStringBase = g_szStringPool;
+
+	gpGlobals = &g_Globals;
+
+	//The engine sets the values when the cvars are registered.
+	for( auto pCvar : g_Cvars )
+	{
+		pCvar->value = static_cast<float>( atof( pCvar->string ) );
+	}
+}
+
+void Stubs_SetTraceWorld( const CBSPWorld* pWorld )
+{
+	g_pTraceWorld = pWorld;
+}
+
+unsigned long long Stubs_GetTraceCount()
+{
+	const unsigned long long ullTraces = g_ullTraces;
+
+	g_ullTraces = 0;
+
+	return ullTraces;
+}
+
+entvars_t* Stubs_CreateLinkEnt( const char* const pszClassname, const int iSpawnFlags )
+{
+	g_Edicts.emplace_back();
+
+	edict_t& edict = g_Edicts.back();
+
+	memset( &edict, 0, sizeof( edict ) );
+
+	entvars_t& entvars = edict.v;
+
+	entvars.pContainingEntity = &edict;
+	entvars.classname = AllocString( pszClassname );
+	entvars.spawnflags = iSpawnFlags;
+
+	return &entvars;
+}
+
+cvar_t* Stubs_FindCvar( const char* const pszName )
+{
+	for( auto pCvar : g_Cvars )
+	{
+		if( !strcmp( pCvar->pszName, pszName ) )
+			return pCvar;
+	}
+
+	return nullptr;
+}
+
+//Entities aren't available, so these never find anything.
+CBaseEntity* GET_PRIVATE( edict_t* pent )
+{
+	return nullptr;
+}
+
+bool FClassnameIs( const CBaseEntity* pEntity, const char* pszClassname )
+{
+	return false;
+}
+
+CBaseEntity* UTIL_FindEntityByString( CBaseEntity* pStartEntity, const char* szKeyword, const char* szValue )
+{
+	return nullptr;
+}
+
+CBaseEntity* UTIL_FindEntityByTarget( CBaseEntity* pStartEntity, const char* const pszTarget )
+{
+	return nullptr;
+}
+
+Vector VecBModelOrigin( const CBaseEntity* const pBModel )
+{
+	return g_vecZero;
+}
+
+void UTIL_ParticleEffect( const Vector& vecOrigin, const Vector& vecDirection, const unsigned int ulColor, const unsigned int ulCount )
+{
+}
+
+void UTIL_TraceLine( const Vector& vecStart, const Vector& vecEnd, IGNORE_MONSTERS igmon, edict_t* pentIgnore, TraceResult* ptr )
+{
+	++g_ullTraces;
+
+	memset( ptr, 0, sizeof( *ptr ) );
+
+	if( !g_pTraceWorld )
+	{
+		ptr->flFraction = 1;
+		ptr->vecEndPos = vecEnd;
+		return;
+	}
+
+	BSPTrace_t tr;
+
+	g_pTraceWorld->TraceLine( vecStart, vecEnd, false, tr );
+
+	ptr->fAllSolid = tr.fAllSolid;
+	ptr->fStartSolid = tr.fStartSolid;
+	ptr->flFraction = tr.flFraction;
+	ptr->vecEndPos = tr.vecEndPos;
+	ptr->vecPlaneNormal = tr.vecPlaneNormal;
+}
@@ -0,0 +1,34 @@
+#ifndef UTILS_NODEBENCH_SERVERSTUBS_H
+#define UTILS_NODEBENCH_SERVERSTUBS_H
+
+class CBSPWorld;
+struct cvar_t;
+struct entvars_t;
+
+/**
+*	Sets up the engine functions and globals that the node graph code uses.
+*	@param pszGameDir Game directory that graphs are loaded from.
+*/
+void Stubs_Init( const char* const pszGameDir );
+
+/**
+*	Sets the world that traces are made against. Without a world, every trace is unobstructed.
+*/
+void Stubs_SetTraceWorld( const CBSPWorld* pWorld );
+
+/**
+*	@return Number of traces made since the last call.
+*/
+unsigned long long Stubs_GetTraceCount();
+
+/**
+*	Creates an entity that only has a classname and spawnflags, for use as a link entity.
+*/
+entvars_t* Stubs_CreateLinkEnt( const char* const pszClassname, const int iSpawnFlags );
+
+/**
+*	@return The node graph cvar with the given name, or null if there is no such cvar.
+*/
+cvar_t* Stubs_FindCvar( const char* const pszName );
+
+#endif //UTILS_NODEBENCH_SERVERSTUBS_H
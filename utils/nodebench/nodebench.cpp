@@ -0,0 +1,444 @@
+//=========================================================
+// nodebench - replays node graph queries recorded with
+// sv_nodegraph_trace against the map's node graph, and
+// reports throughput, latency and the number of nodes each
+// kind of query visits.
+//
+// Usage: nodebench [-iterations <count>] [-bsp <map.bsp>] [-trace <file>] [-set <cvar> <value>] <game dir> <map>
+//
+// The graph is loaded from <game dir>/maps/graphs/<map>.nod,
+// the same way the server loads it, and the trace from
+// <game dir>/maps/graphs/<map>.nqt unless another file is
+// given. Nearest node lookups trace against the map's brush
+// geometry if -bsp is given; otherwise every trace is
+// unobstructed. Link entities are replayed as they were when
+// recording started, with doors closed. -set changes one of
+// the sv_nodegraph_* cvars, such as the path cache size.
+//=========================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "nodes/CGraph.h"
+#include "nodes/CGraphQueryTrace.h"
+#include "nodes/CGraphSearch.h"
+#include "nodes/NodeConstants.h"
+
+#include "../nodegraph/CBSPWorld.h"
+
+#include "ServerStubs.h"
+
+extern DLL_GLOBAL unsigned int g_ulFrameCount;
+
+namespace
+{
+struct QueryTrace_t
+{
+	GraphQueryTraceHeader_t header;
+	std::vector<GraphQueryTraceLinkEnt_t> linkEnts;
+	std::vector<GraphQueryRecord_t> records;
+};
+
+struct QueryStats_t
+{
+	//Latency of each query, in nanoseconds.
+	std::vector<long long> latencies;
+	double flTotalSeconds = 0;
+	unsigned long long ullNodesVisited = 0;
+};
+
+const char* const g_pszQueryNames[] =
+{
+	"Frame",
+	"FindNearestNode",
+	"FindShortestPath",
+	"NextNodeInRoute",
+	"PathLength"
+};
+
+static_assert( ARRAYSIZE( g_pszQueryNames ) == static_cast<size_t>( GraphQueryType::COUNT ), "Query names must match GraphQueryType" );
+
+void PrintUsage()
+{
+	printf( "Usage: nodebench [-iterations <count>] [-bsp <map.bsp>] [-trace <file>] [-set <cvar> <value>] <game dir> <map>\n" );
+}
+
+bool LoadTrace( const char* const pszFilename, QueryTrace_t& trace )
+{
+	FILE* pFile = fopen( pszFilename, "rb" );
+
+	if( !pFile )
+	{
+		printf( "Couldn't open %s\n", pszFilename );
+		return false;
+	}
+
+	bool bSuccess = false;
+
+	if( fread( &trace.header, sizeof( trace.header ), 1, pFile ) != 1
+		|| memcmp( trace.header.szId, GRAPH_QUERY_TRACE_ID, sizeof( trace.header.szId ) )
+		|| trace.header.iVersion != GRAPH_QUERY_TRACE_VERSION
+		|| trace.header.cLinkEnts < 0 )
+	{
+		printf( "%s is not a node graph query trace, or was written by a different version\n", pszFilename );
+	}
+	else
+	{
+		trace.linkEnts.resize( trace.header.cLinkEnts );
+
+		if( trace.header.cLinkEnts > 0 && fread( trace.linkEnts.data(), sizeof( GraphQueryTraceLinkEnt_t ), trace.linkEnts.size(), pFile ) != trace.linkEnts.size() )
+		{
+			printf( "%s is truncated\n", pszFilename );
+		}
+		else
+		{
+			GraphQueryRecord_t record;
+
+			while( fread( &record, sizeof( record ), 1, pFile ) == 1 )
+			{
+				if( record.iType >= 0 && record.iType < static_cast<int>( GraphQueryType::COUNT ) )
+					trace.records.push_back( record );
+			}
+
+			bSuccess = true;
+		}
+	}
+
+	fclose( pFile );
+
+	return bSuccess;
+}
+
+/**
+*	Does what FSetGraphPointers does, using the link entities stored in the trace instead of the map's entities.
+*/
+bool SetLinkEnts( CGraph& graph, const QueryTrace_t& trace )
+{
+	if( trace.header.cNodes != graph.m_cNodes || trace.header.cLinks != graph.m_cLinks )
+	{
+		printf( "The trace was recorded with a graph that has %d nodes and %d links; this graph has %d nodes and %d links\n",
+				trace.header.cNodes, trace.header.cLinks, graph.m_cNodes, graph.m_cLinks );
+		return false;
+	}
+
+	for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+	{
+		graph.m_ppLinkEnts[ iLink ] = nullptr;
+	}
+
+	for( const auto& linkEnt : trace.linkEnts )
+	{
+		if( linkEnt.iLink < 0 || linkEnt.iLink >= graph.m_cLinks )
+			continue;
+
+		char szClassname[ sizeof( linkEnt.szClassname ) + 1 ];
+
+		memcpy( szClassname, linkEnt.szClassname, sizeof( linkEnt.szClassname ) );
+		szClassname[ sizeof( linkEnt.szClassname ) ] = '\0';
+
+		graph.m_ppLinkEnts[ linkEnt.iLink ] = Stubs_CreateLinkEnt( szClassname, linkEnt.iSpawnFlags );
+	}
+
+	graph.m_fGraphPointersSet = true;
+
+	return true;
+}
+
+/**
+*	Graphs written by another build may have hashed their link lookups with a different CRC. Rebuilds them if any link can't be found.
+*/
+void CheckLinkLookups( CGraph& graph )
+{
+	for( int iLink = 0; iLink < graph.m_cLinks; ++iLink )
+	{
+		const CLink& link = graph.m_pLinkPool[ iLink ];
+
+		int iKey;
+		graph.HashSearch( link.m_iSrcNode, link.m_iDestNode, iKey );
+
+		if( iKey < 0 || graph.m_pLinkPool[ iKey ].m_iSrcNode != link.m_iSrcNode || graph.m_pLinkPool[ iKey ].m_iDestNode != link.m_iDestNode )
+		{
+			printf( "Link lookups don't match, rebuilding them\n" );
+
+			//The old table may be part of the mapped file, so it's left alone.
+			graph.m_pHashLinks = nullptr;
+			graph.BuildLinkLookups();
+			return;
+		}
+	}
+}
+
+/**
+*	Runs a single query.
+*	@return Number of nodes the query visited.
+*/
+unsigned long long RunQuery( CGraph& graph, const GraphQueryRecord_t& record )
+{
+	switch( static_cast<GraphQueryType>( record.iType ) )
+	{
+	case GraphQueryType::FIND_NEAREST_NODE:
+		{
+			graph.FindNearestNode( Vector( record.vecOrigin[ 0 ], record.vecOrigin[ 1 ], record.vecOrigin[ 2 ] ), record.iArg0 );
+
+			//Nearest node lookups visit many nodes cheaply, but each node that is close enough costs a trace.
+			return Stubs_GetTraceCount();
+		}
+
+	case GraphQueryType::FIND_SHORTEST_PATH:
+		{
+			int iPath[ MAX_PATH_SIZE ];
+
+			unsigned long long ullExpandedBefore = 0;
+
+			for( int iMode = 0; iMode < static_cast<int>( GraphSearchMode::COUNT ); ++iMode )
+				ullExpandedBefore += CGraphSearch::GetStats( static_cast<GraphSearchMode>( iMode ) ).ullNodesExpanded;
+
+			const int cPathNodes = graph.FindShortestPath( iPath, record.iArg0, record.iArg1, record.iArg2, record.iArg3 );
+
+			unsigned long long ullExpandedAfter = 0;
+
+			for( int iMode = 0; iMode < static_cast<int>( GraphSearchMode::COUNT ); ++iMode )
+				ullExpandedAfter += CGraphSearch::GetStats( static_cast<GraphSearchMode>( iMode ) ).ullNodesExpanded;
+
+			//Searches count the nodes they expanded; routing tables are read once per node on the path.
+			if( ullExpandedAfter != ullExpandedBefore )
+				return ullExpandedAfter - ullExpandedBefore;
+
+			return graph.m_fRoutingComplete ? cPathNodes : 0;
+		}
+
+	case GraphQueryType::NEXT_NODE_IN_ROUTE:
+		{
+			graph.NextNodeInRoute( record.iArg0, record.iArg1, record.iArg2, record.iArg3 );
+			return 1;
+		}
+
+	case GraphQueryType::PATH_LENGTH:
+		{
+			graph.PathLength( record.iArg0, record.iArg1, record.iArg2, record.iArg3 );
+			return 0;
+		}
+
+	default: return 0;
+	}
+}
+
+/**
+*	@return The number of nodes on the route between two nodes, walked outside of the timed query.
+*/
+unsigned long long CountRouteNodes( CGraph& graph, const GraphQueryRecord_t& record )
+{
+	int iCurrentNode = record.iArg0;
+	const int iCap = graph.CapIndex( record.iArg3 );
+
+	unsigned long long ullNodes = 0;
+
+	for( int iMaxLoop = graph.m_cNodes; iCurrentNode != record.iArg1 && iMaxLoop > 0; --iMaxLoop )
+	{
+		const int iNext = graph.NextNodeInRoute( iCurrentNode, record.iArg1, record.iArg2, iCap );
+
+		if( iNext == iCurrentNode )
+			break;
+
+		iCurrentNode = iNext;
+		++ullNodes;
+	}
+
+	return ullNodes;
+}
+
+double Percentile( const std::vector<long long>& sortedLatencies, const double flPercentile )
+{
+	if( sortedLatencies.empty() )
+		return 0;
+
+	const size_t uiIndex = static_cast<size_t>( flPercentile * ( sortedLatencies.size() - 1 ) + 0.5 );
+
+	return sortedLatencies[ uiIndex ] / 1000.0;
+}
+}
+
+int main( int argc, char* argv[] )
+{
+	int iIterations = 1;
+	const char* pszBSPFilename = nullptr;
+	const char* pszTraceFilename = nullptr;
+	const char* pszGameDir = nullptr;
+	const char* pszMapName = nullptr;
+
+	std::vector<std::pair<const char*, const char*>> cvarValues;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( !strcmp( argv[ i ], "-iterations" ) && i + 1 < argc )
+		{
+			iIterations = max( 1, atoi( argv[ ++i ] ) );
+		}
+		else if( !strcmp( argv[ i ], "-bsp" ) && i + 1 < argc )
+		{
+			pszBSPFilename = argv[ ++i ];
+		}
+		else if( !strcmp( argv[ i ], "-trace" ) && i + 1 < argc )
+		{
+			pszTraceFilename = argv[ ++i ];
+		}
+		else if( !strcmp( argv[ i ], "-set" ) && i + 2 < argc )
+		{
+			cvarValues.emplace_back( argv[ i + 1 ], argv[ i + 2 ] );
+			i += 2;
+		}
+		else if( argv[ i ][ 0 ] != '-' && !pszGameDir )
+		{
+			pszGameDir = argv[ i ];
+		}
+		else if( argv[ i ][ 0 ] != '-' && !pszMapName )
+		{
+			pszMapName = argv[ i ];
+		}
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if( !pszGameDir || !pszMapName )
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	Stubs_Init( pszGameDir );
+
+	for( const auto& cvarValue : cvarValues )
+	{
+		cvar_t* pCvar = Stubs_FindCvar( cvarValue.first );
+
+		if( !pCvar )
+		{
+			printf( "Unknown cvar %s\n", cvarValue.first );
+			return EXIT_FAILURE;
+		}
+
+		pCvar->value = static_cast<float>( atof( cvarValue.second ) );
+	}
+
+	const std::string szTraceFilename = pszTraceFilename ? pszTraceFilename : std::string( pszGameDir ) + "/maps/graphs/" + pszMapName + ".nqt";
+
+	QueryTrace_t trace;
+
+	if( !LoadTrace( szTraceFilename.c_str(), trace ) )
+		return EXIT_FAILURE;
+
+	CBSPWorld world;
+
+	if( pszBSPFilename )
+	{
+		world.Load( pszBSPFilename );
+		Stubs_SetTraceWorld( &world );
+	}
+
+	WorldGraph.InitGraph();
+
+	if( !WorldGraph.FLoadGraph( pszMapName ) )
+	{
+		printf( "Couldn't load %s/maps/graphs/%s.nod\n", pszGameDir, pszMapName );
+		return EXIT_FAILURE;
+	}
+
+	if( !SetLinkEnts( WorldGraph, trace ) )
+		return EXIT_FAILURE;
+
+	CheckLinkLookups( WorldGraph );
+
+	printf( "%s: %d nodes, %d links, %s routing tables\n", pszMapName, WorldGraph.m_cNodes, WorldGraph.m_cLinks,
+			WorldGraph.m_fRoutingComplete ? ( WorldGraph.m_nRouteInfo > 0 ? "flat" : "hierarchical" ) : "no" );
+
+	QueryStats_t stats[ static_cast<int>( GraphQueryType::COUNT ) ];
+
+	unsigned int cFrames = 0;
+
+	Stubs_GetTraceCount();
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for( int iIteration = 0; iIteration < iIterations; ++iIteration )
+	{
+		for( const auto& record : trace.records )
+		{
+			if( static_cast<GraphQueryType>( record.iType ) == GraphQueryType::FRAME )
+			{
+				++cFrames;
+				++g_ulFrameCount;
+				continue;
+			}
+
+			QueryStats_t& queryStats = stats[ record.iType ];
+
+			const auto queryStart = std::chrono::steady_clock::now();
+
+			unsigned long long ullNodesVisited = RunQuery( WorldGraph, record );
+
+			const auto queryEnd = std::chrono::steady_clock::now();
+
+			if( static_cast<GraphQueryType>( record.iType ) == GraphQueryType::PATH_LENGTH )
+				ullNodesVisited = CountRouteNodes( WorldGraph, record );
+
+			queryStats.latencies.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( queryEnd - queryStart ).count() );
+			queryStats.flTotalSeconds += std::chrono::duration<double>( queryEnd - queryStart ).count();
+			queryStats.ullNodesVisited += ullNodesVisited;
+		}
+	}
+
+	const double flWallSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	printf( "%u records, %u frames, %d iteration(s), %.3f seconds\n\n", static_cast<unsigned int>( trace.records.size() ), cFrames, iIterations, flWallSeconds );
+
+	printf( "%-17s %10s %12s %9s %9s %9s %9s %12s\n", "Query", "Count", "Queries/s", "p50 us", "p90 us", "p99 us", "Max us", "Avg visited" );
+
+	size_t uiTotalQueries = 0;
+	double flTotalSeconds = 0;
+
+	for( int iType = static_cast<int>( GraphQueryType::FRAME ) + 1; iType < static_cast<int>( GraphQueryType::COUNT ); ++iType )
+	{
+		QueryStats_t& queryStats = stats[ iType ];
+
+		if( queryStats.latencies.empty() )
+			continue;
+
+		std::sort( queryStats.latencies.begin(), queryStats.latencies.end() );
+
+		const size_t uiCount = queryStats.latencies.size();
+
+		printf( "%-17s %10u %12.0f %9.2f %9.2f %9.2f %9.2f %12.1f\n",
+				g_pszQueryNames[ iType ],
+				static_cast<unsigned int>( uiCount ),
+				queryStats.flTotalSeconds > 0 ? uiCount / queryStats.flTotalSeconds : 0,
+				Percentile( queryStats.latencies, 0.5 ),
+				Percentile( queryStats.latencies, 0.9 ),
+				Percentile( queryStats.latencies, 0.99 ),
+				queryStats.latencies.back() / 1000.0,
+				static_cast<double>( queryStats.ullNodesVisited ) / uiCount );
+
+		uiTotalQueries += uiCount;
+		flTotalSeconds += queryStats.flTotalSeconds;
+	}
+
+	printf( "\n%u queries, %.0f queries/s", static_cast<unsigned int>( uiTotalQueries ), flTotalSeconds > 0 ? uiTotalQueries / flTotalSeconds : 0 );
+
+	if( cFrames > 0 )
+		printf( ", %.1f queries and %.3f ms per frame", static_cast<double>( uiTotalQueries ) / cFrames, 1000.0 * flTotalSeconds / cFrames );
+
+	printf( "\n" );
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <cstring>
+
+#include "CBSPWorld.h"
+
+extern "C"
+{
+#define _NOENUMQBOOL
+#include "../common/cmdlib.h"
+#include "../common/mathlib.h"
+#include "../common/bspfile.h"
+}
+
+//cmdlib defines these for C code.
+#undef true
+#undef false
+
+namespace
+{
+//Same as the engine's.
+const float DIST_EPSILON = 0.03125f;
+
+struct ClipNode_t
+{
+	int iPlane;
+	int children[ 2 ];	//Negative numbers are contents.
+};
+
+struct ClipHull_t
+{
+	const ClipNode_t* pClipNodes;
+	Vector vecClipMins;
+	Vector vecClipMaxs;
+};
+
+//Hull 0 is made from the drawing nodes; the others are stored in the BSP as clip nodes.
+//The bsp loading code keeps the file in globals, so these are too.
+std::vector<ClipNode_t> g_DrawClipNodes;
+std::vector<ClipNode_t> g_ClipNodes;
+
+ClipHull_t g_Hulls[ MAX_MAP_HULLS ];
+
+void BuildHulls()
+{
+	g_DrawClipNodes.resize( numnodes );
+
+	for( int i = 0; i < numnodes; ++i )
+	{
+		g_DrawClipNodes[ i ].iPlane = dnodes[ i ].planenum;
+
+		for( int j = 0; j < 2; ++j )
+		{
+			const int iChild = dnodes[ i ].children[ j ];
+
+			g_DrawClipNodes[ i ].children[ j ] = iChild >= 0 ? iChild : dleafs[ -1 - iChild ].contents;
+		}
+	}
+
+	g_ClipNodes.resize( numclipnodes );
+
+	for( int i = 0; i < numclipnodes; ++i )
+	{
+		g_ClipNodes[ i ].iPlane = dclipnodes[ i ].planenum;
+		g_ClipNodes[ i ].children[ 0 ] = dclipnodes[ i ].children[ 0 ];
+		g_ClipNodes[ i ].children[ 1 ] = dclipnodes[ i ].children[ 1 ];
+	}
+
+	g_Hulls[ 0 ] = { g_DrawClipNodes.data(), Vector( 0, 0, 0 ), Vector( 0, 0, 0 ) };
+	g_Hulls[ 1 ] = { g_ClipNodes.data(), Vector( -16, -16, -36 ), Vector( 16, 16, 36 ) };
+	g_Hulls[ 2 ] = { g_ClipNodes.data(), Vector( -32, -32, -32 ), Vector( 32, 32, 32 ) };
+	g_Hulls[ 3 ] = { g_ClipNodes.data(), Vector( -16, -16, -18 ), Vector( 16, 16, 18 ) };
+}
+
+float PlaneDiff( const dplane_t& plane, const Vector& vecPoint )
+{
+	if( plane.type < 3 )
+		return vecPoint[ plane.type ] - plane.dist;
+
+	return plane.normal[ 0 ] * vecPoint.x + plane.normal[ 1 ] * vecPoint.y + plane.normal[ 2 ] * vecPoint.z - plane.dist;
+}
+
+int HullPointContents( const ClipHull_t& hull, int iNode, const Vector& vecPoint )
+{
+	while( iNode >= 0 )
+	{
+		const ClipNode_t& node = hull.pClipNodes[ iNode ];
+
+		iNode = node.children[ PlaneDiff( dplanes[ node.iPlane ], vecPoint ) < 0 ? 1 : 0 ];
+	}
+
+	return iNode;
+}
+
+/*
+*	The engine's hull check. Returns false once the trace has hit something.
+*/
+bool RecursiveHullCheck( const ClipHull_t& hull, const int iHeadNode, const int iNode, const float p1f, const float p2f, const Vector& p1, const Vector& p2, BSPTrace_t& tr )
+{
+	if( iNode < 0 )
+	{
+		if( iNode != CONTENTS_SOLID )
+			tr.fAllSolid = false;
+		else
+			tr.fStartSolid = true;
+
+		return true;
+	}
+
+	const ClipNode_t& node = hull.pClipNodes[ iNode ];
+	const dplane_t& plane = dplanes[ node.iPlane ];
+
+	const float t1 = PlaneDiff( plane, p1 );
+	const float t2 = PlaneDiff( plane, p2 );
+
+	if( t1 >= 0 && t2 >= 0 )
+		return RecursiveHullCheck( hull, iHeadNode, node.children[ 0 ], p1f, p2f, p1, p2, tr );
+
+	if( t1 < 0 && t2 < 0 )
+		return RecursiveHullCheck( hull, iHeadNode, node.children[ 1 ], p1f, p2f, p1, p2, tr );
+
+	//Put the crosspoint DIST_EPSILON units on the near side.
+	float flFrac = t1 < 0 ? ( t1 + DIST_EPSILON ) / ( t1 - t2 ) : ( t1 - DIST_EPSILON ) / ( t1 - t2 );
+
+	flFrac = std::min( 1.0f, std::max( 0.0f, flFrac ) );
+
+	float midf = p1f + ( p2f - p1f ) * flFrac;
+	Vector mid = p1 + ( p2 - p1 ) * flFrac;
+
+	const int side = t1 < 0 ? 1 : 0;
+
+	//Move up to the node.
+	if( !RecursiveHullCheck( hull, iHeadNode, node.children[ side ], p1f, midf, p1, mid, tr ) )
+		return false;
+
+	//Go past the node.
+	if( HullPointContents( hull, node.children[ side ^ 1 ], mid ) != CONTENTS_SOLID )
+		return RecursiveHullCheck( hull, iHeadNode, node.children[ side ^ 1 ], midf, p2f, mid, p2, tr );
+
+	//Never got out of the solid area.
+	if( tr.fAllSolid )
+		return false;
+
+	//The other side of the node is solid, this is the impact point.
+	const Vector vecNormal( plane.normal[ 0 ], plane.normal[ 1 ], plane.normal[ 2 ] );
+
+	tr.vecPlaneNormal = side ? -vecNormal : vecNormal;
+
+	while( HullPointContents( hull, iHeadNode, mid ) == CONTENTS_SOLID )
+	{
+		//Shouldn't really happen, but does occasionally.
+		flFrac -= 0.1f;
+
+		if( flFrac < 0 )
+		{
+			tr.flFraction = midf;
+			tr.vecEndPos = mid;
+			return false;
+		}
+
+		midf = p1f + ( p2f - p1f ) * flFrac;
+		mid = p1 + ( p2 - p1 ) * flFrac;
+	}
+
+	tr.flFraction = midf;
+	tr.vecEndPos = mid;
+
+	return false;
+}
+
+/*
+*	Picks the clipping hull for a box the same way the engine does.
+*/
+int HullForSize( const Vector& vecMins, const Vector& vecMaxs )
+{
+	const Vector vecSize = vecMaxs - vecMins;
+
+	if( vecSize.x <= 8 )
+		return 0;
+
+	if( vecSize.x <= 36 )
+		return vecSize.z <= 36 ? 3 : 1;
+
+	return 2;
+}
+
+bool StartsWith( const char* pszString, const char* pszPrefix )
+{
+	return !strncmp( pszString, pszPrefix, strlen( pszPrefix ) );
+}
+}
+
+const char* BSPEntity_t::ValueForKey( const char* const pszKey ) const
+{
+	for( const auto& keyValue : keyValues )
+	{
+		if( keyValue.first == pszKey )
+			return keyValue.second.c_str();
+	}
+
+	return "";
+}
+
+void CBSPWorld::Load( const char* const pszFilename )
+{
+	char szFilename[ 1024 ];
+
+	strncpy( szFilename, pszFilename, sizeof( szFilename ) - 1 );
+	szFilename[ sizeof( szFilename ) - 1 ] = '\0';
+
+	LoadBSPFile( szFilename );
+	::ParseEntities();
+
+	m_Entities.clear();
+	m_Entities.resize( num_entities );
+
+	m_iWorldEntity = 0;
+
+	for( int i = 0; i < num_entities; ++i )
+	{
+		//Pairs are parsed into a list in reverse order.
+		for( const epair_t* pPair = entities[ i ].epairs; pPair; pPair = pPair->next )
+		{
+			m_Entities[ i ].keyValues.emplace( m_Entities[ i ].keyValues.begin(), pPair->key, pPair->value );
+		}
+
+		if( !strcmp( m_Entities[ i ].ValueForKey( "classname" ), "worldspawn" ) )
+			m_iWorldEntity = i;
+	}
+
+	BuildHulls();
+
+	AddBrushModels();
+}
+
+int CBSPWorld::PointContents( const Vector& vecPoint ) const
+{
+	const int iContents = HullPointContents( g_Hulls[ 0 ], dmodels[ 0 ].headnode[ 0 ], vecPoint );
+
+	if( iContents <= CONTENTS_CURRENT_0 && iContents >= CONTENTS_CURRENT_DOWN )
+		return CONTENTS_WATER;
+
+	return iContents;
+}
+
+void CBSPWorld::TraceHull( const Vector& vecStart, const Vector& vecEnd, const Vector& vecMins, const Vector& vecMaxs, const bool bWorldOnly, BSPTrace_t& tr ) const
+{
+	ClipToModel( 0, m_iWorldEntity, Vector( 0, 0, 0 ), vecStart, vecEnd, vecMins, vecMaxs, tr );
+
+	if( bWorldOnly )
+		return;
+
+	Vector vecMoveMins, vecMoveMaxs;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		vecMoveMins[ i ] = std::min( vecStart[ i ], vecEnd[ i ] ) + vecMins[ i ] - 1;
+		vecMoveMaxs[ i ] = std::max( vecStart[ i ], vecEnd[ i ] ) + vecMaxs[ i ] + 1;
+	}
+
+	BSPTrace_t trModel;
+
+	for( const auto& model : m_BrushModels )
+	{
+		if( tr.fAllSolid )
+			return;
+
+		if( vecMoveMins.x > model.vecAbsMax.x || vecMoveMins.y > model.vecAbsMax.y || vecMoveMins.z > model.vecAbsMax.z
+			|| vecMoveMaxs.x < model.vecAbsMin.x || vecMoveMaxs.y < model.vecAbsMin.y || vecMoveMaxs.z < model.vecAbsMin.z )
+			continue;
+
+		ClipToModel( model.iModel, model.iEntity, model.vecOrigin, vecStart, vecEnd, vecMins, vecMaxs, trModel );
+
+		if( trModel.fAllSolid || trModel.fStartSolid || trModel.flFraction < tr.flFraction )
+		{
+			const bool fStartSolid = tr.fStartSolid;
+
+			tr = trModel;
+
+			if( fStartSolid )
+				tr.fStartSolid = true;
+		}
+		else if( trModel.fStartSolid )
+		{
+			tr.fStartSolid = true;
+		}
+	}
+}
+
+void CBSPWorld::AddBrushModels()
+{
+	m_BrushModels.clear();
+
+	for( size_t i = 0; i < m_Entities.size(); ++i )
+	{
+		const auto& entity = m_Entities[ i ];
+
+		const char* pszModel = entity.ValueForKey( "model" );
+
+		if( pszModel[ 0 ] != '*' )
+			continue;
+
+		const int iModel = atoi( pszModel + 1 );
+
+		if( iModel <= 0 || iModel >= nummodels || !IsSolidBrushEntity( entity ) )
+			continue;
+
+		BrushModel_t model;
+
+		model.iModel = iModel;
+		model.iEntity = static_cast<int>( i );
+		model.vecOrigin = Vector( 0, 0, 0 );
+
+		sscanf( entity.ValueForKey( "origin" ), "%f %f %f", &model.vecOrigin.x, &model.vecOrigin.y, &model.vecOrigin.z );
+
+		for( int j = 0; j < 3; ++j )
+		{
+			model.vecAbsMin[ j ] = model.vecOrigin[ j ] + dmodels[ iModel ].mins[ j ] - 1;
+			model.vecAbsMax[ j ] = model.vecOrigin[ j ] + dmodels[ iModel ].maxs[ j ] + 1;
+		}
+
+		m_BrushModels.push_back( model );
+	}
+}
+
+bool CBSPWorld::IsSolidBrushEntity( const BSPEntity_t& entity )
+{
+	const char* pszClassname = entity.ValueForKey( "classname" );
+	const int iSpawnFlags = atoi( entity.ValueForKey( "spawnflags" ) );
+
+	if( StartsWith( pszClassname, "trigger_" ) )
+		return false;
+
+	static const char* const pszNonSolid[] =
+	{
+		"func_illusionary",
+		"func_ladder",
+		"func_monsterclip",
+		"func_mortar_field",
+		"func_tankcontrols",
+		"func_traincontrols",
+		"func_friction",
+		"game_zone_player"
+	};
+
+	for( auto pszName : pszNonSolid )
+	{
+		if( !strcmp( pszClassname, pszName ) )
+			return false;
+	}
+
+	//Doors with contents (func_water) and passable doors.
+	if( !strcmp( pszClassname, "func_door" ) || !strcmp( pszClassname, "func_water" ) || !strcmp( pszClassname, "func_door_rotating" ) )
+		return atoi( entity.ValueForKey( "skin" ) ) == 0 && !( iSpawnFlags & 8 );
+
+	//Start off.
+	if( !strcmp( pszClassname, "func_wall_toggle" ) )
+		return !( iSpawnFlags & 1 );
+
+	//Not solid.
+	if( !strcmp( pszClassname, "func_rot_button" ) )
+		return !( iSpawnFlags & 1 );
+
+	if( !strcmp( pszClassname, "func_rotating" ) )
+		return !( iSpawnFlags & 64 );
+
+	return true;
+}
+
+void CBSPWorld::ClipToModel( const int iModel, const int iEntity, const Vector& vecOrigin, const Vector& vecStart, const Vector& vecEnd,
+							 const Vector& vecMins, const Vector& vecMaxs, BSPTrace_t& tr )
+{
+	tr.fAllSolid = true;
+	tr.fStartSolid = false;
+	tr.flFraction = 1;
+	tr.vecEndPos = vecEnd;
+	tr.vecPlaneNormal = Vector( 0, 0, 0 );
+	tr.iHitEntity = -1;
+
+	const int iHull = HullForSize( vecMins, vecMaxs );
+	const ClipHull_t& hull = g_Hulls[ iHull ];
+
+	const Vector vecOffset = hull.vecClipMins - vecMins + vecOrigin;
+
+	const int iHeadNode = dmodels[ iModel ].headnode[ iHull ];
+
+	RecursiveHullCheck( hull, iHeadNode, iHeadNode, 0, 1, vecStart - vecOffset, vecEnd - vecOffset, tr );
+
+	if( tr.flFraction != 1 )
+		tr.vecEndPos = tr.vecEndPos + vecOffset;
+
+	if( tr.flFraction < 1 || tr.fStartSolid )
+		tr.iHitEntity = iEntity;
+}
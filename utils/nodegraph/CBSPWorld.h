@@ -0,0 +1,113 @@
+#ifndef UTILS_NODEGRAPH_CBSPWORLD_H
+#define UTILS_NODEGRAPH_CBSPWORLD_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+//vector.h expects the including math header to define vec_t. This header is shared with the map tools' math library, which defines it the same way.
+typedef float vec_t;
+
+#include "vector.h"
+
+/**
+*	An entity from the BSP's entity lump.
+*/
+struct BSPEntity_t
+{
+	std::vector<std::pair<std::string, std::string>> keyValues;
+
+	/**
+	*	@return The value of the given key, or an empty string if the entity doesn't have it.
+	*/
+	const char* ValueForKey( const char* const pszKey ) const;
+};
+
+/**
+*	Result of a trace through the world and its brush models.
+*/
+struct BSPTrace_t
+{
+	bool fAllSolid;
+	bool fStartSolid;
+	float flFraction;
+	Vector vecEndPos;
+	Vector vecPlaneNormal;
+
+	//Index of the entity that was hit, or -1 if nothing was hit.
+	int iHitEntity;
+};
+
+/**
+*	Collision hulls of a BSP file, loaded through the bsp loading code shared by the map tools.
+*	Traces use the same hull selection and hull checks as the engine, so the results match what the game would see at spawn time.
+*	Brush models are placed at their entity's origin; entities that don't block movement when spawned are left out.
+*	The world is only read after it has been loaded, so traces can be made from several threads at once.
+*/
+class CBSPWorld final
+{
+public:
+	CBSPWorld() = default;
+	~CBSPWorld() = default;
+
+	/**
+	*	Loads the BSP file and parses its entities. Exits on errors, like the other map tools.
+	*/
+	void Load( const char* const pszFilename );
+
+	const std::vector<BSPEntity_t>& GetEntities() const { return m_Entities; }
+
+	/**
+	*	@return Contents of the world at the given point. Currents are reported as water.
+	*/
+	int PointContents( const Vector& vecPoint ) const;
+
+	/**
+	*	Traces a box through the world, and through solid brush models unless bWorldOnly is set.
+	*	The box is mapped to one of the BSP's clipping hulls the same way the engine does it.
+	*/
+	void TraceHull( const Vector& vecStart, const Vector& vecEnd, const Vector& vecMins, const Vector& vecMaxs, const bool bWorldOnly, BSPTrace_t& tr ) const;
+
+	void TraceLine( const Vector& vecStart, const Vector& vecEnd, const bool bWorldOnly, BSPTrace_t& tr ) const
+	{
+		TraceHull( vecStart, vecEnd, Vector( 0, 0, 0 ), Vector( 0, 0, 0 ), bWorldOnly, tr );
+	}
+
+	/**
+	*	@return Index of the worldspawn entity.
+	*/
+	int GetWorldEntity() const { return m_iWorldEntity; }
+
+private:
+	struct BrushModel_t
+	{
+		int iModel;
+		int iEntity;
+		Vector vecOrigin;
+		Vector vecAbsMin;
+		Vector vecAbsMax;
+	};
+
+	void AddBrushModels();
+
+	static bool IsSolidBrushEntity( const BSPEntity_t& entity );
+
+	/**
+	*	Traces against a single model at the given origin. The trace reports iEntity as the entity that was hit.
+	*/
+	static void ClipToModel( const int iModel, const int iEntity, const Vector& vecOrigin, const Vector& vecStart, const Vector& vecEnd,
+							 const Vector& vecMins, const Vector& vecMaxs, BSPTrace_t& tr );
+
+private:
+	std::vector<BSPEntity_t> m_Entities;
+
+	int m_iWorldEntity = 0;
+
+	std::vector<BrushModel_t> m_BrushModels;
+
+private:
+	CBSPWorld( const CBSPWorld& ) = delete;
+	CBSPWorld& operator=( const CBSPWorld& ) = delete;
+};
+
+#endif //UTILS_NODEGRAPH_CBSPWORLD_H
@@ -0,0 +1,815 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "nodes/CGraph.h"
+#include "nodes/CNodeHierarchy.h"
+#include "nodes/CNodeVisibility.h"
+
+#include "CBSPWorld.h"
+
+#include "CNodeGraphCompiler.h"
+
+namespace
+{
+//Same as the engine's sv_stepsize.
+const float STEP_SIZE = 18;
+
+struct HullSize_t
+{
+	Vector vecMins;
+	Vector vecMaxs;
+};
+
+//Sizes that CTestHull uses for each node hull.
+const HullSize_t g_HullSizes[ MAX_NODE_HULLS ] =
+{
+	{ Vector( -12, -12, 0 ), Vector( 12, 12, 24 ) },
+	{ Vector( -16, -16, 0 ), Vector( 16, 16, 72 ) },
+	{ Vector( -32, -32, 0 ), Vector( 32, 32, 64 ) },
+	{ Vector( -32, -32, 0 ), Vector( 32, 32, 64 ) }
+};
+
+/*
+*	The engine's yaw calculation, which truncates to whole degrees.
+*/
+float VecToYaw( const Vector& vecDir )
+{
+	if( vecDir.x == 0 && vecDir.y == 0 )
+		return 0;
+
+	float flYaw = static_cast<int>( atan2( vecDir.y, vecDir.x ) * 180 / M_PI );
+
+	if( flYaw < 0 )
+		flYaw += 360;
+
+	return flYaw;
+}
+
+/*
+*	The engine's SV_CheckBottom, for moves that only collide with the world.
+*/
+bool CheckBottom( const CBSPWorld& world, const Vector& vecOrigin, const Vector& vecMins, const Vector& vecMaxs )
+{
+	const Vector vecAbsMin = vecOrigin + vecMins;
+	const Vector vecAbsMax = vecOrigin + vecMaxs;
+
+	Vector vecStart, vecStop;
+
+	//If all of the points under the corners are solid world, don't bother with the tougher checks.
+	vecStart.z = vecAbsMin.z - 1;
+
+	bool bAllSolid = true;
+
+	for( int x = 0; x <= 1 && bAllSolid; ++x )
+	{
+		for( int y = 0; y <= 1 && bAllSolid; ++y )
+		{
+			vecStart.x = x ? vecAbsMax.x : vecAbsMin.x;
+			vecStart.y = y ? vecAbsMax.y : vecAbsMin.y;
+
+			if( world.PointContents( vecStart ) != CONTENTS_SOLID )
+				bAllSolid = false;
+		}
+	}
+
+	if( bAllSolid )
+		return true;
+
+	//The midpoint must be within 16 of the bottom.
+	vecStart.x = vecStop.x = ( vecAbsMin.x + vecAbsMax.x ) * 0.5f;
+	vecStart.y = vecStop.y = ( vecAbsMin.y + vecAbsMax.y ) * 0.5f;
+	vecStart.z = vecAbsMin.z;
+	vecStop.z = vecStart.z - 2 * STEP_SIZE;
+
+	BSPTrace_t tr;
+
+	world.TraceLine( vecStart, vecStop, true, tr );
+
+	if( tr.flFraction == 1 )
+		return false;
+
+	const float flMid = tr.vecEndPos.z;
+
+	//The corners must be within 16 of the midpoint.
+	for( int x = 0; x <= 1; ++x )
+	{
+		for( int y = 0; y <= 1; ++y )
+		{
+			vecStart.x = vecStop.x = x ? vecAbsMax.x : vecAbsMin.x;
+			vecStart.y = vecStop.y = y ? vecAbsMax.y : vecAbsMin.y;
+
+			world.TraceLine( vecStart, vecStop, true, tr );
+
+			if( tr.flFraction == 1 || flMid - tr.vecEndPos.z > STEP_SIZE )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+*	The engine's walkmove, for WALKMOVE_WORLDONLY moves and for swimming monsters.
+*/
+bool TestMove( const CBSPWorld& world, Vector& vecOrigin, const Vector& vecMins, const Vector& vecMaxs, const bool bSwim, const float flYaw, const float flDist )
+{
+	const float flYawRadians = flYaw * M_PI * 2 / 360;
+
+	const Vector vecMove( cos( flYawRadians ) * flDist, sin( flYawRadians ) * flDist, 0 );
+
+	BSPTrace_t tr;
+
+	if( bSwim )
+	{
+		world.TraceHull( vecOrigin, vecOrigin + vecMove, vecMins, vecMaxs, false, tr );
+
+		//Swimming monsters can't leave the water.
+		if( tr.flFraction != 1 || world.PointContents( tr.vecEndPos ) == CONTENTS_EMPTY )
+			return false;
+
+		vecOrigin = tr.vecEndPos;
+		return true;
+	}
+
+	//Push down from a step height above the wished position.
+	Vector vecNewOrigin = vecOrigin + vecMove;
+	vecNewOrigin.z += STEP_SIZE;
+
+	Vector vecEnd = vecNewOrigin;
+	vecEnd.z -= STEP_SIZE * 2;
+
+	world.TraceHull( vecNewOrigin, vecEnd, vecMins, vecMaxs, true, tr );
+
+	if( tr.fAllSolid )
+		return false;
+
+	if( tr.fStartSolid )
+	{
+		vecNewOrigin.z -= STEP_SIZE;
+
+		world.TraceHull( vecNewOrigin, vecEnd, vecMins, vecMaxs, true, tr );
+
+		if( tr.fAllSolid || tr.fStartSolid )
+			return false;
+	}
+
+	//Walked off an edge.
+	if( tr.flFraction == 1 )
+		return false;
+
+	if( !CheckBottom( world, tr.vecEndPos, vecMins, vecMaxs ) )
+		return false;
+
+	vecOrigin = tr.vecEndPos;
+
+	return true;
+}
+
+double GetSeconds( const std::chrono::steady_clock::time_point& start )
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+}
+
+CNodeGraphCompiler::CNodeGraphCompiler( const CBSPWorld& world, const int iNumThreads )
+	: m_World( world )
+	, m_iNumThreads( iNumThreads > 0 ? iNumThreads : 1 )
+	, m_Graph( std::make_unique<CGraph>() )
+	, m_Hierarchy( std::make_unique<CNodeHierarchy>() )
+	, m_Visibility( std::make_unique<CNodeVisibility>() )
+{
+	memset( static_cast<void*>( m_Graph.get() ), 0, sizeof( CGraph ) );
+}
+
+CNodeGraphCompiler::~CNodeGraphCompiler()
+{
+	free( m_Graph->m_pNodes );
+	free( m_Graph->m_pLinkPool );
+	free( m_Graph->m_di );
+	free( m_Graph->m_pRouteInfo );
+}
+
+bool CNodeGraphCompiler::Build()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	LoadNodes();
+
+	if( m_Graph->m_cNodes <= 0 )
+	{
+		printf( "No Nodes!\n" );
+		return false;
+	}
+
+	printf( "%d nodes, using %d threads\n", m_Graph->m_cNodes, m_iNumThreads );
+
+	DropNodes();
+
+	if( !LinkVisibleNodes() )
+		return false;
+
+	printf( "Linked visible nodes (%.2f seconds)\n", GetSeconds( start ) );
+
+	start = std::chrono::steady_clock::now();
+
+	TestHulls();
+
+	printf( "Tested hulls (%.2f seconds)\n", GetSeconds( start ) );
+
+	CGraph& graph = *m_Graph;
+
+	graph.RejectInlineLinks( m_InitialLinks.get(), nullptr );
+
+	//Copy only the used portions of the initial pool into the graph's link pool.
+	graph.m_cLinks = 0;
+
+	for( int i = 0; i < graph.m_cNodes; ++i )
+	{
+		graph.m_cLinks += graph.m_pNodes[ i ].m_cNumLinks;
+	}
+
+	graph.m_pLinkPool = static_cast<CLink*>( calloc( sizeof( CLink ), max( graph.m_cLinks, 1 ) ) );
+
+	if( !graph.m_pLinkPool )
+	{
+		printf( "Couldn't malloc LinkPool!\n" );
+		return false;
+	}
+
+	int iFinalPoolIndex = 0;
+
+	for( int i = 0; i < graph.m_cNodes; ++i )
+	{
+		const int iOldFirstLink = graph.m_pNodes[ i ].m_iFirstLink;
+
+		graph.m_pNodes[ i ].m_iFirstLink = iFinalPoolIndex;
+
+		for( int j = 0; j < graph.m_pNodes[ i ].m_cNumLinks; ++j )
+		{
+			graph.m_pLinkPool[ iFinalPoolIndex++ ] = m_InitialLinks[ iOldFirstLink + j ];
+		}
+	}
+
+	m_InitialLinks.reset();
+
+	//Node sorting numbers linked nodes close to each other.
+	graph.SortNodes();
+
+	printf( "%d Nodes, %d Connections\n", graph.m_cNodes, graph.m_cLinks );
+
+	//Find the entities that block links, the same way the game finds them when it loads the graph.
+	m_LinkEntities = std::make_unique<int[]>( max( graph.m_cLinks, 1 ) );
+
+	const auto& entities = m_World.GetEntities();
+
+	for( int i = 0; i < graph.m_cLinks; ++i )
+	{
+		m_LinkEntities[ i ] = -1;
+
+		if( !graph.m_pLinkPool[ i ].HasLinkEnt() )
+			continue;
+
+		char szName[ 5 ];
+		memcpy( szName, graph.m_pLinkPool[ i ].m_szLinkEntModelname, 4 );
+		szName[ 4 ] = '\0';
+
+		for( size_t iEntity = 0; iEntity < entities.size(); ++iEntity )
+		{
+			if( !strcmp( entities[ iEntity ].ValueForKey( "model" ), szName ) )
+			{
+				m_LinkEntities[ i ] = static_cast<int>( iEntity );
+				break;
+			}
+		}
+	}
+
+	//This is used for FindNearestNode.
+	graph.BuildRangeTables();
+
+	//Push all of the LAND nodes down to the ground now. Leave the water and air nodes alone.
+	for( int i = 0; i < graph.m_cNodes; ++i )
+	{
+		if( graph.m_pNodes[ i ].m_afNodeInfo & bits_NODE_LAND )
+		{
+			graph.m_pNodes[ i ].m_vecOrigin.z -= NODE_HEIGHT;
+		}
+	}
+
+	graph.m_fGraphPresent = true;
+	graph.m_fGraphPointersSet = true;
+	graph.m_fRoutingComplete = false;
+
+	start = std::chrono::steady_clock::now();
+
+	//Same choice as CGraph::ComputeStaticRoutingTables.
+	if( graph.m_cNodes <= FLAT_ROUTING_MAX_NODES )
+	{
+		ComputeRoutingTables();
+
+		printf( "Computed routing tables, %d bytes (%.2f seconds)\n", graph.m_nRouteInfo, GetSeconds( start ) );
+	}
+	else
+	{
+		ComputeHierarchy();
+
+		printf( "Computed hierarchical routing tables, %u bytes (%.2f seconds)\n",
+				static_cast<unsigned int>( m_Hierarchy->GetMemoryUsage() ), GetSeconds( start ) );
+	}
+
+	if( !graph.m_fRoutingComplete )
+		printf( "Routing tables are incomplete, the game will compute them when it first loads the graph\n" );
+
+	//The game only builds the matrix for graphs of this size, so larger graphs don't get one.
+	if( graph.m_cNodes > 1 && graph.m_cNodes <= CNodeVisibility::MAX_MATRIX_NODES )
+	{
+		start = std::chrono::steady_clock::now();
+
+		ComputeVisibility();
+
+		printf( "Computed node visibility, %u bytes (%.2f seconds)\n", static_cast<unsigned int>( m_Visibility->GetMemoryUsage() ), GetSeconds( start ) );
+	}
+
+	return true;
+}
+
+bool CNodeGraphCompiler::Save( const char* const pszFilename ) const
+{
+	std::vector<unsigned char> hierarchyData;
+	std::vector<unsigned char> visibilityData;
+
+	m_Hierarchy->Serialize( hierarchyData );
+	m_Visibility->Serialize( visibilityData );
+
+	return m_Graph->WriteGraphFile( pszFilename, hierarchyData, visibilityData );
+}
+
+template<typename FUNC>
+void CNodeGraphCompiler::ParallelFor( const int iCount, FUNC func ) const
+{
+	std::atomic<int> iNext( 0 );
+
+	auto worker = [ & ]()
+	{
+		for( int i = iNext++; i < iCount; i = iNext++ )
+		{
+			func( i );
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for( int i = 1; i < m_iNumThreads; ++i )
+	{
+		threads.emplace_back( worker );
+	}
+
+	worker();
+
+	for( auto& thread : threads )
+	{
+		thread.join();
+	}
+}
+
+void CNodeGraphCompiler::LoadNodes()
+{
+	CGraph& graph = *m_Graph;
+
+	std::vector<const BSPEntity_t*> nodeEntities;
+
+	for( const auto& entity : m_World.GetEntities() )
+	{
+		const char* pszClassname = entity.ValueForKey( "classname" );
+
+		if( !strcmp( pszClassname, "info_node" ) || !strcmp( pszClassname, "info_node_air" ) )
+		{
+			if( nodeEntities.size() >= MAX_NODES )
+			{
+				printf( "cNodes > MAX_NODES\n" );
+				break;
+			}
+
+			nodeEntities.push_back( &entity );
+		}
+	}
+
+	graph.m_cNodes = static_cast<int>( nodeEntities.size() );
+	graph.m_pNodes = static_cast<CNode*>( calloc( sizeof( CNode ), max( graph.m_cNodes, 1 ) ) );
+
+	for( int i = 0; i < graph.m_cNodes; ++i )
+	{
+		const BSPEntity_t& entity = *nodeEntities[ i ];
+		CNode& node = graph.m_pNodes[ i ];
+
+		Vector vecOrigin( 0, 0, 0 );
+		sscanf( entity.ValueForKey( "origin" ), "%f %f %f", &vecOrigin.x, &vecOrigin.y, &vecOrigin.z );
+
+		Vector vecAngles( 0, 0, 0 );
+
+		if( *entity.ValueForKey( "angles" ) )
+			sscanf( entity.ValueForKey( "angles" ), "%f %f %f", &vecAngles.x, &vecAngles.y, &vecAngles.z );
+		else
+			vecAngles.y = atof( entity.ValueForKey( "angle" ) );
+
+		node.m_vecOriginPeek = node.m_vecOrigin = vecOrigin;
+		node.m_flHintYaw = vecAngles.y;
+		node.m_sHintType = static_cast<short>( atoi( entity.ValueForKey( "hinttype" ) ) );
+		node.m_sHintActivity = static_cast<short>( atoi( entity.ValueForKey( "activity" ) ) );
+		node.m_afNodeInfo = !strcmp( entity.ValueForKey( "classname" ), "info_node_air" ) ? bits_NODE_AIR : 0;
+	}
+}
+
+void CNodeGraphCompiler::DropNodes()
+{
+	CGraph& graph = *m_Graph;
+
+	ParallelFor( graph.m_cNodes, [ & ]( const int i )
+	{
+		CNode& node = graph.m_pNodes[ i ];
+
+		if( node.m_afNodeInfo & bits_NODE_AIR )
+		{
+			// do nothing
+		}
+		else if( m_World.PointContents( node.m_vecOrigin ) == CONTENTS_WATER )
+		{
+			node.m_afNodeInfo |= bits_NODE_WATER;
+		}
+		else
+		{
+			node.m_afNodeInfo |= bits_NODE_LAND;
+
+			// trace to the ground, then pop up 8 units and place node there to make it
+			// easier for them to connect (think stairs, chairs, and bumps in the floor).
+			// After the routing is done, push them back down.
+			BSPTrace_t tr;
+
+			m_World.TraceLine( node.m_vecOrigin, node.m_vecOrigin - Vector( 0, 0, 384 ), false, tr );
+
+			node.m_vecOriginPeek.z = node.m_vecOrigin.z = tr.vecEndPos.z + NODE_HEIGHT;
+		}
+	} );
+}
+
+bool CNodeGraphCompiler::LinkVisibleNodes()
+{
+	CGraph& graph = *m_Graph;
+
+	m_InitialLinks.reset( new( std::nothrow ) CLink[ static_cast<size_t>( graph.m_cNodes ) * MAX_NODE_INITIAL_LINKS ] );
+
+	if( !m_InitialLinks )
+	{
+		printf( "**Could not malloc TempPool!\n" );
+		return false;
+	}
+
+	const auto& entities = m_World.GetEntities();
+
+	std::atomic<int> iBadNode( -1 );
+
+	//Each node gets its own range of the initial pool, so nodes can be linked in any order.
+	ParallelFor( graph.m_cNodes, [ & ]( const int i )
+	{
+		CNode& node = graph.m_pNodes[ i ];
+
+		node.m_iFirstLink = i * MAX_NODE_INITIAL_LINKS;
+		node.m_cNumLinks = 0;
+
+		if( iBadNode != -1 )
+			return;
+
+		BSPTrace_t tr;
+
+		for( int j = 0; j < graph.m_cNodes; ++j )
+		{
+			if( j == i )
+			{// don't connect to self!
+				continue;
+			}
+
+			if( ( node.m_afNodeInfo & bits_NODE_GROUP_REALM ) != ( graph.m_pNodes[ j ].m_afNodeInfo & bits_NODE_GROUP_REALM ) )
+			{
+				// don't connect air nodes to water nodes to land nodes. It just wouldn't be prudent at this juncture.
+				continue;
+			}
+
+			m_World.TraceLine( node.m_vecOrigin, graph.m_pNodes[ j ].m_vecOrigin, false, tr );
+
+			if( tr.fStartSolid )
+				continue;
+
+			int iLinkEnt = -1;
+
+			if( tr.flFraction != 1.0 )
+			{// trace hit a brush ent, trace backwards to make sure that this ent is the only thing in the way.
+				iLinkEnt = tr.iHitEntity;
+
+				m_World.TraceLine( graph.m_pNodes[ j ].m_vecOrigin, node.m_vecOrigin, false, tr );
+
+				if( tr.iHitEntity != iLinkEnt || iLinkEnt == m_World.GetWorldEntity() )
+				{// even if the ent wasn't there, these nodes couldn't be connected. Skip.
+					continue;
+				}
+			}
+
+			if( node.m_cNumLinks == MAX_NODE_INITIAL_LINKS - 1 )
+			{
+				// If we hit this, either a level designer is placing too many nodes in the same area, or
+				// we need to allow for a larger initial link pool.
+				iBadNode = i;
+				return;
+			}
+
+			CLink& link = m_InitialLinks[ node.m_iFirstLink + node.m_cNumLinks++ ];
+
+			memset( static_cast<void*>( &link ), 0, sizeof( link ) );
+
+			link.m_iSrcNode = i;
+			link.m_iDestNode = j;
+
+			if( iLinkEnt != -1 )
+			{
+				// record the modelname, so that the game can find the entity when it loads the graph.
+				const char* pszModel = entities[ iLinkEnt ].ValueForKey( "model" );
+
+				memcpy( link.m_szLinkEntModelname, pszModel, min( strlen( pszModel ) + 1, sizeof( link.m_szLinkEntModelname ) ) );
+			}
+		}
+	} );
+
+	if( iBadNode != -1 )
+	{
+		const Vector& vecOrigin = graph.m_pNodes[ iBadNode ].m_vecOrigin;
+
+		printf( "**LinkVisibleNodes:\nNode %d at %.0f %.0f %.0f has NodeLinks > MAX_NODE_INITIAL_LINKS\n", iBadNode.load(), vecOrigin.x, vecOrigin.y, vecOrigin.z );
+		return false;
+	}
+
+	return true;
+}
+
+void CNodeGraphCompiler::TestHulls()
+{
+	CGraph& graph = *m_Graph;
+
+	ParallelFor( graph.m_cNodes, [ & ]( const int i )
+	{
+		CNode& srcNode = graph.m_pNodes[ i ];
+
+		for( int j = 0; j < srcNode.m_cNumLinks; ++j )
+		{
+			CLink& link = m_InitialLinks[ srcNode.m_iFirstLink + j ];
+			const CNode& destNode = graph.m_pNodes[ link.m_iDestNode ];
+
+			// assume that all hulls can walk this link, then eliminate the ones that can't.
+			link.m_afLinkInfo = bits_LINK_SMALL_HULL | bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL | bits_LINK_FLY_HULL;
+
+			// if we can't fit a tiny hull through a connection, no other hulls with fit either, so we
+			// should just fall out of the loop. Do so by setting the SkipRemainingHulls flag.
+			bool fSkipRemainingHulls = false;
+
+			for( int hull = 0; hull < NODE_FLY_HULL && !fSkipRemainingHulls; ++hull )
+			{
+				if( CanWalk( i, link.m_iDestNode, hull ) )
+					continue;
+
+				switch( hull )
+				{
+				case NODE_SMALL_HULL:	// if this hull can't fit, nothing can, so drop the connection
+					link.m_afLinkInfo &= ~( bits_LINK_SMALL_HULL | bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL );
+					fSkipRemainingHulls = true;
+					break;
+				case NODE_HUMAN_HULL:
+					link.m_afLinkInfo &= ~( bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL );
+					fSkipRemainingHulls = true;
+					break;
+				case NODE_LARGE_HULL:
+					link.m_afLinkInfo &= ~bits_LINK_LARGE_HULL;
+					break;
+				}
+			}
+
+			BSPTrace_t tr;
+
+			m_World.TraceHull( srcNode.m_vecOrigin + Vector( 0, 0, 32 ), destNode.m_vecOriginPeek + Vector( 0, 0, 32 ),
+							   Vector( -32, -32, -32 ), Vector( 32, 32, 32 ), false, tr );
+
+			if( tr.fStartSolid || tr.flFraction < 1.0 )
+			{
+				link.m_afLinkInfo &= ~bits_LINK_FLY_HULL;
+			}
+
+			if( link.m_afLinkInfo == 0 )
+			{
+				link = m_InitialLinks[ srcNode.m_iFirstLink + ( srcNode.m_cNumLinks - 1 ) ];
+				srcNode.m_cNumLinks--;
+				j--;
+			}
+		}
+	} );
+}
+
+bool CNodeGraphCompiler::CanWalk( const int iSrc, const int iDest, const int iHull ) const
+{
+	const CNode& srcNode = m_Graph->m_pNodes[ iSrc ];
+	const CNode& destNode = m_Graph->m_pNodes[ iDest ];
+
+	const Vector& vecMins = g_HullSizes[ iHull ].vecMins;
+	const Vector& vecMaxs = g_HullSizes[ iHull ].vecMaxs;
+
+	const bool bSwim = ( srcNode.m_afNodeInfo & bits_NODE_WATER ) != 0;
+
+	Vector vecOrigin = srcNode.m_vecOrigin;
+	const Vector& vecSpot = destNode.m_vecOrigin;
+
+	const float flYaw = VecToYaw( vecSpot - vecOrigin );
+	const float flDist = ( vecSpot - vecOrigin ).Length2D();
+
+	// in this loop we take tiny steps from the current node to the nodes that it links to, one at a time.
+	for( int step = 0; step < flDist; step += HULL_STEP_SIZE )
+	{
+		float stepSize = HULL_STEP_SIZE;
+
+		if( ( step + stepSize ) >= ( flDist - 1 ) )
+			stepSize = ( flDist - step ) - 1;
+
+		if( !TestMove( m_World, vecOrigin, vecMins, vecMaxs, bSwim, flYaw, stepSize ) )
+		{// can't take the next step
+			return false;
+		}
+	}
+
+	// the yaw is rounded to whole degrees, so long walks can end up somewhere else.
+	return ( vecOrigin - vecSpot ).Length() <= 64;
+}
+
+void CNodeGraphCompiler::ComputeRoutingTables()
+{
+	CGraph& graph = *m_Graph;
+
+	const int cNodes = graph.m_cNodes;
+
+	//Compressed row of the routing table for every hull, capability and node, in the order the game computes them.
+	std::vector<std::string> rows( MAX_NODE_HULLS * 2 * cNodes );
+
+	ParallelFor( cNodes, [ & ]( const int iFrom )
+	{
+		std::vector<float> distances( cNodes );
+		std::vector<unsigned short> bestNextNodes( cNodes );
+		std::vector<char> route( cNodes * 2 );
+
+		using QueueEntry_t = std::pair<float, int>;
+
+		for( int iHull = 0; iHull < MAX_NODE_HULLS; ++iHull )
+		{
+			const int iHullMask = CGraph::HullLinkMask( iHull );
+
+			for( int iCap = 0; iCap < 2; ++iCap )
+			{
+				//Shortest path tree from this node. The next node of each destination is the first node on the path to it.
+				std::priority_queue<QueueEntry_t, std::vector<QueueEntry_t>, std::greater<QueueEntry_t>> queue;
+
+				for( int i = 0; i < cNodes; ++i )
+				{
+					distances[ i ] = -1;
+					bestNextNodes[ i ] = iFrom;
+				}
+
+				distances[ iFrom ] = 0;
+				queue.emplace( 0.0f, iFrom );
+
+				while( !queue.empty() )
+				{
+					const QueueEntry_t current = queue.top();
+					queue.pop();
+
+					const int iCurrentNode = current.second;
+
+					if( current.first > distances[ iCurrentNode ] )
+						continue;
+
+					const CNode& node = graph.m_pNodes[ iCurrentNode ];
+
+					for( int i = 0; i < node.m_cNumLinks; ++i )
+					{
+						const int iLink = node.m_iFirstLink + i;
+						const CLink& link = graph.m_pLinkPool[ iLink ];
+
+						if( ( link.m_afLinkInfo & iHullMask ) != iHullMask )
+							continue;
+
+						if( !IsLinkPassable( iLink, iCap == 1 ) )
+							continue;
+
+						const int iVisitNode = link.m_iDestNode;
+						const float flDistance = current.first + link.m_flWeight;
+
+						if( distances[ iVisitNode ] < -0.5 || flDistance < distances[ iVisitNode ] - 0.001 )
+						{
+							distances[ iVisitNode ] = flDistance;
+							bestNextNodes[ iVisitNode ] = iCurrentNode == iFrom ? iVisitNode : bestNextNodes[ iCurrentNode ];
+							queue.emplace( flDistance, iVisitNode );
+						}
+					}
+				}
+
+				const int nRoute = CGraph::CompressRoute( bestNextNodes.data(), cNodes, iFrom, route.data() );
+
+				rows[ ( iHull * 2 + iCap ) * cNodes + iFrom ].assign( route.data(), nRoute );
+			}
+		}
+	} );
+
+	//Store each row once, sharing rows that are already in the table.
+	std::string routeInfo;
+
+	for( int iHull = 0; iHull < MAX_NODE_HULLS; ++iHull )
+	{
+		for( int iCap = 0; iCap < 2; ++iCap )
+		{
+			for( int iFrom = 0; iFrom < cNodes; ++iFrom )
+			{
+				const std::string& row = rows[ ( iHull * 2 + iCap ) * cNodes + iFrom ];
+
+				size_t uiOffset = routeInfo.find( row );
+
+				if( uiOffset == std::string::npos )
+				{
+					uiOffset = routeInfo.size();
+					routeInfo += row;
+				}
+
+				graph.m_pNodes[ iFrom ].m_pNextBestNode[ iHull ][ iCap ] = static_cast<int>( uiOffset );
+			}
+		}
+	}
+
+	graph.m_nRouteInfo = static_cast<int>( routeInfo.size() );
+	graph.m_pRouteInfo = static_cast<char*>( calloc( sizeof( char ), max( graph.m_nRouteInfo, 1 ) ) );
+
+	if( !graph.m_pRouteInfo )
+	{
+		printf( "Couldn't malloc routing tables!\n" );
+		graph.m_nRouteInfo = 0;
+		return;
+	}
+
+	memcpy( graph.m_pRouteInfo, routeInfo.data(), graph.m_nRouteInfo );
+
+	graph.m_fRoutingComplete = true;
+}
+
+void CNodeGraphCompiler::ComputeHierarchy()
+{
+	CGraph& graph = *m_Graph;
+
+	graph.m_fRoutingComplete = m_Hierarchy->Build( graph,
+		[ this ]( int iLink, int afCapMask ) { return IsLinkPassable( iLink, afCapMask != 0 ); },
+		m_iNumThreads );
+}
+
+void CNodeGraphCompiler::ComputeVisibility()
+{
+	//The game traces with ignore_monsters, which hits the world and solid brush entities.
+	m_Visibility->Build( *m_Graph,
+		[ this ]( const Vector& vecStart, const Vector& vecEnd )
+		{
+			BSPTrace_t tr;
+
+			m_World.TraceLine( vecStart, vecEnd, false, tr );
+
+			return tr.flFraction == 1.0;
+		} );
+}
+
+bool CNodeGraphCompiler::IsLinkPassable( const int iLink, const bool bCanOpenDoors ) const
+{
+	const int iEntity = m_LinkEntities[ iLink ];
+
+	if( iEntity == -1 )
+		return true;
+
+	const char* pszClassname = m_World.GetEntities()[ iEntity ].ValueForKey( "classname" );
+
+	//Doors are closed when the level starts. Monsters that can open doors can use them in static queries.
+	if( !strcmp( pszClassname, "func_door" ) || !strcmp( pszClassname, "func_door_rotating" ) )
+		return bCanOpenDoors;
+
+	if( !strcmp( pszClassname, "func_breakable" ) )
+		return true;
+
+	return false;
+}
@@ -0,0 +1,108 @@
+#ifndef UTILS_NODEGRAPH_CNODEGRAPHCOMPILER_H
+#define UTILS_NODEGRAPH_CNODEGRAPHCOMPILER_H
+
+#include <memory>
+
+class CBSPWorld;
+class CGraph;
+class CLink;
+class CNodeHierarchy;
+class CNodeVisibility;
+
+/**
+*	Builds a node graph from the info_node entities in a BSP, the same way CTestHull::BuildNodeGraph does in the game.
+*	Node linking, hull testing and routing tables are spread across threads.
+*	Link pruning, node sorting, the range tables and the file format are shared with the game through CGraph.build.cpp.
+*	Hierarchical routing tables and the visibility matrix are built by the game's CNodeHierarchy and CNodeVisibility.
+*/
+class CNodeGraphCompiler final
+{
+public:
+	/**
+	*	@param world World to build the graph for. Must be loaded.
+	*	@param iNumThreads Number of threads to use.
+	*/
+	CNodeGraphCompiler( const CBSPWorld& world, const int iNumThreads );
+	~CNodeGraphCompiler();
+
+	/**
+	*	Builds the graph.
+	*	@return Whether the graph was built.
+	*/
+	bool Build();
+
+	/**
+	*	Writes the graph to the given file.
+	*/
+	bool Save( const char* const pszFilename ) const;
+
+private:
+	/**
+	*	Runs func( i ) for every i in [ 0, iCount ) on all threads.
+	*/
+	template<typename FUNC>
+	void ParallelFor( const int iCount, FUNC func ) const;
+
+	void LoadNodes();
+
+	/**
+	*	Recognizes water nodes and drops land nodes to the floor.
+	*/
+	void DropNodes();
+
+	/**
+	*	Links every node to the nodes it can see, then compacts the links into the graph's link pool.
+	*/
+	bool LinkVisibleNodes();
+
+	/**
+	*	Removes the hulls that can't move along each link from the link, and removes links that no hull can use.
+	*/
+	void TestHulls();
+
+	/**
+	*	Returns whether a hull of the given size can walk or swim from node iSrc to node iDest.
+	*/
+	bool CanWalk( const int iSrc, const int iDest, const int iHull ) const;
+
+	/**
+	*	Computes the flat routing tables.
+	*/
+	void ComputeRoutingTables();
+
+	/**
+	*	Computes the hierarchical routing tables, for graphs that are too large for the flat tables.
+	*/
+	void ComputeHierarchy();
+
+	/**
+	*	Traces lines of sight between nodes, the same way the game does when it builds the matrix.
+	*/
+	void ComputeVisibility();
+
+	/**
+	*	@return Whether a link can be used when its link entity is in its spawn state. Mirrors CGraph::HandleLinkEnt.
+	*/
+	bool IsLinkPassable( const int iLink, const bool bCanOpenDoors ) const;
+
+private:
+	const CBSPWorld& m_World;
+	const int m_iNumThreads;
+
+	std::unique_ptr<CGraph> m_Graph;
+
+	std::unique_ptr<CNodeHierarchy> m_Hierarchy;
+	std::unique_ptr<CNodeVisibility> m_Visibility;
+
+	//Link pool before it is compacted. Each node has MAX_NODE_INITIAL_LINKS entries.
+	std::unique_ptr<CLink[]> m_InitialLinks;
+
+	//Index of the entity that blocks each link, or -1. Filled in after links are final.
+	std::unique_ptr<int[]> m_LinkEntities;
+
+private:
+	CNodeGraphCompiler( const CNodeGraphCompiler& ) = delete;
+	CNodeGraphCompiler& operator=( const CNodeGraphCompiler& ) = delete;
+};
+
+#endif //UTILS_NODEGRAPH_CNODEGRAPHCOMPILER_H
@@ -0,0 +1,141 @@
+//=========================================================
+// nodegraph - compiles the node graph for a map, so the game
+// doesn't have to build it the first time the map is loaded.
+//
+// Usage: nodegraph [-threads <count>] [-o <file>] <map.bsp>
+//
+// The graph is written to graphs/<map>.nod next to the bsp
+// unless another file is given. The tool must be built for
+// the same architecture as the game, since the file records
+// the size of pointers.
+//=========================================================
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "extdll.h"
+#include "util.h"
+#include "cbase.h"
+
+#include "CBSPWorld.h"
+#include "CNodeGraphCompiler.h"
+
+//The parts of the game that the graph code uses only print messages.
+enginefuncs_t g_engfuncs;
+globalvars_t* gpGlobals = nullptr;
+
+namespace
+{
+void AlertMessage( ALERT_TYPE aType, const char* pszFormat, ... )
+{
+	va_list list;
+
+	va_start( list, pszFormat );
+	vprintf( pszFormat, list );
+	va_end( list );
+}
+
+void PrintUsage()
+{
+	printf( "Usage: nodegraph [-threads <count>] [-o <file>] <map.bsp>\n" );
+}
+
+/*
+*	@return The default graph file for the given map: graphs/<map>.nod in the map's directory.
+*/
+std::string GetDefaultGraphFilename( const std::string& szBSPFilename )
+{
+	const size_t uiSlash = szBSPFilename.find_last_of( "/\\" );
+
+	const std::string szDirectory = uiSlash != std::string::npos ? szBSPFilename.substr( 0, uiSlash + 1 ) : "";
+	std::string szMapName = uiSlash != std::string::npos ? szBSPFilename.substr( uiSlash + 1 ) : szBSPFilename;
+
+	const size_t uiExtension = szMapName.rfind( '.' );
+
+	if( uiExtension != std::string::npos )
+		szMapName.resize( uiExtension );
+
+	const std::string szGraphDirectory = szDirectory + "graphs";
+
+#ifdef WIN32
+	_mkdir( szGraphDirectory.c_str() );
+#else
+	mkdir( szGraphDirectory.c_str(), 0777 );
+#endif
+
+	return szGraphDirectory + "/" + szMapName + ".nod";
+}
+}
+
+int main( int argc, char* argv[] )
+{
+	int iNumThreads = static_cast<int>( std::thread::hardware_concurrency() );
+	const char* pszBSPFilename = nullptr;
+	const char* pszGraphFilename = nullptr;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( !strcmp( argv[ i ], "-threads" ) && i + 1 < argc )
+		{
+			iNumThreads = atoi( argv[ ++i ] );
+		}
+		else if( !strcmp( argv[ i ], "-o" ) && i + 1 < argc )
+		{
+			pszGraphFilename = argv[ ++i ];
+		}
+		else if( argv[ i ][ 0 ] != '-' && !pszBSPFilename )
+		{
+			pszBSPFilename = argv[ i ];
+		}
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if( !pszBSPFilename )
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	g_engfuncs.pfnAlertMessage = &AlertMessage;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	CBSPWorld world;
+
+	world.Load( pszBSPFilename );
+
+	CNodeGraphCompiler compiler( world, iNumThreads );
+
+	if( !compiler.Build() )
+	{
+		printf( "Couldn't build the node graph for %s\n", pszBSPFilename );
+		return EXIT_FAILURE;
+	}
+
+	const std::string szGraphFilename = pszGraphFilename ? pszGraphFilename : GetDefaultGraphFilename( pszBSPFilename );
+
+	if( !compiler.Save( szGraphFilename.c_str() ) )
+	{
+		printf( "Couldn't write %s\n", szGraphFilename.c_str() );
+		return EXIT_FAILURE;
+	}
+
+	printf( "Created: %s (%.2f seconds)\n", szGraphFilename.c_str(), std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+
+	return EXIT_SUCCESS;
+}